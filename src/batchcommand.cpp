@@ -0,0 +1,311 @@
+#include "batchcommand.h"
+
+#include <QDebug>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QWidget>
+
+#include <core/notebookmgr.h>
+#include <core/exception.h>
+#include <core/vnotex.h>
+#include <core/thememgr.h>
+#include <export/exporter.h>
+#include <notebook/inotebookfactory.h>
+#include <notebook/notebook.h>
+#include <notebookbackend/asyncnotebookbackend.h>
+#include <notebookconfigmgr/vxnotebookchecker.h>
+#include <search/searcher.h>
+#include <search/searchresultitem.h>
+#include <utils/fileutils.h>
+#include <utils/pathutils.h>
+#include "commandlineoptions.h"
+
+using namespace vnotex;
+
+static QString locationTypeToString(LocationType p_type)
+{
+    switch (p_type) {
+    case LocationType::Buffer:
+        return QStringLiteral("buffer");
+
+    case LocationType::File:
+        return QStringLiteral("file");
+
+    case LocationType::Folder:
+        return QStringLiteral("folder");
+
+    case LocationType::Notebook:
+        return QStringLiteral("notebook");
+    }
+
+    return QString();
+}
+
+BatchCommand::BatchCommand(const CommandLineOptions &p_options)
+    : m_options(p_options),
+      m_out(stdout)
+{
+    m_out.setCodec("UTF-8");
+}
+
+BatchCommand::~BatchCommand()
+{
+}
+
+int BatchCommand::run()
+{
+    Q_ASSERT(m_options.hasBatchCommand());
+
+    const bool allOpened = openNotebooks();
+
+    int ret = ExitCode::Success;
+    if (m_options.m_check) {
+        ret = check();
+    } else if (m_options.m_reindex) {
+        ret = reindex();
+    } else if (!m_options.m_searchKeyword.isEmpty()) {
+        ret = search();
+    } else {
+        ret = doExport();
+    }
+
+    for (const auto &notebook : m_notebooks) {
+        notebook->getAsyncBackend()->waitForDone();
+    }
+
+    return allOpened ? ret : ExitCode::Failed;
+}
+
+bool BatchCommand::openNotebooks()
+{
+    m_notebookMgr.reset(new NotebookMgr());
+    m_notebookMgr->init();
+
+    bool allOpened = true;
+    for (const auto &folder : m_options.m_notebooks) {
+        const auto rootFolderPath = PathUtils::absolutePath(folder);
+        try {
+            auto backend = m_notebookMgr->createNotebookBackend(QStringLiteral("local.vnotex"), rootFolderPath);
+            m_notebooks.push_back(m_notebookMgr->getBundleNotebookFactory()->createNotebook(*m_notebookMgr,
+                                                                                            rootFolderPath,
+                                                                                            backend));
+        } catch (Exception &p_e) {
+            printError(rootFolderPath, QString("failed to open notebook (%1)").arg(p_e.what()));
+            allOpened = false;
+        }
+    }
+
+    return allOpened;
+}
+
+int BatchCommand::check()
+{
+    int ret = ExitCode::Success;
+    QJsonArray reports;
+    for (const auto &notebook : m_notebooks) {
+        const auto &rootFolderPath = notebook->getRootFolderAbsolutePath();
+        try {
+            VXNotebookChecker checker(notebook.data());
+            auto report = checker.check();
+            if (m_options.m_repair && !report.m_issues.isEmpty()) {
+                checker.repair(report);
+                notebook->getAsyncBackend()->waitForDone();
+            }
+
+            for (const auto &issue : report.m_issues) {
+                auto obj = issue.toJson();
+                obj[QStringLiteral("type")] = QStringLiteral("issue");
+                obj[QStringLiteral("issue")] = VXNotebookChecker::issueTypeToString(issue.m_type);
+                obj[QStringLiteral("notebook")] = rootFolderPath;
+                print(obj);
+
+                if (!issue.m_repaired) {
+                    ret = qMax<int>(ret, ExitCode::IssuesFound);
+                }
+            }
+
+            QJsonObject obj;
+            obj[QStringLiteral("type")] = QStringLiteral("checked");
+            obj[QStringLiteral("notebook")] = rootFolderPath;
+            obj[QStringLiteral("folders")] = report.m_folderCount;
+            obj[QStringLiteral("files")] = report.m_fileCount;
+            obj[QStringLiteral("issues")] = report.m_issues.size();
+            print(obj);
+
+            reports.append(report.toJson());
+        } catch (Exception &p_e) {
+            printError(rootFolderPath, QString("failed to check notebook (%1)").arg(p_e.what()));
+            ret = ExitCode::Failed;
+        }
+    }
+
+    if (!m_options.m_checkReportFile.isEmpty()) {
+        try {
+            FileUtils::writeFile(m_options.m_checkReportFile, QJsonDocument(reports).toJson());
+        } catch (Exception &p_e) {
+            printError(QString(), QString("failed to write report %1 (%2)").arg(m_options.m_checkReportFile, p_e.what()));
+            ret = ExitCode::Failed;
+        }
+    }
+
+    return ret;
+}
+
+int BatchCommand::reindex()
+{
+    int ret = ExitCode::Success;
+    for (const auto &notebook : m_notebooks) {
+        const auto &rootFolderPath = notebook->getRootFolderAbsolutePath();
+        try {
+            VXNotebookChecker checker(notebook.data());
+            const int cnt = checker.reindex();
+
+            QJsonObject obj;
+            obj[QStringLiteral("type")] = QStringLiteral("reindexed");
+            obj[QStringLiteral("notebook")] = rootFolderPath;
+            obj[QStringLiteral("fixed")] = cnt;
+            print(obj);
+        } catch (Exception &p_e) {
+            printError(rootFolderPath, QString("failed to reindex notebook (%1)").arg(p_e.what()));
+            ret = ExitCode::Failed;
+        }
+    }
+
+    return ret;
+}
+
+int BatchCommand::search()
+{
+    auto option = QSharedPointer<SearchOption>::create();
+    option->m_keyword = m_options.m_searchKeyword;
+    option->m_scope = SearchScope::AllNotebooks;
+
+    QVector<Notebook *> notebooks;
+    for (const auto &notebook : m_notebooks) {
+        notebooks.push_back(notebook.data());
+    }
+
+    int nrResults = 0;
+    auto printItem = [this, &nrResults](const QSharedPointer<SearchResultItem> &p_item) {
+        const auto &loc = p_item->m_location;
+        QJsonArray lines;
+        for (const auto &line : loc.m_lines) {
+            QJsonObject lineObj;
+            lineObj[QStringLiteral("line")] = line.m_lineNumber + 1;
+            lineObj[QStringLiteral("text")] = line.m_text;
+            lines.append(lineObj);
+        }
+
+        QJsonObject obj;
+        obj[QStringLiteral("type")] = QStringLiteral("match");
+        obj[QStringLiteral("kind")] = locationTypeToString(loc.m_type);
+        obj[QStringLiteral("path")] = loc.m_path;
+        obj[QStringLiteral("lines")] = lines;
+        print(obj);
+        ++nrResults;
+    };
+
+    Searcher searcher;
+    QObject::connect(&searcher, &Searcher::resultItemAdded, printItem);
+    QObject::connect(&searcher, &Searcher::resultItemsAdded,
+                     [&printItem](const QVector<QSharedPointer<SearchResultItem>> &p_items) {
+                         for (const auto &item : p_items) {
+                             printItem(item);
+                         }
+                     });
+    QObject::connect(&searcher, &Searcher::logRequested,
+                     [](const QString &p_log) {
+                         qInfo() << p_log;
+                     });
+
+    // Contents are searched in background when there are many candidates.
+    QEventLoop loop;
+    auto state = searcher.search(option, notebooks);
+    if (state == SearchState::Busy) {
+        QObject::connect(&searcher, &Searcher::finished,
+                         &loop, [&state, &loop](SearchState p_state) {
+                             state = p_state;
+                             loop.quit();
+                         });
+        loop.exec();
+    }
+
+    QJsonObject obj;
+    obj[QStringLiteral("type")] = QStringLiteral("searched");
+    obj[QStringLiteral("state")] = SearchStateToString(state);
+    obj[QStringLiteral("matches")] = nrResults;
+    print(obj);
+
+    if (state != SearchState::Finished) {
+        return ExitCode::Failed;
+    }
+    return nrResults > 0 ? ExitCode::Success : ExitCode::NothingFound;
+}
+
+int BatchCommand::doExport()
+{
+    ExportOption option;
+    option.m_source = ExportSource::CurrentNotebook;
+    option.m_outputDir = PathUtils::absolutePath(m_options.m_exportOutputDir);
+
+    // Host of the web view used to render HTML.
+    QScopedPointer<QWidget> host;
+    if (m_options.m_exportFormat == QStringLiteral("html")) {
+        option.m_targetFormat = ExportFormat::HTML;
+
+        const auto &theme = VNoteX::getInst().getThemeMgr().getCurrentTheme();
+        option.m_renderingStyleFile = theme.getFile(Theme::File::WebStyleSheet);
+        option.m_syntaxHighlightStyleFile = theme.getFile(Theme::File::HighlightStyleSheet);
+
+        host.reset(new QWidget());
+    } else {
+        option.m_targetFormat = ExportFormat::Markdown;
+    }
+
+    Exporter exporter(host.data());
+    QObject::connect(&exporter, &Exporter::logRequested,
+                     [](const QString &p_log) {
+                         qInfo() << p_log;
+                     });
+
+    int ret = ExitCode::Success;
+    for (const auto &notebook : m_notebooks) {
+        const auto &rootFolderPath = notebook->getRootFolderAbsolutePath();
+        try {
+            const auto files = exporter.doExport(option, notebook.data());
+            for (const auto &file : files) {
+                QJsonObject obj;
+                obj[QStringLiteral("type")] = QStringLiteral("exported");
+                obj[QStringLiteral("notebook")] = rootFolderPath;
+                obj[QStringLiteral("output")] = file;
+                print(obj);
+            }
+        } catch (Exception &p_e) {
+            printError(rootFolderPath, QString("failed to export notebook (%1)").arg(p_e.what()));
+            ret = ExitCode::Failed;
+        }
+    }
+
+    return ret;
+}
+
+void BatchCommand::print(const QJsonObject &p_obj)
+{
+    // Flush each line so that consumers could process results as they come.
+    m_out << QJsonDocument(p_obj).toJson(QJsonDocument::Compact) << '\n';
+    m_out.flush();
+}
+
+void BatchCommand::printError(const QString &p_notebook, const QString &p_msg)
+{
+    QJsonObject obj;
+    obj[QStringLiteral("type")] = QStringLiteral("error");
+    if (!p_notebook.isEmpty()) {
+        obj[QStringLiteral("notebook")] = p_notebook;
+    }
+    obj[QStringLiteral("message")] = p_msg;
+    print(obj);
+}
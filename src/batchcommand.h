@@ -0,0 +1,64 @@
+#ifndef BATCHCOMMAND_H
+#define BATCHCOMMAND_H
+
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QTextStream>
+#include <QVector>
+
+class CommandLineOptions;
+class QJsonObject;
+
+namespace vnotex
+{
+    class Notebook;
+    class NotebookMgr;
+}
+
+// Run a batch command given on the command line on notebooks without the main window.
+// Output is streamed to stdout as JSON Lines, one object per line with a "type" field.
+class BatchCommand
+{
+public:
+    enum ExitCode
+    {
+        Success = 0,
+        // Check left unrepaired issues or search found nothing.
+        NothingFound = 1,
+        IssuesFound = NothingFound,
+        // Some notebooks could not be opened or processed.
+        Failed = 2
+    };
+
+    explicit BatchCommand(const CommandLineOptions &p_options);
+
+    ~BatchCommand();
+
+    int run();
+
+private:
+    // Open notebooks standalone so that notebooks of the session are untouched.
+    bool openNotebooks();
+
+    int check();
+
+    int reindex();
+
+    int search();
+
+    int doExport();
+
+    void print(const QJsonObject &p_obj);
+
+    void printError(const QString &p_notebook, const QString &p_msg);
+
+    const CommandLineOptions &m_options;
+
+    QScopedPointer<vnotex::NotebookMgr> m_notebookMgr;
+
+    QVector<QSharedPointer<vnotex::Notebook>> m_notebooks;
+
+    QTextStream m_out;
+};
+
+#endif // BATCHCOMMAND_H
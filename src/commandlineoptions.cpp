@@ -22,6 +22,42 @@ CommandLineOptions::ParseResult CommandLineOptions::parse(const QStringList &p_a
     const QCommandLineOption verboseOpt("verbose", MainWindow::tr("Print more logs."));
     parser.addOption(verboseOpt);
 
+    // Batch commands.
+    const QCommandLineOption notebookOpt("notebook",
+                                         MainWindow::tr("Root folder of the notebook to run batch command on. "
+                                                        "Could be specified multiple times."),
+                                         "notebook_root_folder");
+    parser.addOption(notebookOpt);
+
+    const QCommandLineOption checkOpt("check", MainWindow::tr("Check integrity of notebooks and quit."));
+    parser.addOption(checkOpt);
+
+    const QCommandLineOption repairOpt("repair", MainWindow::tr("Repair issues found by --check."));
+    parser.addOption(repairOpt);
+
+    const QCommandLineOption checkReportOpt("check-report",
+                                            MainWindow::tr("Write report of --check to given file in JSON."),
+                                            "file");
+    parser.addOption(checkReportOpt);
+
+    const QCommandLineOption reindexOpt("reindex",
+                                        MainWindow::tr("Update configs of notebooks to match files on disk and quit."));
+    parser.addOption(reindexOpt);
+
+    const QCommandLineOption searchOpt("search",
+                                       MainWindow::tr("Search notebooks for keyword in names and contents and quit."),
+                                       "keyword");
+    parser.addOption(searchOpt);
+
+    const QCommandLineOption exportOpt("export",
+                                       MainWindow::tr("Export notebooks in given format (markdown or html) and quit. "
+                                                      "Exporting to HTML needs a display."),
+                                       "format");
+    parser.addOption(exportOpt);
+
+    const QCommandLineOption outputOpt("output", MainWindow::tr("Output folder of --export."), "folder");
+    parser.addOption(outputOpt);
+
     // WebEngine options.
     // No need to handle them. Just add them to the parser to avoid parse error.
     {
@@ -59,5 +95,90 @@ CommandLineOptions::ParseResult CommandLineOptions::parse(const QStringList &p_a
         m_verbose = true;
     }
 
+    m_notebooks = parser.values(notebookOpt);
+    m_check = parser.isSet(checkOpt);
+    m_repair = parser.isSet(repairOpt);
+    m_checkReportFile = parser.value(checkReportOpt);
+    m_reindex = parser.isSet(reindexOpt);
+    m_searchKeyword = parser.value(searchOpt);
+    m_exportFormat = parser.value(exportOpt).toLower();
+    m_exportOutputDir = parser.value(outputOpt);
+
+    const int nrCommands = (m_check ? 1 : 0) + (m_reindex ? 1 : 0)
+                           + (parser.isSet(searchOpt) ? 1 : 0) + (parser.isSet(exportOpt) ? 1 : 0);
+    if (nrCommands > 1) {
+        m_errorMsg = MainWindow::tr("Only one of --check, --reindex, --search and --export could be specified.");
+        return ParseResult::Error;
+    }
+
+    if (nrCommands == 1 && m_notebooks.isEmpty()) {
+        m_errorMsg = MainWindow::tr("Batch commands require --notebook.");
+        return ParseResult::Error;
+    }
+
+    if ((m_repair || !m_checkReportFile.isEmpty()) && !m_check) {
+        m_errorMsg = MainWindow::tr("--repair and --check-report require --check.");
+        return ParseResult::Error;
+    }
+
+    if (parser.isSet(searchOpt) && m_searchKeyword.isEmpty()) {
+        m_errorMsg = MainWindow::tr("--search requires a non-empty keyword.");
+        return ParseResult::Error;
+    }
+
+    if (parser.isSet(exportOpt)) {
+        if (m_exportFormat != QStringLiteral("markdown") && m_exportFormat != QStringLiteral("html")) {
+            m_errorMsg = MainWindow::tr("Unknown format of --export: %1.").arg(m_exportFormat);
+            return ParseResult::Error;
+        }
+
+        if (m_exportOutputDir.isEmpty()) {
+            m_errorMsg = MainWindow::tr("--export requires --output.");
+            return ParseResult::Error;
+        }
+    } else if (!m_exportOutputDir.isEmpty()) {
+        m_errorMsg = MainWindow::tr("--output requires --export.");
+        return ParseResult::Error;
+    }
+
     return ParseResult::Ok;
 }
+
+bool CommandLineOptions::hasBatchCommand() const
+{
+    return m_check || m_reindex || !m_searchKeyword.isEmpty() || !m_exportFormat.isEmpty();
+}
+
+bool CommandLineOptions::isHeadless(int p_argc, char *p_argv[])
+{
+    for (int i = 1; i < p_argc; ++i) {
+        const auto arg = QString::fromLocal8Bit(p_argv[i]);
+        if (!arg.startsWith(QLatin1Char('-'))) {
+            continue;
+        }
+
+        // Accept -name, --name and --name=value.
+        auto name = arg.mid(arg.startsWith(QStringLiteral("--")) ? 2 : 1);
+        QString value;
+        const int idx = name.indexOf(QLatin1Char('='));
+        if (idx != -1) {
+            value = name.mid(idx + 1);
+            name = name.left(idx);
+        } else if (i + 1 < p_argc) {
+            value = QString::fromLocal8Bit(p_argv[i + 1]);
+        }
+
+        if (name == QStringLiteral("check")
+            || name == QStringLiteral("reindex")
+            || name == QStringLiteral("search")) {
+            return true;
+        }
+
+        // HTML is rendered by WebEngine, which needs a GUI application.
+        if (name == QStringLiteral("export")) {
+            return value.toLower() != QStringLiteral("html");
+        }
+    }
+
+    return false;
+}
@@ -18,6 +18,13 @@ public:
 
     ParseResult parse(const QStringList &p_arguments);
 
+    // Whether any batch command is requested.
+    bool hasBatchCommand() const;
+
+    // Whether @p_argv requests a batch command that runs without GUI.
+    // Called before the application is created.
+    static bool isHeadless(int p_argc, char *p_argv[]);
+
     QString m_errorMsg;
 
     QString m_helpText;
@@ -25,6 +32,27 @@ public:
     QStringList m_pathsToOpen;
 
     bool m_verbose = false;
+
+    // Batch commands run on notebooks without opening the main window.
+    // Root folders of notebooks to run on.
+    QStringList m_notebooks;
+
+    bool m_check = false;
+
+    // Repair issues found by check.
+    bool m_repair = false;
+
+    // File to write the check report in JSON.
+    QString m_checkReportFile;
+
+    bool m_reindex = false;
+
+    QString m_searchKeyword;
+
+    // markdown or html.
+    QString m_exportFormat;
+
+    QString m_exportOutputDir;
 };
 
 #endif // COMMANDLINEOPTIONS_H
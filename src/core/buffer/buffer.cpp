@@ -1,11 +1,16 @@
 #include "buffer.h"
 
 #include <QTimer>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include <notebook/node.h>
 #include <utils/fileutils.h>
 #include <widgets/viewwindow.h>
 #include <utils/pathutils.h>
+#include <utils/textutils.h>
+#include <utils/mappedtextfile.h>
 
 #include <core/configmgr.h>
 #include <core/editorconfig.h>
@@ -15,12 +20,86 @@
 
 using namespace vnotex;
 
+const int Buffer::c_maxBackupRecordCount = 500;
+
+const int Buffer::c_minBackupJournalSize = 64 * 1024;
+
 static vnotex::ID generateBufferID()
 {
     static vnotex::ID id = 0;
     return ++id;
 }
 
+static quint64 generateAccessStamp()
+{
+    static quint64 stamp = 0;
+    return ++stamp;
+}
+
+// Backup journal is a head line "vnotex_backup_journal <path>|<base size>", the base
+// snapshot of the content and then one TextUtils::patchToString() record per change.
+static QString replayBackupJournal(const QString &p_text)
+{
+    const int eol = p_text.indexOf(QLatin1Char('\n'));
+    const int sep = p_text.lastIndexOf(QLatin1Char('|'), eol);
+    if (eol == -1 || sep == -1) {
+        qWarning() << "invalid head of backup journal";
+        return QString();
+    }
+
+    bool ok = false;
+    const int baseSize = p_text.mid(sep + 1, eol - sep - 1).toInt(&ok);
+    if (!ok || baseSize < 0 || eol + 1 + baseSize > p_text.size()) {
+        qWarning() << "invalid base snapshot of backup journal";
+        return p_text.mid(eol + 1);
+    }
+
+    auto lines = p_text.mid(eol + 1, baseSize).split(QLatin1Char('\n'));
+    int pos = eol + 1 + baseSize;
+    TextUtils::LinePatch patch;
+    while (TextUtils::patchFromString(p_text, pos, patch)) {
+        if (patch.m_startLine + patch.m_removedCount > lines.size()) {
+            break;
+        }
+
+        TextUtils::applyPatch(lines, patch);
+    }
+
+    if (pos < p_text.size()) {
+        // Crashed during appending.
+        qWarning() << "ignored incomplete records of backup journal" << (p_text.size() - pos);
+    }
+
+    return lines.join(QLatin1Char('\n'));
+}
+
+class Buffer::SaveTask : public QRunnable
+{
+public:
+    SaveTask(Buffer *p_buffer, const QSharedPointer<PendingSave> &p_save)
+        : m_buffer(p_buffer),
+          m_save(p_save)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        m_save->m_result = Buffer::executeSaveJob(m_save->m_job);
+
+        // The buffer waits for the pool before being deleted.
+        auto buffer = m_buffer;
+        auto save = m_save;
+        QMetaObject::invokeMethod(buffer, [buffer, save]() {
+            buffer->finishSaveTask(save);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    Buffer *m_buffer = nullptr;
+
+    QSharedPointer<PendingSave> m_save;
+};
+
 Buffer::Buffer(const BufferParameters &p_parameters,
                QObject *p_parent)
     : QObject(p_parent),
@@ -34,14 +113,21 @@ Buffer::Buffer(const BufferParameters &p_parameters,
     connect(m_autoSaveTimer, &QTimer::timeout,
             this, &Buffer::autoSave);
 
+    m_saveThreadPool = new QThreadPool(this);
+    m_saveThreadPool->setMaxThreadCount(1);
+
+    openLargeFile();
     readContent();
+    markAccessed();
 
     checkBackupFileOfPreviousSession();
 }
 
 Buffer::~Buffer()
 {
-    Q_ASSERT(m_attachedViewWindowCount == 0);
+    m_saveThreadPool->waitForDone();
+
+    Q_ASSERT(m_attachedViewWindows.isEmpty());
     Q_ASSERT(!m_viewWindowToSync);
     Q_ASSERT(!isModified());
     Q_ASSERT(m_backupFilePath.isEmpty());
@@ -49,24 +135,25 @@ Buffer::~Buffer()
 
 int Buffer::getAttachViewWindowCount() const
 {
-    return m_attachedViewWindowCount;
+    return m_attachedViewWindows.size();
 }
 
 void Buffer::attachViewWindow(ViewWindow *p_win)
 {
-    Q_UNUSED(p_win);
     Q_ASSERT(!(m_state & StateFlag::Discarded));
-    ++m_attachedViewWindowCount;
+    Q_ASSERT(!m_attachedViewWindows.contains(p_win));
+    m_attachedViewWindows.push_back(p_win);
 }
 
 void Buffer::detachViewWindow(ViewWindow *p_win)
 {
     Q_ASSERT(p_win != m_viewWindowToSync);
 
-    --m_attachedViewWindowCount;
-    Q_ASSERT(m_attachedViewWindowCount >= 0);
+    const bool removed = m_attachedViewWindows.removeOne(p_win);
+    Q_ASSERT(removed);
+    Q_UNUSED(removed);
 
-    if (m_attachedViewWindowCount == 0) {
+    if (m_attachedViewWindows.isEmpty()) {
         emit attachedViewWindowEmpty();
     }
 }
@@ -125,6 +212,7 @@ void Buffer::setContent(const QString &p_content, int &p_revision)
 {
     m_viewWindowToSync = nullptr;
     m_content = p_content;
+    m_contentEvicted = false;
     p_revision = ++m_revision;
     setModified(true);
     m_autoSaveTimer->start();
@@ -138,6 +226,8 @@ void Buffer::invalidateContent(const ViewWindow *p_win,
     ++m_revision;
     p_setRevision(m_revision);
     m_viewWindowToSync = p_win;
+    // Content will be synced from @p_win.
+    m_contentEvicted = false;
     m_autoSaveTimer->start();
     emit contentsChanged();
 }
@@ -160,7 +250,15 @@ void Buffer::syncContent()
         // Need to sync content.
         m_content = m_viewWindowToSync->getLatestContent();
         m_viewWindowToSync = nullptr;
+    } else if (m_contentEvicted) {
+        // Changes made outside meanwhile are left to checkFileChangedOutside().
+        m_content = m_provider->reread();
+        m_contentEvicted = false;
+        qDebug() << "reloaded evicted buffer content" << getPath() << m_content.size();
+        emit contentReloaded();
     }
+
+    markAccessed();
 }
 
 bool Buffer::isModified() const
@@ -183,6 +281,42 @@ bool Buffer::isReadOnly() const
     return m_readOnly;
 }
 
+bool Buffer::isLargeFile() const
+{
+    return !m_largeFile.isNull();
+}
+
+QSharedPointer<const MappedTextFile> Buffer::getLargeFile() const
+{
+    return m_largeFile;
+}
+
+void Buffer::openLargeFile()
+{
+    const qint64 threshold = static_cast<qint64>(ConfigMgr::getInst().getEditorConfig().getLargeFileSize()) * 1024 * 1024;
+    const auto contentPath = getContentPath();
+    if (threshold <= 0 || QFileInfo(contentPath).size() < threshold) {
+        return;
+    }
+
+    auto file = QSharedPointer<MappedTextFile>::create(contentPath);
+    if (!file->open()) {
+        qWarning() << "failed to map large file, read it as a whole" << contentPath;
+        return;
+    }
+
+    qInfo() << "open large file read-only" << contentPath << file->size() << "pages" << file->pageCount();
+    m_largeFile = file;
+    m_readOnly = true;
+}
+
+bool Buffer::needSave(bool p_force) const
+{
+    return m_modified
+           || p_force
+           || m_state & (StateFlag::FileMissingOnDisk | StateFlag::FileChangedOutside);
+}
+
 Buffer::OperationCode Buffer::save(bool p_force)
 {
     Q_ASSERT(!m_readOnly);
@@ -190,36 +324,152 @@ Buffer::OperationCode Buffer::save(bool p_force)
         return OperationCode::Failed;
     }
 
-    if (m_modified
-        || p_force
-        || m_state & (StateFlag::FileMissingOnDisk | StateFlag::FileChangedOutside)) {
-        syncContent();
+    waitForSave();
+
+    if (!needSave(p_force)) {
+        return OperationCode::Success;
+    }
+
+    syncContent();
+
+    const auto job = prepareSaveJob(p_force);
+    const auto result = executeSaveJob(job);
+    finishSave(job, result);
+    return result.m_code;
+}
+
+void Buffer::saveAsync(bool p_force)
+{
+    Q_ASSERT(!m_readOnly);
+    if (m_readOnly) {
+        return;
+    }
+
+    if (m_pendingSave) {
+        // Save the latest content once current save finishes.
+        m_saveRequested = true;
+        m_forceSaveRequested = m_forceSaveRequested || p_force;
+        return;
+    }
+
+    if (!needSave(p_force)) {
+        return;
+    }
+
+    syncContent();
+
+    m_pendingSave.reset(new PendingSave());
+    m_pendingSave->m_job = prepareSaveJob(p_force);
+    m_saveThreadPool->start(new SaveTask(this, m_pendingSave));
+}
+
+Buffer::SaveJob Buffer::prepareSaveJob(bool p_force)
+{
+    SaveJob job;
+    job.m_filePath = getContentPath();
+    job.m_content = m_content;
+    job.m_revision = m_revision;
+    job.m_lastModified = m_provider->getLastModified();
+    job.m_force = p_force;
+    return job;
+}
 
-        // We do not involve user here to handle file missing and changed outside cases.
-        // The active ViewWindow will check this periodically.
-        // Check if file still exists.
-        if (!p_force && !checkFileExistsOnDisk()) {
-            qWarning() << "failed to save buffer due to file missing on disk" << getPath();
-            return OperationCode::FileMissingOnDisk;
+Buffer::SaveResult Buffer::executeSaveJob(const SaveJob &p_job)
+{
+    SaveResult result;
+
+    // We do not involve user here to handle file missing and changed outside cases.
+    // The active ViewWindow will check this periodically.
+    if (!p_job.m_force) {
+        QFileInfo info(p_job.m_filePath);
+        if (!info.exists()) {
+            qWarning() << "failed to save buffer due to file missing on disk" << p_job.m_filePath;
+            result.m_code = OperationCode::FileMissingOnDisk;
+            return result;
         }
 
-        // Check if file is modified outside.
-        if (!p_force && checkFileChangedOutside()) {
-            qWarning() << "failed to save buffer due to file changed from outside" << getPath();
-            return OperationCode::FileChangedOutside;
+        if (info.lastModified() != p_job.m_lastModified) {
+            qWarning() << "failed to save buffer due to file changed from outside" << p_job.m_filePath;
+            result.m_code = OperationCode::FileChangedOutside;
+            return result;
         }
+    }
 
-        try {
-            m_provider->write(m_content);
-        } catch (Exception &p_e) {
-            qWarning() << "failed to write the buffer content" << getPath() << p_e.what();
-            return OperationCode::Failed;
+    try {
+        FileUtils::writeFileAtomically(p_job.m_filePath, p_job.m_content);
+    } catch (Exception &p_e) {
+        qWarning() << "failed to write the buffer content" << p_job.m_filePath << p_e.what();
+        result.m_code = OperationCode::Failed;
+        return result;
+    }
+
+    result.m_lastModified = QFileInfo(p_job.m_filePath).lastModified();
+    return result;
+}
+
+void Buffer::finishSaveTask(const QSharedPointer<PendingSave> &p_save)
+{
+    // Already applied by waitForSave().
+    if (p_save != m_pendingSave) {
+        return;
+    }
+
+    m_pendingSave.reset();
+    finishSave(p_save->m_job, p_save->m_result);
+
+    if (m_saveRequested) {
+        const bool force = m_forceSaveRequested;
+        m_saveRequested = false;
+        m_forceSaveRequested = false;
+        if (!(m_state & StateFlag::Discarded)) {
+            saveAsync(force);
         }
+    }
+}
 
-        setModified(false);
+void Buffer::finishSave(const SaveJob &p_job, const SaveResult &p_result)
+{
+    switch (p_result.m_code) {
+    case OperationCode::Success:
         m_state &= ~(StateFlag::FileMissingOnDisk | StateFlag::FileChangedOutside);
+        m_provider->contentWritten(p_result.m_lastModified);
+        // Content may be changed during the save.
+        if (p_job.m_revision == m_revision) {
+            setModified(false);
+        }
+        break;
+
+    case OperationCode::FileMissingOnDisk:
+        m_state |= StateFlag::FileMissingOnDisk;
+        break;
+
+    case OperationCode::FileChangedOutside:
+        m_state |= StateFlag::FileChangedOutside;
+        break;
+
+    case OperationCode::Failed:
+        break;
     }
-    return OperationCode::Success;
+
+    emit saveFinished(p_result.m_code, p_job.m_revision);
+}
+
+void Buffer::waitForSave()
+{
+    if (!m_pendingSave) {
+        return;
+    }
+
+    m_saveThreadPool->waitForDone();
+
+    // Apply the result now. The queued notification will be ignored.
+    auto save = m_pendingSave;
+    m_pendingSave.reset();
+    finishSave(save->m_job, save->m_result);
+
+    // The caller will handle the latest content.
+    m_saveRequested = false;
+    m_forceSaveRequested = false;
 }
 
 Buffer::OperationCode Buffer::reload()
@@ -242,7 +492,23 @@ Buffer::OperationCode Buffer::reload()
 
 void Buffer::readContent()
 {
-    m_content = m_provider->read();
+    if (m_largeFile) {
+        // View windows read pages on demand. Mapped and indexed already unless changed.
+        // Map into a new one since the old one may still be in use.
+        if (m_largeFile->isStale()) {
+            auto file = QSharedPointer<MappedTextFile>::create(getContentPath());
+            if (file->open()) {
+                m_largeFile = file;
+            } else {
+                qWarning() << "failed to map large file" << getContentPath();
+            }
+        }
+        m_provider->refreshLastModified();
+        m_content.clear();
+    } else {
+        m_content = m_provider->read();
+    }
+    m_contentEvicted = false;
     ++m_revision;
 
     // Reset state.
@@ -253,9 +519,11 @@ void Buffer::readContent()
 void Buffer::discard()
 {
     Q_ASSERT(!(m_state & StateFlag::Discarded));
-    Q_ASSERT(m_attachedViewWindowCount == 1);
+    Q_ASSERT(m_attachedViewWindows.size() == 1);
     m_autoSaveTimer->stop();
+    waitForSave();
     m_content.clear();
+    m_contentEvicted = false;
     m_state |= StateFlag::Discarded;
     ++m_revision;
 
@@ -267,9 +535,12 @@ void Buffer::close()
 {
     // Delete the backup file if exists.
     m_autoSaveTimer->stop();
+    waitForSave();
     if (!m_backupFilePath.isEmpty()) {
         FileUtils::removeFile(m_backupFilePath);
         m_backupFilePath.clear();
+        m_backupLines.clear();
+        m_backupSnapshotNeeded = true;
     }
 }
 
@@ -318,9 +589,8 @@ void Buffer::autoSave()
         return;
 
     case EditorConfig::AutoSavePolicy::AutoSave:
-        if (save(false) != OperationCode::Success) {
-            qWarning() << "AutoSave failed to save buffer, retry later";
-        }
+        // Failures are reported via saveFinished() and retried on next change.
+        saveAsync(false);
         break;
 
     case EditorConfig::AutoSavePolicy::BackupFile:
@@ -350,7 +620,38 @@ void Buffer::writeBackupFile()
     Q_ASSERT(m_backupFilePathOfPreviousSession.isEmpty());
 
     // Just use FileUtils instead of notebook backend.
-    FileUtils::writeFile(m_backupFilePath, generateBackupFileHead() + getContent());
+    const auto &content = getContent();
+    auto lines = content.split(QLatin1Char('\n'));
+    if (!m_backupSnapshotNeeded
+        && m_backupRecordCount < c_maxBackupRecordCount
+        && m_backupJournalSize < qMax<qint64>(m_backupBaseSize / 2, c_minBackupJournalSize)) {
+        const auto patch = TextUtils::diffLines(m_backupLines, lines);
+        if (patch.isEmpty()) {
+            return;
+        }
+
+        const auto record = TextUtils::patchToString(patch);
+
+        // A failed append may leave an incomplete record behind.
+        m_backupSnapshotNeeded = true;
+        FileUtils::appendFile(m_backupFilePath, record);
+        m_backupSnapshotNeeded = false;
+
+        m_backupJournalSize += record.size();
+        ++m_backupRecordCount;
+    } else {
+        FileUtils::writeFileAtomically(m_backupFilePath,
+                                       generateBackupJournalHead()
+                                       + QString::number(content.size())
+                                       + QLatin1Char('\n')
+                                       + content);
+        m_backupSnapshotNeeded = false;
+        m_backupBaseSize = content.size();
+        m_backupJournalSize = 0;
+        m_backupRecordCount = 0;
+    }
+
+    m_backupLines = lines;
 }
 
 QString Buffer::generateBackupFileHead() const
@@ -358,8 +659,18 @@ QString Buffer::generateBackupFileHead() const
     return QString("vnotex_backup_file %1|").arg(getContentPath());
 }
 
+QString Buffer::generateBackupJournalHead() const
+{
+    return QString("vnotex_backup_journal %1|").arg(getContentPath());
+}
+
 void Buffer::checkBackupFileOfPreviousSession()
 {
+    // Large files are read-only.
+    if (m_largeFile) {
+        return;
+    }
+
     const auto &config = ConfigMgr::getInst().getEditorConfig();
     if (config.getAutoSavePolicy() != EditorConfig::AutoSavePolicy::BackupFile) {
         return;
@@ -406,7 +717,7 @@ bool Buffer::isBackupFileOfBuffer(const QString &p_file) const
 
     QTextStream st(&file);
     const auto head = st.readLine();
-    return head.startsWith(generateBackupFileHead());
+    return head.startsWith(generateBackupJournalHead()) || head.startsWith(generateBackupFileHead());
 }
 
 const QString &Buffer::getBackupFileOfPreviousSession() const
@@ -417,6 +728,11 @@ const QString &Buffer::getBackupFileOfPreviousSession() const
 QString Buffer::readBackupFile(const QString &p_filePath)
 {
     auto content = FileUtils::readTextFile(p_filePath);
+    if (content.startsWith(QStringLiteral("vnotex_backup_journal "))) {
+        return replayBackupJournal(content);
+    }
+
+    // Backup file of previous versions with the whole content after the head.
     return content.mid(content.indexOf(QLatin1Char('|')) + 1);
 }
 
@@ -434,6 +750,7 @@ void Buffer::recoverFromBackupFileOfPreviousSession()
     Q_ASSERT(!m_backupFilePathOfPreviousSession.isEmpty());
 
     m_content = readBackupFile(m_backupFilePathOfPreviousSession);
+    m_contentEvicted = false;
     m_provider->write(m_content);
     ++m_revision;
 
@@ -549,6 +866,11 @@ bool Buffer::checkFileExistsOnDisk()
 
 bool Buffer::checkFileChangedOutside()
 {
+    // The file is being replaced by our own save, which will update the state once done.
+    if (m_pendingSave) {
+        return m_state.testFlag(StateFlag::FileChangedOutside);
+    }
+
     if (m_provider->checkFileChangedOutside()) {
         m_state |= StateFlag::FileChangedOutside;
         return true;
@@ -567,3 +889,63 @@ QSharedPointer<File> Buffer::getFile() const
 {
     return m_provider->getFile();
 }
+
+qint64 Buffer::getResidentBytes() const
+{
+    return static_cast<qint64>(m_content.capacity()) * sizeof(QChar);
+}
+
+bool Buffer::hasVisibleViewWindow() const
+{
+    for (auto win : m_attachedViewWindows) {
+        if (win->isVisible()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Buffer::isContentEvictable() const
+{
+    if (m_contentEvicted || m_modified || m_viewWindowToSync || m_pendingSave || m_content.isEmpty()) {
+        return false;
+    }
+
+    if (m_state & (StateFlag::FileMissingOnDisk | StateFlag::FileChangedOutside | StateFlag::Discarded)) {
+        return false;
+    }
+
+    // Compared with the content once the user decides.
+    if (!m_backupFilePathOfPreviousSession.isEmpty()) {
+        return false;
+    }
+
+    return !hasVisibleViewWindow();
+}
+
+void Buffer::evictContent()
+{
+    Q_ASSERT(isContentEvictable());
+    m_content = QString();
+    m_contentEvicted = true;
+
+    // Backup journal diffs against the content.
+    m_backupSnapshotNeeded = true;
+    m_backupLines.clear();
+}
+
+bool Buffer::isContentEvicted() const
+{
+    return m_contentEvicted;
+}
+
+quint64 Buffer::getLastAccessStamp() const
+{
+    return m_lastAccessStamp;
+}
+
+void Buffer::markAccessed()
+{
+    m_lastAccessStamp = generateAccessStamp();
+}
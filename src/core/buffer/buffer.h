@@ -2,7 +2,11 @@
 #define BUFFER_H
 
 #include <QObject>
+#include <QScopedPointer>
 #include <QSharedPointer>
+#include <QStringList>
+#include <QDateTime>
+#include <QVector>
 
 #include <functional>
 
@@ -10,6 +14,7 @@
 
 class QWidget;
 class QTimer;
+class QThreadPool;
 
 namespace vnotex
 {
@@ -19,6 +24,7 @@ namespace vnotex
     struct FileOpenParameters;
     class BufferProvider;
     class File;
+    class MappedTextFile;
 
     struct BufferParameters
     {
@@ -114,9 +120,23 @@ namespace vnotex
 
         bool isReadOnly() const;
 
+        // Large file is opened read-only and mapped instead of read into content.
+        bool isLargeFile() const;
+
+        // Return null if not a large file.
+        // The file is replaced by a new one once remapped on reload. Holders of the old one
+        // could keep using it, such as to search in background.
+        QSharedPointer<const MappedTextFile> getLargeFile() const;
+
         // Save buffer content to file.
+        // Wait for any pending asynchronous save and write synchronously.
         OperationCode save(bool p_force);
 
+        // Save buffer content to file on the I/O thread of this buffer.
+        // saveFinished() will be emitted once done. Requests during a running save are
+        // coalesced into one save of the latest content after it.
+        void saveAsync(bool p_force);
+
         // Discard changes and reload file.
         OperationCode reload();
 
@@ -169,12 +189,31 @@ namespace vnotex
 
         bool checkFileExistsOnDisk();
 
+        // Keep the last state while a save is pending.
         bool checkFileChangedOutside();
 
         StateFlags state() const;
 
         static QString readBackupFile(const QString &p_filePath);
 
+        // Memory held by the content in bytes.
+        qint64 getResidentBytes() const;
+
+        bool hasVisibleViewWindow() const;
+
+        // Whether the content could be dropped and read from file again on demand.
+        bool isContentEvictable() const;
+
+        // Drop the content. It will be read from file on next access.
+        void evictContent();
+
+        bool isContentEvicted() const;
+
+        // Larger for more recently accessed buffers.
+        quint64 getLastAccessStamp() const;
+
+        void markAccessed();
+
     signals:
         void attachedViewWindowEmpty();
 
@@ -186,6 +225,12 @@ namespace vnotex
 
         void attachmentChanged();
 
+        // Emitted when a save finishes. @p_revision is the revision of the saved content.
+        void saveFinished(Buffer::OperationCode p_code, int p_revision);
+
+        // Evicted content is read back from file.
+        void contentReloaded();
+
     protected:
         virtual ViewWindow *createViewWindowInternal(const QSharedPointer<FileOpenParameters> &p_paras, QWidget *p_parent) = 0;
 
@@ -195,18 +240,73 @@ namespace vnotex
         void autoSave();
 
     private:
+        class SaveTask;
+
+        struct SaveJob
+        {
+            QString m_filePath;
+
+            QString m_content;
+
+            int m_revision = 0;
+
+            // Last modified time of the file when it was last read or written.
+            QDateTime m_lastModified;
+
+            bool m_force = false;
+        };
+
+        struct SaveResult
+        {
+            OperationCode m_code = OperationCode::Success;
+
+            // Last modified time of the file after written.
+            QDateTime m_lastModified;
+        };
+
+        // Save handed to the I/O thread. Result is set before the task finishes.
+        struct PendingSave
+        {
+            SaveJob m_job;
+
+            SaveResult m_result;
+        };
+
+        // Sync content with the view window to sync, or read it back if evicted.
         void syncContent();
 
+        // Whether there is anything to save.
+        bool needSave(bool p_force) const;
+
+        SaveJob prepareSaveJob(bool p_force);
+
+        // Called on the I/O thread.
+        static SaveResult executeSaveJob(const SaveJob &p_job);
+
+        void finishSaveTask(const QSharedPointer<PendingSave> &p_save);
+
+        void finishSave(const SaveJob &p_job, const SaveResult &p_result);
+
+        void waitForSave();
+
         void readContent();
 
+        // Map the content file if it is large enough.
+        void openLargeFile();
+
         // Get the path of the image folder.
         QString getImageFolderPath() const;
 
+        // Append the changes since last write to the backup journal, or rewrite it
+        // as a new base snapshot once the journal grows too long.
         void writeBackupFile();
 
         // Generate backup file head.
         QString generateBackupFileHead() const;
 
+        // Generate head of backup file in journal format.
+        QString generateBackupJournalHead() const;
+
         void checkBackupFileOfPreviousSession();
 
         bool isBackupFileOfBuffer(const QString &p_file) const;
@@ -223,9 +323,15 @@ namespace vnotex
 
         bool m_readOnly = false;
 
+        QSharedPointer<MappedTextFile> m_largeFile;
+
         bool m_modified = false;
 
-        int m_attachedViewWindowCount = 0;
+        QVector<ViewWindow *> m_attachedViewWindows;
+
+        bool m_contentEvicted = false;
+
+        quint64 m_lastAccessStamp = 0;
 
         const ViewWindow *m_viewWindowToSync = nullptr;
 
@@ -236,7 +342,39 @@ namespace vnotex
 
         QString m_backupFilePathOfPreviousSession;
 
+        // Lines of the content last written to the backup file.
+        QStringList m_backupLines;
+
+        // Size of the base snapshot in the backup file.
+        int m_backupBaseSize = 0;
+
+        // Size and count of the records appended after the base snapshot.
+        qint64 m_backupJournalSize = 0;
+
+        int m_backupRecordCount = 0;
+
+        // Rewrite the whole backup file on next write.
+        bool m_backupSnapshotNeeded = true;
+
         StateFlags m_state = StateFlag::Normal;
+
+        // Single thread to serialize saves of this buffer.
+        // Managed by QObject.
+        QThreadPool *m_saveThreadPool = nullptr;
+
+        // Save running on m_saveThreadPool.
+        QSharedPointer<PendingSave> m_pendingSave;
+
+        // Another save is requested while one is running.
+        bool m_saveRequested = false;
+
+        bool m_forceSaveRequested = false;
+
+        // Compact the backup journal once it has more records than this.
+        static const int c_maxBackupRecordCount;
+
+        // Do not compact the backup journal before it reaches this size.
+        static const int c_minBackupJournalSize;
     };
 } // ns vnotex
 
@@ -2,6 +2,8 @@
 
 #include <QFileInfo>
 
+#include <core/file.h>
+
 using namespace vnotex;
 
 bool BufferProvider::checkFileExistsOnDisk() const
@@ -14,6 +16,34 @@ QDateTime BufferProvider::getLastModifiedFromFile() const
     return QFileInfo(getContentPath()).lastModified();
 }
 
+const QDateTime &BufferProvider::getLastModified() const
+{
+    return m_lastModified;
+}
+
+void BufferProvider::contentWritten(const QDateTime &p_lastModified)
+{
+    m_lastModified = p_lastModified;
+
+    auto file = getFile();
+    if (file) {
+        file->contentWritten();
+    }
+}
+
+QString BufferProvider::reread()
+{
+    const auto lastModified = m_lastModified;
+    auto content = read();
+    m_lastModified = lastModified;
+    return content;
+}
+
+void BufferProvider::refreshLastModified()
+{
+    m_lastModified = getLastModifiedFromFile();
+}
+
 bool BufferProvider::checkFileChangedOutside() const
 {
     QFileInfo info(getContentPath());
@@ -40,6 +40,13 @@ namespace vnotex
 
         virtual QString read() const = 0;
 
+        // Read the content again without updating the last modified time, so that
+        // changes made outside since last read() are still reported.
+        QString reread();
+
+        // Take the current last modified time of the file, for content not read via read().
+        void refreshLastModified();
+
         virtual QString fetchImageFolderPath() = 0;
 
         virtual bool isChildOf(const Node *p_node) const = 0;
@@ -72,6 +79,12 @@ namespace vnotex
 
         virtual bool checkFileChangedOutside() const;
 
+        // Last modified time of the content file after last read or write.
+        const QDateTime &getLastModified() const;
+
+        // The content file has been written to @p_lastModified bypassing write().
+        void contentWritten(const QDateTime &p_lastModified);
+
         virtual bool isReadOnly() const = 0;
 
         // Return nullptr if not available.
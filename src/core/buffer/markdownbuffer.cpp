@@ -3,6 +3,7 @@
 #include <QDir>
 
 #include <widgets/markdownviewwindow.h>
+#include <widgets/textviewwindow.h>
 #include <notebook/node.h>
 #include <utils/pathutils.h>
 #include <buffer/bufferprovider.h>
@@ -19,6 +20,10 @@ MarkdownBuffer::MarkdownBuffer(const BufferParameters &p_parameters,
 ViewWindow *MarkdownBuffer::createViewWindowInternal(const QSharedPointer<FileOpenParameters> &p_paras, QWidget *p_parent)
 {
     Q_UNUSED(p_paras);
+    // Large file is shown as plain text page by page, without highlighting, preview or outline.
+    if (isLargeFile()) {
+        return new TextViewWindow(p_parent);
+    }
     return new MarkdownViewWindow(p_parent);
 }
 
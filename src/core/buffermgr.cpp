@@ -2,6 +2,9 @@
 
 #include <QUrl>
 #include <QDebug>
+#include <QTimer>
+
+#include <algorithm>
 
 #include <notebook/node.h>
 #include <buffer/filetypehelper.h>
@@ -11,8 +14,11 @@
 #include <buffer/nodebufferprovider.h>
 #include <buffer/filebufferprovider.h>
 #include <utils/widgetutils.h>
+#include <utils/pathutils.h>
 #include "notebookmgr.h"
 #include "vnotex.h"
+#include "configmgr.h"
+#include "editorconfig.h"
 #include "externalfile.h"
 
 #include "fileopenparameters.h"
@@ -32,6 +38,13 @@ BufferMgr::~BufferMgr()
 void BufferMgr::init()
 {
     initBufferServer();
+
+    // Let newly opened view windows show up first.
+    m_memoryBudgetTimer = new QTimer(this);
+    m_memoryBudgetTimer->setSingleShot(true);
+    m_memoryBudgetTimer->setInterval(1000);
+    connect(m_memoryBudgetTimer, &QTimer::timeout,
+            this, &BufferMgr::enforceMemoryBudget);
 }
 
 void BufferMgr::initBufferServer()
@@ -149,45 +162,158 @@ void BufferMgr::open(const QString &p_filePath, const QSharedPointer<FileOpenPar
 
 Buffer *BufferMgr::findBuffer(const Node *p_node) const
 {
-    auto it = std::find_if(m_buffers.constBegin(),
-                           m_buffers.constEnd(),
-                           [p_node](const Buffer *p_buffer) {
-                               return p_buffer->match(p_node);
-                           });
-    if (it != m_buffers.constEnd()) {
-        return *it;
-    }
-
-    return nullptr;
+    auto buffer = m_nodeIndex.value(p_node, nullptr);
+    Q_ASSERT(!buffer || buffer->match(p_node));
+    return buffer;
 }
 
 Buffer *BufferMgr::findBuffer(const QString &p_filePath) const
 {
-    auto it = std::find_if(m_buffers.constBegin(),
-                           m_buffers.constEnd(),
-                           [p_filePath](const Buffer *p_buffer) {
-                               return p_buffer->match(p_filePath);
-                           });
-    if (it != m_buffers.constEnd()) {
-        return *it;
+    validatePathIndex();
+    auto buffer = m_pathIndex.value(PathUtils::normalizePath(p_filePath), nullptr);
+    Q_ASSERT(!buffer || buffer->match(p_filePath));
+    return buffer;
+}
+
+void BufferMgr::validatePathIndex() const
+{
+    // Paths of node buffers change with their nodes or ancestors renamed or moved.
+    const auto generation = Node::getPathGeneration();
+    if (m_pathIndexGeneration == generation) {
+        return;
     }
 
-    return nullptr;
+    m_pathIndexGeneration = generation;
+    m_pathIndex.clear();
+    m_pathIndex.reserve(m_buffers.size());
+    for (auto buffer : m_buffers) {
+        // Keep the first buffer of the same path as a linear search does.
+        const auto path = PathUtils::normalizePath(buffer->getPath());
+        if (!m_pathIndex.contains(path)) {
+            m_pathIndex.insert(path, buffer);
+        }
+    }
 }
 
 void BufferMgr::addBuffer(Buffer *p_buffer)
 {
     m_buffers.push_back(p_buffer);
+
+    if (p_buffer->getProviderType() == Buffer::ProviderType::Internal) {
+        m_nodeIndex.insert(p_buffer->getNode(), p_buffer);
+    }
+
+    if (m_pathIndexGeneration == Node::getPathGeneration()) {
+        const auto path = PathUtils::normalizePath(p_buffer->getPath());
+        if (!m_pathIndex.contains(path)) {
+            m_pathIndex.insert(path, p_buffer);
+        }
+    }
+
+    connect(p_buffer, &Buffer::contentReloaded,
+            m_memoryBudgetTimer, QOverload<>::of(&QTimer::start));
+    m_memoryBudgetTimer->start();
+
     connect(p_buffer, &Buffer::attachedViewWindowEmpty,
             this, [this, p_buffer]() {
                 qDebug() << "delete buffer without attached view window"
                          << p_buffer->getName();
-                m_buffers.removeAll(p_buffer);
+                removeBuffer(p_buffer);
                 p_buffer->close();
                 p_buffer->deleteLater();
             });
 }
 
+void BufferMgr::removeBuffer(Buffer *p_buffer)
+{
+    m_buffers.removeAll(p_buffer);
+
+    if (p_buffer->getProviderType() == Buffer::ProviderType::Internal) {
+        auto it = m_nodeIndex.find(p_buffer->getNode());
+        if (it != m_nodeIndex.end() && it.value() == p_buffer) {
+            m_nodeIndex.erase(it);
+        }
+    }
+
+    // Another buffer of the same path may be indexed next time.
+    m_pathIndexGeneration = 0;
+}
+
+int BufferMgr::getBufferCount() const
+{
+    return m_buffers.size();
+}
+
+QList<Buffer *> BufferMgr::getModifiedBuffers() const
+{
+    QList<Buffer *> buffers;
+    for (auto buffer : m_buffers) {
+        if (buffer->isModified()) {
+            buffers << buffer;
+        }
+    }
+    return buffers;
+}
+
+int BufferMgr::getEvictedBufferCount() const
+{
+    return std::count_if(m_buffers.constBegin(),
+                         m_buffers.constEnd(),
+                         [](const Buffer *p_buffer) {
+                             return p_buffer->isContentEvicted();
+                         });
+}
+
+qint64 BufferMgr::getResidentBytes() const
+{
+    qint64 bytes = 0;
+    for (auto buffer : m_buffers) {
+        bytes += buffer->getResidentBytes();
+    }
+    return bytes;
+}
+
+void BufferMgr::enforceMemoryBudget()
+{
+    const qint64 budget = static_cast<qint64>(ConfigMgr::getInst().getEditorConfig().getBufferMemoryBudget()) * 1024 * 1024;
+    if (budget <= 0) {
+        return;
+    }
+
+    // Contents of buffers shown are always kept, but still count.
+    qint64 bytes = 0;
+    QVector<Buffer *> candidates;
+    for (auto buffer : m_buffers) {
+        bytes += buffer->getResidentBytes();
+        if (buffer->hasVisibleViewWindow()) {
+            buffer->markAccessed();
+        } else if (buffer->isContentEvictable()) {
+            candidates.push_back(buffer);
+        }
+    }
+
+    if (bytes <= budget) {
+        return;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Buffer *p_a, const Buffer *p_b) {
+        return p_a->getLastAccessStamp() < p_b->getLastAccessStamp();
+    });
+
+    int cnt = 0;
+    for (auto buffer : candidates) {
+        if (bytes <= budget) {
+            break;
+        }
+
+        bytes -= buffer->getResidentBytes();
+        buffer->evictContent();
+        ++cnt;
+    }
+
+    qDebug() << "evicted contents of" << cnt << "buffers, resident bytes" << bytes << "budget" << budget;
+}
+
 QSharedPointer<Node> BufferMgr::loadNodeByPath(const QString &p_path)
 {
     const auto &notebooks = VNoteX::getInst().getNotebookMgr().getNotebooks();
@@ -2,12 +2,15 @@
 #define BUFFERMGR_H
 
 #include <QObject>
+#include <QHash>
 #include <QScopedPointer>
 #include <QSharedPointer>
 #include <QVector>
 
 #include "namebasedserver.h"
 
+class QTimer;
+
 namespace vnotex
 {
     class IBufferFactory;
@@ -25,6 +28,17 @@ namespace vnotex
 
         void init();
 
+        int getBufferCount() const;
+
+        // Number of buffers whose contents are dropped.
+        int getEvictedBufferCount() const;
+
+        // Memory held by contents of all buffers in bytes.
+        qint64 getResidentBytes() const;
+
+        // Buffers with changes not saved yet.
+        QList<Buffer *> getModifiedBuffers() const;
+
     public slots:
         void open(Node *p_node, const QSharedPointer<FileOpenParameters> &p_paras);
 
@@ -42,6 +56,15 @@ namespace vnotex
 
         void addBuffer(Buffer *p_buffer);
 
+        void removeBuffer(Buffer *p_buffer);
+
+        // Rebuild m_pathIndex if any node has been renamed or moved since last build.
+        void validatePathIndex() const;
+
+        // Drop contents of least recently accessed buffers not shown until the total
+        // fits the budget.
+        void enforceMemoryBudget();
+
         // Try to load @p_path as a node if it is within one notebook.
         QSharedPointer<Node> loadNodeByPath(const QString &p_path);
 
@@ -49,6 +72,19 @@ namespace vnotex
 
         // Managed by QObject.
         QVector<Buffer *> m_buffers;
+
+        // Buffers of nodes by node. A buffer holds its node so the pointer will not be reused.
+        QHash<const Node *, Buffer *> m_nodeIndex;
+
+        // Buffers by normalized path.
+        mutable QHash<QString, Buffer *> m_pathIndex;
+
+        // Node::getPathGeneration() when m_pathIndex is built.
+        mutable quint64 m_pathIndexGeneration = 0;
+
+        // Coalesce budget checks after contents are loaded.
+        // Managed by QObject.
+        QTimer *m_memoryBudgetTimer = nullptr;
     };
 } // ns vnotex
 
@@ -1,7 +1,7 @@
 #include "configmgr.h"
 
 #include <QDir>
-#include <QCoreApplication>
+#include <QApplication>
 #include <QFileInfo>
 #include <QDebug>
 #include <QStandardPaths>
@@ -152,12 +152,23 @@ void ConfigMgr::checkAppConfig()
 
     Q_ASSERT(appConfigDir.exists());
 
-    QPixmap pixmap(":/vnotex/data/core/logo/vnote.png");
-    QScopedPointer<QSplashScreen> splash(new QSplashScreen(pixmap));
-    splash->show();
+    // No splash screen in headless mode.
+    QScopedPointer<QSplashScreen> splash;
+    if (qobject_cast<QApplication *>(QCoreApplication::instance())) {
+        QPixmap pixmap(":/vnotex/data/core/logo/vnote.png");
+        splash.reset(new QSplashScreen(pixmap));
+        splash->show();
+    }
+    auto showMessage = [&splash](const QString &p_msg) {
+        if (splash) {
+            splash->showMessage(p_msg);
+        } else {
+            qInfo() << p_msg;
+        }
+    };
 
     // Load extra data.
-    splash->showMessage("Loading extra resource data");
+    showMessage("Loading extra resource data");
     const QString extraRcc(PathUtils::concatenateFilePath(QCoreApplication::applicationDirPath(),
                                                           QStringLiteral("vnote_extra.rcc")));
     bool ret = QResource::registerResource(extraRcc);
@@ -175,7 +186,7 @@ void ConfigMgr::checkAppConfig()
     if (!needUpdate) {
         // Always update main config file and web folder.
         qDebug() << "forced to update main config file and web folder for debugging";
-        splash->showMessage("update main config file and web folder for debugging");
+        showMessage("update main config file and web folder for debugging");
 
         // Cancel the read-only permission of the main config file.
         QFile::setPermissions(mainConfigFilePath, QFile::WriteUser);
@@ -196,31 +207,31 @@ void ConfigMgr::checkAppConfig()
 
     // Copy themes.
     qApp->processEvents();
-    splash->showMessage("Copying themes");
+    showMessage("Copying themes");
     FileUtils::copyDir(extraDataRoot + QStringLiteral("/themes"),
                        appConfigDir.filePath(QStringLiteral("themes")));
 
     // Copy docs.
     qApp->processEvents();
-    splash->showMessage("Copying docs");
+    showMessage("Copying docs");
     FileUtils::copyDir(extraDataRoot + QStringLiteral("/docs"),
                        appConfigDir.filePath(QStringLiteral("docs")));
 
     // Copy syntax-highlighting.
     qApp->processEvents();
-    splash->showMessage("Copying syntax-highlighting");
+    showMessage("Copying syntax-highlighting");
     FileUtils::copyDir(extraDataRoot + QStringLiteral("/syntax-highlighting"),
                        appConfigDir.filePath(QStringLiteral("syntax-highlighting")));
 
     // Copy web.
     qApp->processEvents();
-    splash->showMessage("Copying web");
+    showMessage("Copying web");
     FileUtils::copyDir(extraDataRoot + QStringLiteral("/web"),
                        appConfigDir.filePath(QStringLiteral("web")));
 
     // Copy dicts.
     qApp->processEvents();
-    splash->showMessage("Copying dicts");
+    showMessage("Copying dicts");
     FileUtils::copyDir(extraDataRoot + QStringLiteral("/dicts"),
                        appConfigDir.filePath(QStringLiteral("dicts")));
 
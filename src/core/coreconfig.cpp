@@ -116,6 +116,25 @@ void CoreConfig::loadNoteManagement(const QJsonObject &p_app, const QJsonObject
 
         m_externalNodeExcludePatterns = READSTRLIST(QStringLiteral("exclude_patterns"));
     }
+
+    // Recycle bin.
+    {
+        const auto appObj = topAppObj.value(QStringLiteral("recycle_bin")).toObject();
+        const auto userObj = topUserObj.value(QStringLiteral("recycle_bin")).toObject();
+
+        m_recycleBinRetentionDays = qMax(0, READINT(QStringLiteral("retention_days")));
+
+        m_recycleBinMaxSize = qMax(0, READINT(QStringLiteral("max_size")));
+    }
+
+    {
+        const auto &appObj = topAppObj;
+        const auto &userObj = topUserObj;
+
+        m_watchExternalChangesEnabled = READBOOL(QStringLiteral("watch_external_changes"));
+
+        m_contentAddressedMediaEnabled = READBOOL(QStringLiteral("content_addressed_media"));
+    }
 }
 
 QJsonObject CoreConfig::saveShortcuts() const
@@ -153,6 +172,26 @@ const QStringList &CoreConfig::getExternalNodeExcludePatterns() const
     return m_externalNodeExcludePatterns;
 }
 
+bool CoreConfig::isWatchExternalChangesEnabled() const
+{
+    return m_watchExternalChangesEnabled;
+}
+
+bool CoreConfig::isContentAddressedMediaEnabled() const
+{
+    return m_contentAddressedMediaEnabled;
+}
+
+int CoreConfig::getRecycleBinRetentionDays() const
+{
+    return m_recycleBinRetentionDays;
+}
+
+int CoreConfig::getRecycleBinMaxSize() const
+{
+    return m_recycleBinMaxSize;
+}
+
 bool CoreConfig::isRecoverLastSessionOnStartEnabled() const
 {
     return m_recoverLastSessionOnStartEnabled;
@@ -78,6 +78,15 @@ namespace vnotex
 
         const QStringList &getExternalNodeExcludePatterns() const;
 
+        bool isWatchExternalChangesEnabled() const;
+
+        bool isContentAddressedMediaEnabled() const;
+
+        int getRecycleBinRetentionDays() const;
+
+        // In MiB.
+        int getRecycleBinMaxSize() const;
+
         static const QStringList &getAvailableLocales();
 
         bool isRecoverLastSessionOnStartEnabled() const;
@@ -106,6 +115,18 @@ namespace vnotex
 
         QStringList m_externalNodeExcludePatterns;
 
+        // Whether watch the folders of current notebook and refresh nodes on external changes.
+        bool m_watchExternalChangesEnabled = true;
+
+        // Whether store inserted images in the content-addressed media store of notebook.
+        bool m_contentAddressedMediaEnabled = false;
+
+        // Days to keep folders in recycle bin. 0 to keep forever.
+        int m_recycleBinRetentionDays = 0;
+
+        // Max size of recycle bin in MiB. 0 for no limit.
+        int m_recycleBinMaxSize = 0;
+
         // Whether recover last session on start.
         bool m_recoverLastSessionOnStartEnabled = true;
 
@@ -57,6 +57,10 @@ void EditorConfig::loadCore(const QJsonObject &p_app, const QJsonObject &p_user)
 
     m_backupFileExtension = READSTR(QStringLiteral("backup_file_extension"));
 
+    m_bufferMemoryBudget = qMax(0, READINT(QStringLiteral("buffer_memory_budget")));
+
+    m_largeFileSize = qMax(0, READINT(QStringLiteral("large_file_size")));
+
     loadShortcuts(appObj, userObj);
 
     m_spellCheckAutoDetectLanguageEnabled = READBOOL(QStringLiteral("spell_check_auto_detect_language"));
@@ -73,6 +77,8 @@ QJsonObject EditorConfig::saveCore() const
     obj[QStringLiteral("auto_save_policy")] = autoSavePolicyToString(m_autoSavePolicy);
     obj[QStringLiteral("backup_file_directory")] = m_backupFileDirectory;
     obj[QStringLiteral("backup_file_extension")] = m_backupFileExtension;
+    obj[QStringLiteral("buffer_memory_budget")] = m_bufferMemoryBudget;
+    obj[QStringLiteral("large_file_size")] = m_largeFileSize;
     obj[QStringLiteral("shortcuts")] = saveShortcuts();
     obj[QStringLiteral("spell_check_auto_detect_language")] = m_spellCheckAutoDetectLanguageEnabled;
     obj[QStringLiteral("spell_check_default_dictionary")] = m_spellCheckDefaultDictionary;
@@ -198,6 +204,16 @@ const QString &EditorConfig::getBackupFileExtension() const
     return m_backupFileExtension;
 }
 
+int EditorConfig::getBufferMemoryBudget() const
+{
+    return m_bufferMemoryBudget;
+}
+
+int EditorConfig::getLargeFileSize() const
+{
+    return m_largeFileSize;
+}
+
 bool EditorConfig::isSpellCheckAutoDetectLanguageEnabled() const
 {
     return m_spellCheckAutoDetectLanguageEnabled;
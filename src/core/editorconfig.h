@@ -85,6 +85,10 @@ namespace vnotex
 
         const QString &getBackupFileExtension() const;
 
+        int getBufferMemoryBudget() const;
+
+        int getLargeFileSize() const;
+
         const QString &getShortcut(Shortcut p_shortcut) const;
 
         bool isSpellCheckAutoDetectLanguageEnabled() const;
@@ -119,6 +123,14 @@ namespace vnotex
         // Backup file extension.
         QString m_backupFileExtension;
 
+        // In MiB. Contents of buffers not shown beyond it will be dropped if unmodified.
+        // 0 to keep all contents.
+        int m_bufferMemoryBudget = 256;
+
+        // In MiB. Files not smaller than it are opened read-only page by page.
+        // 0 to disable.
+        int m_largeFileSize = 32;
+
         // Will be shared with MarkdownEditorConfig.
         QSharedPointer<TextEditorConfig> m_textEditorConfig;
 
@@ -7,6 +7,10 @@ const FileType &File::getContentType() const
     return FileTypeHelper::getInst().getFileType(m_contentType);
 }
 
+void File::contentWritten()
+{
+}
+
 void File::setContentType(int p_type)
 {
     m_contentType = p_type;
@@ -41,6 +41,10 @@ namespace vnotex
 
         virtual void write(const QString &p_content) = 0;
 
+        // Called after the content file is written bypassing write(), such as by
+        // an asynchronous save.
+        virtual void contentWritten();
+
         virtual QString getName() const = 0;
 
         virtual QString getFilePath() const = 0;
@@ -32,6 +32,9 @@ namespace vnotex
 
         // Whether always open a new window for file.
         bool m_alwaysNewWindow = false;
+
+        // Whether make the new window the current one of its split.
+        bool m_activate = true;
     };
 }
 
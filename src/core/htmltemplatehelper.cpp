@@ -1,6 +1,12 @@
 #include "htmltemplatehelper.h"
 
 #include <QDebug>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
 
 #include <core/markdowneditorconfig.h>
 #include <core/configmgr.h>
@@ -10,11 +16,14 @@
 #include <utils/htmlutils.h>
 #include <core/thememgr.h>
 #include <core/vnotex.h>
+#include <core/exception.h>
 
 using namespace vnotex;
 
 HtmlTemplateHelper::Template HtmlTemplateHelper::s_markdownViewerTemplate;
 
+QString HtmlTemplateHelper::s_viewerResourceScheme;
+
 static const QString c_globalStylesPlaceholder = "/* VX_GLOBAL_STYLES_PLACEHOLDER */";
 
 QString WebGlobalOptions::toJavascriptObject() const
@@ -63,29 +72,52 @@ static void fillGlobalStyles(QString &p_template, const WebResource &p_resource,
     }
 }
 
-static QString fillStyleTag(const QString &p_styleFile)
+// Whether @p_file could be served via the viewer resource scheme.
+// Must match the folders served by WebResourceSchemeHandler.
+static bool isViewerResourceServable(const QString &p_file)
+{
+    const auto &configMgr = ConfigMgr::getInst();
+    return PathUtils::pathContains(configMgr.getAppFolder(), p_file)
+           || PathUtils::pathContains(configMgr.getUserFolder(), p_file);
+}
+
+static QUrl resourceUrl(const QString &p_file, const QString &p_scheme)
+{
+    auto url = PathUtils::pathToUrl(p_file);
+    // Leave resource files and remote URLs alone.
+    // Files outside the app and user folders, such as configured absolute paths, are kept as file URLs.
+    if (!p_scheme.isEmpty() && url.isLocalFile() && isViewerResourceServable(PathUtils::cleanPath(url.toLocalFile()))) {
+        url.setScheme(p_scheme);
+    }
+    return url;
+}
+
+static QString fillStyleTag(const QString &p_styleFile, const QString &p_scheme)
 {
     if (p_styleFile.isEmpty()) {
         return "";
     }
-    auto url = PathUtils::pathToUrl(p_styleFile);
+    auto url = resourceUrl(p_styleFile, p_scheme);
     return QString("<link rel=\"stylesheet\" type=\"text/css\" href=\"%1\">\n").arg(url.toString());
 }
 
-static QString fillScriptTag(const QString &p_scriptFile)
+static QString fillScriptTag(const QString &p_scriptFile, const QString &p_scheme)
 {
     if (p_scriptFile.isEmpty()) {
         return "";
     }
-    auto url = PathUtils::pathToUrl(p_scriptFile);
+    auto url = resourceUrl(p_scriptFile, p_scheme);
     return QString("<script type=\"text/javascript\" src=\"%1\"></script>\n").arg(url.toString());
 }
 
-static void fillThemeStyles(QString &p_template, const QString &p_webStyleSheetFile, const QString &p_highlightStyleSheetFile)
+static void fillThemeStyles(QString &p_template,
+                            const QString &p_webStyleSheetFile,
+                            const QString &p_highlightStyleSheetFile,
+                            const QString &p_scheme)
 {
     QString styles;
-    styles += fillStyleTag(p_webStyleSheetFile);
-    styles += fillStyleTag(p_highlightStyleSheetFile);
+    styles += fillStyleTag(p_webStyleSheetFile, p_scheme);
+    styles += fillStyleTag(p_highlightStyleSheetFile, p_scheme);
 
     if (!styles.isEmpty()) {
         p_template.replace(QStringLiteral("<!-- VX_THEME_STYLES_PLACEHOLDER -->"),
@@ -93,6 +125,34 @@ static void fillThemeStyles(QString &p_template, const QString &p_webStyleSheetF
     }
 }
 
+static WebGlobalOptions markdownViewerOptions(const MarkdownEditorConfig &p_config,
+                                              bool p_useTransparentBg,
+                                              bool p_scrollable,
+                                              int p_bodyWidth,
+                                              int p_bodyHeight,
+                                              bool p_transformSvgToPng,
+                                              qreal p_mathJaxScale)
+{
+    WebGlobalOptions opts;
+    opts.m_webPlantUml = p_config.getWebPlantUml();
+    opts.m_webGraphviz = p_config.getWebGraphviz();
+    opts.m_sectionNumberEnabled = p_config.getSectionNumberMode() == MarkdownEditorConfig::SectionNumberMode::Read;
+    opts.m_sectionNumberBaseLevel = p_config.getSectionNumberBaseLevel();
+    opts.m_constrainImageWidthEnabled = p_config.getConstrainImageWidthEnabled();
+    opts.m_protectFromXss = p_config.getProtectFromXss();
+    opts.m_htmlTagEnabled = p_config.getHtmlTagEnabled();
+    opts.m_autoBreakEnabled = p_config.getAutoBreakEnabled();
+    opts.m_linkifyEnabled = p_config.getLinkifyEnabled();
+    opts.m_indentFirstLineEnabled = p_config.getIndentFirstLineEnabled();
+    opts.m_transparentBackgroundEnabled = p_useTransparentBg;
+    opts.m_scrollable = p_scrollable;
+    opts.m_bodyWidth = p_bodyWidth;
+    opts.m_bodyHeight = p_bodyHeight;
+    opts.m_transformSvgToPngEnabled = p_transformSvgToPng;
+    opts.m_mathJaxScale = p_mathJaxScale;
+    return opts;
+}
+
 static void fillGlobalOptions(QString &p_template, const WebGlobalOptions &p_opts)
 {
     p_template.replace(QStringLiteral("/* VX_GLOBAL_OPTIONS_PLACEHOLDER */"),
@@ -100,7 +160,7 @@ static void fillGlobalOptions(QString &p_template, const WebGlobalOptions &p_opt
 }
 
 // Read all other resources in @p_resource and fill the holder with proper resource path.
-static void fillResources(QString &p_template, const WebResource &p_resource)
+static void fillResources(QString &p_template, const WebResource &p_resource, const QString &p_scheme)
 {
     QString styles;
     QString scripts;
@@ -110,13 +170,13 @@ static void fillResources(QString &p_template, const WebResource &p_resource)
             // Styles.
             for (const auto &style : ele.m_styles) {
                 auto styleFile = ConfigMgr::getInst().getUserOrAppFile(style);
-                styles += fillStyleTag(styleFile);
+                styles += fillStyleTag(styleFile, p_scheme);
             }
 
             // Scripts.
             for (const auto &script : ele.m_scripts) {
                 auto scriptFile = ConfigMgr::getInst().getUserOrAppFile(script);
-                scripts += fillScriptTag(scriptFile);
+                scripts += fillScriptTag(scriptFile, p_scheme);
             }
         }
     }
@@ -167,6 +227,11 @@ const QString &HtmlTemplateHelper::getMarkdownViewerTemplate()
     return s_markdownViewerTemplate.m_template;
 }
 
+int HtmlTemplateHelper::getMarkdownViewerTemplateRevision()
+{
+    return s_markdownViewerTemplate.m_revision;
+}
+
 void HtmlTemplateHelper::updateMarkdownViewerTemplate(const MarkdownEditorConfig &p_config)
 {
     if (p_config.revision() == s_markdownViewerTemplate.m_revision) {
@@ -176,10 +241,94 @@ void HtmlTemplateHelper::updateMarkdownViewerTemplate(const MarkdownEditorConfig
     s_markdownViewerTemplate.m_revision = p_config.revision();
 
     const auto &themeMgr = VNoteX::getInst().getThemeMgr();
+    const auto webStyleSheetFile = themeMgr.getFile(Theme::File::WebStyleSheet);
+    const auto highlightStyleSheetFile = themeMgr.getFile(Theme::File::HighlightStyleSheet);
+
+    // Reuse the template generated by previous runs if nothing changes.
+    const auto cacheFolder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    const auto cacheFile = PathUtils::concatenateFilePath(
+        cacheFolder,
+        QStringLiteral("viewer_template_%1.html").arg(markdownViewerTemplateCacheKey(p_config,
+                                                                                     webStyleSheetFile,
+                                                                                     highlightStyleSheetFile)));
+    if (!cacheFolder.isEmpty() && QFileInfo::exists(cacheFile)) {
+        try {
+            s_markdownViewerTemplate.m_template = FileUtils::readTextFile(cacheFile);
+            return;
+        } catch (Exception &p_e) {
+            qWarning() << "failed to read cached viewer template" << cacheFile << p_e.what();
+        }
+    }
+
     s_markdownViewerTemplate.m_template =
         generateMarkdownViewerTemplate(p_config,
-                                       themeMgr.getFile(Theme::File::WebStyleSheet),
-                                       themeMgr.getFile(Theme::File::HighlightStyleSheet));
+                                       webStyleSheetFile,
+                                       highlightStyleSheetFile,
+                                       false,
+                                       true,
+                                       -1,
+                                       -1,
+                                       false,
+                                       -1,
+                                       s_viewerResourceScheme);
+
+    if (cacheFolder.isEmpty()) {
+        return;
+    }
+
+    try {
+        QDir dir(cacheFolder);
+        dir.mkpath(cacheFolder);
+
+        // Only the latest one is useful.
+        const auto staleFiles = dir.entryList({QStringLiteral("viewer_template_*.html")}, QDir::Files);
+        for (const auto &file : staleFiles) {
+            dir.remove(file);
+        }
+
+        FileUtils::writeFile(cacheFile, s_markdownViewerTemplate.m_template);
+    } catch (Exception &p_e) {
+        qWarning() << "failed to cache viewer template" << cacheFile << p_e.what();
+    }
+}
+
+QString HtmlTemplateHelper::markdownViewerTemplateCacheKey(const MarkdownEditorConfig &p_config,
+                                                           const QString &p_webStyleSheetFile,
+                                                           const QString &p_highlightStyleSheetFile)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    auto addFile = [&hash](const QString &p_file) {
+        QFileInfo info(p_file);
+        hash.addData(p_file.toUtf8());
+        hash.addData(QByteArray::number(info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1));
+    };
+
+    const auto &configMgr = ConfigMgr::getInst();
+    const auto &viewerResource = p_config.getViewerResource();
+    addFile(configMgr.getUserOrAppFile(viewerResource.m_template));
+    for (const auto &ele : viewerResource.m_resources) {
+        hash.addData(ele.m_name.toUtf8());
+        hash.addData(ele.m_enabled ? "1" : "0");
+        if (!ele.m_enabled) {
+            continue;
+        }
+        for (const auto &style : ele.m_styles) {
+            addFile(configMgr.getUserOrAppFile(style));
+        }
+        for (const auto &script : ele.m_scripts) {
+            addFile(configMgr.getUserOrAppFile(script));
+        }
+    }
+
+    addFile(p_webStyleSheetFile);
+    addFile(p_highlightStyleSheetFile);
+
+    hash.addData(markdownViewerOptions(p_config, false, true, -1, -1, false, -1).toJavascriptObject().toUtf8());
+    hash.addData(s_viewerResourceScheme.toUtf8());
+    hash.addData(QCoreApplication::applicationVersion().toUtf8());
+
+    return QString::fromLatin1(hash.result().toHex());
 }
 
 QString HtmlTemplateHelper::generateMarkdownViewerTemplate(const MarkdownEditorConfig &p_config,
@@ -190,7 +339,8 @@ QString HtmlTemplateHelper::generateMarkdownViewerTemplate(const MarkdownEditorC
                                                            int p_bodyWidth,
                                                            int p_bodyHeight,
                                                            bool p_transformSvgToPng,
-                                                           qreal p_mathJaxScale)
+                                                           qreal p_mathJaxScale,
+                                                           const QString &p_resourceScheme)
 {
     const auto &viewerResource = p_config.getViewerResource();
     const auto templateFile = ConfigMgr::getInst().getUserOrAppFile(viewerResource.m_template);
@@ -198,30 +348,17 @@ QString HtmlTemplateHelper::generateMarkdownViewerTemplate(const MarkdownEditorC
 
     fillGlobalStyles(htmlTemplate, viewerResource, "");
 
-    fillThemeStyles(htmlTemplate, p_webStyleSheetFile, p_highlightStyleSheetFile);
-
-    {
-        WebGlobalOptions opts;
-        opts.m_webPlantUml = p_config.getWebPlantUml();
-        opts.m_webGraphviz = p_config.getWebGraphviz();
-        opts.m_sectionNumberEnabled = p_config.getSectionNumberMode() == MarkdownEditorConfig::SectionNumberMode::Read;
-        opts.m_sectionNumberBaseLevel = p_config.getSectionNumberBaseLevel();
-        opts.m_constrainImageWidthEnabled = p_config.getConstrainImageWidthEnabled();
-        opts.m_protectFromXss = p_config.getProtectFromXss();
-        opts.m_htmlTagEnabled = p_config.getHtmlTagEnabled();
-        opts.m_autoBreakEnabled = p_config.getAutoBreakEnabled();
-        opts.m_linkifyEnabled = p_config.getLinkifyEnabled();
-        opts.m_indentFirstLineEnabled = p_config.getIndentFirstLineEnabled();
-        opts.m_transparentBackgroundEnabled = p_useTransparentBg;
-        opts.m_scrollable = p_scrollable;
-        opts.m_bodyWidth = p_bodyWidth;
-        opts.m_bodyHeight = p_bodyHeight;
-        opts.m_transformSvgToPngEnabled = p_transformSvgToPng;
-        opts.m_mathJaxScale = p_mathJaxScale;
-        fillGlobalOptions(htmlTemplate, opts);
-    }
+    fillThemeStyles(htmlTemplate, p_webStyleSheetFile, p_highlightStyleSheetFile, p_resourceScheme);
+
+    fillGlobalOptions(htmlTemplate, markdownViewerOptions(p_config,
+                                                          p_useTransparentBg,
+                                                          p_scrollable,
+                                                          p_bodyWidth,
+                                                          p_bodyHeight,
+                                                          p_transformSvgToPng,
+                                                          p_mathJaxScale));
 
-    fillResources(htmlTemplate, viewerResource);
+    fillResources(htmlTemplate, viewerResource, p_resourceScheme);
 
     return htmlTemplate;
 }
@@ -275,3 +412,14 @@ void HtmlTemplateHelper::fillBodyClassList(QString &p_template, const QString &p
 {
     p_template.replace("<!-- VX_BODY_CLASS_LIST_PLACEHOLDER -->", p_classList);
 }
+
+void HtmlTemplateHelper::setViewerResourceScheme(const QString &p_scheme)
+{
+    if (s_viewerResourceScheme == p_scheme) {
+        return;
+    }
+
+    s_viewerResourceScheme = p_scheme;
+    // Force to regenerate.
+    s_markdownViewerTemplate.m_revision = -1;
+}
@@ -60,6 +60,9 @@ namespace vnotex
         static const QString &getMarkdownViewerTemplate();
         static void updateMarkdownViewerTemplate(const MarkdownEditorConfig &p_config);
 
+        // Revision of the config the Markdown viewer template is generated from, -1 if none.
+        static int getMarkdownViewerTemplateRevision();
+
         static QString generateMarkdownViewerTemplate(const MarkdownEditorConfig &p_config,
                                                       const QString &p_webStyleSheetFile,
                                                       const QString &p_highlightStyleSheetFile,
@@ -68,7 +71,8 @@ namespace vnotex
                                                       int p_bodyWidth = -1,
                                                       int p_bodyHeight = -1,
                                                       bool p_transformSvgToPng = false,
-                                                      qreal p_mathJaxScale = -1);
+                                                      qreal p_mathJaxScale = -1,
+                                                      const QString &p_resourceScheme = QString());
 
         static QString generateExportTemplate(const MarkdownEditorConfig &p_config,
                                               bool p_addOutlinePanel);
@@ -83,6 +87,10 @@ namespace vnotex
 
         static void fillBodyClassList(QString &p_template, const QString &p_classList);
 
+        // Let MarkdownViewer load styles and scripts of the template via URL scheme @p_scheme
+        // instead of file. Only files within the app and user folders are loaded this way.
+        static void setViewerResourceScheme(const QString &p_scheme);
+
     private:
         struct Template
         {
@@ -90,8 +98,15 @@ namespace vnotex
             QString m_template;
         };
 
+        // Key of the generated template cached on disk. Changes with any input file or config.
+        static QString markdownViewerTemplateCacheKey(const MarkdownEditorConfig &p_config,
+                                                      const QString &p_webStyleSheetFile,
+                                                      const QString &p_highlightStyleSheetFile);
+
         // Template for MarkdownViewer.
         static Template s_markdownViewerTemplate;
+
+        static QString s_viewerResourceScheme;
     };
 }
 
@@ -0,0 +1,571 @@
+#include "mediagarbagecollector.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QUrl>
+#include <QDebug>
+
+#include <notebookbackend/inotebookbackend.h>
+#include <notebookbackend/asyncnotebookbackend.h>
+#include <notebookconfigmgr/bundlenotebookconfigmgr.h>
+#include <buffer/filetypehelper.h>
+#include <utils/pathutils.h>
+#include <vtextedit/markdownutils.h>
+#include "exception.h"
+#include "notebook.h"
+#include "mediastore.h"
+
+using namespace vnotex;
+
+const QString MediaGarbageCollector::c_cacheFileName = QStringLiteral("vx_media_gc.json");
+
+MediaGarbageCollector::Worker::Worker(const MediaGarbageCollector *p_collector,
+                                      const QVector<NoteItem> &p_notes,
+                                      const QVector<FolderItem> &p_folders,
+                                      const QStringList &p_dirsToList)
+    : m_notes(p_notes),
+      m_collector(p_collector),
+      m_folders(p_folders),
+      m_dirsToList(p_dirsToList)
+{
+}
+
+void MediaGarbageCollector::Worker::run()
+{
+    for (auto &item : m_notes) {
+        processNote(item);
+    }
+
+    for (const auto &folder : m_folders) {
+        processFolder(folder);
+    }
+
+    for (const auto &dir : m_dirsToList) {
+        if (QFileInfo(dir).isDir()) {
+            m_dirEntries.insert(dir, FileUtils::listDir(dir));
+        }
+    }
+}
+
+void MediaGarbageCollector::Worker::processNote(NoteItem &p_item) const
+{
+    // Images just pasted may be referred only by the buffer.
+    auto unsavedIt = m_collector->m_unsavedContents.find(PathUtils::normalizePath(p_item.m_path));
+    if (unsavedIt != m_collector->m_unsavedContents.end()) {
+        // The file differs, so force a parse next time.
+        p_item.m_modifiedTimeMsecs = -1;
+        parseNote(p_item, unsavedIt.value());
+        return;
+    }
+
+    QFileInfo info(p_item.m_path);
+    if (!info.exists()) {
+        p_item.m_links.clear();
+        return;
+    }
+
+    const auto modifiedTime = info.lastModified().toMSecsSinceEpoch();
+    if (modifiedTime == p_item.m_modifiedTimeMsecs) {
+        return;
+    }
+
+    QString content;
+    try {
+        content = FileUtils::readTextFile(p_item.m_path);
+    } catch (Exception &p_e) {
+        qWarning() << "failed to read note for media collection" << p_item.m_path << p_e.what();
+        p_item.m_parsed = true;
+        p_item.m_links.clear();
+        // Force a parse next time.
+        p_item.m_modifiedTimeMsecs = -1;
+        return;
+    }
+
+    p_item.m_modifiedTimeMsecs = modifiedTime;
+    parseNote(p_item, content);
+}
+
+void MediaGarbageCollector::Worker::parseNote(NoteItem &p_item, const QString &p_content) const
+{
+    p_item.m_parsed = true;
+    p_item.m_links.clear();
+
+    const auto noteFolderPath = PathUtils::parentDirPath(p_item.m_path);
+    QDir rootDir(m_collector->m_rootPath);
+    QSet<QString> handledLinks;
+    auto addLink = [&](const QString &p_path) {
+        const auto path = PathUtils::cleanPath(p_path);
+        if (handledLinks.contains(path)) {
+            return;
+        }
+        handledLinks.insert(path);
+        p_item.m_links << rootDir.relativeFilePath(path);
+    };
+
+    // Images in Markdown syntax, whose size suffix and title are handled by vtextedit.
+    const auto images =
+        vte::MarkdownUtils::fetchImagesFromMarkdownText(p_content,
+                                                        noteFolderPath,
+                                                        vte::MarkdownLink::TypeFlag::LocalRelativeInternal);
+    for (const auto &link : images) {
+        addLink(link.m_path);
+    }
+
+    // Any other local target, like plain links to attachments or HTML elements.
+    // Missing a reference would get a file in use recycled, so be generous.
+    for (const auto &target : fetchLinkTargets(p_content)) {
+        const auto path = resolveLocalLink(target, noteFolderPath);
+        if (!path.isEmpty()) {
+            addLink(path);
+        }
+    }
+}
+
+QStringList MediaGarbageCollector::Worker::fetchLinkTargets(const QString &p_content)
+{
+    // [text](target "title") and ![alt](<target with spaces>).
+    static const QRegularExpression inlineLinkReg(QStringLiteral("\\]\\(\\s*(?:<([^>\\n]*)>|([^)\\s]+))"));
+    // [label]: target "title"
+    static const QRegularExpression refDefReg(QStringLiteral("^ {0,3}\\[[^\\]\\n]+\\]:[ \\t]*(?:<([^>\\n]*)>|(\\S+))"),
+                                              QRegularExpression::MultilineOption);
+    // <img src="target">, <a href='target'>, <video src=target>.
+    static const QRegularExpression htmlAttrReg(QStringLiteral("<[a-zA-Z][^>]*?\\s(?:src|href|poster|data)\\s*=\\s*(?:\"([^\"]*)\"|'([^']*)'|([^\\s>]+))"),
+                                                QRegularExpression::CaseInsensitiveOption);
+
+    QStringList targets;
+    for (const auto *reg : {&inlineLinkReg, &refDefReg, &htmlAttrReg}) {
+        auto it = reg->globalMatch(p_content);
+        while (it.hasNext()) {
+            const auto match = it.next();
+            for (int i = 1; i <= reg->captureCount(); ++i) {
+                const auto target = match.captured(i);
+                if (!target.isEmpty()) {
+                    targets << target;
+                    break;
+                }
+            }
+        }
+    }
+    return targets;
+}
+
+QString MediaGarbageCollector::Worker::resolveLocalLink(const QString &p_target, const QString &p_noteFolderPath)
+{
+    // Anchors within the note.
+    if (p_target.startsWith(QLatin1Char('#'))) {
+        return QString();
+    }
+
+    // URLs with a scheme. A single letter is a Windows drive.
+    static const QRegularExpression schemeReg(QStringLiteral("^([a-zA-Z][a-zA-Z0-9+.-]*):"));
+    const auto schemeMatch = schemeReg.match(p_target);
+    if (schemeMatch.hasMatch() && schemeMatch.capturedLength(1) > 1) {
+        if (schemeMatch.captured(1).compare(QStringLiteral("file"), Qt::CaseInsensitive) == 0) {
+            return QUrl(p_target).toLocalFile();
+        }
+        return QString();
+    }
+
+    static const QRegularExpression suffixReg(QStringLiteral("[?#]"));
+    auto target = p_target;
+    const int idx = target.indexOf(suffixReg);
+    if (idx > -1) {
+        target.truncate(idx);
+    }
+    target = QUrl::fromPercentEncoding(target.toUtf8());
+    if (target.isEmpty()) {
+        return QString();
+    }
+
+    if (QDir::isAbsolutePath(target)) {
+        return target;
+    }
+    return PathUtils::concatenateFilePath(p_noteFolderPath, target);
+}
+
+void MediaGarbageCollector::Worker::processFolder(const FolderItem &p_folder)
+{
+    // Notes not tracked by config may refer to media too.
+    const auto entries = FileUtils::listDir(p_folder.m_path);
+    QDir rootDir(m_collector->m_rootPath);
+    for (const auto &name : entries.m_files) {
+        if (p_folder.m_files.contains(name)) {
+            continue;
+        }
+
+        const auto filePath = PathUtils::concatenateFilePath(p_folder.m_path, name);
+        if (!FileTypeHelper::getInst().getFileType(filePath).isMarkdown()) {
+            continue;
+        }
+
+        NoteItem item;
+        item.m_path = filePath;
+        item.m_relativePath = rootDir.relativeFilePath(filePath);
+        auto it = m_collector->m_cache.find(item.m_relativePath);
+        if (it != m_collector->m_cache.end()) {
+            item.m_modifiedTimeMsecs = it->m_modifiedTimeMsecs;
+            item.m_links = it->m_links;
+        }
+        processNote(item);
+        m_notes.append(item);
+    }
+
+    if (!p_folder.m_collectMedia) {
+        return;
+    }
+
+    const QStringList dirs = {m_collector->getImageFolderPath(p_folder.m_path),
+                              m_collector->getAttachmentFolderPath(p_folder.m_path)};
+    for (const auto &dir : dirs) {
+        if (QFileInfo(dir).isDir()) {
+            m_dirEntries.insert(dir, FileUtils::listDir(dir));
+        }
+    }
+}
+
+MediaGarbageCollector::MediaGarbageCollector(Notebook *p_notebook, QObject *p_parent)
+    : QObject(p_parent),
+      m_notebook(p_notebook)
+{
+    Q_ASSERT(m_notebook);
+}
+
+MediaGarbageCollector::~MediaGarbageCollector()
+{
+    for (const auto &th : m_workers) {
+        th->wait();
+    }
+}
+
+bool MediaGarbageCollector::isRunning() const
+{
+    return !m_workers.isEmpty() || m_pendingMoveCount > 0;
+}
+
+void MediaGarbageCollector::waitForDone()
+{
+    while (isRunning()) {
+        for (const auto &th : m_workers) {
+            th->wait();
+        }
+
+        if (m_pendingMoveCount > 0) {
+            m_notebook->getAsyncBackend()->waitForDone();
+        }
+
+        // Deliver finished() of workers and callbacks of moves.
+        QCoreApplication::processEvents();
+    }
+}
+
+bool MediaGarbageCollector::collect(bool p_dryRun, const QHash<QString, QString> &p_unsavedContents)
+{
+    if (isRunning()) {
+        return false;
+    }
+
+    m_dryRun = p_dryRun;
+    m_unsavedContents.clear();
+    for (auto it = p_unsavedContents.constBegin(); it != p_unsavedContents.constEnd(); ++it) {
+        m_unsavedContents.insert(PathUtils::normalizePath(it.key()), it.value());
+    }
+    m_rootPath = m_notebook->getRootFolderAbsolutePath();
+    loadCache();
+
+    m_notes.clear();
+    m_folders.clear();
+    collectItems(m_notebook->getRootNode().data(), false);
+
+    int numThread = QThread::idealThreadCount();
+    if (numThread < 1) {
+        numThread = 1;
+    }
+
+    if (m_notes.size() + m_folders.size() < numThread) {
+        numThread = 1;
+    }
+
+    // The media store is listed by the first worker.
+    const QStringList dirsToList = {m_notebook->getMediaStore()->getFolderPath()};
+
+    m_workers.reserve(numThread);
+    for (int i = 0; i < numThread; ++i) {
+        QVector<NoteItem> notes;
+        for (int j = i; j < m_notes.size(); j += numThread) {
+            notes.append(m_notes[j]);
+        }
+
+        QVector<FolderItem> folders;
+        for (int j = i; j < m_folders.size(); j += numThread) {
+            folders.append(m_folders[j]);
+        }
+
+        auto th = QSharedPointer<Worker>::create(this, notes, folders, i == 0 ? dirsToList : QStringList());
+        connect(th.data(), &QThread::finished,
+                this, &MediaGarbageCollector::handleWorkerFinished);
+        m_workers.append(th);
+    }
+
+    // Start after all workers are created since the finished() of one may be delivered early.
+    for (const auto &th : m_workers) {
+        th->start();
+    }
+
+    return true;
+}
+
+void MediaGarbageCollector::collectItems(Node *p_node, bool p_inRecycleBin)
+{
+    if (!p_node->isLoaded()) {
+        p_node->load();
+    }
+
+    p_inRecycleBin = p_inRecycleBin || m_notebook->isRecycleBinNode(p_node);
+
+    FolderItem folder;
+    folder.m_path = p_node->fetchAbsolutePath();
+    folder.m_collectMedia = !p_inRecycleBin;
+
+    QDir rootDir(m_rootPath);
+    for (const auto &child : p_node->getChildrenRef()) {
+        if (child->isContainer()) {
+            collectItems(child.data(), p_inRecycleBin);
+            continue;
+        }
+
+        folder.m_files.insert(child->getName());
+        if (!child->getAttachmentFolder().isEmpty()) {
+            folder.m_attachmentFolders.insert(child->getAttachmentFolder());
+        }
+
+        const auto filePath = child->fetchAbsolutePath();
+        if (!FileTypeHelper::getInst().getFileType(filePath).isMarkdown()) {
+            continue;
+        }
+
+        NoteItem item;
+        item.m_path = filePath;
+        item.m_relativePath = rootDir.relativeFilePath(filePath);
+        auto it = m_cache.find(item.m_relativePath);
+        if (it != m_cache.end()) {
+            item.m_modifiedTimeMsecs = it->m_modifiedTimeMsecs;
+            item.m_links = it->m_links;
+        }
+        m_notes.append(item);
+    }
+
+    m_folders.append(folder);
+}
+
+void MediaGarbageCollector::handleWorkerFinished()
+{
+    ++m_numOfFinishedWorkers;
+    if (m_numOfFinishedWorkers == m_workers.size()) {
+        finish();
+    }
+}
+
+void MediaGarbageCollector::finish()
+{
+    Result result;
+    auto store = m_notebook->getMediaStore();
+    const auto storeFolderPath = store->getFolderPath();
+
+    QHash<QString, NoteItem> cache;
+    QSet<QString> reachableFiles;
+    QHash<QString, FileUtils::DirEntries> dirEntries;
+    for (const auto &th : m_workers) {
+        Q_ASSERT(th->isFinished());
+        for (const auto &item : th->m_notes) {
+            ++result.m_noteCount;
+            if (item.m_parsed) {
+                ++result.m_parsedNoteCount;
+            }
+
+            for (const auto &link : item.m_links) {
+                const auto linkPath = PathUtils::concatenateFilePath(m_rootPath, link);
+                reachableFiles.insert(PathUtils::normalizePath(linkPath));
+                if (store->contains(linkPath)) {
+                    ++result.m_blobRefs[PathUtils::fileName(linkPath)];
+                }
+            }
+
+            cache.insert(item.m_relativePath, item);
+        }
+
+        for (auto it = th->m_dirEntries.constBegin(); it != th->m_dirEntries.constEnd(); ++it) {
+            dirEntries.insert(it.key(), it.value());
+        }
+    }
+
+    m_workers.clear();
+    m_numOfFinishedWorkers = 0;
+
+    m_cache = cache;
+    saveCache();
+
+    auto collectFiles = [&result, &reachableFiles](const QString &p_dirPath, const FileUtils::DirEntries &p_entries) {
+        for (const auto &name : p_entries.m_files) {
+            const auto filePath = PathUtils::concatenateFilePath(p_dirPath, name);
+            if (!reachableFiles.contains(PathUtils::normalizePath(filePath))) {
+                result.m_files << filePath;
+            }
+        }
+    };
+
+    for (const auto &folder : m_folders) {
+        if (!folder.m_collectMedia) {
+            continue;
+        }
+
+        const auto imageFolderPath = getImageFolderPath(folder.m_path);
+        auto it = dirEntries.find(imageFolderPath);
+        if (it != dirEntries.end()) {
+            collectFiles(imageFolderPath, it.value());
+        }
+
+        const auto attachmentFolderPath = getAttachmentFolderPath(folder.m_path);
+        it = dirEntries.find(attachmentFolderPath);
+        if (it != dirEntries.end()) {
+            for (const auto &name : it->m_folders) {
+                if (!folder.m_attachmentFolders.contains(name)) {
+                    result.m_folders << PathUtils::concatenateFilePath(attachmentFolderPath, name);
+                }
+            }
+        }
+    }
+
+    {
+        auto it = dirEntries.find(storeFolderPath);
+        if (it != dirEntries.end()) {
+            collectFiles(storeFolderPath, it.value());
+        }
+    }
+
+    m_notes.clear();
+    m_folders.clear();
+    m_unsavedContents.clear();
+
+    if (!m_dryRun) {
+        apply(result);
+    }
+
+    qDebug() << "media collection of notebook" << m_notebook->getName()
+             << "notes" << result.m_noteCount << "parsed" << result.m_parsedNoteCount
+             << "orphaned files" << result.m_files.size() << "orphaned folders" << result.m_folders.size();
+
+    emit finished(result);
+}
+
+bool MediaGarbageCollector::apply(const Result &p_result)
+{
+    if (isRunning()) {
+        return false;
+    }
+
+    // Counted references supersede the incremental ones.
+    m_notebook->getMediaStore()->resetRefCounts(p_result.m_blobRefs);
+
+    auto onMoved = [this](const QString &p_errMsg) {
+        if (p_errMsg.isEmpty()) {
+            ++m_movedCount;
+        }
+        if (--m_pendingMoveCount == 0) {
+            emit applied(m_movedCount);
+        }
+    };
+
+    m_movedCount = 0;
+    for (const auto &file : p_result.m_files) {
+        if (QFileInfo::exists(file)) {
+            ++m_pendingMoveCount;
+            m_notebook->moveFileToRecycleBin(file, onMoved);
+        }
+    }
+
+    for (const auto &folder : p_result.m_folders) {
+        if (QFileInfo::exists(folder)) {
+            ++m_pendingMoveCount;
+            m_notebook->moveDirToRecycleBin(folder, onMoved);
+        }
+    }
+
+    if (m_pendingMoveCount == 0) {
+        emit applied(0);
+    }
+
+    return true;
+}
+
+QString MediaGarbageCollector::getCacheFilePath() const
+{
+    return PathUtils::concatenateFilePath(m_rootPath,
+                                          BundleNotebookConfigMgr::getConfigFolderName() + QStringLiteral("/") + c_cacheFileName);
+}
+
+QString MediaGarbageCollector::getImageFolderPath(const QString &p_folderPath) const
+{
+    return PathUtils::concatenateFilePath(p_folderPath, m_notebook->getImageFolder());
+}
+
+QString MediaGarbageCollector::getAttachmentFolderPath(const QString &p_folderPath) const
+{
+    return PathUtils::concatenateFilePath(p_folderPath, m_notebook->getAttachmentFolder());
+}
+
+void MediaGarbageCollector::loadCache()
+{
+    if (m_cacheLoaded) {
+        return;
+    }
+
+    m_cacheLoaded = true;
+    m_cache.clear();
+
+    const auto cacheFilePath = getCacheFilePath();
+    auto backend = m_notebook->getBackend();
+    if (!backend->existsFile(cacheFilePath)) {
+        return;
+    }
+
+    const auto notes = QJsonDocument::fromJson(backend->readFile(cacheFilePath)).object().value(QStringLiteral("notes")).toObject();
+    for (auto it = notes.constBegin(); it != notes.constEnd(); ++it) {
+        const auto obj = it.value().toObject();
+        NoteItem item;
+        item.m_relativePath = it.key();
+        // Caches of old versions hold only images. Parse those notes again.
+        if (!obj.contains(QStringLiteral("links"))) {
+            continue;
+        }
+        item.m_modifiedTimeMsecs = static_cast<qint64>(obj.value(QStringLiteral("modified_time")).toDouble(-1));
+        for (const auto &link : obj.value(QStringLiteral("links")).toArray()) {
+            item.m_links << link.toString();
+        }
+        m_cache.insert(item.m_relativePath, item);
+    }
+}
+
+void MediaGarbageCollector::saveCache()
+{
+    QJsonObject notes;
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        QJsonObject obj;
+        obj[QStringLiteral("modified_time")] = static_cast<double>(it->m_modifiedTimeMsecs);
+        obj[QStringLiteral("links")] = QJsonArray::fromStringList(it->m_links);
+        notes.insert(it.key(), obj);
+    }
+
+    QJsonObject obj;
+    obj[QStringLiteral("notes")] = notes;
+
+    try {
+        m_notebook->getBackend()->writeFile(getCacheFilePath(), obj);
+    } catch (Exception &p_e) {
+        qWarning() << "failed to save media collection cache" << p_e.what();
+    }
+}
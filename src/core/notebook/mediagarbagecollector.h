@@ -0,0 +1,189 @@
+#ifndef MEDIAGARBAGECOLLECTOR_H
+#define MEDIAGARBAGECOLLECTOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+#include <utils/fileutils.h>
+
+namespace vnotex
+{
+    class Notebook;
+    class Node;
+
+    // Find images and attachments of a notebook that no note refers to.
+    // Notes are parsed in parallel in background. Links of notes not modified
+    // since last run are taken from a cache kept along with the notebook config.
+    class MediaGarbageCollector : public QObject
+    {
+        Q_OBJECT
+    public:
+        struct Result
+        {
+            // Absolute paths of images not linked by any note.
+            QStringList m_files;
+
+            // Absolute paths of attachment folders not owned by any note.
+            QStringList m_folders;
+
+            int m_noteCount = 0;
+
+            // Notes parsed in this run. The others are served from cache.
+            int m_parsedNoteCount = 0;
+
+            // Blob file name to number of notes referring to it.
+            QHash<QString, int> m_blobRefs;
+        };
+
+        explicit MediaGarbageCollector(Notebook *p_notebook, QObject *p_parent = nullptr);
+
+        ~MediaGarbageCollector();
+
+        // Start a run in background. Orphans are moved to recycle bin unless @p_dryRun.
+        // @p_unsavedContents: absolute path of note to its content not saved yet, which
+        // is parsed instead of the file.
+        // Return false if a run is in progress.
+        bool collect(bool p_dryRun,
+                     const QHash<QString, QString> &p_unsavedContents = QHash<QString, QString>());
+
+        // Move orphans found by a dry run to recycle bin in background.
+        // applied() is emitted once all moves are done.
+        // Return false if a run or moves are in progress.
+        bool apply(const Result &p_result);
+
+        // Whether a run or moves of its result are in progress.
+        bool isRunning() const;
+
+        // Block until current run and moves finish.
+        void waitForDone();
+
+    signals:
+        void finished(const MediaGarbageCollector::Result &p_result);
+
+        // @p_movedCount: files and folders moved to recycle bin successfully.
+        void applied(int p_movedCount);
+
+    private:
+        struct NoteItem
+        {
+            // Absolute path.
+            QString m_path;
+
+            // Path relative to notebook root. Key of the cache.
+            QString m_relativePath;
+
+            qint64 m_modifiedTimeMsecs = -1;
+
+            // Local files linked, relative to notebook root.
+            QStringList m_links;
+
+            bool m_parsed = false;
+        };
+
+        struct FolderItem
+        {
+            // Absolute path.
+            QString m_path;
+
+            // Names of files tracked as nodes.
+            QSet<QString> m_files;
+
+            // Names of attachment folders owned by nodes.
+            QSet<QString> m_attachmentFolders;
+
+            // False within recycle bin, where only notes are parsed.
+            bool m_collectMedia = true;
+        };
+
+        class Worker : public QThread
+        {
+        public:
+            Worker(const MediaGarbageCollector *p_collector,
+                   const QVector<NoteItem> &p_notes,
+                   const QVector<FolderItem> &p_folders,
+                   const QStringList &p_dirsToList);
+
+            // Notes, with untracked ones found in folders appended.
+            QVector<NoteItem> m_notes;
+
+            // Directory path to its entries.
+            QHash<QString, FileUtils::DirEntries> m_dirEntries;
+
+        protected:
+            void run() Q_DECL_OVERRIDE;
+
+        private:
+            void processNote(NoteItem &p_item) const;
+
+            void parseNote(NoteItem &p_item, const QString &p_content) const;
+
+            void processFolder(const FolderItem &p_folder);
+
+            // Targets of Markdown links, reference definitions and HTML src/href attributes.
+            static QStringList fetchLinkTargets(const QString &p_content);
+
+            // Return the absolute path of @p_target, or empty if it is not a local file.
+            static QString resolveLocalLink(const QString &p_target, const QString &p_noteFolderPath);
+
+            const MediaGarbageCollector *m_collector = nullptr;
+
+            QVector<FolderItem> m_folders;
+
+            QStringList m_dirsToList;
+        };
+
+        void collectItems(Node *p_node, bool p_inRecycleBin);
+
+        void handleWorkerFinished();
+
+        void finish();
+
+        void loadCache();
+
+        void saveCache();
+
+        QString getCacheFilePath() const;
+
+        QString getImageFolderPath(const QString &p_folderPath) const;
+
+        QString getAttachmentFolderPath(const QString &p_folderPath) const;
+
+        Notebook *m_notebook = nullptr;
+
+        QString m_rootPath;
+
+        bool m_dryRun = true;
+
+        // Normalized path of note to its unsaved content.
+        // Read only by workers during a run.
+        QHash<QString, QString> m_unsavedContents;
+
+        QVector<NoteItem> m_notes;
+
+        QVector<FolderItem> m_folders;
+
+        // Relative path of note to its item of last run.
+        // Read only by workers during a run.
+        QHash<QString, NoteItem> m_cache;
+
+        bool m_cacheLoaded = false;
+
+        QVector<QSharedPointer<Worker>> m_workers;
+
+        int m_numOfFinishedWorkers = 0;
+
+        // Moves to recycle bin submitted by apply() and not finished yet.
+        int m_pendingMoveCount = 0;
+
+        int m_movedCount = 0;
+
+        static const QString c_cacheFileName;
+    };
+} // ns vnotex
+
+#endif // MEDIAGARBAGECOLLECTOR_H
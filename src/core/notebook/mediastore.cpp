@@ -0,0 +1,181 @@
+#include "mediastore.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+#include <notebookbackend/inotebookbackend.h>
+#include <notebookconfigmgr/bundlenotebookconfigmgr.h>
+#include <utils/pathutils.h>
+#include "exception.h"
+#include "notebook.h"
+
+using namespace vnotex;
+
+const QString MediaStore::c_folderName = QStringLiteral("vx_media");
+
+MediaStore::MediaStore(Notebook *p_notebook)
+    : m_notebook(p_notebook)
+{
+    Q_ASSERT(m_notebook);
+}
+
+QString MediaStore::getFolderPath() const
+{
+    return PathUtils::concatenateFilePath(m_notebook->getRootFolderAbsolutePath(),
+                                          BundleNotebookConfigMgr::getConfigFolderName() + QStringLiteral("/") + c_folderName);
+}
+
+QString MediaStore::getRefsFilePath() const
+{
+    return PathUtils::concatenateFilePath(m_notebook->getRootFolderAbsolutePath(),
+                                          BundleNotebookConfigMgr::getConfigFolderName() + QStringLiteral("/") + c_folderName + QStringLiteral(".json"));
+}
+
+bool MediaStore::contains(const QString &p_path) const
+{
+    return PathUtils::areSamePaths(PathUtils::parentDirPath(p_path), getFolderPath());
+}
+
+bool MediaStore::isBlobPath(const QString &p_path)
+{
+    const auto folderPath = PathUtils::parentDirPath(p_path);
+    return PathUtils::dirName(folderPath) == c_folderName
+           && PathUtils::dirName(PathUtils::parentDirPath(folderPath)) == BundleNotebookConfigMgr::getConfigFolderName();
+}
+
+QString MediaStore::blobPath(const QString &p_hash, const QString &p_suffix) const
+{
+    auto name = p_hash;
+    if (!p_suffix.isEmpty()) {
+        name += QStringLiteral(".") + p_suffix.toLower();
+    }
+    return PathUtils::concatenateFilePath(getFolderPath(), name);
+}
+
+QString MediaStore::addFile(const QString &p_filePath)
+{
+    // Hash in a streaming way and copy only if it is a new blob.
+    QFile file(p_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        Exception::throwOne(Exception::Type::FailToReadFile,
+                            QString("failed to read file: %1").arg(p_filePath));
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    file.close();
+
+    const auto destPath = blobPath(QString::fromLatin1(hash.result().toHex()), QFileInfo(p_filePath).suffix());
+    auto backend = m_notebook->getBackend();
+    if (!backend->existsFile(destPath)) {
+        backend->makePath(getFolderPath());
+        backend->copyFile(p_filePath, destPath);
+    }
+
+    addRef(destPath);
+    return destPath;
+}
+
+QString MediaStore::addData(const QByteArray &p_data, const QString &p_suffix)
+{
+    const auto hash = QCryptographicHash::hash(p_data, QCryptographicHash::Sha256);
+    const auto destPath = blobPath(QString::fromLatin1(hash.toHex()), p_suffix);
+    auto backend = m_notebook->getBackend();
+    if (!backend->existsFile(destPath)) {
+        backend->makePath(getFolderPath());
+        backend->writeFile(destPath, p_data);
+        backend->addFile(destPath);
+    }
+
+    addRef(destPath);
+    return destPath;
+}
+
+void MediaStore::addRef(const QString &p_blobPath)
+{
+    Q_ASSERT(contains(p_blobPath));
+    load();
+    ++m_refs[PathUtils::fileName(p_blobPath)];
+    save();
+}
+
+bool MediaStore::release(const QString &p_blobPath)
+{
+    Q_ASSERT(contains(p_blobPath));
+    load();
+
+    const auto name = PathUtils::fileName(p_blobPath);
+    auto it = m_refs.find(name);
+    if (it != m_refs.end() && --it.value() > 0) {
+        save();
+        return false;
+    }
+
+    // Unknown blobs are treated as referred once.
+    if (it != m_refs.end()) {
+        m_refs.erase(it);
+    }
+    save();
+
+    // Other notes may still link to it without being counted. Leave it to the collector.
+    return true;
+}
+
+int MediaStore::getRefCount(const QString &p_blobPath) const
+{
+    load();
+    return m_refs.value(PathUtils::fileName(p_blobPath), 0);
+}
+
+void MediaStore::resetRefCounts(const QHash<QString, int> &p_refs)
+{
+    m_loaded = true;
+    m_refs = p_refs;
+    save();
+}
+
+void MediaStore::load() const
+{
+    if (m_loaded) {
+        return;
+    }
+
+    m_loaded = true;
+    m_refs.clear();
+
+    const auto refsFilePath = getRefsFilePath();
+    auto backend = m_notebook->getBackend();
+    if (!backend->existsFile(refsFilePath)) {
+        return;
+    }
+
+    const auto obj = QJsonDocument::fromJson(backend->readFile(refsFilePath)).object();
+    const auto blobs = obj.value(QStringLiteral("blobs")).toObject();
+    for (auto it = blobs.constBegin(); it != blobs.constEnd(); ++it) {
+        const int cnt = it.value().toInt();
+        if (cnt > 0) {
+            m_refs.insert(it.key(), cnt);
+        }
+    }
+}
+
+void MediaStore::save()
+{
+    QJsonObject blobs;
+    for (auto it = m_refs.constBegin(); it != m_refs.constEnd(); ++it) {
+        blobs.insert(it.key(), it.value());
+    }
+
+    QJsonObject obj;
+    obj[QStringLiteral("blobs")] = blobs;
+
+    try {
+        m_notebook->getBackend()->writeFile(getRefsFilePath(), obj);
+    } catch (Exception &p_e) {
+        qWarning() << "failed to save media store references" << p_e.what();
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef MEDIASTORE_H
+#define MEDIASTORE_H
+
+#include <QHash>
+#include <QString>
+
+class QByteArray;
+
+namespace vnotex
+{
+    class Notebook;
+
+    // Content-addressed store of media files of a notebook.
+    // Each blob is named after the hash of its content and shared by all notes
+    // referring to it. Reference counts are persisted along with the notebook config.
+    // Counts are only a hint since links could be copied by hand. Blobs are never removed
+    // here but by MediaGarbageCollector, which checks the links of all notes.
+    class MediaStore
+    {
+    public:
+        explicit MediaStore(Notebook *p_notebook);
+
+        // Absolute path of the folder holding blobs.
+        QString getFolderPath() const;
+
+        // Whether @p_path is a blob of this store.
+        bool contains(const QString &p_path) const;
+
+        // Whether @p_path is a blob of any media store.
+        static bool isBlobPath(const QString &p_path);
+
+        // Add file @p_filePath and add one reference.
+        // Return the absolute path of the blob.
+        QString addFile(const QString &p_filePath);
+
+        // Add @p_data as a blob with suffix @p_suffix and add one reference.
+        QString addData(const QByteArray &p_data, const QString &p_suffix);
+
+        void addRef(const QString &p_blobPath);
+
+        // Drop one reference. The blob is kept on disk until collected.
+        // Return true if no reference is counted any more.
+        bool release(const QString &p_blobPath);
+
+        int getRefCount(const QString &p_blobPath) const;
+
+        // Replace all reference counts, keyed by blob file name, with ones counted from notes.
+        void resetRefCounts(const QHash<QString, int> &p_refs);
+
+        static const QString c_folderName;
+
+    private:
+        void load() const;
+
+        void save();
+
+        QString getRefsFilePath() const;
+
+        QString blobPath(const QString &p_hash, const QString &p_suffix) const;
+
+        Notebook *m_notebook = nullptr;
+
+        // Blob file name to reference count.
+        mutable QHash<QString, int> m_refs;
+
+        mutable bool m_loaded = false;
+    };
+} // ns vnotex
+
+#endif // MEDIASTORE_H
@@ -1,6 +1,10 @@
 #include "node.h"
 
 #include <QDir>
+#include <QThread>
+#include <QCoreApplication>
+
+#include <limits>
 
 #include <notebookconfigmgr/inotebookconfigmgr.h>
 #include <notebookbackend/inotebookbackend.h>
@@ -10,6 +14,17 @@
 
 using namespace vnotex;
 
+QAtomicInteger<quint64> Node::s_pathGeneration(1);
+
+const qint64 Node::c_invalidTime = std::numeric_limits<qint64>::min();
+
+// Caches are mutable and not guarded, so only the GUI thread may touch them.
+static bool isCacheThread()
+{
+    auto app = QCoreApplication::instance();
+    return !app || QThread::currentThread() == app->thread();
+}
+
 Node::Node(Flags p_flags,
            ID p_id,
            const QString &p_name,
@@ -20,17 +35,17 @@ Node::Node(Flags p_flags,
            Notebook *p_notebook,
            Node *p_parent)
     : m_notebook(p_notebook),
-      m_loaded(true),
-      m_flags(p_flags),
-      m_id(p_id),
+      m_parent(p_parent),
       m_name(p_name),
-      m_createdTimeUtc(p_createdTimeUtc),
-      m_modifiedTimeUtc(p_modifiedTimeUtc),
-      m_tags(p_tags),
-      m_attachmentFolder(p_attachmentFolder),
-      m_parent(p_parent)
+      m_tagIds(TagPool::intern(p_tags)),
+      m_id(p_id),
+      m_createdTimeMsecs(timeToMsecs(p_createdTimeUtc)),
+      m_modifiedTimeMsecs(timeToMsecs(p_modifiedTimeUtc)),
+      m_flags(p_flags),
+      m_loaded(true)
 {
     Q_ASSERT(m_notebook);
+    setAttachmentFolder(p_attachmentFolder);
 }
 
 Node::Node(Flags p_flags,
@@ -38,9 +53,9 @@ Node::Node(Flags p_flags,
            Notebook *p_notebook,
            Node *p_parent)
     : m_notebook(p_notebook),
-      m_flags(p_flags),
+      m_parent(p_parent),
       m_name(p_name),
-      m_parent(p_parent)
+      m_flags(p_flags)
 {
     Q_ASSERT(m_notebook);
 }
@@ -62,13 +77,36 @@ void Node::loadCompleteInfo(ID p_id,
 {
     Q_ASSERT(!m_loaded);
     m_id = p_id;
-    m_createdTimeUtc = p_createdTimeUtc;
-    m_modifiedTimeUtc = p_modifiedTimeUtc;
-    m_tags = p_tags;
+    m_createdTimeMsecs = timeToMsecs(p_createdTimeUtc);
+    m_modifiedTimeMsecs = timeToMsecs(p_modifiedTimeUtc);
+    m_tagIds = TagPool::intern(p_tags);
     m_children = p_children;
     m_loaded = true;
 }
 
+bool Node::updateInfo(const QDateTime &p_createdTimeUtc,
+                      const QDateTime &p_modifiedTimeUtc,
+                      const QStringList &p_tags,
+                      const QString &p_attachmentFolder)
+{
+    Q_ASSERT(m_loaded);
+    const auto createdTimeMsecs = timeToMsecs(p_createdTimeUtc);
+    const auto modifiedTimeMsecs = timeToMsecs(p_modifiedTimeUtc);
+    const auto tagIds = TagPool::intern(p_tags);
+    if (createdTimeMsecs == m_createdTimeMsecs
+        && modifiedTimeMsecs == m_modifiedTimeMsecs
+        && tagIds == m_tagIds
+        && p_attachmentFolder == m_attachmentFolder) {
+        return false;
+    }
+
+    m_createdTimeMsecs = createdTimeMsecs;
+    m_modifiedTimeMsecs = modifiedTimeMsecs;
+    m_tagIds = tagIds;
+    setAttachmentFolder(p_attachmentFolder);
+    return true;
+}
+
 bool Node::isRoot() const
 {
     return !m_parent && m_use == Use::Root;
@@ -81,7 +119,12 @@ const QString &Node::getName() const
 
 void Node::setName(const QString &p_name)
 {
+    if (m_name == p_name) {
+        return;
+    }
+
     m_name = p_name;
+    bumpPathGeneration();
 }
 
 void Node::updateName(const QString &p_name)
@@ -121,7 +164,19 @@ QSharedPointer<Node> Node::findChild(const QString &p_name, bool p_caseSensitive
 
 void Node::setParent(Node *p_parent)
 {
-    m_parent = p_parent;
+    if (m_parent == p_parent) {
+        return;
+    }
+
+    if (m_parent) {
+        // Paths of an attached subtree may be cached by anyone.
+        m_parent = p_parent;
+        bumpPathGeneration();
+    } else {
+        // Attaching a detached node, such as one just loaded, changes only paths of its own subtree.
+        m_parent = p_parent;
+        dropPathCache();
+    }
 }
 
 Node *Node::getParent() const
@@ -149,19 +204,43 @@ ID Node::getId() const
     return m_id;
 }
 
-const QDateTime &Node::getCreatedTimeUtc() const
+QDateTime Node::getCreatedTimeUtc() const
+{
+    return msecsToTime(m_createdTimeMsecs);
+}
+
+qint64 Node::getCreatedTimeMsecs() const
+{
+    return m_createdTimeMsecs;
+}
+
+QDateTime Node::getModifiedTimeUtc() const
 {
-    return m_createdTimeUtc;
+    return msecsToTime(m_modifiedTimeMsecs);
 }
 
-const QDateTime &Node::getModifiedTimeUtc() const
+qint64 Node::getModifiedTimeMsecs() const
 {
-    return m_modifiedTimeUtc;
+    return m_modifiedTimeMsecs;
 }
 
 void Node::setModifiedTimeUtc()
 {
-    m_modifiedTimeUtc = QDateTime::currentDateTimeUtc();
+    m_modifiedTimeMsecs = QDateTime::currentMSecsSinceEpoch();
+}
+
+qint64 Node::timeToMsecs(const QDateTime &p_time)
+{
+    return p_time.isValid() ? p_time.toMSecsSinceEpoch() : c_invalidTime;
+}
+
+QDateTime Node::msecsToTime(qint64 p_msecs)
+{
+    if (p_msecs == c_invalidTime) {
+        return QDateTime();
+    }
+
+    return QDateTime::fromMSecsSinceEpoch(p_msecs, Qt::UTC);
 }
 
 const QVector<QSharedPointer<Node>> &Node::getChildrenRef() const
@@ -200,6 +279,23 @@ void Node::removeChild(const QSharedPointer<Node> &p_child)
     }
 }
 
+void Node::replaceChildren(const QVector<QSharedPointer<Node>> &p_children)
+{
+    Q_ASSERT(isContainer());
+
+    for (const auto &child : m_children) {
+        if (!p_children.contains(child)) {
+            child->setParent(nullptr);
+        }
+    }
+
+    for (const auto &child : p_children) {
+        child->setParent(this);
+    }
+
+    m_children = p_children;
+}
+
 Notebook *Node::getNotebook() const
 {
     return m_notebook;
@@ -221,9 +317,14 @@ bool Node::isAncestor(const Node *p_ancestor, const Node *p_child)
     return false;
 }
 
-const QStringList &Node::getTags() const
+QStringList Node::getTags() const
 {
-    return m_tags;
+    return TagPool::names(m_tagIds);
+}
+
+const QVector<TagId> &Node::getTagIds() const
+{
+    return m_tagIds;
 }
 
 bool Node::isReadOnly() const
@@ -241,6 +342,36 @@ void Node::setReadOnly(bool p_readOnly)
 }
 
 QString Node::fetchPath() const
+{
+    if (!isCacheThread()) {
+        return computePath();
+    }
+
+    validatePathCache();
+    if (!m_pathCached) {
+        m_pathCache = computePath();
+        m_pathCached = true;
+    }
+
+    return m_pathCache;
+}
+
+QString Node::fetchAbsolutePath() const
+{
+    if (!isCacheThread()) {
+        return computeAbsolutePath();
+    }
+
+    validatePathCache();
+    if (!m_absolutePathCached) {
+        m_absolutePathCache = computeAbsolutePath();
+        m_absolutePathCached = true;
+    }
+
+    return m_absolutePathCache;
+}
+
+QString Node::computePath() const
 {
     if (!m_parent) {
         return QString();
@@ -249,6 +380,35 @@ QString Node::fetchPath() const
     }
 }
 
+void Node::validatePathCache() const
+{
+    const quint64 generation = s_pathGeneration.loadAcquire();
+    if (m_pathCacheGeneration != generation) {
+        m_pathCacheGeneration = generation;
+        m_pathCached = false;
+        m_absolutePathCached = false;
+    }
+}
+
+void Node::dropPathCache() const
+{
+    m_pathCached = false;
+    m_absolutePathCached = false;
+    for (const auto &child : m_children) {
+        child->dropPathCache();
+    }
+}
+
+void Node::bumpPathGeneration()
+{
+    s_pathGeneration.fetchAndAddOrdered(1);
+}
+
+quint64 Node::getPathGeneration()
+{
+    return s_pathGeneration.loadAcquire();
+}
+
 bool Node::isContainer() const
 {
     return m_flags & Flag::Container;
@@ -275,6 +435,10 @@ void Node::load()
     }
 
     getConfigMgr()->loadNode(this);
+
+    if (isLoaded()) {
+        emit m_notebook->nodeLoaded(this);
+    }
 }
 
 void Node::save()
@@ -294,7 +458,12 @@ const QString &Node::getAttachmentFolder() const
 
 void Node::setAttachmentFolder(const QString &p_attachmentFolder)
 {
-    m_attachmentFolder = p_attachmentFolder;
+    if (p_attachmentFolder.isEmpty()) {
+        // Share the null string instead of holding an empty one per node.
+        m_attachmentFolder.clear();
+    } else {
+        m_attachmentFolder = p_attachmentFolder;
+    }
 }
 
 QString Node::fetchAttachmentFolderPath()
@@ -413,3 +582,85 @@ bool Node::checkExists()
     }
     return after;
 }
+
+static qint64 stringBytes(const QString &p_str)
+{
+    if (p_str.isNull()) {
+        return 0;
+    }
+
+    // Header of QArrayData plus the UTF-16 payload.
+    return 24 + (p_str.capacity() + 1) * static_cast<qint64>(sizeof(QChar));
+}
+
+NodeMemoryStats Node::collectMemoryStats(const Node *p_root)
+{
+    NodeMemoryStats stats;
+    if (!p_root) {
+        return stats;
+    }
+
+    // Size of the control block of QSharedPointer::create().
+    const qint64 sharedPointerOverhead = 16;
+
+    // QDateTime of Qt 5 keeps a heap-allocated private for values it could not pack inline.
+    const qint64 legacyDateTimeBytes = sizeof(QDateTime) + 40;
+
+    QVector<const Node *> stack;
+    stack.push_back(p_root);
+    while (!stack.isEmpty()) {
+        const auto node = stack.takeLast();
+
+        qint64 bytes = sizeof(*node) + sharedPointerOverhead;
+        bytes += stringBytes(node->m_name);
+        bytes += stringBytes(node->m_attachmentFolder);
+        bytes += stringBytes(node->m_pathCache);
+        bytes += stringBytes(node->m_absolutePathCache);
+        bytes += node->m_tagIds.capacity() * static_cast<qint64>(sizeof(TagId));
+        bytes += node->m_children.capacity() * static_cast<qint64>(sizeof(QSharedPointer<Node>));
+
+        qint64 legacyBytes = bytes;
+        // Two QDateTime instead of two qint64.
+        legacyBytes += 2 * (legacyDateTimeBytes - static_cast<qint64>(sizeof(qint64)));
+        // A QStringList with a private copy of each tag instead of the IDs.
+        legacyBytes -= node->m_tagIds.capacity() * static_cast<qint64>(sizeof(TagId));
+        for (auto id : node->m_tagIds) {
+            legacyBytes += sizeof(QString) + stringBytes(TagPool::name(id));
+        }
+        // An empty but non-null attachment folder string as parsed from config.
+        if (node->m_attachmentFolder.isNull() && node->hasContent()) {
+            legacyBytes += 24 + static_cast<qint64>(sizeof(QChar));
+        }
+
+        ++stats.m_nodeCount;
+        stats.m_bytes += bytes;
+        stats.m_estimatedLegacyBytes += legacyBytes;
+
+        for (const auto &child : node->m_children) {
+            stack.push_back(child.data());
+        }
+    }
+
+    stats.m_bytes += TagPool::bytes();
+    return stats;
+}
+
+qint64 NodeMemoryStats::bytesPerNode() const
+{
+    return m_nodeCount > 0 ? m_bytes / m_nodeCount : 0;
+}
+
+qint64 NodeMemoryStats::estimatedLegacyBytesPerNode() const
+{
+    return m_nodeCount > 0 ? m_estimatedLegacyBytes / m_nodeCount : 0;
+}
+
+QString NodeMemoryStats::toString() const
+{
+    return QString("%1 nodes, about %2 bytes (%3 bytes per node), estimated %4 bytes with previous layout (%5 bytes per node)")
+                  .arg(QString::number(m_nodeCount),
+                       QString::number(m_bytes),
+                       QString::number(bytesPerNode()),
+                       QString::number(m_estimatedLegacyBytes),
+                       QString::number(estimatedLegacyBytesPerNode()));
+}
@@ -6,9 +6,12 @@
 #include <QSharedPointer>
 #include <QDir>
 #include <QEnableSharedFromThis>
+#include <QAtomicInteger>
 
 #include <global.h>
 
+#include "tagpool.h"
+
 namespace vnotex
 {
     class Notebook;
@@ -26,6 +29,26 @@ namespace vnotex
         QStringList m_tags;
     };
 
+    // Approximate memory usage of a loaded node tree, computed from sizes of members.
+    // It walks the whole tree, so it is for diagnostics only.
+    struct NodeMemoryStats
+    {
+        qint64 bytesPerNode() const;
+
+        qint64 estimatedLegacyBytesPerNode() const;
+
+        QString toString() const;
+
+        int m_nodeCount = 0;
+
+        qint64 m_bytes = 0;
+
+        // Estimated, not measured, bytes of the same tree with the previous layout, which held
+        // two QDateTime, a QStringList of tags and an attachment folder string per node.
+        // Sizes of QDateTime privates and string headers are typical values of Qt 5 on 64-bit.
+        qint64 m_estimatedLegacyBytes = 0;
+    };
+
     // Node of notebook.
     class Node : public QEnableSharedFromThis<Node>
     {
@@ -80,10 +103,18 @@ namespace vnotex
 
         // Fetch path of this node within notebook.
         // This may not be the same as the actual file path. It depends on the config mgr.
-        virtual QString fetchPath() const;
+        // The result is cached until this node or any of its ancestors is renamed or moved.
+        // Only the GUI thread reads and fills the cache. Other threads get a computed path.
+        QString fetchPath() const;
 
         // Fetch absolute file path if available.
-        virtual QString fetchAbsolutePath() const = 0;
+        // Cached the same way as fetchPath().
+        QString fetchAbsolutePath() const;
+
+        // Changed whenever any attached node is renamed, moved or detached.
+        // Attaching new nodes, such as loading, does not change it.
+        // Used to invalidate caches keyed by node paths.
+        static quint64 getPathGeneration();
 
         bool isContainer() const;
 
@@ -103,9 +134,15 @@ namespace vnotex
 
         ID getId() const;
 
-        const QDateTime &getCreatedTimeUtc() const;
+        QDateTime getCreatedTimeUtc() const;
+
+        // Milliseconds since epoch, cheaper for comparison.
+        qint64 getCreatedTimeMsecs() const;
+
+        QDateTime getModifiedTimeUtc() const;
+
+        qint64 getModifiedTimeMsecs() const;
 
-        const QDateTime &getModifiedTimeUtc() const;
         void setModifiedTimeUtc();
 
         const QVector<QSharedPointer<Node>> &getChildrenRef() const;
@@ -130,6 +167,9 @@ namespace vnotex
 
         void removeChild(const QSharedPointer<Node> &p_node);
 
+        // Replace all children with @p_children, which may reuse some of current children.
+        void replaceChildren(const QVector<QSharedPointer<Node>> &p_children);
+
         QVector<QSharedPointer<ExternalNode>> fetchExternalChildren() const;
 
         void setParent(Node *p_parent);
@@ -140,7 +180,9 @@ namespace vnotex
         void load();
         void save();
 
-        const QStringList &getTags() const;
+        QStringList getTags() const;
+
+        const QVector<TagId> &getTagIds() const;
 
         const QString &getAttachmentFolder() const;
         void setAttachmentFolder(const QString &p_attachmentFolder);
@@ -171,6 +213,13 @@ namespace vnotex
                               const QStringList &p_tags,
                               const QVector<QSharedPointer<Node>> &p_children);
 
+        // Update info of a loaded node, such as after its config is changed outside.
+        // Return true if anything is changed.
+        bool updateInfo(const QDateTime &p_createdTimeUtc,
+                        const QDateTime &p_modifiedTimeUtc,
+                        const QStringList &p_tags,
+                        const QString &p_attachmentFolder);
+
         INotebookConfigMgr *getConfigMgr() const;
 
         INotebookBackend *getBackend() const;
@@ -181,31 +230,76 @@ namespace vnotex
 
         static bool isAncestor(const Node *p_ancestor, const Node *p_child);
 
+        // Walk the loaded part of tree @p_root and estimate its memory usage.
+        static NodeMemoryStats collectMemoryStats(const Node *p_root);
+
+        // Milliseconds since epoch as kept by nodes.
+        static qint64 timeToMsecs(const QDateTime &p_time);
+
     protected:
+        // Compute the path within notebook without cache.
+        virtual QString computePath() const;
+
+        // Compute the absolute file path without cache.
+        virtual QString computeAbsolutePath() const = 0;
+
         Notebook *m_notebook = nullptr;
 
     private:
-        bool m_loaded = false;
+        // Drop cached paths if the tree has been restructured since they are computed.
+        void validatePathCache() const;
 
-        Flags m_flags = Flag::None;
+        // Drop cached paths of this node and its loaded descendants.
+        void dropPathCache() const;
 
-        Use m_use = Use::Normal;
+        // Invalidate cached paths of all nodes.
+        static void bumpPathGeneration();
 
-        ID m_id = InvalidId;
+        static QDateTime msecsToTime(qint64 p_msecs);
+
+        // Members are ordered by size to avoid padding since there may be hundreds of thousands of nodes.
+        Node *m_parent = nullptr;
 
         QString m_name;
 
-        QDateTime m_createdTimeUtc;
+        // Empty folder is kept as the shared null string.
+        QString m_attachmentFolder;
 
-        QDateTime m_modifiedTimeUtc;
+        // Interned tags.
+        QVector<TagId> m_tagIds;
 
-        QStringList m_tags;
+        QVector<QSharedPointer<Node>> m_children;
 
-        QString m_attachmentFolder;
+        mutable QString m_pathCache;
 
-        Node *m_parent = nullptr;
+        mutable QString m_absolutePathCache;
 
-        QVector<QSharedPointer<Node>> m_children;
+        ID m_id = InvalidId;
+
+        // Milliseconds since epoch in UTC.
+        qint64 m_createdTimeMsecs = c_invalidTime;
+
+        qint64 m_modifiedTimeMsecs = c_invalidTime;
+
+        // Generation of the tree structure when the caches are computed.
+        mutable quint64 m_pathCacheGeneration = 0;
+
+        Flags m_flags = Flag::None;
+
+        Use m_use = Use::Normal;
+
+        bool m_loaded = false;
+
+        mutable bool m_pathCached = false;
+
+        mutable bool m_absolutePathCached = false;
+
+        // Bumped whenever any node is renamed or moved.
+        // Atomic since workers may read it while the GUI thread restructures the tree.
+        static QAtomicInteger<quint64> s_pathGeneration;
+
+        // Used for invalid QDateTime.
+        static const qint64 c_invalidTime;
     };
 
     Q_DECLARE_OPERATORS_FOR_FLAGS(Node::Flags)
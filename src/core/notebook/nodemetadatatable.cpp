@@ -0,0 +1,517 @@
+#include "nodemetadatatable.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <QFileInfo>
+#include <QPair>
+#include <QDebug>
+
+#include <notebookconfigmgr/inotebookconfigmgr.h>
+#include <utils/pathutils.h>
+#include "notebook.h"
+#include "node.h"
+
+using namespace vnotex;
+
+NodeMetadataTable::Worker::Worker(const QSharedPointer<INotebookConfigMgr> &p_configMgr,
+                                  const QString &p_rootFolderPath,
+                                  const QString &p_recycleBinPath,
+                                  const QSet<QString> &p_loadedRecycleBinFolders,
+                                  const QHash<QString, QPair<qint64, qint64>> &p_oldSizes)
+    : m_configMgr(p_configMgr),
+      m_rootFolderPath(p_rootFolderPath),
+      m_recycleBinPath(p_recycleBinPath),
+      m_loadedRecycleBinFolders(p_loadedRecycleBinFolders),
+      m_oldSizes(p_oldSizes)
+{
+}
+
+void NodeMetadataTable::Worker::appendRow(const INotebookConfigMgr::NodeInfo &p_info,
+                                          const QString &p_path,
+                                          int p_parent,
+                                          quint8 p_flags)
+{
+    qint64 size = 0;
+    if (p_info.m_isContainer) {
+        p_flags |= RowFlag::Container;
+    } else {
+        p_flags |= RowFlag::Content;
+
+        // Sizes of unmodified files are taken from the previous table to save a stat per file.
+        const auto modifiedTime = Node::timeToMsecs(p_info.m_modifiedTimeUtc);
+        auto it = m_oldSizes.constFind(p_path);
+        if (it != m_oldSizes.constEnd() && it.value().first == modifiedTime) {
+            size = it.value().second;
+        } else {
+            size = QFileInfo(PathUtils::concatenateFilePath(m_rootFolderPath, p_path)).size();
+            ++m_statCount;
+        }
+    }
+
+    m_ids.push_back(p_info.m_id);
+    m_parents.push_back(p_parent);
+    m_names.push_back(p_info.m_name);
+    m_createdTimes.push_back(Node::timeToMsecs(p_info.m_createdTimeUtc));
+    m_modifiedTimes.push_back(Node::timeToMsecs(p_info.m_modifiedTimeUtc));
+    m_sizes.push_back(size);
+    m_flags.push_back(p_flags);
+
+    const auto tagIds = TagPool::intern(p_info.m_tags);
+    for (auto tagId : tagIds) {
+        if (!m_tagBitIndex.contains(tagId)) {
+            m_tagBitIndex.insert(tagId, m_tagBitIndex.size());
+        }
+    }
+    m_rowTags.push_back(tagIds);
+}
+
+void NodeMetadataTable::Worker::run()
+{
+    // Info of containers is filled once their configs are read.
+    INotebookConfigMgr::NodeInfo rootInfo;
+    rootInfo.m_isContainer = true;
+    appendRow(rootInfo, QString(), -1, 0);
+
+    // Breadth-first so that rows of siblings are adjacent.
+    QVector<QPair<QString, int>> containers;
+    containers.push_back(qMakePair(QString(), 0));
+    QVector<INotebookConfigMgr::NodeInfo> children;
+    for (int i = 0; i < containers.size(); ++i) {
+        const auto path = containers[i].first;
+        const int row = containers[i].second;
+        const bool inRecycleBin = m_flags[row] & RowFlag::InRecycleBin;
+        if (inRecycleBin && !m_loadedRecycleBinFolders.contains(path)) {
+            // Do not read the many date folders of recycle bin.
+            continue;
+        }
+
+        INotebookConfigMgr::NodeInfo info;
+        if (m_configMgr->readFolderInfo(path, info, children)) {
+            m_ids[row] = info.m_id;
+            m_createdTimes[row] = Node::timeToMsecs(info.m_createdTimeUtc);
+            m_modifiedTimes[row] = Node::timeToMsecs(info.m_modifiedTimeUtc);
+        } else {
+            children.clear();
+        }
+
+        ContainerRows rows;
+        rows.m_row = row;
+        rows.m_firstChildRow = m_ids.size();
+        rows.m_childCount = children.size();
+        m_containerRows.insert(path, rows);
+
+        for (const auto &child : children) {
+            const auto childPath = PathUtils::concatenateFilePath(path, child.m_name);
+            const bool childInRecycleBin = inRecycleBin || childPath == m_recycleBinPath;
+            appendRow(child, childPath, row, childInRecycleBin ? RowFlag::InRecycleBin : 0);
+            if (child.m_isContainer) {
+                containers.push_back(qMakePair(childPath, m_ids.size() - 1));
+            }
+        }
+    }
+
+    // Tags bitmap.
+    m_tagWordCount = (m_tagBitIndex.size() + 63) / 64;
+    m_tagBits.fill(0, m_ids.size() * m_tagWordCount);
+    for (int i = 0; i < m_rowTags.size(); ++i) {
+        auto words = m_tagBits.data() + i * m_tagWordCount;
+        for (auto tagId : m_rowTags[i]) {
+            const int bit = m_tagBitIndex.value(tagId);
+            words[bit / 64] |= Q_UINT64_C(1) << (bit % 64);
+        }
+    }
+    m_rowTags.clear();
+}
+
+NodeMetadataTable::NodeMetadataTable(Notebook *p_notebook, QObject *p_parent)
+    : QObject(p_parent),
+      m_notebook(p_notebook)
+{
+    Q_ASSERT(m_notebook);
+
+    // All changes of nodes end up in writing configs.
+    connect(m_notebook->getConfigMgr().data(), &INotebookConfigMgr::nodeConfigWritten,
+            this, &NodeMetadataTable::updateRows);
+    connect(m_notebook, &Notebook::nodeUpdated,
+            this, &NodeMetadataTable::updateRows);
+
+    // Changes from outside.
+    connect(m_notebook, &Notebook::nodeRefreshed,
+            this, &NodeMetadataTable::invalidate);
+}
+
+NodeMetadataTable::~NodeMetadataTable()
+{
+    if (m_worker) {
+        m_worker->wait();
+    }
+}
+
+bool NodeMetadataTable::isBuilt() const
+{
+    return m_valid;
+}
+
+void NodeMetadataTable::invalidate()
+{
+    m_valid = false;
+    if (m_worker) {
+        m_workerOutdated = true;
+    }
+}
+
+void NodeMetadataTable::updateRows(const Node *p_node)
+{
+    if (!m_valid) {
+        if (m_worker) {
+            // The worker may have read the config before this change.
+            m_workerOutdated = true;
+        }
+        return;
+    }
+
+    auto it = m_containerRows.constFind(p_node->fetchPath());
+    if (it == m_containerRows.constEnd()) {
+        // Folders of recycle bin not loaded are not covered.
+        if (!m_notebook->isRecycleBinNode(p_node) && !m_notebook->isNodeInRecycleBin(p_node)) {
+            invalidate();
+        }
+        return;
+    }
+
+    const auto rows = it.value();
+    const auto &children = p_node->getChildrenRef();
+    if (m_ids[rows.m_row] != p_node->getId() || children.size() != rows.m_childCount) {
+        invalidate();
+        return;
+    }
+
+    // Children in memory may be ordered differently from the config.
+    QHash<QString, int> childRows;
+    childRows.reserve(rows.m_childCount);
+    for (int i = 0; i < rows.m_childCount; ++i) {
+        const int row = rows.m_firstChildRow + i;
+        childRows.insert(m_names[row], row);
+    }
+
+    bool succeeded = updateRow(rows.m_row, p_node);
+    for (int i = 0; succeeded && i < children.size(); ++i) {
+        const int row = childRows.value(children[i]->getName(), -1);
+        succeeded = row != -1
+                    && bool(m_flags[row] & RowFlag::Container) == children[i]->isContainer()
+                    && updateRow(row, children[i].data());
+    }
+
+    if (!succeeded) {
+        invalidate();
+    }
+}
+
+bool NodeMetadataTable::updateRow(int p_row, const Node *p_node)
+{
+    const auto &tagIds = p_node->getTagIds();
+    for (auto tagId : tagIds) {
+        if (!m_tagBitIndex.contains(tagId)) {
+            return false;
+        }
+    }
+
+    const auto modifiedTime = p_node->getModifiedTimeMsecs();
+    if ((m_flags[p_row] & RowFlag::Content) && m_modifiedTimes[p_row] != modifiedTime) {
+        m_sizes[p_row] = QFileInfo(p_node->fetchAbsolutePath()).size();
+    }
+
+    m_ids[p_row] = p_node->getId();
+    m_createdTimes[p_row] = p_node->getCreatedTimeMsecs();
+    m_modifiedTimes[p_row] = modifiedTime;
+
+    auto words = m_tagBits.data() + p_row * m_tagWordCount;
+    std::fill(words, words + m_tagWordCount, Q_UINT64_C(0));
+    for (auto tagId : tagIds) {
+        const int bit = m_tagBitIndex.value(tagId);
+        words[bit / 64] |= Q_UINT64_C(1) << (bit % 64);
+    }
+
+    return true;
+}
+
+void NodeMetadataTable::ensureBuilt()
+{
+    while (!m_valid) {
+        buildAsync();
+        m_worker->wait();
+        handleWorkerFinished();
+    }
+}
+
+int NodeMetadataTable::rowCount()
+{
+    ensureBuilt();
+    return m_ids.size();
+}
+
+void NodeMetadataTable::buildAsync()
+{
+    if (m_valid || m_worker) {
+        return;
+    }
+
+    // Keyed by path since IDs may be shared, such as InvalidId.
+    QHash<QString, QPair<qint64, qint64>> oldSizes;
+    {
+        // Parents come before children.
+        QVector<QString> oldPaths(m_ids.size());
+        for (int i = 1; i < m_ids.size(); ++i) {
+            oldPaths[i] = PathUtils::concatenateFilePath(oldPaths[m_parents[i]], m_names[i]);
+            if (m_flags[i] & RowFlag::Content) {
+                oldSizes.insert(oldPaths[i], qMakePair(m_modifiedTimes[i], m_sizes[i]));
+            }
+        }
+    }
+
+    QString recycleBinPath;
+    QSet<QString> loadedRecycleBinFolders;
+    auto recycleBinNode = m_notebook->getRecycleBinNode();
+    if (recycleBinNode) {
+        recycleBinPath = recycleBinNode->fetchPath();
+        QVector<const Node *> stack = {recycleBinNode.data()};
+        while (!stack.isEmpty()) {
+            auto node = stack.takeLast();
+            if (!node->isContainer() || !node->isLoaded()) {
+                continue;
+            }
+
+            loadedRecycleBinFolders.insert(node->fetchPath());
+            for (const auto &child : node->getChildrenRef()) {
+                stack.push_back(child.data());
+            }
+        }
+    }
+
+    m_workerOutdated = false;
+    m_worker = QSharedPointer<Worker>::create(m_notebook->getConfigMgr(),
+                                              m_notebook->getRootFolderAbsolutePath(),
+                                              recycleBinPath,
+                                              loadedRecycleBinFolders,
+                                              oldSizes);
+    const auto generation = ++m_workerGeneration;
+    connect(m_worker.data(), &QThread::finished,
+            this, [this, generation]() {
+                // It may have been handled by ensureBuilt().
+                if (m_worker && m_workerGeneration == generation) {
+                    handleWorkerFinished();
+                }
+            });
+    m_worker->start();
+}
+
+void NodeMetadataTable::handleWorkerFinished()
+{
+    Q_ASSERT(m_worker && m_worker->isFinished());
+    auto worker = m_worker;
+    m_worker.reset();
+
+    if (m_workerOutdated) {
+        // Changed during build.
+        buildAsync();
+        return;
+    }
+
+    m_ids = worker->m_ids;
+    m_parents = worker->m_parents;
+    m_names = worker->m_names;
+    m_createdTimes = worker->m_createdTimes;
+    m_modifiedTimes = worker->m_modifiedTimes;
+    m_sizes = worker->m_sizes;
+    m_flags = worker->m_flags;
+    m_tagBits = worker->m_tagBits;
+    m_tagWordCount = worker->m_tagWordCount;
+    m_tagBitIndex = worker->m_tagBitIndex;
+    m_containerRows = worker->m_containerRows;
+    m_valid = true;
+
+    qDebug() << "built node metadata table of notebook" << m_notebook->getName()
+             << "rows" << m_ids.size() << "tags" << m_tagBitIndex.size() << "stats" << worker->m_statCount;
+
+    emit built();
+}
+
+bool NodeMetadataTable::tagMask(const QStringList &p_tags, QVector<quint64> &p_mask) const
+{
+    p_mask.fill(0, m_tagWordCount);
+    for (const auto &tag : p_tags) {
+        auto it = m_tagBitIndex.constFind(TagPool::intern(tag));
+        if (it == m_tagBitIndex.constEnd()) {
+            return false;
+        }
+
+        p_mask[it.value() / 64] |= Q_UINT64_C(1) << (it.value() % 64);
+    }
+
+    return true;
+}
+
+QVector<int> NodeMetadataTable::query(const NodeMetadataQuery &p_query)
+{
+    ensureBuilt();
+
+    QVector<int> rows;
+
+    QVector<quint64> mask;
+    if (!tagMask(p_query.m_tags, mask)) {
+        return rows;
+    }
+    const bool checkTags = !p_query.m_tags.isEmpty();
+
+    quint8 excludedFlags = 0;
+    if (!p_query.m_includeRecycleBin) {
+        excludedFlags |= RowFlag::InRecycleBin;
+    }
+    const quint8 requiredFlags = p_query.m_includeFolders ? 0 : RowFlag::Content;
+
+    // Skip root.
+    const int cnt = m_ids.size();
+    for (int i = 1; i < cnt; ++i) {
+        const auto flags = m_flags[i];
+        if ((flags & excludedFlags) || (flags & requiredFlags) != requiredFlags) {
+            continue;
+        }
+
+        if ((p_query.m_modifiedAfterMsecs >= 0 && m_modifiedTimes[i] < p_query.m_modifiedAfterMsecs)
+            || (p_query.m_createdAfterMsecs >= 0 && m_createdTimes[i] < p_query.m_createdAfterMsecs)) {
+            continue;
+        }
+
+        if ((p_query.m_minSize >= 0 && m_sizes[i] < p_query.m_minSize)
+            || (p_query.m_maxSize >= 0 && m_sizes[i] > p_query.m_maxSize)) {
+            continue;
+        }
+
+        if (checkTags) {
+            const auto words = m_tagBits.constData() + i * m_tagWordCount;
+            bool matched = true;
+            for (int w = 0; w < m_tagWordCount; ++w) {
+                if ((words[w] & mask[w]) != mask[w]) {
+                    matched = false;
+                    break;
+                }
+            }
+
+            if (!matched) {
+                continue;
+            }
+        }
+
+        rows.push_back(i);
+    }
+
+    std::function<bool(int, int)> lessThan;
+    switch (p_query.m_sortKey) {
+    case NodeMetadataQuery::SortKey::None:
+        break;
+
+    case NodeMetadataQuery::SortKey::Name:
+        lessThan = [this](int p_a, int p_b) {
+            return m_names[p_a].compare(m_names[p_b], Qt::CaseInsensitive) < 0;
+        };
+        break;
+
+    case NodeMetadataQuery::SortKey::CreatedTime:
+        lessThan = [this](int p_a, int p_b) {
+            return m_createdTimes[p_a] < m_createdTimes[p_b];
+        };
+        break;
+
+    case NodeMetadataQuery::SortKey::ModifiedTime:
+        lessThan = [this](int p_a, int p_b) {
+            return m_modifiedTimes[p_a] < m_modifiedTimes[p_b];
+        };
+        break;
+
+    case NodeMetadataQuery::SortKey::Size:
+        lessThan = [this](int p_a, int p_b) {
+            return m_sizes[p_a] < m_sizes[p_b];
+        };
+        break;
+    }
+
+    const bool needTruncate = p_query.m_limit > 0 && rows.size() > p_query.m_limit;
+    if (lessThan) {
+        auto cmp = [&lessThan, &p_query](int p_a, int p_b) {
+            return p_query.m_descending ? lessThan(p_b, p_a) : lessThan(p_a, p_b);
+        };
+
+        if (needTruncate) {
+            std::partial_sort(rows.begin(), rows.begin() + p_query.m_limit, rows.end(), cmp);
+        } else {
+            std::stable_sort(rows.begin(), rows.end(), cmp);
+        }
+    }
+
+    if (needTruncate) {
+        rows.resize(p_query.m_limit);
+    }
+
+    return rows;
+}
+
+ID NodeMetadataTable::getId(int p_row) const
+{
+    return m_ids[p_row];
+}
+
+int NodeMetadataTable::getParent(int p_row) const
+{
+    return m_parents[p_row];
+}
+
+const QString &NodeMetadataTable::getName(int p_row) const
+{
+    return m_names[p_row];
+}
+
+QString NodeMetadataTable::fetchPath(int p_row) const
+{
+    QStringList names;
+    // Root has no name in path.
+    while (p_row > 0) {
+        names.prepend(m_names[p_row]);
+        p_row = m_parents[p_row];
+    }
+
+    return names.join(QLatin1Char('/'));
+}
+
+qint64 NodeMetadataTable::getCreatedTimeMsecs(int p_row) const
+{
+    return m_createdTimes[p_row];
+}
+
+qint64 NodeMetadataTable::getModifiedTimeMsecs(int p_row) const
+{
+    return m_modifiedTimes[p_row];
+}
+
+qint64 NodeMetadataTable::getSize(int p_row) const
+{
+    return m_sizes[p_row];
+}
+
+QStringList NodeMetadataTable::getTags(int p_row) const
+{
+    QStringList tags;
+    const auto words = m_tagBits.constData() + p_row * m_tagWordCount;
+    for (auto it = m_tagBitIndex.constBegin(); it != m_tagBitIndex.constEnd(); ++it) {
+        if (words[it.value() / 64] & (Q_UINT64_C(1) << (it.value() % 64))) {
+            tags << TagPool::name(it.key());
+        }
+    }
+
+    return tags;
+}
+
+bool NodeMetadataTable::isContainer(int p_row) const
+{
+    return m_flags[p_row] & RowFlag::Container;
+}
@@ -0,0 +1,243 @@
+#ifndef NODEMETADATATABLE_H
+#define NODEMETADATATABLE_H
+
+#include <QObject>
+#include <QThread>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+#include <global.h>
+#include <notebookconfigmgr/inotebookconfigmgr.h>
+
+#include "tagpool.h"
+
+namespace vnotex
+{
+    class Notebook;
+    class Node;
+
+    struct NodeMetadataQuery
+    {
+        enum class SortKey
+        {
+            None,
+            Name,
+            CreatedTime,
+            ModifiedTime,
+            Size
+        };
+
+        // Milliseconds since epoch in UTC. Negative to ignore.
+        qint64 m_modifiedAfterMsecs = -1;
+
+        qint64 m_createdAfterMsecs = -1;
+
+        // Nodes must have all the tags.
+        QStringList m_tags;
+
+        // In bytes. Negative to ignore.
+        qint64 m_minSize = -1;
+
+        qint64 m_maxSize = -1;
+
+        // Notes only by default.
+        bool m_includeFolders = false;
+
+        // Only folders of recycle bin already loaded are covered.
+        bool m_includeRecycleBin = false;
+
+        SortKey m_sortKey = SortKey::ModifiedTime;
+
+        bool m_descending = true;
+
+        // 0 for no limit.
+        int m_limit = 0;
+    };
+
+    // Metadata of all nodes of a notebook kept column by column, so that queries
+    // scan contiguous arrays instead of walking the node tree.
+    // Built in background from configs on disk, without loading nodes. Rows of a folder are
+    // updated in place once its config is written and the table is rebuilt if its children change.
+    class NodeMetadataTable : public QObject
+    {
+        Q_OBJECT
+    public:
+        explicit NodeMetadataTable(Notebook *p_notebook, QObject *p_parent = nullptr);
+
+        ~NodeMetadataTable();
+
+        // Whether the table is built and up to date.
+        bool isBuilt() const;
+
+        // Start building the table in background if it is not built.
+        // built() will be emitted once done.
+        void buildAsync();
+
+        // Return rows matching @p_query in order.
+        // Block until the table is built. Call buildAsync() first to avoid blocking.
+        QVector<int> query(const NodeMetadataQuery &p_query);
+
+        int rowCount();
+
+        ID getId(int p_row) const;
+
+        // Row of the parent. -1 for root.
+        int getParent(int p_row) const;
+
+        const QString &getName(int p_row) const;
+
+        // Path relative to notebook root.
+        QString fetchPath(int p_row) const;
+
+        qint64 getCreatedTimeMsecs(int p_row) const;
+
+        qint64 getModifiedTimeMsecs(int p_row) const;
+
+        // Size of the content file in bytes. 0 for folders.
+        qint64 getSize(int p_row) const;
+
+        QStringList getTags(int p_row) const;
+
+        bool isContainer(int p_row) const;
+
+        // Drop the table. It will be rebuilt on next access.
+        void invalidate();
+
+    signals:
+        void built();
+
+    private:
+        enum RowFlag
+        {
+            Content = 0x1,
+            Container = 0x2,
+            InRecycleBin = 0x4
+        };
+
+        struct ContainerRows
+        {
+            int m_row = -1;
+
+            // Children occupy [m_firstChildRow, m_firstChildRow + m_childCount).
+            int m_firstChildRow = -1;
+
+            int m_childCount = 0;
+        };
+
+        // Read configs and stat files to build the columns.
+        class Worker : public QThread
+        {
+        public:
+            Worker(const QSharedPointer<INotebookConfigMgr> &p_configMgr,
+                   const QString &p_rootFolderPath,
+                   const QString &p_recycleBinPath,
+                   const QSet<QString> &p_loadedRecycleBinFolders,
+                   const QHash<QString, QPair<qint64, qint64>> &p_oldSizes);
+
+            // Columns built, the same as those of the table.
+            QVector<ID> m_ids;
+
+            QVector<int> m_parents;
+
+            QVector<QString> m_names;
+
+            QVector<qint64> m_createdTimes;
+
+            QVector<qint64> m_modifiedTimes;
+
+            QVector<qint64> m_sizes;
+
+            QVector<quint8> m_flags;
+
+            QVector<quint64> m_tagBits;
+
+            int m_tagWordCount = 0;
+
+            QHash<TagId, int> m_tagBitIndex;
+
+            QHash<QString, ContainerRows> m_containerRows;
+
+            int m_statCount = 0;
+
+        protected:
+            void run() Q_DECL_OVERRIDE;
+
+        private:
+            void appendRow(const INotebookConfigMgr::NodeInfo &p_info,
+                           const QString &p_path,
+                           int p_parent,
+                           quint8 p_flags);
+
+            QSharedPointer<INotebookConfigMgr> m_configMgr;
+
+            QString m_rootFolderPath;
+
+            QString m_recycleBinPath;
+
+            // Folders of recycle bin already loaded, which are the only ones covered.
+            QSet<QString> m_loadedRecycleBinFolders;
+
+            // Path to modified time and size of files in previous table.
+            QHash<QString, QPair<qint64, qint64>> m_oldSizes;
+
+            QVector<QVector<TagId>> m_rowTags;
+        };
+
+        void ensureBuilt();
+
+        void handleWorkerFinished();
+
+        // Update rows of @p_node and its children. Invalidate the table if that could not be done.
+        void updateRows(const Node *p_node);
+
+        // Return false if @p_node has tags unknown to the table.
+        bool updateRow(int p_row, const Node *p_node);
+
+        // Tag mask of @p_tags in words. Return false if any tag is unknown to the table.
+        bool tagMask(const QStringList &p_tags, QVector<quint64> &p_mask) const;
+
+        Notebook *m_notebook = nullptr;
+
+        bool m_valid = false;
+
+        QSharedPointer<Worker> m_worker;
+
+        // Bumped for each worker started.
+        quint64 m_workerGeneration = 0;
+
+        // Table is invalidated while the worker is running, so its result is out of date.
+        bool m_workerOutdated = false;
+
+        // Columns.
+        QVector<ID> m_ids;
+
+        QVector<int> m_parents;
+
+        QVector<QString> m_names;
+
+        QVector<qint64> m_createdTimes;
+
+        QVector<qint64> m_modifiedTimes;
+
+        QVector<qint64> m_sizes;
+
+        QVector<quint8> m_flags;
+
+        // Row i occupies [i * m_tagWordCount, (i + 1) * m_tagWordCount).
+        QVector<quint64> m_tagBits;
+
+        int m_tagWordCount = 0;
+
+        // Tag to its bit in m_tagBits.
+        QHash<TagId, int> m_tagBitIndex;
+
+        // Path of container within notebook to its rows in the table.
+        QHash<QString, ContainerRows> m_containerRows;
+    };
+} // ns vnotex
+
+#endif // NODEMETADATATABLE_H
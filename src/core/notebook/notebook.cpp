@@ -1,13 +1,18 @@
 #include "notebook.h"
 
 #include <QFileInfo>
+#include <QThread>
 
 #include <versioncontroller/iversioncontroller.h>
 #include <notebookbackend/inotebookbackend.h>
+#include <notebookbackend/asyncnotebookbackend.h>
 #include <notebookconfigmgr/inotebookconfigmgr.h>
 #include <utils/pathutils.h>
 #include <utils/fileutils.h>
 #include "exception.h"
+#include "mediastore.h"
+#include "mediagarbagecollector.h"
+#include "nodemetadatatable.h"
 
 using namespace vnotex;
 
@@ -44,6 +49,7 @@ Notebook::Notebook(const NotebookParameters &p_paras,
         m_attachmentFolder = c_defaultAttachmentFolder;
     }
     m_configMgr->setNotebook(this);
+    m_versionController->setNotebook(this);
 }
 
 Notebook::~Notebook()
@@ -280,6 +286,8 @@ QSharedPointer<Node> Notebook::getOrCreateRecycleBinDateNode()
     auto dateNodeName = QDate::currentDate().toString(QStringLiteral("yyyyMMdd"));
 
     auto recycleBinNode = getRecycleBinNode();
+    // Only the config of recycle bin itself is read. Date folders are loaded on demand.
+    recycleBinNode->load();
     auto dateNode = recycleBinNode->findChild(dateNodeName,
                                               FileUtils::isPlatformNameCaseSensitive());
     if (!dateNode) {
@@ -290,6 +298,116 @@ QSharedPointer<Node> Notebook::getOrCreateRecycleBinDateNode()
     return dateNode;
 }
 
+void Notebook::purgeRecycleBin(int p_retentionDays, qint64 p_maxSize)
+{
+    auto recycleBinNode = getRecycleBinNode();
+    if (!recycleBinNode || (p_retentionDays <= 0 && p_maxSize <= 0)) {
+        emit recycleBinPurged(0);
+        return;
+    }
+
+    recycleBinNode->load();
+
+    // Date folders are handled as a whole without reading their configs.
+    const auto today = QDate::currentDate();
+    QVector<QSharedPointer<Node>> dateNodes;
+    QVector<QDate> dates;
+    QStringList paths;
+    for (const auto &child : recycleBinNode->getChildrenRef()) {
+        const auto date = QDate::fromString(child->getName(), QStringLiteral("yyyyMMdd"));
+        if (!child->isContainer() || !date.isValid()) {
+            continue;
+        }
+
+        // Name after date so it is sorted by date already.
+        int idx = 0;
+        while (idx < dates.size() && dates[idx] < date) {
+            ++idx;
+        }
+        dateNodes.insert(idx, child);
+        dates.insert(idx, date);
+        paths.insert(idx, child->fetchAbsolutePath());
+    }
+
+    QVector<QSharedPointer<Node>> purgedNodes;
+    QVector<int> keptIndexes;
+    for (int i = 0; i < dateNodes.size(); ++i) {
+        if (p_retentionDays > 0 && dates[i].daysTo(today) > p_retentionDays) {
+            purgedNodes << dateNodes[i];
+        } else {
+            keptIndexes << i;
+        }
+    }
+
+    if (p_maxSize <= 0 || keptIndexes.isEmpty()) {
+        removeRecycleBinDateNodes(purgedNodes);
+        return;
+    }
+
+    // Sizing may take long.
+    auto sizes = QSharedPointer<QVector<qint64>>::create(paths.size(), 0);
+    auto th = QThread::create([paths, keptIndexes, sizes]() {
+        for (int idx : keptIndexes) {
+            (*sizes)[idx] = FileUtils::dirSize(paths[idx]);
+        }
+    });
+    connect(th, &QThread::finished,
+            this, [this, th, today, dateNodes, dates, keptIndexes, sizes, purgedNodes, p_maxSize]() mutable {
+                th->deleteLater();
+
+                qint64 totalSize = 0;
+                for (int idx : keptIndexes) {
+                    totalSize += (*sizes)[idx];
+                }
+
+                // Oldest first.
+                for (int idx : keptIndexes) {
+                    if (totalSize <= p_maxSize || dates[idx] >= today) {
+                        break;
+                    }
+
+                    purgedNodes << dateNodes[idx];
+                    totalSize -= (*sizes)[idx];
+                }
+
+                removeRecycleBinDateNodes(purgedNodes);
+            });
+    th->start();
+}
+
+void Notebook::removeRecycleBinDateNodes(const QVector<QSharedPointer<Node>> &p_nodes)
+{
+    if (p_nodes.isEmpty()) {
+        emit recycleBinPurged(0);
+        return;
+    }
+
+    auto recycleBinNode = getRecycleBinNode();
+    QVector<AsyncNotebookBackend::Operation> ops;
+    {
+        BulkUpdateScope bulkUpdate(this);
+        for (const auto &node : p_nodes) {
+            if (node->getParent() != recycleBinNode.data()) {
+                // Removed meanwhile.
+                continue;
+            }
+
+            ops << AsyncNotebookBackend::Operation::removeDir(node->fetchAbsolutePath());
+            removeNode(node, false, true);
+        }
+    }
+
+    emit nodeUpdated(recycleBinNode.data());
+
+    const int cnt = ops.size();
+    getAsyncBackend()->submit(ops, [this, cnt](const QString &p_errMsg) {
+        if (!p_errMsg.isEmpty()) {
+            qWarning() << "failed to purge recycle bin" << p_errMsg;
+        }
+        emit recycleBinPurged(cnt);
+    });
+}
+
 void Notebook::emptyNode(const Node *p_node, bool p_force)
 {
     // Copy the children.
@@ -299,30 +417,79 @@ void Notebook::emptyNode(const Node *p_node, bool p_force)
     }
 }
 
-void Notebook::moveFileToRecycleBin(const QString &p_filePath)
+ID Notebook::moveFileToRecycleBin(const QString &p_filePath,
+                                  const std::function<void(const QString &)> &p_callback)
+{
+    // Names are picked on the worker and moves are serialized, so moves of
+    // same-named files will not collide.
+    auto node = getOrCreateRecycleBinDateNode();
+    QVector<AsyncNotebookBackend::Operation> ops;
+    ops << AsyncNotebookBackend::Operation::moveFileInto(p_filePath, node->fetchPath());
+    return getAsyncBackend()->submit(ops, [this, node, p_filePath, p_callback](const QString &p_errMsg) {
+        if (!p_errMsg.isEmpty()) {
+            qWarning() << "failed to move file to recycle bin" << p_filePath << p_errMsg;
+            emit moveToRecycleBinFailed(p_filePath, p_errMsg);
+        }
+        emit nodeUpdated(node.data());
+        if (p_callback) {
+            p_callback(p_errMsg);
+        }
+    }, true);
+}
+
+ID Notebook::moveDirToRecycleBin(const QString &p_dirPath,
+                                 const std::function<void(const QString &)> &p_callback)
 {
+    // A rename mostly, but a copy if the recycle bin is on another device.
     auto node = getOrCreateRecycleBinDateNode();
-    auto destFilePath = PathUtils::concatenateFilePath(node->fetchPath(),
-                                                       PathUtils::fileName(p_filePath));
-    destFilePath = getBackend()->renameIfExistsCaseInsensitive(destFilePath);
-    m_backend->copyFile(p_filePath, destFilePath);
+    QVector<AsyncNotebookBackend::Operation> ops;
+    ops << AsyncNotebookBackend::Operation::moveDirInto(p_dirPath, node->fetchPath());
+    return getAsyncBackend()->submit(ops, [this, node, p_dirPath, p_callback](const QString &p_errMsg) {
+        if (!p_errMsg.isEmpty()) {
+            qWarning() << "failed to move folder to recycle bin" << p_dirPath << p_errMsg;
+            emit moveToRecycleBinFailed(p_dirPath, p_errMsg);
+        }
+        emit nodeUpdated(node.data());
+        if (p_callback) {
+            p_callback(p_errMsg);
+        }
+    }, true);
+}
 
-    getBackend()->removeFile(p_filePath);
+AsyncNotebookBackend *Notebook::getAsyncBackend()
+{
+    if (!m_asyncBackend) {
+        m_asyncBackend = new AsyncNotebookBackend(m_backend, this);
+    }
 
-    emit nodeUpdated(node.data());
+    return m_asyncBackend;
 }
 
-void Notebook::moveDirToRecycleBin(const QString &p_dirPath)
+MediaStore *Notebook::getMediaStore()
 {
-    auto node = getOrCreateRecycleBinDateNode();
-    auto destDirPath = PathUtils::concatenateFilePath(node->fetchPath(),
-                                                      PathUtils::fileName(p_dirPath));
-    destDirPath = getBackend()->renameIfExistsCaseInsensitive(destDirPath);
-    m_backend->copyDir(p_dirPath, destDirPath);
+    if (!m_mediaStore) {
+        m_mediaStore.reset(new MediaStore(this));
+    }
+
+    return m_mediaStore.data();
+}
+
+MediaGarbageCollector *Notebook::getMediaGarbageCollector()
+{
+    if (!m_mediaGarbageCollector) {
+        m_mediaGarbageCollector = new MediaGarbageCollector(this, this);
+    }
+
+    return m_mediaGarbageCollector;
+}
 
-    getBackend()->removeDir(p_dirPath);
+NodeMetadataTable *Notebook::getNodeMetadataTable()
+{
+    if (!m_nodeMetadataTable) {
+        m_nodeMetadataTable = new NodeMetadataTable(this, this);
+    }
 
-    emit nodeUpdated(node.data());
+    return m_nodeMetadataTable;
 }
 
 QSharedPointer<Node> Notebook::addAsNode(Node *p_parent,
@@ -354,4 +521,40 @@ void Notebook::reloadNodes()
 {
     m_root.clear();
     getRootNode();
+
+    if (m_nodeMetadataTable) {
+        m_nodeMetadataTable->invalidate();
+    }
+
+    emit nodeLoaded(m_root.data());
+}
+
+bool Notebook::refreshNode(Node *p_node)
+{
+    Q_ASSERT(p_node && p_node->getNotebook() == this);
+    bool changed = false;
+    try {
+        changed = m_configMgr->refreshNode(p_node);
+    } catch (Exception &p_e) {
+        qWarning() << "failed to refresh node" << p_node->fetchPath() << p_e.what();
+        return false;
+    }
+
+    emit nodeRefreshed(p_node);
+    return changed;
+}
+
+void Notebook::beginBulkUpdate()
+{
+    m_configMgr->beginBulkUpdate();
+}
+
+void Notebook::endBulkUpdate()
+{
+    m_configMgr->endBulkUpdate();
+}
+
+NodeMemoryStats Notebook::collectNodeMemoryStats() const
+{
+    return Node::collectMemoryStats(m_root.data());
 }
@@ -1,6 +1,8 @@
 #ifndef NOTEBOOK_H
 #define NOTEBOOK_H
 
+#include <functional>
+
 #include <QObject>
 #include <QIcon>
 #include <QSharedPointer>
@@ -12,6 +14,10 @@
 namespace vnotex
 {
     class INotebookBackend;
+    class AsyncNotebookBackend;
+    class MediaStore;
+    class MediaGarbageCollector;
+    class NodeMetadataTable;
     class IVersionController;
     class INotebookConfigMgr;
     struct NodeParameters;
@@ -57,6 +63,18 @@ namespace vnotex
 
         const QSharedPointer<INotebookBackend> &getBackend() const;
 
+        // Backend running I/O on a thread pool. Created on demand.
+        AsyncNotebookBackend *getAsyncBackend();
+
+        // Content-addressed store of media files. Created on demand.
+        MediaStore *getMediaStore();
+
+        // Collector of unreferenced images and attachments. Created on demand.
+        MediaGarbageCollector *getMediaGarbageCollector();
+
+        // Metadata of all nodes for queries across the notebook. Created on demand.
+        NodeMetadataTable *getNodeMetadataTable();
+
         const QSharedPointer<IVersionController> &getVersionController() const;
 
         const QSharedPointer<INotebookConfigMgr> &getConfigMgr() const;
@@ -106,11 +124,21 @@ namespace vnotex
 
         void moveNodeToRecycleBin(Node *p_node);
 
-        // Move @p_filePath to the recycle bin, without adding it as a child node.
-        void moveFileToRecycleBin(const QString &p_filePath);
+        // Move @p_filePath to the recycle bin in background, without adding it as a child node.
+        // @p_callback: called with the error message, empty on success, once done.
+        // Return the request ID of the async backend, which could be waited on.
+        ID moveFileToRecycleBin(const QString &p_filePath,
+                                const std::function<void(const QString &)> &p_callback = nullptr);
+
+        // Move @p_dirPath to the recycle bin in background, without adding it as a child node.
+        ID moveDirToRecycleBin(const QString &p_dirPath,
+                               const std::function<void(const QString &)> &p_callback = nullptr);
 
-        // Move @p_dirPath to the recycle bin, without adding it as a child node.
-        void moveDirToRecycleBin(const QString &p_dirPath);
+        // Purge date folders of recycle bin in background.
+        // @p_retentionDays: purge folders older than it. 0 to disable.
+        // @p_maxSize: purge oldest folders until the recycle bin fits in it, in bytes. 0 to disable.
+        // Folder of today is kept. recycleBinPurged() will be emitted when done.
+        void purgeRecycleBin(int p_retentionDays, qint64 p_maxSize);
 
         // Remove all files of this notebook from disk.
         virtual void remove() = 0;
@@ -130,6 +158,37 @@ namespace vnotex
 
         void reloadNodes();
 
+        // Apply changes made outside to loaded container @p_node and its direct children.
+        // Return true if the tree changed.
+        bool refreshNode(Node *p_node);
+
+        // Defer config writes of nodes until the outermost endBulkUpdate().
+        // Prefer BulkUpdateScope.
+        void beginBulkUpdate();
+        void endBulkUpdate();
+
+        // Memory usage of currently loaded nodes. Walk all loaded nodes for diagnostics.
+        NodeMemoryStats collectNodeMemoryStats() const;
+
+        // Guard to begin and end bulk update of a notebook.
+        class BulkUpdateScope
+        {
+        public:
+            explicit BulkUpdateScope(Notebook *p_notebook)
+                : m_notebook(p_notebook)
+            {
+                m_notebook->beginBulkUpdate();
+            }
+
+            ~BulkUpdateScope()
+            {
+                m_notebook->endBulkUpdate();
+            }
+
+        private:
+            Notebook *m_notebook = nullptr;
+        };
+
         static const QString c_defaultAttachmentFolder;
 
         static const QString c_defaultImageFolder;
@@ -139,9 +198,22 @@ namespace vnotex
 
         void nodeUpdated(const Node *p_node);
 
+        // Children of @p_node are loaded from config.
+        void nodeLoaded(Node *p_node);
+
+        // Children of @p_node are refreshed due to changes from outside.
+        void nodeRefreshed(Node *p_node);
+
+        void recycleBinPurged(int p_purgedCount);
+
+        // Moving @p_path to the recycle bin in background failed.
+        void moveToRecycleBinFailed(const QString &p_path, const QString &p_errMsg);
+
     private:
         QSharedPointer<Node> getOrCreateRecycleBinDateNode();
 
+        void removeRecycleBinDateNodes(const QVector<QSharedPointer<Node>> &p_nodes);
+
         // ID of this notebook.
         // Will be assigned uniquely once loaded.
         ID m_id;
@@ -171,6 +243,14 @@ namespace vnotex
         // Backend for file access and synchronization.
         QSharedPointer<INotebookBackend> m_backend;
 
+        AsyncNotebookBackend *m_asyncBackend = nullptr;
+
+        QSharedPointer<MediaStore> m_mediaStore;
+
+        MediaGarbageCollector *m_mediaGarbageCollector = nullptr;
+
+        NodeMetadataTable *m_nodeMetadataTable = nullptr;
+
         // Version controller.
         QSharedPointer<IVersionController> m_versionController;
 
@@ -6,7 +6,12 @@ SOURCES += \
     $$PWD/bundlenotebook.cpp \
     $$PWD/node.cpp \
     $$PWD/vxnode.cpp \
-    $$PWD/vxnodefile.cpp
+    $$PWD/vxnodefile.cpp \
+    $$PWD/tagpool.cpp \
+    $$PWD/notebookwatcher.cpp \
+    $$PWD/mediastore.cpp \
+    $$PWD/mediagarbagecollector.cpp \
+    $$PWD/nodemetadatatable.cpp
 
 HEADERS += \
     $$PWD/externalnode.h \
@@ -17,4 +22,9 @@ HEADERS += \
     $$PWD/bundlenotebook.h \
     $$PWD/node.h \
     $$PWD/vxnode.h \
-    $$PWD/vxnodefile.h
+    $$PWD/vxnodefile.h \
+    $$PWD/tagpool.h \
+    $$PWD/notebookwatcher.h \
+    $$PWD/mediastore.h \
+    $$PWD/mediagarbagecollector.h \
+    $$PWD/nodemetadatatable.h
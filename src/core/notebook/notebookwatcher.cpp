@@ -0,0 +1,182 @@
+#include "notebookwatcher.h"
+
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QDebug>
+
+#include "notebook.h"
+#include "node.h"
+#include <notebookconfigmgr/inotebookconfigmgr.h>
+
+using namespace vnotex;
+
+const int NotebookWatcher::c_debounceInterval = 500;
+
+const int NotebookWatcher::c_maxDelay = 5000;
+
+const int NotebookWatcher::c_selfWriteInterval = 1000;
+
+NotebookWatcher::NotebookWatcher(QObject *p_parent)
+    : QObject(p_parent)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &NotebookWatcher::handleDirectoryChanged);
+
+    m_debounceTimer = new QTimer(this);
+    m_debounceTimer->setSingleShot(true);
+    m_debounceTimer->setInterval(c_debounceInterval);
+    connect(m_debounceTimer, &QTimer::timeout,
+            this, &NotebookWatcher::applyPendingChanges);
+
+    m_clock.start();
+}
+
+NotebookWatcher::~NotebookWatcher()
+{
+}
+
+void NotebookWatcher::setNotebook(const QSharedPointer<Notebook> &p_notebook)
+{
+    if (m_notebook == p_notebook) {
+        return;
+    }
+
+    if (m_notebook) {
+        disconnect(m_notebook.data(), nullptr, this, nullptr);
+        disconnect(m_notebook->getConfigMgr().data(), nullptr, this, nullptr);
+    }
+
+    unwatchAll();
+
+    m_notebook = p_notebook;
+    if (!m_notebook) {
+        return;
+    }
+
+    connect(m_notebook.data(), &Notebook::nodeLoaded,
+            this, [this](Node *p_node) {
+                watchNode(p_node);
+            });
+    connect(m_notebook->getConfigMgr().data(), &INotebookConfigMgr::nodeConfigWritten,
+            this, &NotebookWatcher::handleNodeConfigWritten);
+
+    watchNode(m_notebook->getRootNode().data());
+}
+
+void NotebookWatcher::watchNode(Node *p_node)
+{
+    if (!p_node->isContainer() || !p_node->isLoaded() || !p_node->exists()) {
+        return;
+    }
+
+    const auto path = p_node->fetchAbsolutePath();
+    auto it = m_watchedNodes.find(path);
+    if (it == m_watchedNodes.end()) {
+        if (m_watcher->addPath(path)) {
+            m_watchedNodes.insert(path, p_node->sharedFromThis());
+        } else {
+            qWarning() << "failed to watch folder" << path;
+        }
+    } else if (it.value().data() != p_node) {
+        // Nodes have been reloaded.
+        it.value() = p_node->sharedFromThis();
+    }
+
+    for (const auto &child : p_node->getChildrenRef()) {
+        watchNode(child.data());
+    }
+}
+
+void NotebookWatcher::unwatchAll()
+{
+    m_debounceTimer->stop();
+    m_pendingPaths.clear();
+    m_selfWrittenPaths.clear();
+
+    const auto dirs = m_watcher->directories();
+    if (!dirs.isEmpty()) {
+        m_watcher->removePaths(dirs);
+    }
+    m_watchedNodes.clear();
+}
+
+void NotebookWatcher::handleNodeConfigWritten(const Node *p_node)
+{
+    const auto path = p_node->fetchAbsolutePath();
+    if (m_watchedNodes.contains(path)) {
+        m_selfWrittenPaths.insert(path, m_clock.elapsed());
+    }
+}
+
+void NotebookWatcher::handleDirectoryChanged(const QString &p_path)
+{
+    auto it = m_selfWrittenPaths.find(p_path);
+    if (it != m_selfWrittenPaths.end()) {
+        if (m_clock.elapsed() - it.value() <= c_selfWriteInterval) {
+            // Caused by VNote itself.
+            return;
+        }
+        m_selfWrittenPaths.erase(it);
+    }
+
+    if (m_pendingPaths.isEmpty()) {
+        m_pendingTimer.start();
+    }
+    m_pendingPaths.insert(p_path);
+
+    if (m_pendingTimer.elapsed() >= c_maxDelay) {
+        applyPendingChanges();
+    } else {
+        m_debounceTimer->start();
+    }
+}
+
+void NotebookWatcher::applyPendingChanges()
+{
+    m_debounceTimer->stop();
+
+    const auto paths = m_pendingPaths;
+    m_pendingPaths.clear();
+    if (!m_notebook || paths.isEmpty()) {
+        return;
+    }
+
+    QVector<QSharedPointer<Node>> changedNodes;
+    for (const auto &path : paths) {
+        auto node = m_watchedNodes.value(path).toStrongRef();
+        bool stale = !node
+                     || (!node->isRoot() && !node->getParent())
+                     || node->fetchAbsolutePath() != path;
+        if (stale) {
+            // Node is removed or renamed.
+            m_watchedNodes.remove(path);
+            m_watcher->removePath(path);
+            if (node && node->getParent()) {
+                watchNode(node.data());
+            }
+            continue;
+        }
+
+        changedNodes.push_back(node);
+    }
+
+    // Refresh parents first since they may drop some of the children.
+    std::sort(changedNodes.begin(), changedNodes.end(),
+              [](const QSharedPointer<Node> &p_a, const QSharedPointer<Node> &p_b) {
+                  return p_a->fetchPath().size() < p_b->fetchPath().size();
+              });
+
+    for (const auto &node : changedNodes) {
+        if (!node->isRoot() && !node->getParent()) {
+            continue;
+        }
+
+        if (m_notebook->refreshNode(node.data())) {
+            qDebug() << "node refreshed due to external changes" << node->fetchPath();
+        }
+
+        // Watch newly-added and loaded folders.
+        watchNode(node.data());
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef NOTEBOOKWATCHER_H
+#define NOTEBOOKWATCHER_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+
+class QFileSystemWatcher;
+class QTimer;
+
+namespace vnotex
+{
+    class Notebook;
+    class Node;
+
+    // Watch folders of loaded container nodes of a notebook and refresh the affected nodes
+    // when they are changed outside.
+    // Bursts of events (such as git checkout) are debounced and only the changed folders are refreshed.
+    // Events caused by VNote's own config writes are ignored.
+    class NotebookWatcher : public QObject
+    {
+        Q_OBJECT
+    public:
+        explicit NotebookWatcher(QObject *p_parent = nullptr);
+
+        ~NotebookWatcher();
+
+        void setNotebook(const QSharedPointer<Notebook> &p_notebook);
+
+    private slots:
+        void handleDirectoryChanged(const QString &p_path);
+
+        void applyPendingChanges();
+
+        void handleNodeConfigWritten(const Node *p_node);
+
+    private:
+        // Watch @p_node and its loaded descendant containers.
+        void watchNode(Node *p_node);
+
+        void unwatchAll();
+
+        // Debounce interval in ms.
+        static const int c_debounceInterval;
+
+        // Flush anyway if events keep coming for this long in ms.
+        static const int c_maxDelay;
+
+        // Events of a folder within this interval in ms after VNote writes its config are ignored.
+        static const int c_selfWriteInterval;
+
+        QFileSystemWatcher *m_watcher = nullptr;
+
+        QTimer *m_debounceTimer = nullptr;
+
+        QElapsedTimer m_pendingTimer;
+
+        // Used to time config writes of VNote.
+        QElapsedTimer m_clock;
+
+        QSharedPointer<Notebook> m_notebook;
+
+        // Absolute folder path -> node.
+        QHash<QString, QWeakPointer<Node>> m_watchedNodes;
+
+        QSet<QString> m_pendingPaths;
+
+        // Absolute folder path -> time of the last config write of VNote from m_clock.
+        QHash<QString, qint64> m_selfWrittenPaths;
+    };
+} // ns vnotex
+
+#endif // NOTEBOOKWATCHER_H
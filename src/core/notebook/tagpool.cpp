@@ -0,0 +1,78 @@
+#include "tagpool.h"
+
+#include <QMutexLocker>
+
+using namespace vnotex;
+
+QMutex TagPool::s_mutex;
+
+QHash<QString, TagId> TagPool::s_ids;
+
+QVector<QString> TagPool::s_names;
+
+TagId TagPool::intern(const QString &p_tag)
+{
+    QMutexLocker locker(&s_mutex);
+    auto it = s_ids.constFind(p_tag);
+    if (it != s_ids.constEnd()) {
+        return it.value();
+    }
+
+    TagId id = static_cast<TagId>(s_names.size());
+    s_names.push_back(p_tag);
+    s_ids.insert(p_tag, id);
+    return id;
+}
+
+QVector<TagId> TagPool::intern(const QStringList &p_tags)
+{
+    QVector<TagId> ids;
+    if (p_tags.isEmpty()) {
+        return ids;
+    }
+
+    ids.reserve(p_tags.size());
+    for (const auto &tag : p_tags) {
+        ids.push_back(intern(tag));
+    }
+    return ids;
+}
+
+QString TagPool::name(TagId p_id)
+{
+    QMutexLocker locker(&s_mutex);
+    Q_ASSERT(static_cast<int>(p_id) < s_names.size());
+    return s_names[static_cast<int>(p_id)];
+}
+
+QStringList TagPool::names(const QVector<TagId> &p_ids)
+{
+    QStringList tags;
+    if (p_ids.isEmpty()) {
+        return tags;
+    }
+
+    QMutexLocker locker(&s_mutex);
+    tags.reserve(p_ids.size());
+    for (auto id : p_ids) {
+        tags << s_names[static_cast<int>(id)];
+    }
+    return tags;
+}
+
+int TagPool::size()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_names.size();
+}
+
+qint64 TagPool::bytes()
+{
+    QMutexLocker locker(&s_mutex);
+    qint64 total = s_names.capacity() * sizeof(QString)
+                   + s_ids.capacity() * (sizeof(QString) + sizeof(TagId) + sizeof(void *));
+    for (const auto &name : s_names) {
+        total += name.capacity() * sizeof(QChar);
+    }
+    return total;
+}
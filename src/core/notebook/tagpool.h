@@ -0,0 +1,44 @@
+#ifndef TAGPOOL_H
+#define TAGPOOL_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+
+namespace vnotex
+{
+    typedef quint32 TagId;
+
+    // Process-wide pool to intern tag names.
+    // Nodes keep only the IDs so that the same tag shared by many nodes is stored once.
+    class TagPool
+    {
+    public:
+        TagPool() = delete;
+
+        static TagId intern(const QString &p_tag);
+
+        static QVector<TagId> intern(const QStringList &p_tags);
+
+        static QString name(TagId p_id);
+
+        static QStringList names(const QVector<TagId> &p_ids);
+
+        // Number of distinct tags interned.
+        static int size();
+
+        // Approximate bytes used by the pool.
+        static qint64 bytes();
+
+    private:
+        static QMutex s_mutex;
+
+        static QHash<QString, TagId> s_ids;
+
+        static QVector<QString> s_names;
+    };
+} // ns vnotex
+
+#endif // TAGPOOL_H
@@ -4,6 +4,7 @@
 
 #include <utils/pathutils.h>
 #include <notebookbackend/inotebookbackend.h>
+#include <notebookbackend/asyncnotebookbackend.h>
 #include <notebookconfigmgr/inotebookconfigmgr.h>
 #include "notebook.h"
 #include "vxnodefile.h"
@@ -40,7 +41,7 @@ VXNode::VXNode(const QString &p_name,
 {
 }
 
-QString VXNode::fetchAbsolutePath() const
+QString VXNode::computeAbsolutePath() const
 {
     return PathUtils::concatenateFilePath(m_notebook->getRootFolderAbsolutePath(),
                                           fetchPath());
@@ -106,12 +107,19 @@ void VXNode::removeAttachment(const QStringList &p_paths)
 {
     auto attaFolderPath = fetchAttachmentFolderPath();
     // Just move it to recycle bin but not added as a child node of recycle bin.
+    ID lastId = AsyncNotebookBackend::InvalidRequestId;
     for (const auto &pa : p_paths) {
         Q_ASSERT(PathUtils::pathContains(attaFolderPath, pa));
         if (QFileInfo(pa).isDir()) {
-            m_notebook->moveDirToRecycleBin(pa);
+            lastId = m_notebook->moveDirToRecycleBin(pa);
         } else {
-            m_notebook->moveFileToRecycleBin(pa);
+            lastId = m_notebook->moveFileToRecycleBin(pa);
         }
     }
+
+    // Callers list the attachment folder right after. Moves are serial and
+    // mostly renames, so waiting for the last one is cheap.
+    if (lastId != AsyncNotebookBackend::InvalidRequestId) {
+        m_notebook->getAsyncBackend()->wait(lastId);
+    }
 }
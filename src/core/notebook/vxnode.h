@@ -24,8 +24,6 @@ namespace vnotex
                Notebook *p_notebook,
                Node *p_parent);
 
-        QString fetchAbsolutePath() const Q_DECL_OVERRIDE;
-
         QSharedPointer<File> getContentFile() Q_DECL_OVERRIDE;
 
         QStringList addAttachment(const QString &p_destFolderPath, const QStringList &p_files) Q_DECL_OVERRIDE;
@@ -38,7 +36,8 @@ namespace vnotex
 
         void removeAttachment(const QStringList &p_paths) Q_DECL_OVERRIDE;
 
-    private:
+    protected:
+        QString computeAbsolutePath() const Q_DECL_OVERRIDE;
     };
 }
 
@@ -1,13 +1,18 @@
 #include "vxnodefile.h"
 
 #include <QImage>
+#include <QBuffer>
+#include <QFileInfo>
 
 #include <notebookbackend/inotebookbackend.h>
 #include <notebookconfigmgr/inotebookconfigmgr.h>
 #include <notebookconfigmgr/vxnotebookconfigmgr.h>
 #include <utils/pathutils.h>
+#include <core/configmgr.h>
+#include <core/coreconfig.h>
 #include "vxnode.h"
 #include "notebook.h"
+#include "mediastore.h"
 
 using namespace vnotex;
 
@@ -27,6 +32,11 @@ void VXNodeFile::write(const QString &p_content)
 {
     m_node->getBackend()->writeFile(m_node->fetchPath(), p_content);
 
+    contentWritten();
+}
+
+void VXNodeFile::contentWritten()
+{
     m_node->setModifiedTimeUtc();
     m_node->save();
 }
@@ -67,8 +77,17 @@ QString VXNodeFile::fetchImageFolderPath()
     return configMgr->fetchNodeImageFolderPath(m_node.data());
 }
 
+static bool isMediaStoreEnabled()
+{
+    return ConfigMgr::getInst().getCoreConfig().isContentAddressedMediaEnabled();
+}
+
 QString VXNodeFile::insertImage(const QString &p_srcImagePath, const QString &p_imageFileName)
 {
+    if (isMediaStoreEnabled()) {
+        return m_node->getNotebook()->getMediaStore()->addFile(p_srcImagePath);
+    }
+
     auto backend = m_node->getBackend();
     const auto imageFolderPath = fetchImageFolderPath();
     auto destFilePath = backend->renameIfExistsCaseInsensitive(PathUtils::concatenateFilePath(imageFolderPath, p_imageFileName));
@@ -78,6 +97,19 @@ QString VXNodeFile::insertImage(const QString &p_srcImagePath, const QString &p_
 
 QString VXNodeFile::insertImage(const QImage &p_image, const QString &p_imageFileName)
 {
+    if (isMediaStoreEnabled()) {
+        // Encode once and hash the encoded data.
+        auto suffix = QFileInfo(p_imageFileName).suffix();
+        if (suffix.isEmpty()) {
+            suffix = QStringLiteral("png");
+        }
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        p_image.save(&buffer, suffix.toLatin1().constData());
+        return m_node->getNotebook()->getMediaStore()->addData(data, suffix);
+    }
+
     auto backend = m_node->getBackend();
     const auto imageFolderPath = fetchImageFolderPath();
     auto destFilePath = backend->renameIfExistsCaseInsensitive(PathUtils::concatenateFilePath(imageFolderPath, p_imageFileName));
@@ -88,6 +120,13 @@ QString VXNodeFile::insertImage(const QImage &p_image, const QString &p_imageFil
 
 void VXNodeFile::removeImage(const QString &p_imagePath)
 {
+    auto store = m_node->getNotebook()->getMediaStore();
+    if (store->contains(p_imagePath)) {
+        // Shared by other notes probably.
+        store->release(p_imagePath);
+        return;
+    }
+
     // Just move it to recycle bin but not added as a child node of recycle bin.
     m_node->getNotebook()->moveFileToRecycleBin(p_imagePath);
 }
@@ -19,6 +19,8 @@ namespace vnotex
 
         void write(const QString &p_content) Q_DECL_OVERRIDE;
 
+        void contentWritten() Q_DECL_OVERRIDE;
+
         QString getName() const Q_DECL_OVERRIDE;
 
         QString getFilePath() const Q_DECL_OVERRIDE;
@@ -0,0 +1,433 @@
+#include "asyncnotebookbackend.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QDebug>
+
+#include "inotebookbackend.h"
+#include <utils/pathutils.h>
+#include "exception.h"
+
+using namespace vnotex;
+
+class AsyncNotebookBackend::Worker : public QRunnable
+{
+public:
+    Worker(AsyncNotebookBackend *p_owner,
+           ID p_id,
+           const QSharedPointer<INotebookBackend> &p_backend,
+           const QVector<Operation> &p_ops)
+        : m_owner(p_owner),
+          m_id(p_id),
+          m_backend(p_backend),
+          m_ops(p_ops)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        for (const auto &op : m_ops) {
+            m_total += estimateBytes(op);
+        }
+
+        QString errMsg;
+        try {
+            if (m_readCallback) {
+                m_readData = m_backend->readFile(m_readPath);
+                m_done = m_total = m_readData.size();
+                m_owner->reportProgress(m_id, m_done, m_total);
+            } else {
+                for (const auto &op : m_ops) {
+                    execute(op);
+                }
+            }
+        } catch (Exception &p_e) {
+            errMsg = p_e.what();
+        }
+
+        if (!errMsg.isEmpty()) {
+            qWarning() << "async backend request failed" << m_id << errMsg;
+        }
+
+        const bool succeeded = errMsg.isEmpty();
+        std::function<void()> notifier;
+        if (m_readCallback) {
+            auto cb = m_readCallback;
+            auto data = m_readData;
+            notifier = [cb, data, errMsg]() {
+                cb(data, errMsg);
+            };
+        } else if (m_callback) {
+            auto cb = m_callback;
+            notifier = [cb, errMsg]() {
+                cb(errMsg);
+            };
+        }
+
+        m_owner->finishRequest(m_id, notifier, succeeded);
+    }
+
+    ID getId() const
+    {
+        return m_id;
+    }
+
+    Callback m_callback;
+
+    ReadCallback m_readCallback;
+
+    // Path to read when @m_readCallback is set.
+    QString m_readPath;
+
+private:
+    qint64 estimateBytes(const Operation &p_op) const
+    {
+        switch (p_op.m_type) {
+        case Operation::Type::WriteFile:
+            return p_op.m_data.size();
+
+        case Operation::Type::CopyFile:
+        case Operation::Type::MoveFileInto:
+            return QFileInfo(fullPath(p_op.m_path)).size();
+
+        default:
+            // Directories are counted once scanned.
+            return 0;
+        }
+    }
+
+    QString fullPath(const QString &p_path) const
+    {
+        if (QFileInfo(p_path).isRelative()) {
+            return m_backend->getFullPath(p_path);
+        }
+        return p_path;
+    }
+
+    void execute(const Operation &p_op)
+    {
+        switch (p_op.m_type) {
+        case Operation::Type::MakePath:
+            m_backend->makePath(p_op.m_path);
+            break;
+
+        case Operation::Type::WriteFile:
+            m_backend->writeFile(p_op.m_path, p_op.m_data);
+            advance(p_op.m_data.size());
+            break;
+
+        case Operation::Type::CopyFile:
+            m_backend->copyFile(p_op.m_path, p_op.m_destPath);
+            advance(QFileInfo(fullPath(p_op.m_path)).size());
+            break;
+
+        case Operation::Type::CopyDir:
+            copyDir(p_op.m_path, p_op.m_destPath);
+            break;
+
+        case Operation::Type::RemoveFile:
+            m_backend->removeFile(p_op.m_path);
+            break;
+
+        case Operation::Type::RemoveDir:
+            m_backend->removeDir(p_op.m_path);
+            break;
+
+        case Operation::Type::MoveFileInto:
+        {
+            // A rename within the same device. Only falls back to copy across devices.
+            const auto bytes = QFileInfo(fullPath(p_op.m_path)).size();
+            m_backend->moveFile(p_op.m_path, uniquePathInto(p_op.m_path, p_op.m_destPath));
+            advance(bytes);
+            break;
+        }
+
+        case Operation::Type::MoveDirInto:
+            m_backend->moveDir(p_op.m_path, uniquePathInto(p_op.m_path, p_op.m_destPath));
+            break;
+        }
+    }
+
+    // Pick the name on the worker so that previous operations are taken into account.
+    QString uniquePathInto(const QString &p_path, const QString &p_destDirPath) const
+    {
+        return m_backend->renameIfExistsCaseInsensitive(
+            PathUtils::concatenateFilePath(p_destDirPath, PathUtils::fileName(p_path)));
+    }
+
+    // Copy file by file instead of INotebookBackend::copyDir() to report progress.
+    void copyDir(const QString &p_dirPath, const QString &p_destPath)
+    {
+        const auto srcDirPath = fullPath(p_dirPath);
+        if (!QFileInfo(srcDirPath).isDir()) {
+            Exception::throwOne(Exception::Type::FailToCopyDir,
+                                QString("source directory does not exist: %1").arg(srcDirPath));
+        }
+
+        // An empty target may be created beforehand to reserve the name.
+        const auto destDirPath = m_backend->getFullPath(p_destPath);
+        if (QFileInfo::exists(destDirPath) && !QDir(destDirPath).isEmpty()) {
+            Exception::throwOne(Exception::Type::FailToCopyDir,
+                                QString("target directory %1 already exists").arg(destDirPath));
+        }
+
+        QStringList dirs;
+        QVector<QPair<QString, qint64>> files;
+        QDirIterator it(srcDirPath,
+                        QDir::Dirs | QDir::Files | QDir::Hidden | QDir::NoSymLinks | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            const auto fi = it.fileInfo();
+            if (fi.isDir()) {
+                dirs << fi.filePath();
+            } else {
+                files.push_back(qMakePair(fi.filePath(), fi.size()));
+                m_total += fi.size();
+            }
+        }
+        m_owner->reportProgress(m_id, m_done, m_total);
+
+        QDir srcDir(srcDirPath);
+        m_backend->makePath(destDirPath);
+        for (const auto &dir : dirs) {
+            m_backend->makePath(PathUtils::concatenateFilePath(destDirPath, srcDir.relativeFilePath(dir)));
+        }
+
+        for (const auto &file : files) {
+            m_backend->copyFile(file.first,
+                                PathUtils::concatenateFilePath(destDirPath, srcDir.relativeFilePath(file.first)));
+            advance(file.second);
+        }
+    }
+
+    void advance(qint64 p_bytes)
+    {
+        m_done += p_bytes;
+
+        // Throttle to avoid flooding the event loop when copying many small files.
+        if (m_done < m_total && m_progressTimer.isValid() && m_progressTimer.elapsed() < 100) {
+            return;
+        }
+
+        m_progressTimer.start();
+        m_owner->reportProgress(m_id, m_done, m_total);
+    }
+
+    AsyncNotebookBackend *m_owner = nullptr;
+
+    ID m_id = InvalidRequestId;
+
+    QSharedPointer<INotebookBackend> m_backend;
+
+    QVector<Operation> m_ops;
+
+    QByteArray m_readData;
+
+    qint64 m_done = 0;
+
+    qint64 m_total = 0;
+
+    QElapsedTimer m_progressTimer;
+};
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::makePath(const QString &p_dirPath)
+{
+    Operation op;
+    op.m_type = Type::MakePath;
+    op.m_path = p_dirPath;
+    return op;
+}
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::writeFile(const QString &p_filePath,
+                                                                           const QByteArray &p_data)
+{
+    Operation op;
+    op.m_type = Type::WriteFile;
+    op.m_path = p_filePath;
+    op.m_data = p_data;
+    return op;
+}
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::copyFile(const QString &p_filePath,
+                                                                          const QString &p_destPath)
+{
+    Operation op;
+    op.m_type = Type::CopyFile;
+    op.m_path = p_filePath;
+    op.m_destPath = p_destPath;
+    return op;
+}
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::copyDir(const QString &p_dirPath,
+                                                                         const QString &p_destPath)
+{
+    Operation op;
+    op.m_type = Type::CopyDir;
+    op.m_path = p_dirPath;
+    op.m_destPath = p_destPath;
+    return op;
+}
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::removeFile(const QString &p_filePath)
+{
+    Operation op;
+    op.m_type = Type::RemoveFile;
+    op.m_path = p_filePath;
+    return op;
+}
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::removeDir(const QString &p_dirPath)
+{
+    Operation op;
+    op.m_type = Type::RemoveDir;
+    op.m_path = p_dirPath;
+    return op;
+}
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::moveFileInto(const QString &p_filePath,
+                                                                              const QString &p_destDirPath)
+{
+    Operation op;
+    op.m_type = Type::MoveFileInto;
+    op.m_path = p_filePath;
+    op.m_destPath = p_destDirPath;
+    return op;
+}
+
+AsyncNotebookBackend::Operation AsyncNotebookBackend::Operation::moveDirInto(const QString &p_dirPath,
+                                                                             const QString &p_destDirPath)
+{
+    Operation op;
+    op.m_type = Type::MoveDirInto;
+    op.m_path = p_dirPath;
+    op.m_destPath = p_destDirPath;
+    return op;
+}
+
+AsyncNotebookBackend::AsyncNotebookBackend(const QSharedPointer<INotebookBackend> &p_backend,
+                                           QObject *p_parent)
+    : QObject(p_parent),
+      m_backend(p_backend),
+      m_threadPool(new QThreadPool(this)),
+      m_serialThreadPool(new QThreadPool(this))
+{
+    // Disk I/O does not scale with cores. A few threads are enough to overlap
+    // independent requests.
+    m_threadPool->setMaxThreadCount(qBound(1, QThread::idealThreadCount(), 4));
+
+    m_serialThreadPool->setMaxThreadCount(1);
+}
+
+AsyncNotebookBackend::~AsyncNotebookBackend()
+{
+    waitForDone();
+}
+
+ID AsyncNotebookBackend::nextRequestId()
+{
+    return m_nextRequestId++;
+}
+
+ID AsyncNotebookBackend::submit(const QVector<Operation> &p_ops,
+                               const Callback &p_callback,
+                               bool p_serial)
+{
+    const auto id = nextRequestId();
+    auto worker = new Worker(this, id, m_backend, p_ops);
+    worker->m_callback = p_callback;
+    start(worker, p_serial);
+    return id;
+}
+
+ID AsyncNotebookBackend::copyFile(const QString &p_filePath,
+                                  const QString &p_destPath,
+                                  const Callback &p_callback)
+{
+    return submit({Operation::copyFile(p_filePath, p_destPath)}, p_callback);
+}
+
+ID AsyncNotebookBackend::copyDir(const QString &p_dirPath,
+                                 const QString &p_destPath,
+                                 const Callback &p_callback)
+{
+    return submit({Operation::copyDir(p_dirPath, p_destPath)}, p_callback);
+}
+
+ID AsyncNotebookBackend::writeFile(const QString &p_filePath,
+                                   const QByteArray &p_data,
+                                   const Callback &p_callback)
+{
+    return submit({Operation::writeFile(p_filePath, p_data)}, p_callback);
+}
+
+ID AsyncNotebookBackend::readFile(const QString &p_filePath, const ReadCallback &p_callback)
+{
+    Q_ASSERT(p_callback);
+    const auto id = nextRequestId();
+    auto worker = new Worker(this, id, m_backend, QVector<Operation>());
+    worker->m_readCallback = p_callback;
+    worker->m_readPath = p_filePath;
+    start(worker);
+    return id;
+}
+
+void AsyncNotebookBackend::start(Worker *p_worker, bool p_serial)
+{
+    m_pendingCount.ref();
+    {
+        QMutexLocker locker(&m_runningMutex);
+        m_runningIds.insert(p_worker->getId());
+    }
+    // QThreadPool runs queued runnables in FIFO order for the same priority.
+    (p_serial ? m_serialThreadPool : m_threadPool)->start(p_worker);
+}
+
+int AsyncNotebookBackend::pendingRequestCount() const
+{
+    return m_pendingCount.load();
+}
+
+void AsyncNotebookBackend::waitForDone()
+{
+    m_threadPool->waitForDone();
+    m_serialThreadPool->waitForDone();
+}
+
+void AsyncNotebookBackend::wait(ID p_id)
+{
+    QMutexLocker locker(&m_runningMutex);
+    while (m_runningIds.contains(p_id)) {
+        m_runningDone.wait(&m_runningMutex);
+    }
+}
+
+void AsyncNotebookBackend::reportProgress(ID p_id, qint64 p_done, qint64 p_total)
+{
+    QMetaObject::invokeMethod(this, [this, p_id, p_done, p_total]() {
+        emit progressUpdated(p_id, p_done, p_total);
+    }, Qt::QueuedConnection);
+}
+
+void AsyncNotebookBackend::finishRequest(ID p_id, const std::function<void()> &p_notifier, bool p_succeeded)
+{
+    {
+        QMutexLocker locker(&m_runningMutex);
+        m_runningIds.remove(p_id);
+    }
+    m_runningDone.wakeAll();
+
+    QMetaObject::invokeMethod(this, [this, p_id, p_notifier, p_succeeded]() {
+        m_pendingCount.deref();
+        if (p_notifier) {
+            p_notifier();
+        }
+        emit requestFinished(p_id, p_succeeded);
+    }, Qt::QueuedConnection);
+}
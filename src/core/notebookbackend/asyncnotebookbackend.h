@@ -0,0 +1,158 @@
+#ifndef ASYNCNOTEBOOKBACKEND_H
+#define ASYNCNOTEBOOKBACKEND_H
+
+#include <functional>
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSet>
+#include <QWaitCondition>
+
+#include "../global.h"
+
+class QThreadPool;
+
+namespace vnotex
+{
+    class INotebookBackend;
+
+    // Run I/O of INotebookBackend on a dedicated thread pool so that large copies
+    // and moves do not block the GUI thread.
+    // Operations are submitted in batches. Operations within one batch are executed
+    // in order on one worker thread while different batches may run concurrently.
+    // Serial batches are executed one by one on a separate thread in submission order.
+    // Callbacks and signals are delivered on the thread owning this object.
+    class AsyncNotebookBackend : public QObject
+    {
+        Q_OBJECT
+    public:
+        enum { InvalidRequestId = 0 };
+
+        struct Operation
+        {
+            enum class Type
+            {
+                MakePath,
+                WriteFile,
+                CopyFile,
+                CopyDir,
+                RemoveFile,
+                RemoveDir,
+                MoveFileInto,
+                MoveDirInto
+            };
+
+            static Operation makePath(const QString &p_dirPath);
+
+            static Operation writeFile(const QString &p_filePath, const QByteArray &p_data);
+
+            static Operation copyFile(const QString &p_filePath, const QString &p_destPath);
+
+            static Operation copyDir(const QString &p_dirPath, const QString &p_destPath);
+
+            static Operation removeFile(const QString &p_filePath);
+
+            static Operation removeDir(const QString &p_dirPath);
+
+            // Move @p_filePath into folder @p_destDirPath by renaming, which falls back to copy
+            // across devices. The file name is made unique when the operation is executed.
+            static Operation moveFileInto(const QString &p_filePath, const QString &p_destDirPath);
+
+            static Operation moveDirInto(const QString &p_dirPath, const QString &p_destDirPath);
+
+            Type m_type = Type::MakePath;
+
+            QString m_path;
+
+            QString m_destPath;
+
+            QByteArray m_data;
+        };
+
+        // @p_errMsg is empty on success.
+        typedef std::function<void(const QString &p_errMsg)> Callback;
+
+        typedef std::function<void(const QByteArray &p_data, const QString &p_errMsg)> ReadCallback;
+
+        AsyncNotebookBackend(const QSharedPointer<INotebookBackend> &p_backend,
+                             QObject *p_parent = nullptr);
+
+        // Wait for all pending requests.
+        ~AsyncNotebookBackend();
+
+        // Execute @p_ops in order. Stop at the first failure.
+        // @p_serial: run after all serial batches submitted before, such as when
+        // the operations pick names in a shared folder.
+        // Return the request ID.
+        ID submit(const QVector<Operation> &p_ops,
+                  const Callback &p_callback = nullptr,
+                  bool p_serial = false);
+
+        ID copyFile(const QString &p_filePath,
+                    const QString &p_destPath,
+                    const Callback &p_callback = nullptr);
+
+        ID copyDir(const QString &p_dirPath,
+                   const QString &p_destPath,
+                   const Callback &p_callback = nullptr);
+
+        ID writeFile(const QString &p_filePath,
+                     const QByteArray &p_data,
+                     const Callback &p_callback = nullptr);
+
+        ID readFile(const QString &p_filePath, const ReadCallback &p_callback);
+
+        int pendingRequestCount() const;
+
+        // Block until all submitted requests are done.
+        void waitForDone();
+
+        // Block until request @p_id is executed.
+        // Its callback is still delivered later via the event loop.
+        void wait(ID p_id);
+
+    signals:
+        // Bytes processed of request @p_id.
+        // @p_total may grow as directories are scanned.
+        void progressUpdated(ID p_id, qint64 p_done, qint64 p_total);
+
+        void requestFinished(ID p_id, bool p_succeeded);
+
+    private:
+        class Worker;
+
+        ID nextRequestId();
+
+        void start(Worker *p_worker, bool p_serial = false);
+
+        // Called from worker threads.
+        void reportProgress(ID p_id, qint64 p_done, qint64 p_total);
+
+        // Called from worker threads.
+        void finishRequest(ID p_id, const std::function<void()> &p_notifier, bool p_succeeded);
+
+        QSharedPointer<INotebookBackend> m_backend;
+
+        QThreadPool *m_threadPool = nullptr;
+
+        // Pool with only one thread for serial batches.
+        QThreadPool *m_serialThreadPool = nullptr;
+
+        QAtomicInt m_pendingCount;
+
+        // IDs of requests submitted but not executed yet.
+        QSet<ID> m_runningIds;
+
+        QMutex m_runningMutex;
+
+        QWaitCondition m_runningDone;
+
+        ID m_nextRequestId = InvalidRequestId + 1;
+    };
+} // ns vnotex
+
+#endif // ASYNCNOTEBOOKBACKEND_H
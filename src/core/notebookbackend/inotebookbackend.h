@@ -89,6 +89,14 @@ namespace vnotex
         // Copy  @p_dirPath to as @p_destPath.
         virtual void copyDir(const QString &p_dirPath, const QString &p_destPath) = 0;
 
+        // Move @p_filePath to @p_destPath.
+        // Rename in place if possible. Otherwise, copy and delete.
+        virtual void moveFile(const QString &p_filePath, const QString &p_destPath) = 0;
+
+        // Move @p_dirPath to @p_destPath as a whole.
+        // Rename in place if possible. Otherwise, copy and delete.
+        virtual void moveDir(const QString &p_dirPath, const QString &p_destPath) = 0;
+
         // Delete @p_dirPath from disk if it is empty.
         // Return false if it is not deleted due to non-empty.
         virtual bool removeDirIfEmpty(const QString &p_dirPath) = 0;
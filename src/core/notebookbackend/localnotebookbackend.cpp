@@ -5,6 +5,7 @@
 #include <QTextStream>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QDebug>
 
 #include <utils/pathutils.h>
 #include "exception.h"
@@ -131,7 +132,8 @@ void LocalNotebookBackend::copyFile(const QString &p_filePath, const QString &p_
     }
 
     if (QFileInfo(filePath).isFile()) {
-        FileUtils::copyFile(filePath, getFullPath(p_destPath));
+        auto method = FileUtils::copyFile(filePath, getFullPath(p_destPath));
+        qDebug() << "copied file via" << FileUtils::copyMethodToString(method) << filePath;
     } else {
         Exception::throwOne(Exception::Type::FailToRemoveFile,
                             QString("failed to remove file: %1").arg(filePath));
@@ -146,7 +148,23 @@ void LocalNotebookBackend::copyDir(const QString &p_dirPath, const QString &p_de
     }
 
     if (QFileInfo(dirPath).isDir()) {
+        // Counts are global. Concurrent copies may be mixed in, which is fine for diagnostics.
+        int counts[static_cast<int>(FileUtils::CopyMethod::MaxMethod)];
+        for (int i = 0; i < static_cast<int>(FileUtils::CopyMethod::MaxMethod); ++i) {
+            counts[i] = FileUtils::getCopyMethodCount(static_cast<FileUtils::CopyMethod>(i));
+        }
+
         FileUtils::copyDir(dirPath, getFullPath(p_destPath));
+
+        QStringList methods;
+        for (int i = 0; i < static_cast<int>(FileUtils::CopyMethod::MaxMethod); ++i) {
+            const auto method = static_cast<FileUtils::CopyMethod>(i);
+            const int delta = FileUtils::getCopyMethodCount(method) - counts[i];
+            if (delta > 0) {
+                methods << QString("%1:%2").arg(FileUtils::copyMethodToString(method), QString::number(delta));
+            }
+        }
+        qDebug() << "copied dir via" << methods.join(QLatin1Char(' ')) << dirPath;
     } else {
         Exception::throwOne(Exception::Type::FailToRemoveDir,
                             QString("failed to remove dir: %1").arg(dirPath));
@@ -171,6 +189,18 @@ void LocalNotebookBackend::removeDir(const QString &p_dirPath)
     return FileUtils::removeDir(getFullPath(p_dirPath));
 }
 
+void LocalNotebookBackend::moveFile(const QString &p_filePath, const QString &p_destPath)
+{
+    Q_ASSERT(isFile(p_filePath));
+    FileUtils::copyFile(getFullPath(p_filePath), getFullPath(p_destPath), true);
+}
+
+void LocalNotebookBackend::moveDir(const QString &p_dirPath, const QString &p_destPath)
+{
+    Q_ASSERT(!isFile(p_dirPath));
+    FileUtils::copyDir(getFullPath(p_dirPath), getFullPath(p_destPath), true);
+}
+
 QString LocalNotebookBackend::renameIfExistsCaseInsensitive(const QString &p_path) const
 {
     return FileUtils::renameIfExistsCaseInsensitive(getFullPath(p_path));
@@ -74,6 +74,10 @@ namespace vnotex
         // Copy @p_dirPath to as @p_destPath.
         void copyDir(const QString &p_dirPath, const QString &p_destPath) Q_DECL_OVERRIDE;
 
+        void moveFile(const QString &p_filePath, const QString &p_destPath) Q_DECL_OVERRIDE;
+
+        void moveDir(const QString &p_dirPath, const QString &p_destPath) Q_DECL_OVERRIDE;
+
         QString renameIfExistsCaseInsensitive(const QString &p_path) const Q_DECL_OVERRIDE;
 
         void addFile(const QString &p_path) Q_DECL_OVERRIDE;
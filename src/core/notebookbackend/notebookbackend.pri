@@ -1,10 +1,12 @@
 SOURCES += \
     $$PWD/localnotebookbackend.cpp \
     $$PWD/localnotebookbackendfactory.cpp \
-    $$PWD/inotebookbackend.cpp
+    $$PWD/inotebookbackend.cpp \
+    $$PWD/asyncnotebookbackend.cpp
 
 HEADERS += \
     $$PWD/inotebookbackend.h \
     $$PWD/localnotebookbackend.h \
     $$PWD/inotebookbackendfactory.h \
-    $$PWD/localnotebookbackendfactory.h
+    $$PWD/localnotebookbackendfactory.h \
+    $$PWD/asyncnotebookbackend.h
@@ -20,6 +20,23 @@ namespace vnotex
     {
         Q_OBJECT
     public:
+        // Info of a node read from config without loading nodes.
+        struct NodeInfo
+        {
+            QString m_name;
+
+            bool m_isContainer = false;
+
+            // Info below of a container child is kept in its own config and not filled.
+            ID m_id = Node::InvalidId;
+
+            QDateTime m_createdTimeUtc;
+
+            QDateTime m_modifiedTimeUtc;
+
+            QStringList m_tags;
+        };
+
         INotebookConfigMgr(const QSharedPointer<INotebookBackend> &p_backend,
                            QObject *p_parent = nullptr);
 
@@ -80,6 +97,28 @@ namespace vnotex
 
         virtual bool checkNodeExists(Node *p_node) = 0;
 
+        // Re-read the config of loaded container @p_node from disk and apply the differences
+        // to its children, reusing unchanged child nodes.
+        // Return true if anything changed.
+        virtual bool refreshNode(Node *p_node) = 0;
+
+        // Read info of the folder at @p_path within notebook and its children from config on disk.
+        // Nodes are not touched, so it could be called in worker threads.
+        // Return false if the config could not be read.
+        virtual bool readFolderInfo(const QString &p_path,
+                                    NodeInfo &p_info,
+                                    QVector<NodeInfo> &p_children) const = 0;
+
+        // Defer writing node configs until the outermost endBulkUpdate().
+        // Each dirty config will be written only once then.
+        // Nodes should not be removed during bulk update.
+        virtual void beginBulkUpdate() = 0;
+        virtual void endBulkUpdate() = 0;
+
+    signals:
+        // Config of @p_node is written, after it or its children are changed.
+        void nodeConfigWritten(const Node *p_node);
+
     protected:
         // Version of the config processing code.
         virtual QString getCodeVersion() const;
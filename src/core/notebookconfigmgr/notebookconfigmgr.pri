@@ -3,7 +3,8 @@ SOURCES += \
     $$PWD/vxnotebookconfigmgrfactory.cpp \
     $$PWD/inotebookconfigmgr.cpp \
     $$PWD/notebookconfig.cpp \
-    $$PWD/bundlenotebookconfigmgr.cpp
+    $$PWD/bundlenotebookconfigmgr.cpp \
+    $$PWD/vxnotebookchecker.cpp
 
 HEADERS += \
     $$PWD/inotebookconfigmgr.h \
@@ -11,4 +12,5 @@ HEADERS += \
     $$PWD/inotebookconfigmgrfactory.h \
     $$PWD/vxnotebookconfigmgrfactory.h \
     $$PWD/notebookconfig.h \
-    $$PWD/bundlenotebookconfigmgr.h
+    $$PWD/bundlenotebookconfigmgr.h \
+    $$PWD/vxnotebookchecker.h
@@ -0,0 +1,398 @@
+#include "vxnotebookchecker.h"
+
+#include <algorithm>
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QDebug>
+
+#include <notebookbackend/inotebookbackend.h>
+#include <notebookbackend/asyncnotebookbackend.h>
+#include <notebook/notebook.h>
+#include <utils/fileutils.h>
+#include <utils/pathutils.h>
+#include "vxnotebookconfigmgr.h"
+#include "exception.h"
+
+using namespace vnotex;
+
+class VXNotebookChecker::FolderTask : public QRunnable
+{
+public:
+    FolderTask(VXNotebookChecker *p_checker, const QString &p_path, bool p_inRecycleBin)
+        : m_checker(p_checker),
+          m_path(p_path),
+          m_inRecycleBin(p_inRecycleBin)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        m_checker->checkFolder(m_path, m_inRecycleBin);
+    }
+
+private:
+    VXNotebookChecker *m_checker = nullptr;
+
+    QString m_path;
+
+    bool m_inRecycleBin = false;
+};
+
+static QString joinPath(const QString &p_folderPath, const QString &p_name)
+{
+    return p_folderPath.isEmpty() ? p_name : p_folderPath + QLatin1Char('/') + p_name;
+}
+
+static QString nameKey(const QString &p_name)
+{
+    return FileUtils::isPlatformNameCaseSensitive() ? p_name : p_name.toLower();
+}
+
+QJsonObject VXNotebookChecker::Issue::toJson() const
+{
+    QJsonObject obj;
+    obj[QStringLiteral("type")] = issueTypeToString(m_type);
+    obj[QStringLiteral("path")] = m_path;
+    obj[QStringLiteral("repaired")] = m_repaired;
+    return obj;
+}
+
+QJsonObject VXNotebookChecker::Report::toJson() const
+{
+    QJsonArray issues;
+    for (const auto &issue : m_issues) {
+        issues.append(issue.toJson());
+    }
+
+    QJsonObject obj;
+    obj[QStringLiteral("root_folder")] = m_rootFolderPath;
+    obj[QStringLiteral("folders")] = m_folderCount;
+    obj[QStringLiteral("files")] = m_fileCount;
+    obj[QStringLiteral("issues")] = issues;
+    return obj;
+}
+
+VXNotebookChecker::VXNotebookChecker(Notebook *p_notebook)
+    : m_notebook(p_notebook)
+{
+    Q_ASSERT(m_notebook);
+    m_configMgr = dynamic_cast<VXNotebookConfigMgr *>(m_notebook->getConfigMgr().data());
+    if (!m_configMgr) {
+        Exception::throwOne(Exception::Type::InvalidArgument,
+                            QString("notebook (%1) is not managed by VNoteX config manager").arg(m_notebook->getName()));
+    }
+
+    m_rootFolderPath = m_notebook->getRootFolderAbsolutePath();
+}
+
+QString VXNotebookChecker::issueTypeToString(IssueType p_type)
+{
+    switch (p_type) {
+    case IssueType::MissingFile:
+        return QStringLiteral("missing_file");
+
+    case IssueType::MissingFolder:
+        return QStringLiteral("missing_folder");
+
+    case IssueType::InvalidConfig:
+        return QStringLiteral("invalid_config");
+
+    case IssueType::UnindexedFile:
+        return QStringLiteral("unindexed_file");
+
+    case IssueType::UnindexedFolder:
+        return QStringLiteral("unindexed_folder");
+
+    case IssueType::OrphanedAttachmentFolder:
+        return QStringLiteral("orphaned_attachment_folder");
+
+    case IssueType::MissingAttachmentFolder:
+        return QStringLiteral("missing_attachment_folder");
+    }
+
+    return QString();
+}
+
+VXNotebookChecker::Report VXNotebookChecker::check()
+{
+    m_report = Report();
+    m_report.m_rootFolderPath = m_rootFolderPath;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+    m_threadPool = &threadPool;
+
+    threadPool.start(new FolderTask(this, QString(), false));
+
+    // Tasks of sub-folders are started before their parents finish.
+    threadPool.waitForDone();
+    m_threadPool = nullptr;
+
+    // Make the report stable.
+    std::sort(m_report.m_issues.begin(), m_report.m_issues.end(), [](const Issue &p_a, const Issue &p_b) {
+        return p_a.m_path < p_b.m_path;
+    });
+
+    return m_report;
+}
+
+void VXNotebookChecker::checkFolder(const QString &p_path, bool p_inRecycleBin)
+{
+    const auto folderPath = toAbsolutePath(p_path);
+
+    VXNotebookConfigMgr::NodeConfig config;
+    {
+        QJsonParseError err;
+        QJsonDocument doc;
+        try {
+            doc = QJsonDocument::fromJson(m_configMgr->getBackend()->readFile(joinPath(p_path, VXNotebookConfigMgr::c_nodeConfigName)),
+                                          &err);
+        } catch (Exception &p_e) {
+            qWarning() << "failed to read config of folder" << folderPath << p_e.what();
+            addIssue(IssueType::InvalidConfig, p_path);
+            return;
+        }
+
+        if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+            addIssue(IssueType::InvalidConfig, p_path);
+            return;
+        }
+
+        config.fromJson(doc.object());
+    }
+
+    const auto entries = FileUtils::listDir(folderPath);
+    QSet<QString> diskFiles;
+    for (const auto &name : entries.m_files) {
+        diskFiles.insert(nameKey(name));
+    }
+
+    QSet<QString> diskFolders;
+    for (const auto &name : entries.m_folders) {
+        diskFolders.insert(nameKey(name));
+    }
+
+    const auto attachmentFolderPath = PathUtils::concatenateFilePath(folderPath, m_notebook->getAttachmentFolder());
+
+    int fileCount = 0;
+    QSet<QString> indexedFiles;
+    QSet<QString> ownedAttachmentFolders;
+    for (const auto &file : config.m_files) {
+        const auto filePath = joinPath(p_path, file.m_name);
+        indexedFiles.insert(nameKey(file.m_name));
+        if (!diskFiles.contains(nameKey(file.m_name))) {
+            addIssue(IssueType::MissingFile, filePath);
+            continue;
+        }
+
+        ++fileCount;
+
+        if (!file.m_attachmentFolder.isEmpty()) {
+            ownedAttachmentFolders.insert(nameKey(file.m_attachmentFolder));
+            if (!QFileInfo(PathUtils::concatenateFilePath(attachmentFolderPath, file.m_attachmentFolder)).isDir()) {
+                addIssue(IssueType::MissingAttachmentFolder, filePath);
+            }
+        }
+    }
+
+    QSet<QString> indexedFolders;
+    for (const auto &folder : config.m_folders) {
+        const auto subFolderPath = joinPath(p_path, folder.m_name);
+        indexedFolders.insert(nameKey(folder.m_name));
+        if (!diskFolders.contains(nameKey(folder.m_name))) {
+            addIssue(IssueType::MissingFolder, subFolderPath);
+            continue;
+        }
+
+        const bool inRecycleBin = p_inRecycleBin
+                                  || (p_path.isEmpty() && nameKey(folder.m_name) == nameKey(VXNotebookConfigMgr::c_recycleBinFolderName));
+        m_threadPool->start(new FolderTask(this, subFolderPath, inRecycleBin));
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        ++m_report.m_folderCount;
+        m_report.m_fileCount += fileCount;
+    }
+
+    // Files are moved into recycle bin without being indexed.
+    if (p_inRecycleBin) {
+        return;
+    }
+
+    for (const auto &name : entries.m_files) {
+        if (indexedFiles.contains(nameKey(name))
+            || m_configMgr->isBuiltInFile(nullptr, name)
+            || m_configMgr->isExcludedFromExternalNode(name)) {
+            continue;
+        }
+
+        addIssue(IssueType::UnindexedFile, joinPath(p_path, name));
+    }
+
+    for (const auto &name : entries.m_folders) {
+        if (indexedFolders.contains(nameKey(name))
+            || m_configMgr->isBuiltInFolderName(p_path.isEmpty(), name)
+            || m_configMgr->isExcludedFromExternalNode(name)) {
+            continue;
+        }
+
+        addIssue(IssueType::UnindexedFolder, joinPath(p_path, name));
+    }
+
+    if (diskFolders.contains(nameKey(m_notebook->getAttachmentFolder()))) {
+        const auto attachmentEntries = FileUtils::listDir(attachmentFolderPath);
+        const auto attachmentFolder = joinPath(p_path, m_notebook->getAttachmentFolder());
+        for (const auto &name : attachmentEntries.m_folders) {
+            if (!ownedAttachmentFolders.contains(nameKey(name))) {
+                addIssue(IssueType::OrphanedAttachmentFolder, joinPath(attachmentFolder, name));
+            }
+        }
+    }
+}
+
+void VXNotebookChecker::addIssue(IssueType p_type, const QString &p_path)
+{
+    Issue issue;
+    issue.m_type = p_type;
+    issue.m_path = p_path;
+
+    QMutexLocker lock(&m_mutex);
+    m_report.m_issues.append(issue);
+}
+
+QString VXNotebookChecker::toAbsolutePath(const QString &p_path) const
+{
+    return p_path.isEmpty() ? m_rootFolderPath : PathUtils::concatenateFilePath(m_rootFolderPath, p_path);
+}
+
+int VXNotebookChecker::repair(Report &p_report)
+{
+    const auto root = m_notebook->getRootNode();
+    const bool caseSensitive = FileUtils::isPlatformNameCaseSensitive();
+    auto findNode = [this, &root](const QString &p_path) {
+        return m_configMgr->loadNodeByPath(root, p_path);
+    };
+
+    int cnt = 0;
+    Notebook::BulkUpdateScope bulkUpdate(m_notebook);
+    for (auto &issue : p_report.m_issues) {
+        const int idx = issue.m_path.lastIndexOf(QLatin1Char('/'));
+        const auto parentPath = idx == -1 ? QString() : issue.m_path.left(idx);
+        const auto name = issue.m_path.mid(idx + 1);
+
+        try {
+            switch (issue.m_type) {
+            case IssueType::MissingFile:
+                Q_FALLTHROUGH();
+            case IssueType::MissingFolder:
+            {
+                auto parent = findNode(parentPath);
+                auto node = parent ? parent->findChild(name, caseSensitive) : QSharedPointer<Node>();
+                if (node) {
+                    m_notebook->removeNode(node, false, true);
+                    issue.m_repaired = true;
+                }
+                break;
+            }
+
+            case IssueType::MissingAttachmentFolder:
+            {
+                auto node = findNode(issue.m_path);
+                if (node) {
+                    node->setAttachmentFolder(QString());
+                    node->save();
+                    issue.m_repaired = true;
+                }
+                break;
+            }
+
+            case IssueType::UnindexedFile:
+                Q_FALLTHROUGH();
+            case IssueType::UnindexedFolder:
+            {
+                auto parent = findNode(parentPath);
+                if (parent && !parent->findChild(name, caseSensitive)) {
+                    m_notebook->addAsNode(parent.data(),
+                                          issue.m_type == IssueType::UnindexedFile ? Node::Flag::Content : Node::Flag::Container,
+                                          name,
+                                          NodeParameters());
+                    issue.m_repaired = true;
+                }
+                break;
+            }
+
+            case IssueType::OrphanedAttachmentFolder:
+            {
+                // Reports are checked against disk right after, so wait for the move.
+                const auto folderPath = toAbsolutePath(issue.m_path);
+                const auto id = m_notebook->moveDirToRecycleBin(folderPath);
+                m_notebook->getAsyncBackend()->wait(id);
+                issue.m_repaired = !QFileInfo::exists(folderPath);
+                break;
+            }
+
+            case IssueType::InvalidConfig:
+                // Needs manual fix.
+                break;
+            }
+        } catch (Exception &p_e) {
+            qWarning() << "failed to repair" << issueTypeToString(issue.m_type) << issue.m_path << p_e.what();
+        }
+
+        if (issue.m_repaired) {
+            ++cnt;
+        }
+    }
+
+    return cnt;
+}
+
+bool VXNotebookChecker::isIndexIssue(IssueType p_type)
+{
+    switch (p_type) {
+    case IssueType::MissingFile:
+        Q_FALLTHROUGH();
+    case IssueType::MissingFolder:
+        Q_FALLTHROUGH();
+    case IssueType::UnindexedFile:
+        Q_FALLTHROUGH();
+    case IssueType::UnindexedFolder:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+int VXNotebookChecker::reindex()
+{
+    int cnt = 0;
+    while (true) {
+        auto report = check();
+
+        Report indexReport;
+        for (const auto &issue : report.m_issues) {
+            if (isIndexIssue(issue.m_type)) {
+                indexReport.m_issues.append(issue);
+            }
+        }
+
+        // Children of newly indexed folders show up in the next pass.
+        const int fixed = indexReport.m_issues.isEmpty() ? 0 : repair(indexReport);
+        if (fixed == 0) {
+            break;
+        }
+        cnt += fixed;
+    }
+
+    return cnt;
+}
@@ -0,0 +1,110 @@
+#ifndef VXNOTEBOOKCHECKER_H
+#define VXNOTEBOOKCHECKER_H
+
+#include <QString>
+#include <QVector>
+#include <QMutex>
+
+class QJsonObject;
+class QThreadPool;
+
+namespace vnotex
+{
+    class Notebook;
+    class VXNotebookConfigMgr;
+
+    // Check whether the configs of a VNoteX notebook match its files.
+    // Folders are checked in parallel by reading configs directly without loading nodes.
+    class VXNotebookChecker
+    {
+    public:
+        enum class IssueType
+        {
+            // Entry of a file in config without the file on disk.
+            MissingFile,
+            // Entry of a folder in config without the folder on disk.
+            MissingFolder,
+            // Config of a folder is missing or could not be parsed.
+            InvalidConfig,
+            // File on disk not in config.
+            UnindexedFile,
+            // Folder on disk not in config.
+            UnindexedFolder,
+            // Attachment folder owned by no file.
+            OrphanedAttachmentFolder,
+            // Attachment folder in config missing on disk.
+            MissingAttachmentFolder
+        };
+
+        struct Issue
+        {
+            QJsonObject toJson() const;
+
+            IssueType m_type = IssueType::MissingFile;
+
+            // Path relative to notebook root.
+            QString m_path;
+
+            bool m_repaired = false;
+        };
+
+        struct Report
+        {
+            QJsonObject toJson() const;
+
+            QString m_rootFolderPath;
+
+            int m_folderCount = 0;
+
+            int m_fileCount = 0;
+
+            QVector<Issue> m_issues;
+        };
+
+        // Throw if @p_notebook is not managed by VXNotebookConfigMgr.
+        explicit VXNotebookChecker(Notebook *p_notebook);
+
+        // Walk configs and folders. Block until done.
+        Report check();
+
+        // Fix issues of @p_report, marking the fixed ones. Config writes are batched.
+        // Orphaned attachment folders are moved to recycle bin.
+        // Return the number of issues fixed.
+        int repair(Report &p_report);
+
+        // Bring configs in line with files on disk: drop entries of missing files and folders
+        // and index unindexed ones, level by level until nothing is left.
+        // Return the number of entries fixed.
+        int reindex();
+
+        static QString issueTypeToString(IssueType p_type);
+
+    private:
+        class FolderTask;
+
+        // Check folder @p_path (relative to root) and schedule its sub-folders.
+        void checkFolder(const QString &p_path, bool p_inRecycleBin);
+
+        void addIssue(IssueType p_type, const QString &p_path);
+
+        static bool isIndexIssue(IssueType p_type);
+
+        QString toAbsolutePath(const QString &p_path) const;
+
+        Notebook *m_notebook = nullptr;
+
+        VXNotebookConfigMgr *m_configMgr = nullptr;
+
+        QString m_rootFolderPath;
+
+        // Valid during check().
+        QThreadPool *m_threadPool = nullptr;
+
+        // Guard of m_report.
+        QMutex m_mutex;
+
+        Report m_report;
+    };
+} // ns vnotex
+
+#endif // VXNOTEBOOKCHECKER_H
@@ -3,13 +3,18 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QHash>
+#include <QFileInfo>
+#include <QPointer>
 #include <QDebug>
 
 #include <notebookbackend/inotebookbackend.h>
+#include <notebookbackend/asyncnotebookbackend.h>
 #include <notebook/notebookparameters.h>
 #include <notebook/vxnode.h>
 #include <notebook/externalnode.h>
 #include <notebook/bundlenotebook.h>
+#include <notebook/mediastore.h>
 #include <utils/utils.h>
 #include <utils/fileutils.h>
 #include <utils/pathutils.h>
@@ -22,6 +27,15 @@
 
 using namespace vnotex;
 
+static int nodeDepth(const Node *p_node)
+{
+    int depth = 0;
+    for (auto node = p_node; node; node = node->getParent()) {
+        ++depth;
+    }
+    return depth;
+}
+
 const QString VXNotebookConfigMgr::NodeConfig::c_version = "version";
 
 const QString VXNotebookConfigMgr::NodeConfig::c_id = "id";
@@ -167,9 +181,11 @@ const QString VXNotebookConfigMgr::c_nodeConfigName = "vx.json";
 
 const QString VXNotebookConfigMgr::c_recycleBinFolderName = "vx_recycle_bin";
 
+const int VXNotebookConfigMgr::c_maxExternalCandidatesCacheSize = 1000;
+
 bool VXNotebookConfigMgr::s_initialized = false;
 
-QVector<QRegExp> VXNotebookConfigMgr::s_externalNodeExcludePatterns;
+QRegularExpression VXNotebookConfigMgr::s_externalNodeExcludeRegExp;
 
 VXNotebookConfigMgr::VXNotebookConfigMgr(const QString &p_name,
                                          const QString &p_displayName,
@@ -183,12 +199,18 @@ VXNotebookConfigMgr::VXNotebookConfigMgr(const QString &p_name,
         s_initialized = true;
 
         const auto &patterns = ConfigMgr::getInst().getCoreConfig().getExternalNodeExcludePatterns();
-        s_externalNodeExcludePatterns.reserve(patterns.size());
+        QStringList regExps;
         for (const auto &pat : patterns) {
             if (!pat.isEmpty()) {
-                s_externalNodeExcludePatterns.push_back(QRegExp(pat, Qt::CaseInsensitive, QRegExp::Wildcard));
+                regExps << QStringLiteral("(?:%1)").arg(QRegularExpression::wildcardToRegularExpression(pat));
             }
         }
+
+        if (!regExps.isEmpty()) {
+            s_externalNodeExcludeRegExp.setPattern(QRegularExpression::anchoredPattern(regExps.join(QLatin1Char('|'))));
+            s_externalNodeExcludeRegExp.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+            s_externalNodeExcludeRegExp.optimize();
+        }
     }
 }
 
@@ -313,8 +335,15 @@ void VXNotebookConfigMgr::writeNodeConfig(const QString &p_path, const NodeConfi
 
 void VXNotebookConfigMgr::writeNodeConfig(const Node *p_node)
 {
+    if (m_bulkUpdateDepth > 0) {
+        m_pendingConfigNodes.insert(p_node, p_node->sharedFromThis());
+        return;
+    }
+
     auto config = nodeToNodeConfig(p_node);
     writeNodeConfig(getNodeConfigFilePath(p_node), *config);
+
+    emit nodeConfigWritten(p_node);
 }
 
 QSharedPointer<Node> VXNotebookConfigMgr::nodeConfigToNode(const NodeConfig &p_config,
@@ -339,12 +368,7 @@ void VXNotebookConfigMgr::loadFolderNode(Node *p_node, const NodeConfig &p_confi
             continue;
         }
 
-        auto folderNode = QSharedPointer<VXNode>::create(folder.m_name,
-                                                         getNotebook(),
-                                                         p_node);
-        inheritNodeFlags(p_node, folderNode.data());
-        folderNode->setExists(getBackend()->existsDir(PathUtils::concatenateFilePath(basePath, folder.m_name)));
-        children.push_back(folderNode);
+        children.push_back(folderConfigToNode(folder, basePath, p_node));
     }
 
     for (const auto &file : p_config.m_files) {
@@ -354,17 +378,7 @@ void VXNotebookConfigMgr::loadFolderNode(Node *p_node, const NodeConfig &p_confi
             continue;
         }
 
-        auto fileNode = QSharedPointer<VXNode>::create(file.m_id,
-                                                       file.m_name,
-                                                       file.m_createdTimeUtc,
-                                                       file.m_modifiedTimeUtc,
-                                                       file.m_tags,
-                                                       file.m_attachmentFolder,
-                                                       getNotebook(),
-                                                       p_node);
-        inheritNodeFlags(p_node, fileNode.data());
-        fileNode->setExists(getBackend()->existsFile(PathUtils::concatenateFilePath(basePath, file.m_name)));
-        children.push_back(fileNode);
+        children.push_back(fileConfigToNode(file, basePath, p_node));
     }
 
     p_node->loadCompleteInfo(p_config.m_id,
@@ -374,6 +388,35 @@ void VXNotebookConfigMgr::loadFolderNode(Node *p_node, const NodeConfig &p_confi
                              children);
 }
 
+QSharedPointer<Node> VXNotebookConfigMgr::folderConfigToNode(const NodeFolderConfig &p_config,
+                                                             const QString &p_basePath,
+                                                             Node *p_parent) const
+{
+    auto folderNode = QSharedPointer<VXNode>::create(p_config.m_name,
+                                                     getNotebook(),
+                                                     p_parent);
+    inheritNodeFlags(p_parent, folderNode.data());
+    folderNode->setExists(getBackend()->existsDir(PathUtils::concatenateFilePath(p_basePath, p_config.m_name)));
+    return folderNode;
+}
+
+QSharedPointer<Node> VXNotebookConfigMgr::fileConfigToNode(const NodeFileConfig &p_config,
+                                                           const QString &p_basePath,
+                                                           Node *p_parent) const
+{
+    auto fileNode = QSharedPointer<VXNode>::create(p_config.m_id,
+                                                   p_config.m_name,
+                                                   p_config.m_createdTimeUtc,
+                                                   p_config.m_modifiedTimeUtc,
+                                                   p_config.m_tags,
+                                                   p_config.m_attachmentFolder,
+                                                   getNotebook(),
+                                                   p_parent);
+    inheritNodeFlags(p_parent, fileNode.data());
+    fileNode->setExists(getBackend()->existsFile(PathUtils::concatenateFilePath(p_basePath, p_config.m_name)));
+    return fileNode;
+}
+
 QSharedPointer<Node> VXNotebookConfigMgr::newNode(Node *p_parent,
                                                   Node::Flags p_flags,
                                                   const QString &p_name,
@@ -548,6 +591,7 @@ void VXNotebookConfigMgr::saveNode(const Node *p_node)
 void VXNotebookConfigMgr::renameNode(Node *p_node, const QString &p_name)
 {
     Q_ASSERT(!p_node->isRoot());
+    dropExternalCandidatesCache(p_node);
     if (p_node->isContainer()) {
         getBackend()->renameDir(p_node->fetchPath(), p_name);
     } else {
@@ -585,7 +629,7 @@ QSharedPointer<Node> VXNotebookConfigMgr::loadNodeByPath(const QSharedPointer<No
     for (auto &pa : paths) {
         // Find child @pa in @node.
         if (!node->isLoaded()) {
-            loadNode(node.data());
+            node->load();
         }
 
         auto child = node->findChild(pa, FileUtils::isPlatformNameCaseSensitive());
@@ -614,19 +658,56 @@ QSharedPointer<Node> VXNotebookConfigMgr::copyNodeAsChildOf(const QSharedPointer
         return nullptr;
     }
 
+    if (p_move && p_src->getNotebook() == getNotebook()) {
+        if (p_src->isContainer()) {
+            return moveFolderNodeAsChildOf(p_src, p_dest);
+        } else {
+            return moveFileNodeAsChildOf(p_src, p_dest);
+        }
+    }
+
+    QVector<AsyncNotebookBackend::Operation> ops;
     QSharedPointer<Node> node;
     if (p_src->isContainer()) {
-        node = copyFolderNodeAsChildOf(p_src, p_dest, p_move);
+        node = copyFolderNodeAsChildOf(p_src, p_dest, p_move, ops);
     } else {
-        node = copyFileNodeAsChildOf(p_src, p_dest, p_move);
+        node = copyFileNodeAsChildOf(p_src, p_dest, p_move, ops);
     }
 
+    submitCopyOperations(p_src, p_move, ops);
     return node;
 }
 
+void VXNotebookConfigMgr::submitCopyOperations(const QSharedPointer<Node> &p_src,
+                                               bool p_move,
+                                               const QVector<AsyncNotebookBackend::Operation> &p_ops)
+{
+    if (p_ops.isEmpty()) {
+        if (p_move) {
+            p_src->getNotebook()->removeNode(p_src);
+        }
+        return;
+    }
+
+    // Attachment folders could take GBs. Copy them in background and remove
+    // the source only after all are copied.
+    QPointer<Notebook> srcNotebook(p_src->getNotebook());
+    getNotebook()->getAsyncBackend()->submit(p_ops, [srcNotebook, p_src, p_move](const QString &p_errMsg) {
+        if (!p_errMsg.isEmpty()) {
+            qWarning() << "failed to copy attachments of node, source is kept" << p_src->fetchAbsolutePath() << p_errMsg;
+            return;
+        }
+
+        if (p_move && srcNotebook && p_src->getParent()) {
+            srcNotebook->removeNode(p_src);
+        }
+    });
+}
+
 QSharedPointer<Node> VXNotebookConfigMgr::copyFileNodeAsChildOf(const QSharedPointer<Node> &p_src,
                                                                 Node *p_dest,
-                                                                bool p_move)
+                                                                bool p_move,
+                                                                QVector<AsyncNotebookBackend::Operation> &p_ops)
 {
     // Copy source file itself.
     auto srcFilePath = p_src->fetchAbsolutePath();
@@ -636,13 +717,18 @@ QSharedPointer<Node> VXNotebookConfigMgr::copyFileNodeAsChildOf(const QSharedPoi
     getBackend()->copyFile(srcFilePath, destFilePath);
 
     // Copy media files fetched from content.
-    ContentMediaUtils::copyMediaFiles(p_src.data(), getBackend().data(), destFilePath);
+    ContentMediaUtils::copyMediaFiles(p_src.data(), getBackend().data(), destFilePath, getNotebook()->getMediaStore());
 
-    // Copy attachment folder. Rename attachment folder if conflicts.
+    // Copy attachment folder in background. Rename attachment folder if conflicts.
     QString attachmentFolder = p_src->getAttachmentFolder();
     if (!attachmentFolder.isEmpty()) {
         auto destAttachmentFolderPath = fetchNodeAttachmentFolder(destFilePath, attachmentFolder);
-        ContentMediaUtils::copyAttachment(p_src.data(), getBackend().data(), destFilePath, destAttachmentFolderPath);
+        // Reserve the name before the copy starts.
+        getBackend()->makePath(destAttachmentFolderPath);
+        if (getBackend()->existsDir(p_src->fetchAttachmentFolderPath())) {
+            p_ops << AsyncNotebookBackend::Operation::copyDir(p_src->fetchAttachmentFolderPath(), destAttachmentFolderPath);
+        }
+        ContentMediaUtils::fixAttachmentLinks(p_src.data(), getBackend().data(), destFilePath, destAttachmentFolderPath);
     }
 
     // Create a file node.
@@ -665,17 +751,14 @@ QSharedPointer<Node> VXNotebookConfigMgr::copyFileNodeAsChildOf(const QSharedPoi
     addChildNode(p_dest, destNode);
     writeNodeConfig(p_dest);
 
-    if (p_move) {
-        // Delete src node.
-        p_src->getNotebook()->removeNode(p_src);
-    }
-
+    // The source is removed by the caller once @p_ops are done.
     return destNode;
 }
 
 QSharedPointer<Node> VXNotebookConfigMgr::copyFolderNodeAsChildOf(const QSharedPointer<Node> &p_src,
                                                                   Node *p_dest,
-                                                                  bool p_move)
+                                                                  bool p_move,
+                                                                  QVector<AsyncNotebookBackend::Operation> &p_ops)
 {
     auto srcFolderPath = p_src->fetchAbsolutePath();
     auto destFolderPath = PathUtils::concatenateFilePath(p_dest->fetchPath(),
@@ -710,19 +793,105 @@ QSharedPointer<Node> VXNotebookConfigMgr::copyFolderNodeAsChildOf(const QSharedP
     // Copy children node.
     auto children = p_src->getChildren();
     for (const auto &childNode : children) {
-        copyNodeAsChildOf(childNode, destNode.data(), p_move);
+        if (p_move && childNode->getNotebook() == notebook) {
+            // Renames within this notebook.
+            copyNodeAsChildOf(childNode, destNode.data(), true);
+        } else if (!childNode->exists()) {
+            // Gone with its parent if moved.
+            continue;
+        } else if (childNode->isContainer()) {
+            copyFolderNodeAsChildOf(childNode, destNode.data(), p_move, p_ops);
+        } else {
+            copyFileNodeAsChildOf(childNode, destNode.data(), p_move, p_ops);
+        }
     }
 
-    if (p_move) {
-        p_src->getNotebook()->removeNode(p_src);
+    // The source is removed by the caller once @p_ops are done.
+    return destNode;
+}
+
+QSharedPointer<Node> VXNotebookConfigMgr::moveFileNodeAsChildOf(const QSharedPointer<Node> &p_src, Node *p_dest)
+{
+    Q_ASSERT(p_src->getNotebook() == getNotebook());
+
+    auto destFilePath = PathUtils::concatenateFilePath(p_dest->fetchPath(), p_src->getName());
+    destFilePath = getBackend()->renameIfExistsCaseInsensitive(destFilePath);
+
+    // Move media files fetched from content before the file itself since links
+    // may be updated in the source file.
+    ContentMediaUtils::moveMediaFiles(p_src.data(), getBackend().data(), destFilePath);
+
+    // Move attachment folder. Rename attachment folder if conflicts.
+    QString attachmentFolder = p_src->getAttachmentFolder();
+    if (!attachmentFolder.isEmpty()) {
+        auto srcAttachmentFolderPath = p_src->fetchAttachmentFolderPath();
+        auto destAttachmentFolderPath = fetchNodeAttachmentFolder(destFilePath, attachmentFolder);
+        if (getBackend()->existsDir(srcAttachmentFolderPath)) {
+            getBackend()->moveDir(srcAttachmentFolderPath, destAttachmentFolderPath);
+        }
     }
 
+    getBackend()->moveFile(p_src->fetchPath(), destFilePath);
+
+    // Keep the id within the same notebook.
+    auto destNode = QSharedPointer<VXNode>::create(p_src->getId(),
+                                                   PathUtils::fileName(destFilePath),
+                                                   p_src->getCreatedTimeUtc(),
+                                                   p_src->getModifiedTimeUtc(),
+                                                   p_src->getTags(),
+                                                   attachmentFolder,
+                                                   getNotebook(),
+                                                   p_dest);
+    destNode->setExists(true);
+    addChildNode(p_dest, destNode);
+    writeNodeConfig(p_dest);
+
+    // Files are already moved. Just detach it from its parent.
+    getNotebook()->removeNode(p_src, false, true);
+
+    return destNode;
+}
+
+QSharedPointer<Node> VXNotebookConfigMgr::moveFolderNodeAsChildOf(const QSharedPointer<Node> &p_src, Node *p_dest)
+{
+    Q_ASSERT(p_src->getNotebook() == getNotebook());
+
+    if (nodeDepth(p_src->getParent()) != nodeDepth(p_dest)
+        && getBackend()->existsDir(getNotebook()->getMediaStore()->getFolderPath())) {
+        // Links to shared media are relative to the note, so they have to be
+        // rewritten one by one once the depth changes.
+        // Children are moved by renaming, so nothing is left to copy in background.
+        QVector<AsyncNotebookBackend::Operation> ops;
+        auto node = copyFolderNodeAsChildOf(p_src, p_dest, true, ops);
+        submitCopyOperations(p_src, true, ops);
+        return node;
+    }
+
+    dropExternalCandidatesCache(p_src.data());
+
+    auto destFolderPath = PathUtils::concatenateFilePath(p_dest->fetchPath(), p_src->getName());
+    destFolderPath = getBackend()->renameIfExistsCaseInsensitive(destFolderPath);
+
+    // The folder carries its own config, children, attachments and images.
+    getBackend()->moveDir(p_src->fetchPath(), destFolderPath);
+
+    // Children will be loaded from the moved config on demand.
+    auto destNode = QSharedPointer<VXNode>::create(PathUtils::fileName(destFolderPath),
+                                                   getNotebook(),
+                                                   p_dest);
+    destNode->setExists(true);
+    addChildNode(p_dest, destNode);
+    writeNodeConfig(p_dest);
+
+    getNotebook()->removeNode(p_src, false, true);
+
     return destNode;
 }
 
 void VXNotebookConfigMgr::removeNode(const QSharedPointer<Node> &p_node, bool p_force, bool p_configOnly)
 {
     auto parentNode = p_node->getParent();
+    dropExternalCandidatesCache(p_node.data());
     if (!p_configOnly && p_node->exists()) {
         // Remove all children.
         auto children = p_node->getChildren();
@@ -835,6 +1004,14 @@ bool VXNotebookConfigMgr::isBuiltInFile(const Node *p_node, const QString &p_nam
 }
 
 bool VXNotebookConfigMgr::isBuiltInFolder(const Node *p_node, const QString &p_name) const
+{
+    if (isBuiltInFolderName(false, p_name)) {
+        return true;
+    }
+    return BundleNotebookConfigMgr::isBuiltInFolder(p_node, p_name);
+}
+
+bool VXNotebookConfigMgr::isBuiltInFolderName(bool p_isRoot, const QString &p_name) const
 {
     const auto name = p_name.toLower();
     if (name == c_recycleBinFolderName
@@ -844,7 +1021,7 @@ bool VXNotebookConfigMgr::isBuiltInFolder(const Node *p_node, const QString &p_n
         || name == QStringLiteral("_v_attachments")) {
         return true;
     }
-    return BundleNotebookConfigMgr::isBuiltInFolder(p_node, p_name);
+    return p_isRoot && name == getConfigFolderName();
 }
 
 QSharedPointer<Node> VXNotebookConfigMgr::copyFileAsChildOf(const QString &p_srcPath, Node *p_dest)
@@ -858,7 +1035,7 @@ QSharedPointer<Node> VXNotebookConfigMgr::copyFileAsChildOf(const QString &p_src
         getBackend()->copyFile(p_srcPath, destFilePath);
 
         // Copy media files fetched from content.
-        ContentMediaUtils::copyMediaFiles(p_srcPath, getBackend().data(), destFilePath);
+        ContentMediaUtils::copyMediaFiles(p_srcPath, getBackend().data(), destFilePath, getNotebook()->getMediaStore());
     }
 
     const auto name = PathUtils::fileName(destFilePath);
@@ -935,59 +1112,95 @@ QVector<QSharedPointer<ExternalNode>> VXNotebookConfigMgr::fetchExternalChildren
     Q_ASSERT(p_node->isContainer());
     QVector<QSharedPointer<ExternalNode>> externalNodes;
 
-    auto dir = p_node->toDir();
+    const auto &candidates = fetchExternalCandidates(p_node);
 
     // Folders.
-    {
-        const auto folders = dir.entryList(QDir::Dirs | QDir::NoSymLinks | QDir::NoDotAndDotDot);
-        for (const auto &folder : folders) {
-            if (isBuiltInFolder(p_node, folder)) {
-                continue;
-            }
-
-            if (isExcludedFromExternalNode(folder)) {
-                continue;
-            }
+    for (const auto &folder : candidates.m_folders) {
+        if (p_node->containsContainerChild(folder)) {
+            continue;
+        }
 
-            if (p_node->containsContainerChild(folder)) {
-                continue;
-            }
+        externalNodes.push_back(QSharedPointer<ExternalNode>::create(p_node, folder, ExternalNode::Type::Folder));
+    }
 
-            externalNodes.push_back(QSharedPointer<ExternalNode>::create(p_node, folder, ExternalNode::Type::Folder));
+    // Files.
+    for (const auto &file : candidates.m_files) {
+        if (p_node->containsContentChild(file)) {
+            continue;
         }
+
+        externalNodes.push_back(QSharedPointer<ExternalNode>::create(p_node, file, ExternalNode::Type::File));
     }
 
-    // Files.
-    {
-        const auto files = dir.entryList(QDir::Files);
-        for (const auto &file : files) {
-            if (isBuiltInFile(p_node, file)) {
-                continue;
-            }
+    return externalNodes;
+}
 
-            if (isExcludedFromExternalNode(file)) {
-                continue;
-            }
+const VXNotebookConfigMgr::ExternalCandidatesCache &VXNotebookConfigMgr::fetchExternalCandidates(Node *p_node) const
+{
+    const auto dirPath = p_node->fetchAbsolutePath();
 
-            if (p_node->containsContentChild(file)) {
-                continue;
-            }
+    // Fetch the time before listing so that changes during listing will invalidate the cache next time.
+    const auto modifiedTime = QFileInfo(dirPath).lastModified().toMSecsSinceEpoch();
 
-            externalNodes.push_back(QSharedPointer<ExternalNode>::create(p_node, file, ExternalNode::Type::File));
+    auto it = m_externalCandidatesCache.find(dirPath);
+    if (it != m_externalCandidatesCache.end() && it->m_modifiedTimeMsecs == modifiedTime) {
+        return it.value();
+    }
+
+    ExternalCandidatesCache cache;
+    cache.m_modifiedTimeMsecs = modifiedTime;
+
+    const auto entries = FileUtils::listDir(dirPath);
+
+    cache.m_folders.reserve(entries.m_folders.size());
+    for (const auto &folder : entries.m_folders) {
+        if (isBuiltInFolder(p_node, folder) || isExcludedFromExternalNode(folder)) {
+            continue;
         }
+
+        cache.m_folders << folder;
     }
 
-    return externalNodes;
+    cache.m_files.reserve(entries.m_files.size());
+    for (const auto &file : entries.m_files) {
+        if (isBuiltInFile(p_node, file) || isExcludedFromExternalNode(file)) {
+            continue;
+        }
+
+        cache.m_files << file;
+    }
+
+    if (m_externalCandidatesCache.size() >= c_maxExternalCandidatesCacheSize) {
+        // Cheap to rebuild, so just start over.
+        m_externalCandidatesCache.clear();
+    }
+
+    return m_externalCandidatesCache.insert(dirPath, cache).value();
 }
 
-bool VXNotebookConfigMgr::isExcludedFromExternalNode(const QString &p_name) const
+void VXNotebookConfigMgr::dropExternalCandidatesCache(const Node *p_node) const
 {
-    for (const auto &regExp : s_externalNodeExcludePatterns) {
-        if (regExp.exactMatch(p_name)) {
-            return true;
+    if (!p_node->isContainer() || m_externalCandidatesCache.isEmpty()) {
+        return;
+    }
+
+    const auto dirPath = p_node->fetchAbsolutePath();
+    for (auto it = m_externalCandidatesCache.begin(); it != m_externalCandidatesCache.end();) {
+        if (PathUtils::pathContains(dirPath, it.key())) {
+            it = m_externalCandidatesCache.erase(it);
+        } else {
+            ++it;
         }
     }
-    return false;
+}
+
+bool VXNotebookConfigMgr::isExcludedFromExternalNode(const QString &p_name) const
+{
+    if (s_externalNodeExcludeRegExp.pattern().isEmpty()) {
+        return false;
+    }
+
+    return s_externalNodeExcludeRegExp.match(p_name).hasMatch();
 }
 
 bool VXNotebookConfigMgr::checkNodeExists(Node *p_node)
@@ -996,3 +1209,177 @@ bool VXNotebookConfigMgr::checkNodeExists(Node *p_node)
     p_node->setExists(exists);
     return exists;
 }
+
+bool VXNotebookConfigMgr::refreshNode(Node *p_node)
+{
+    Q_ASSERT(p_node->isContainer());
+    if (!p_node->isLoaded()) {
+        return false;
+    }
+
+    const auto basePath = p_node->fetchPath();
+    if (!getBackend()->existsDir(basePath)) {
+        if (p_node->exists()) {
+            p_node->setExists(false);
+            return true;
+        }
+        return false;
+    }
+
+    auto config = readNodeConfig(basePath);
+
+    bool changed = !p_node->exists();
+    p_node->setExists(true);
+
+    if (p_node->updateInfo(config->m_createdTimeUtc, config->m_modifiedTimeUtc, QStringList(), QString())) {
+        changed = true;
+    }
+
+    // Index current children by type and name.
+    QHash<QString, QSharedPointer<Node>> oldChildren;
+    const auto &children = p_node->getChildrenRef();
+    for (const auto &child : children) {
+        oldChildren.insert((child->isContainer() ? QStringLiteral("d:") : QStringLiteral("f:")) + child->getName(),
+                           child);
+    }
+
+    QVector<QSharedPointer<Node>> newChildren;
+    newChildren.reserve(config->m_files.size() + config->m_folders.size());
+
+    for (const auto &folder : config->m_folders) {
+        if (folder.m_name.isEmpty()) {
+            continue;
+        }
+
+        auto oldChild = oldChildren.value(QStringLiteral("d:") + folder.m_name);
+        if (oldChild) {
+            bool exists = getBackend()->existsDir(PathUtils::concatenateFilePath(basePath, folder.m_name));
+            if (exists != oldChild->exists()) {
+                oldChild->setExists(exists);
+                changed = true;
+            }
+            newChildren.push_back(oldChild);
+        } else {
+            newChildren.push_back(folderConfigToNode(folder, basePath, p_node));
+            changed = true;
+        }
+    }
+
+    for (const auto &file : config->m_files) {
+        if (file.m_name.isEmpty()) {
+            continue;
+        }
+
+        auto oldChild = oldChildren.value(QStringLiteral("f:") + file.m_name);
+        if (oldChild && oldChild->getId() == file.m_id) {
+            bool exists = getBackend()->existsFile(PathUtils::concatenateFilePath(basePath, file.m_name));
+            if (exists != oldChild->exists()) {
+                oldChild->setExists(exists);
+                changed = true;
+            }
+            // Metadata in config may be changed outside.
+            if (oldChild->updateInfo(file.m_createdTimeUtc, file.m_modifiedTimeUtc, file.m_tags, file.m_attachmentFolder)) {
+                changed = true;
+            }
+            newChildren.push_back(oldChild);
+        } else {
+            newChildren.push_back(fileConfigToNode(file, basePath, p_node));
+            changed = true;
+        }
+    }
+
+    if (!changed && newChildren != children) {
+        // Removed or reordered.
+        changed = true;
+    }
+
+    if (changed) {
+        p_node->replaceChildren(newChildren);
+    }
+
+    return changed;
+}
+
+bool VXNotebookConfigMgr::readFolderInfo(const QString &p_path,
+                                         NodeInfo &p_info,
+                                         QVector<NodeInfo> &p_children) const
+{
+    QSharedPointer<NodeConfig> config;
+    try {
+        config = readNodeConfig(p_path);
+    } catch (Exception &p_e) {
+        qWarning() << "failed to read config of folder" << p_path << p_e.what();
+        return false;
+    }
+
+    if (!config) {
+        return false;
+    }
+
+    p_info.m_isContainer = true;
+    p_info.m_id = config->m_id;
+    p_info.m_createdTimeUtc = config->m_createdTimeUtc;
+    p_info.m_modifiedTimeUtc = config->m_modifiedTimeUtc;
+
+    // Same order as loadFolderNode().
+    p_children.clear();
+    p_children.reserve(config->m_folders.size() + config->m_files.size());
+    for (const auto &folder : config->m_folders) {
+        if (folder.m_name.isEmpty()) {
+            continue;
+        }
+
+        NodeInfo info;
+        info.m_name = folder.m_name;
+        info.m_isContainer = true;
+        p_children.push_back(info);
+    }
+
+    for (const auto &file : config->m_files) {
+        if (file.m_name.isEmpty()) {
+            continue;
+        }
+
+        NodeInfo info;
+        info.m_name = file.m_name;
+        info.m_id = file.m_id;
+        info.m_createdTimeUtc = file.m_createdTimeUtc;
+        info.m_modifiedTimeUtc = file.m_modifiedTimeUtc;
+        info.m_tags = file.m_tags;
+        p_children.push_back(info);
+    }
+
+    return true;
+}
+
+void VXNotebookConfigMgr::beginBulkUpdate()
+{
+    ++m_bulkUpdateDepth;
+}
+
+void VXNotebookConfigMgr::endBulkUpdate()
+{
+    Q_ASSERT(m_bulkUpdateDepth > 0);
+    if (--m_bulkUpdateDepth > 0) {
+        return;
+    }
+
+    const auto pendingNodes = m_pendingConfigNodes;
+    m_pendingConfigNodes.clear();
+
+    qDebug() << "flush node configs of bulk update" << pendingNodes.size();
+
+    for (const auto &weakNode : pendingNodes) {
+        auto node = weakNode.toStrongRef();
+        if (!node || (!node->isRoot() && !node->getParent())) {
+            // Removed.
+            continue;
+        }
+
+        try {
+            writeNodeConfig(node.data());
+        } catch (Exception &p_e) {
+            qWarning() << "failed to write config of node" << node->fetchPath() << p_e.what();
+        }
+    }
+}
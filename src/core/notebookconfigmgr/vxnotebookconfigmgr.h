@@ -5,9 +5,11 @@
 
 #include <QDateTime>
 #include <QVector>
-#include <QRegExp>
+#include <QRegularExpression>
+#include <QHash>
 
 #include "../global.h"
+#include "../notebookbackend/asyncnotebookbackend.h"
 
 class QJsonObject;
 
@@ -17,6 +19,7 @@ namespace vnotex
     class VXNotebookConfigMgr : public BundleNotebookConfigMgr
     {
         Q_OBJECT
+        friend class VXNotebookChecker;
     public:
         explicit VXNotebookConfigMgr(const QString &p_name,
                                      const QString &p_displayName,
@@ -74,6 +77,15 @@ namespace vnotex
 
         bool checkNodeExists(Node *p_node) Q_DECL_OVERRIDE;
 
+        bool refreshNode(Node *p_node) Q_DECL_OVERRIDE;
+
+        bool readFolderInfo(const QString &p_path,
+                            NodeInfo &p_info,
+                            QVector<NodeInfo> &p_children) const Q_DECL_OVERRIDE;
+
+        void beginBulkUpdate() Q_DECL_OVERRIDE;
+        void endBulkUpdate() Q_DECL_OVERRIDE;
+
     private:
         // Config of a file child.
         struct NodeFileConfig
@@ -153,6 +165,14 @@ namespace vnotex
 
         void loadFolderNode(Node *p_node, const NodeConfig &p_config) const;
 
+        QSharedPointer<Node> folderConfigToNode(const NodeFolderConfig &p_config,
+                                                const QString &p_basePath,
+                                                Node *p_parent) const;
+
+        QSharedPointer<Node> fileConfigToNode(const NodeFileConfig &p_config,
+                                              const QString &p_basePath,
+                                              Node *p_parent) const;
+
         QSharedPointer<VXNotebookConfigMgr::NodeConfig> nodeToNodeConfig(const Node *p_node) const;
 
         QSharedPointer<Node> newFileNode(Node *p_parent,
@@ -170,9 +190,28 @@ namespace vnotex
 
         void addChildNode(Node *p_parent, const QSharedPointer<Node> &p_child) const;
 
-        QSharedPointer<Node> copyFileNodeAsChildOf(const QSharedPointer<Node> &p_src, Node *p_dest, bool p_move);
+        // Configs and content are copied at once while attachment folders are
+        // appended to @p_ops to copy in background. @p_src is left in place.
+        QSharedPointer<Node> copyFileNodeAsChildOf(const QSharedPointer<Node> &p_src,
+                                                   Node *p_dest,
+                                                   bool p_move,
+                                                   QVector<AsyncNotebookBackend::Operation> &p_ops);
 
-        QSharedPointer<Node> copyFolderNodeAsChildOf(const QSharedPointer<Node> &p_src, Node *p_dest, bool p_move);
+        QSharedPointer<Node> copyFolderNodeAsChildOf(const QSharedPointer<Node> &p_src,
+                                                     Node *p_dest,
+                                                     bool p_move,
+                                                     QVector<AsyncNotebookBackend::Operation> &p_ops);
+
+        // Run @p_ops in background and remove @p_src afterwards if @p_move.
+        void submitCopyOperations(const QSharedPointer<Node> &p_src,
+                                  bool p_move,
+                                  const QVector<AsyncNotebookBackend::Operation> &p_ops);
+
+        // Move @p_src within this notebook by renaming files instead of copy and delete.
+        // Only the configs of the old parent and @p_dest are written.
+        QSharedPointer<Node> moveFileNodeAsChildOf(const QSharedPointer<Node> &p_src, Node *p_dest);
+
+        QSharedPointer<Node> moveFolderNodeAsChildOf(const QSharedPointer<Node> &p_src, Node *p_dest);
 
         QSharedPointer<Node> copyFileAsChildOf(const QString &p_srcPath, Node *p_dest);
 
@@ -195,17 +234,47 @@ namespace vnotex
 
         bool isExcludedFromExternalNode(const QString &p_name) const;
 
+        // Whether @p_name is a built-in folder of a folder node, or of root if @p_isRoot.
+        bool isBuiltInFolderName(bool p_isRoot, const QString &p_name) const;
+
+        // Candidates of external children of a folder node, keyed by the folder's modified time.
+        struct ExternalCandidatesCache
+        {
+            qint64 m_modifiedTimeMsecs = 0;
+
+            QStringList m_folders;
+
+            QStringList m_files;
+        };
+
+        const ExternalCandidatesCache &fetchExternalCandidates(Node *p_node) const;
+
+        // Drop cached candidates of @p_node and its descendants before it is renamed, moved or removed.
+        void dropExternalCandidatesCache(const Node *p_node) const;
+
         Info m_info;
 
+        // Folder absolute path -> cache.
+        mutable QHash<QString, ExternalCandidatesCache> m_externalCandidatesCache;
+
+        int m_bulkUpdateDepth = 0;
+
+        // Container nodes whose config should be written when bulk update ends.
+        QHash<const Node *, QWeakPointer<const Node>> m_pendingConfigNodes;
+
         static bool s_initialized;
 
-        static QVector<QRegExp> s_externalNodeExcludePatterns;
+        // All the exclude patterns combined into one.
+        static QRegularExpression s_externalNodeExcludeRegExp;
 
         // Name of the node's config file.
         static const QString c_nodeConfigName;
 
         // Name of the recycle bin folder which should be a child of the root node.
         static const QString c_recycleBinFolderName;
+
+        // Max number of folders in m_externalCandidatesCache.
+        static const int c_maxExternalCandidatesCacheSize;
     };
 } // ns vnotex
 
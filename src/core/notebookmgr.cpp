@@ -1,6 +1,9 @@
 #include "notebookmgr.h"
 
+#include <QTimer>
+
 #include <versioncontroller/dummyversioncontrollerfactory.h>
+#include <versioncontroller/gitversioncontrollerfactory.h>
 #include <versioncontroller/iversioncontroller.h>
 #include <notebookconfigmgr/vxnotebookconfigmgrfactory.h>
 #include <notebookconfigmgr/inotebookconfigmgr.h>
@@ -9,12 +12,16 @@
 #include <notebook/bundlenotebookfactory.h>
 #include <notebook/notebook.h>
 #include <notebook/notebookparameters.h>
+#include <notebook/notebookwatcher.h>
 #include "exception.h"
 #include "configmgr.h"
+#include "coreconfig.h"
 #include <utils/pathutils.h>
 
 using namespace vnotex;
 
+const int NotebookMgr::c_purgeRecycleBinDelay = 10 * 1000;
+
 NotebookMgr::NotebookMgr(QObject *p_parent)
     : QObject(p_parent),
       m_currentNotebookId(Notebook::InvalidId)
@@ -30,6 +37,34 @@ void NotebookMgr::init()
     initBackendServer();
 
     initNotebookServer();
+
+    if (ConfigMgr::getInst().getCoreConfig().isWatchExternalChangesEnabled()) {
+        m_watcher = new NotebookWatcher(this);
+    }
+
+    connect(this, &NotebookMgr::currentNotebookChanged,
+            this, &NotebookMgr::schedulePurgeRecycleBin);
+}
+
+void NotebookMgr::schedulePurgeRecycleBin(const QSharedPointer<Notebook> &p_notebook)
+{
+    if (!p_notebook || m_recycleBinPurgedNotebooks.contains(p_notebook->getId())) {
+        return;
+    }
+
+    const auto &coreConfig = ConfigMgr::getInst().getCoreConfig();
+    const int retentionDays = coreConfig.getRecycleBinRetentionDays();
+    const qint64 maxSize = static_cast<qint64>(coreConfig.getRecycleBinMaxSize()) * 1024 * 1024;
+    if (retentionDays <= 0 && maxSize <= 0) {
+        return;
+    }
+
+    // Once per session. Let the notebook open first.
+    m_recycleBinPurgedNotebooks.insert(p_notebook->getId());
+    auto nb = p_notebook.data();
+    QTimer::singleShot(c_purgeRecycleBinDelay, nb, [nb, retentionDays, maxSize]() {
+        nb->purgeRecycleBin(retentionDays, maxSize);
+    });
 }
 
 void NotebookMgr::initVersionControllerServer()
@@ -39,6 +74,10 @@ void NotebookMgr::initVersionControllerServer()
     // Dummy Version Controller.
     auto dummyFactory = QSharedPointer<DummyVersionControllerFactory>::create();
     m_versionControllerServer->registerItem(dummyFactory->getName(), dummyFactory);
+
+    // Git Version Controller.
+    auto gitFactory = QSharedPointer<GitVersionControllerFactory>::create();
+    m_versionControllerServer->registerItem(gitFactory->getName(), gitFactory);
 }
 
 void NotebookMgr::initConfigMgrServer()
@@ -268,6 +307,10 @@ void NotebookMgr::setCurrentNotebook(ID p_notebookId)
     }
 
     if (lastId != m_currentNotebookId) {
+        if (m_watcher) {
+            m_watcher->setNotebook(nb);
+        }
+
         emit currentNotebookChanged(nb);
     }
 
@@ -373,4 +416,8 @@ void NotebookMgr::addNotebook(const QSharedPointer<Notebook> &p_notebook)
             this, [this, notebook = p_notebook.data()]() {
                 emit notebookUpdated(notebook);
             });
+    connect(p_notebook.data(), &Notebook::moveToRecycleBinFailed,
+            this, [this, notebook = p_notebook.data()](const QString &p_path, const QString &p_errMsg) {
+                emit moveToRecycleBinFailed(notebook, p_path, p_errMsg);
+            });
 }
@@ -5,6 +5,7 @@
 #include <QScopedPointer>
 #include <QList>
 #include <QVector>
+#include <QSet>
 
 #include "namebasedserver.h"
 #include "sessionconfig.h"
@@ -21,6 +22,7 @@ namespace vnotex
     class INotebookBackendFactory;
     class INotebookFactory;
     class NotebookParameters;
+    class NotebookWatcher;
 
     class NotebookMgr : public QObject
     {
@@ -75,6 +77,8 @@ namespace vnotex
 
         void notebookUpdated(const Notebook *p_notebook);
 
+        void moveToRecycleBinFailed(const Notebook *p_notebook, const QString &p_path, const QString &p_errMsg);
+
         void notebookAboutToClose(const Notebook *p_notebook);
 
         void notebookAboutToRemove(const Notebook *p_notebook);
@@ -101,6 +105,9 @@ namespace vnotex
 
         void addNotebook(const QSharedPointer<Notebook> &p_notebook);
 
+        // Purge recycle bin of @p_notebook by retention policies later.
+        void schedulePurgeRecycleBin(const QSharedPointer<Notebook> &p_notebook);
+
         QSharedPointer<NameBasedServer<IVersionControllerFactory>> m_versionControllerServer;
 
         QSharedPointer<NameBasedServer<INotebookConfigMgrFactory>> m_configMgrServer;
@@ -112,6 +119,15 @@ namespace vnotex
         QVector<QSharedPointer<Notebook>> m_notebooks;
 
         ID m_currentNotebookId = 0;
+
+        // Watcher of current notebook. Null if disabled.
+        NotebookWatcher *m_watcher = nullptr;
+
+        // Notebooks whose recycle bin has been purged in this session.
+        QSet<ID> m_recycleBinPurgedNotebooks;
+
+        // In milliseconds.
+        static const int c_purgeRecycleBinDelay;
     };
 } // ns vnotex
 
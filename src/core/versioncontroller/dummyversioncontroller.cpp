@@ -26,3 +26,20 @@ QString DummyVersionController::getDescription() const
 {
     return m_info.m_description;
 }
+
+IVersionController::Status DummyVersionController::getStatus(const QString &p_relativePath) const
+{
+    Q_UNUSED(p_relativePath);
+    return Status::Unknown;
+}
+
+void DummyVersionController::refreshStatus(const QStringList &p_relativePaths)
+{
+    Q_UNUSED(p_relativePaths);
+}
+
+void DummyVersionController::snapshot(const QString &p_message)
+{
+    Q_UNUSED(p_message);
+    emit snapshotFinished(false, tr("Version control is disabled for this notebook"));
+}
@@ -22,6 +22,12 @@ namespace vnotex
 
         QString getDescription() const Q_DECL_OVERRIDE;
 
+        Status getStatus(const QString &p_relativePath) const Q_DECL_OVERRIDE;
+
+        void refreshStatus(const QStringList &p_relativePaths = QStringList()) Q_DECL_OVERRIDE;
+
+        void snapshot(const QString &p_message) Q_DECL_OVERRIDE;
+
     private:
         Info m_info;
     };
@@ -0,0 +1,479 @@
+#include "gitversioncontroller.h"
+
+#include <QProcess>
+#include <QTimer>
+#include <QStandardPaths>
+#include <QDebug>
+
+#include <notebook/notebook.h>
+#include <notebook/node.h>
+#include <utils/pathutils.h>
+
+using namespace vnotex;
+
+// Refresh all instead of passing too many pathspecs.
+static const int c_maxPathspecs = 256;
+
+// Parent of a path relative to notebook root. Empty for the root.
+static QString relativeParentPath(const QString &p_path)
+{
+    int idx = p_path.lastIndexOf(QLatin1Char('/'));
+    return idx > 0 ? p_path.left(idx) : QString();
+}
+
+GitVersionController::GitVersionController(const QString &p_name,
+                                           const QString &p_displayName,
+                                           const QString &p_description,
+                                           QObject *p_parent)
+    : IVersionController(p_parent),
+      m_info(p_name, p_displayName, p_description),
+      m_gitExe(findGitExecutable())
+{
+    m_process = new QProcess(this);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this](int p_exitCode, QProcess::ExitStatus p_exitStatus) {
+                handleJobFinished(p_exitStatus == QProcess::NormalExit ? p_exitCode : -1);
+            });
+    connect(m_process, &QProcess::errorOccurred,
+            this, [this](QProcess::ProcessError p_error) {
+                // finished() is not emitted in this case.
+                if (p_error == QProcess::FailedToStart) {
+                    handleJobFinished(-1);
+                }
+            });
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout,
+            this, [this]() {
+                if (!m_refreshRunning) {
+                    doRefreshStatus();
+                }
+            });
+}
+
+GitVersionController::~GitVersionController()
+{
+    m_process->disconnect(this);
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->kill();
+        m_process->waitForFinished(1000);
+    }
+}
+
+QString GitVersionController::getName() const
+{
+    return m_info.m_name;
+}
+
+QString GitVersionController::getDisplayName() const
+{
+    return m_info.m_displayName;
+}
+
+QString GitVersionController::getDescription() const
+{
+    return m_info.m_description;
+}
+
+QString GitVersionController::findGitExecutable()
+{
+    return QStandardPaths::findExecutable(QStringLiteral("git"));
+}
+
+void GitVersionController::setNotebook(Notebook *p_notebook)
+{
+    IVersionController::setNotebook(p_notebook);
+
+    connect(p_notebook, &Notebook::nodeUpdated,
+            this, &GitVersionController::handleNodeUpdated);
+}
+
+void GitVersionController::ensureStarted()
+{
+    if (m_started || !getNotebook()) {
+        return;
+    }
+
+    m_started = true;
+
+    enqueue({"rev-parse", "--show-prefix"},
+            [this](int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr) {
+                Q_UNUSED(p_stdErr);
+                m_prefixResolved = p_exitCode == 0;
+                m_prefix = m_prefixResolved ? QString::fromUtf8(p_stdOut).trimmed() : QString();
+            });
+
+    refreshStatus();
+}
+
+QString GitVersionController::getRootPath() const
+{
+    return getNotebook() ? getNotebook()->getRootFolderAbsolutePath() : QString();
+}
+
+void GitVersionController::enqueue(const QStringList &p_args, const JobCallback &p_callback)
+{
+    Job job;
+    job.m_args = p_args;
+    job.m_callback = p_callback;
+    m_jobs.enqueue(job);
+
+    startNextJob();
+}
+
+void GitVersionController::startNextJob()
+{
+    if (m_jobs.isEmpty() || m_process->state() != QProcess::NotRunning) {
+        return;
+    }
+
+    if (m_gitExe.isEmpty()) {
+        // Fail all jobs.
+        while (!m_jobs.isEmpty()) {
+            auto job = m_jobs.dequeue();
+            if (job.m_callback) {
+                job.m_callback(-1, QByteArray(), QByteArrayLiteral("git is not found"));
+            }
+        }
+        return;
+    }
+
+    m_process->setWorkingDirectory(getRootPath());
+    m_process->start(m_gitExe, m_jobs.head().m_args);
+}
+
+void GitVersionController::handleJobFinished(int p_exitCode)
+{
+    Q_ASSERT(!m_jobs.isEmpty());
+    auto job = m_jobs.dequeue();
+    const auto stdOut = m_process->readAllStandardOutput();
+    const auto stdErr = m_process->readAllStandardError();
+    if (p_exitCode != 0) {
+        qDebug() << "git" << job.m_args << "exited with" << p_exitCode << stdErr;
+    }
+
+    if (job.m_callback) {
+        job.m_callback(p_exitCode, stdOut, stdErr);
+    }
+
+    startNextJob();
+}
+
+IVersionController::Status GitVersionController::getStatus(const QString &p_relativePath) const
+{
+    const_cast<GitVersionController *>(this)->ensureStarted();
+
+    if (!m_prefixResolved) {
+        return Status::Unknown;
+    }
+
+    auto path = PathUtils::cleanPath(p_relativePath);
+    if (path == QStringLiteral(".")) {
+        path.clear();
+    }
+
+    auto it = m_fileStatus.find(path);
+    if (it != m_fileStatus.end()) {
+        return it.value();
+    }
+
+    if (m_dirtyFolderCounts.contains(path)) {
+        return Status::Modified;
+    }
+
+    return Status::Unmodified;
+}
+
+void GitVersionController::refreshStatus(const QStringList &p_relativePaths)
+{
+    if (!m_started) {
+        // Full status will be read on start.
+        ensureStarted();
+        return;
+    }
+
+    if (p_relativePaths.isEmpty()) {
+        m_pendingFullRefresh = true;
+        m_pendingPaths.clear();
+    } else if (!m_pendingFullRefresh) {
+        for (const auto &pa : p_relativePaths) {
+            m_pendingPaths.insert(PathUtils::cleanPath(pa));
+        }
+    }
+
+    if (!m_refreshRunning) {
+        doRefreshStatus();
+    }
+}
+
+void GitVersionController::handleNodeUpdated(const Node *p_node)
+{
+    if (!m_started || m_pendingFullRefresh) {
+        return;
+    }
+
+    m_pendingPaths.insert(p_node->fetchPath());
+    m_refreshTimer->start();
+}
+
+void GitVersionController::doRefreshStatus()
+{
+    if (m_pendingPaths.contains(QString()) || m_pendingPaths.size() > c_maxPathspecs) {
+        m_pendingFullRefresh = true;
+    }
+
+    if (!m_pendingFullRefresh && m_pendingPaths.isEmpty()) {
+        return;
+    }
+
+    QStringList paths;
+    if (!m_pendingFullRefresh) {
+        paths = m_pendingPaths.values();
+    }
+    m_pendingPaths.clear();
+    m_pendingFullRefresh = false;
+    m_refreshRunning = true;
+
+    // Untracked cache and the stat data in index avoid re-hashing unchanged files.
+    QStringList args {"-c", "core.quotepath=off",
+                      "-c", "core.untrackedCache=true",
+                      "status", "--porcelain=v1", "-z", "--untracked-files=all", "--ignore-submodules",
+                      "--"};
+    if (paths.isEmpty()) {
+        args << QStringLiteral(".");
+    } else {
+        args << paths;
+    }
+
+    enqueue(args,
+            [this, paths](int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr) {
+                Q_UNUSED(p_stdErr);
+                if (p_exitCode == 0) {
+                    handleStatusOutput(paths, p_stdOut);
+                } else if (paths.isEmpty()) {
+                    // Not a repository yet.
+                    m_fileStatus.clear();
+                    m_dirtyFolderCounts.clear();
+                }
+
+                m_refreshRunning = false;
+                emit statusUpdated();
+
+                if (m_pendingFullRefresh || !m_pendingPaths.isEmpty()) {
+                    doRefreshStatus();
+                }
+            });
+}
+
+void GitVersionController::handleStatusOutput(const QStringList &p_paths, const QByteArray &p_output)
+{
+    if (p_paths.isEmpty()) {
+        m_fileStatus.clear();
+        m_dirtyFolderCounts.clear();
+    } else {
+        // Drop cached status of refreshed paths.
+        const auto cachedPaths = m_fileStatus.keys();
+        for (const auto &cached : cachedPaths) {
+            for (const auto &pa : p_paths) {
+                if (cached == pa || cached.startsWith(pa + QLatin1Char('/'))) {
+                    clearStatus(cached);
+                    break;
+                }
+            }
+        }
+    }
+
+    const auto entries = parseStatusOutput(p_output, m_prefix);
+    for (const auto &entry : entries) {
+        setStatus(entry.first, entry.second);
+    }
+}
+
+QVector<QPair<QString, IVersionController::Status>> GitVersionController::parseStatusOutput(const QByteArray &p_output,
+                                                                                          const QString &p_prefix)
+{
+    QVector<QPair<QString, Status>> result;
+
+    // With -z, paths are NUL-terminated and never quoted.
+    const auto entries = p_output.split('\0');
+    for (int i = 0; i < entries.size(); ++i) {
+        const auto &entry = entries[i];
+        if (entry.size() < 4) {
+            continue;
+        }
+
+        const char x = entry[0];
+        const char y = entry[1];
+        if (x == 'R' || x == 'C') {
+            // Followed by the original path.
+            ++i;
+        }
+
+        // Paths are relative to the top level of the repository.
+        auto path = QString::fromUtf8(entry.mid(3));
+        if (!p_prefix.isEmpty()) {
+            if (!path.startsWith(p_prefix)) {
+                continue;
+            }
+            path = path.mid(p_prefix.size());
+        }
+
+        result.push_back(qMakePair(path, parseStatus(x, y)));
+    }
+
+    return result;
+}
+
+IVersionController::Status GitVersionController::parseStatus(char p_index, char p_workTree)
+{
+    if (p_index == '?' && p_workTree == '?') {
+        return Status::Untracked;
+    }
+
+    if (p_index == 'U' || p_workTree == 'U' || (p_index == 'A' && p_workTree == 'A') || (p_index == 'D' && p_workTree == 'D')) {
+        return Status::Conflicted;
+    }
+
+    if (p_index == 'D' || p_workTree == 'D') {
+        return Status::Deleted;
+    }
+
+    if (p_index == 'R') {
+        return Status::Renamed;
+    }
+
+    if (p_index == 'A') {
+        return Status::Added;
+    }
+
+    return Status::Modified;
+}
+
+void GitVersionController::setStatus(const QString &p_path, Status p_status)
+{
+    if (p_status == Status::Unmodified) {
+        return;
+    }
+
+    if (m_fileStatus.contains(p_path)) {
+        m_fileStatus[p_path] = p_status;
+        return;
+    }
+
+    m_fileStatus.insert(p_path, p_status);
+
+    // Mark all ancestors, including the root.
+    auto folder = p_path;
+    do {
+        folder = relativeParentPath(folder);
+        ++m_dirtyFolderCounts[folder];
+    } while (!folder.isEmpty());
+}
+
+void GitVersionController::clearStatus(const QString &p_path)
+{
+    if (!m_fileStatus.remove(p_path)) {
+        return;
+    }
+
+    auto folder = p_path;
+    do {
+        folder = relativeParentPath(folder);
+        auto it = m_dirtyFolderCounts.find(folder);
+        if (it != m_dirtyFolderCounts.end() && --it.value() <= 0) {
+            m_dirtyFolderCounts.erase(it);
+        }
+    } while (!folder.isEmpty());
+}
+
+void GitVersionController::snapshot(const QString &p_message)
+{
+    if (m_snapshotRunning) {
+        emit snapshotFinished(false, tr("Another snapshot is in progress"));
+        return;
+    }
+
+    m_snapshotRunning = true;
+    ensureStarted();
+
+    // Resolve the repository again in case it is created or removed outside.
+    enqueue({"rev-parse", "--show-prefix"},
+            [this, p_message](int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr) {
+                Q_UNUSED(p_stdErr);
+                if (p_exitCode == 0) {
+                    m_prefixResolved = true;
+                    m_prefix = QString::fromUtf8(p_stdOut).trimmed();
+                    stageAll(p_message);
+                    return;
+                }
+
+                enqueue({"init"},
+                        [this, p_message](int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr) {
+                            Q_UNUSED(p_stdOut);
+                            if (p_exitCode != 0) {
+                                finishSnapshot(QString::fromLocal8Bit(p_stdErr));
+                                return;
+                            }
+
+                            m_prefixResolved = true;
+                            m_prefix.clear();
+                            stageAll(p_message);
+                        });
+            });
+}
+
+void GitVersionController::stageAll(const QString &p_message)
+{
+    // Stage all changes since last snapshot within the notebook.
+    enqueue({"-c", "core.untrackedCache=true", "add", "-A", "--", "."},
+            [this, p_message](int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr) {
+                Q_UNUSED(p_stdOut);
+                if (p_exitCode != 0) {
+                    finishSnapshot(QString::fromLocal8Bit(p_stdErr));
+                    return;
+                }
+
+                // Provide an identity only if user does not have one.
+                enqueue({"config", "user.email"},
+                        [this, p_message](int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr) {
+                            Q_UNUSED(p_stdOut);
+                            Q_UNUSED(p_stdErr);
+                            commit(p_message, p_exitCode != 0);
+                        });
+            });
+}
+
+void GitVersionController::commit(const QString &p_message, bool p_needIdentity)
+{
+    QStringList args;
+    if (p_needIdentity) {
+        args << "-c" << "user.name=VNote" << "-c" << "user.email=vnote@localhost";
+    }
+
+    args << "commit" << "-m" << p_message;
+    if (!m_prefix.isEmpty()) {
+        // Notebook is part of a larger repository. Do not commit others' staged changes.
+        args << "--" << ".";
+    }
+
+    enqueue(args,
+            [this](int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr) {
+                // Exit code 1 with nothing to commit is fine.
+                if (p_exitCode != 0 && !p_stdOut.contains("nothing to commit")) {
+                    finishSnapshot(QString::fromLocal8Bit(p_stdErr.isEmpty() ? p_stdOut : p_stdErr));
+                    return;
+                }
+
+                finishSnapshot(QString());
+            });
+}
+
+void GitVersionController::finishSnapshot(const QString &p_errMsg)
+{
+    m_snapshotRunning = false;
+    emit snapshotFinished(p_errMsg.isEmpty(), p_errMsg.trimmed());
+
+    refreshStatus();
+}
@@ -0,0 +1,135 @@
+#ifndef GITVERSIONCONTROLLER_H
+#define GITVERSIONCONTROLLER_H
+
+#include "iversioncontroller.h"
+
+#include <functional>
+
+#include <QHash>
+#include <QSet>
+#include <QQueue>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+
+#include <global.h>
+
+class QProcess;
+class QTimer;
+
+namespace vnotex
+{
+    class Node;
+
+    // Version control via the git command line.
+    // Git commands run asynchronously one by one. Status relies on the stat data
+    // cached in git's index so only changed files are re-hashed.
+    // Git is not run until status or snapshot is requested.
+    class GitVersionController : public IVersionController
+    {
+        Q_OBJECT
+    public:
+        explicit GitVersionController(const QString &p_name,
+                                      const QString &p_displayName,
+                                      const QString &p_description,
+                                      QObject *p_parent = nullptr);
+
+        ~GitVersionController();
+
+        QString getName() const Q_DECL_OVERRIDE;
+
+        QString getDisplayName() const Q_DECL_OVERRIDE;
+
+        QString getDescription() const Q_DECL_OVERRIDE;
+
+        void setNotebook(Notebook *p_notebook) Q_DECL_OVERRIDE;
+
+        Status getStatus(const QString &p_relativePath) const Q_DECL_OVERRIDE;
+
+        void refreshStatus(const QStringList &p_relativePaths = QStringList()) Q_DECL_OVERRIDE;
+
+        void snapshot(const QString &p_message) Q_DECL_OVERRIDE;
+
+        static QString findGitExecutable();
+
+        // Parse output of "git status --porcelain=v1 -z" into status of each changed path.
+        // Paths are made relative to @p_prefix and those outside it are skipped.
+        static QVector<QPair<QString, Status>> parseStatusOutput(const QByteArray &p_output,
+                                                                 const QString &p_prefix);
+
+    private:
+        typedef std::function<void(int p_exitCode, const QByteArray &p_stdOut, const QByteArray &p_stdErr)> JobCallback;
+
+        struct Job
+        {
+            QStringList m_args;
+
+            JobCallback m_callback;
+        };
+
+        QString getRootPath() const;
+
+        // Resolve the repository and read the full status on first use.
+        void ensureStarted();
+
+        void enqueue(const QStringList &p_args, const JobCallback &p_callback);
+
+        void startNextJob();
+
+        void handleJobFinished(int p_exitCode);
+
+        // Start a status refresh for pending paths.
+        void doRefreshStatus();
+
+        void handleStatusOutput(const QStringList &p_paths, const QByteArray &p_output);
+
+        void clearStatus(const QString &p_path);
+
+        void setStatus(const QString &p_path, Status p_status);
+
+        void stageAll(const QString &p_message);
+
+        void commit(const QString &p_message, bool p_needIdentity);
+
+        void finishSnapshot(const QString &p_errMsg);
+
+        void handleNodeUpdated(const Node *p_node);
+
+        static Status parseStatus(char p_index, char p_workTree);
+
+        Info m_info;
+
+        QString m_gitExe;
+
+        // Path of notebook root relative to the top level of the repository.
+        QString m_prefix;
+
+        bool m_prefixResolved = false;
+
+        bool m_started = false;
+
+        QProcess *m_process = nullptr;
+
+        QQueue<Job> m_jobs;
+
+        // Changed files relative to notebook root.
+        QHash<QString, Status> m_fileStatus;
+
+        // Number of changed files under each folder.
+        QHash<QString, int> m_dirtyFolderCounts;
+
+        // Paths waiting for refresh.
+        QSet<QString> m_pendingPaths;
+
+        bool m_pendingFullRefresh = false;
+
+        bool m_refreshRunning = false;
+
+        bool m_snapshotRunning = false;
+
+        // Coalesce node updates.
+        QTimer *m_refreshTimer = nullptr;
+    };
+} // ns vnotex
+
+#endif // GITVERSIONCONTROLLER_H
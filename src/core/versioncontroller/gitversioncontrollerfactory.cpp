@@ -0,0 +1,33 @@
+#include "gitversioncontrollerfactory.h"
+
+using namespace vnotex;
+
+#include <QObject>
+
+#include "gitversioncontroller.h"
+
+GitVersionControllerFactory::GitVersionControllerFactory()
+{
+}
+
+QString GitVersionControllerFactory::getName() const
+{
+    return QStringLiteral("git.vnotex");
+}
+
+QString GitVersionControllerFactory::getDisplayName() const
+{
+    return QObject::tr("Git");
+}
+
+QString GitVersionControllerFactory::getDescription() const
+{
+    return QObject::tr("Take snapshots of the notebook in a local Git repository");
+}
+
+QSharedPointer<IVersionController> GitVersionControllerFactory::createVersionController()
+{
+    return QSharedPointer<GitVersionController>::create(getName(),
+                                                        getDisplayName(),
+                                                        getDescription());
+}
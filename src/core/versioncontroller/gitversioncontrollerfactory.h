@@ -0,0 +1,24 @@
+#ifndef GITVERSIONCONTROLLERFACTORY_H
+#define GITVERSIONCONTROLLERFACTORY_H
+
+#include "iversioncontrollerfactory.h"
+
+
+namespace vnotex
+{
+    class GitVersionControllerFactory : public IVersionControllerFactory
+    {
+    public:
+        GitVersionControllerFactory();
+
+        QString getName() const Q_DECL_OVERRIDE;
+
+        QString getDisplayName() const Q_DECL_OVERRIDE;
+
+        QString getDescription()const Q_DECL_OVERRIDE;
+
+        QSharedPointer<IVersionController> createVersionController() Q_DECL_OVERRIDE;
+    };
+} // ns vnotex
+
+#endif // GITVERSIONCONTROLLERFACTORY_H
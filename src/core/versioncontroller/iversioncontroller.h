@@ -5,11 +5,25 @@
 
 namespace vnotex
 {
+    class Notebook;
+
     // Abstract class for version control.
     class IVersionController : public QObject
     {
         Q_OBJECT
     public:
+        enum class Status
+        {
+            Unmodified,
+            Modified,
+            Added,
+            Deleted,
+            Renamed,
+            Untracked,
+            Conflicted,
+            Unknown
+        };
+
         explicit IVersionController(QObject *p_parent = nullptr)
             : QObject(p_parent)
         {
@@ -24,6 +38,38 @@ namespace vnotex
         virtual QString getDisplayName() const = 0;
 
         virtual QString getDescription() const = 0;
+
+        Notebook *getNotebook() const
+        {
+            return m_notebook;
+        }
+
+        // Called once by the notebook owning this controller.
+        virtual void setNotebook(Notebook *p_notebook)
+        {
+            m_notebook = p_notebook;
+        }
+
+        // Cached status of @p_relativePath (relative to notebook root).
+        // Folders are Modified if any path under it is changed.
+        virtual Status getStatus(const QString &p_relativePath) const = 0;
+
+        // Refresh status in background. Refresh all paths if @p_relativePaths is empty.
+        // statusUpdated() will be emitted when done.
+        virtual void refreshStatus(const QStringList &p_relativePaths = QStringList()) = 0;
+
+        // Record all changes since last snapshot in background.
+        // snapshotFinished() will be emitted when done.
+        virtual void snapshot(const QString &p_message) = 0;
+
+    signals:
+        void statusUpdated();
+
+        // @p_errMsg is empty on success.
+        void snapshotFinished(bool p_succeeded, const QString &p_errMsg);
+
+    private:
+        Notebook *m_notebook = nullptr;
     };
 } // ns vnotex
 
@@ -1,11 +1,15 @@
 SOURCES += \
     $$PWD/dummyversioncontroller.cpp \
     $$PWD/versioncontrollerserver.cpp \
-    $$PWD/dummyversioncontrollerfactory.cpp
+    $$PWD/dummyversioncontrollerfactory.cpp \
+    $$PWD/gitversioncontroller.cpp \
+    $$PWD/gitversioncontrollerfactory.cpp
 
 HEADERS += \
     $$PWD/iversioncontroller.h \
     $$PWD/dummyversioncontroller.h \
     $$PWD/versioncontrollerserver.h \
     $$PWD/iversioncontrollerfactory.h \
-    $$PWD/dummyversioncontrollerfactory.h
+    $$PWD/dummyversioncontrollerfactory.h \
+    $$PWD/gitversioncontroller.h \
+    $$PWD/gitversioncontrollerfactory.h
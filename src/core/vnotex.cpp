@@ -90,6 +90,11 @@ void VNoteX::initNotebookMgr()
 {
     Q_ASSERT(!m_notebookMgr);
     m_notebookMgr = new NotebookMgr(this);
+    connect(m_notebookMgr, &NotebookMgr::moveToRecycleBinFailed,
+            this, [this](const Notebook *p_notebook, const QString &p_path, const QString &p_errMsg) {
+                Q_UNUSED(p_notebook);
+                showStatusMessageShort(tr("Failed to move (%1) to recycle bin (%2).").arg(p_path, p_errMsg));
+            });
     m_notebookMgr->init();
 }
 
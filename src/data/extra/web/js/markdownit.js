@@ -116,6 +116,24 @@ class MarkdownIt extends VxWorker {
 
         this.codeNodesCollected = false;
 
+        // Source lines of the text rendered in lastContainerNode.
+        this.lines = null;
+
+        // Top-level blocks of lastContainerNode in order: { start, type, marker }.
+        // Each block begins with a marker comment node, which stays in DOM so that the
+        // block could be located and re-rendered even if workers replace its nodes.
+        // Null if blocks could not be located.
+        this.blocks = null;
+
+        // Marker after the last block.
+        this.blockEndMarker = null;
+
+        // Markers of blocks rendered by last patch round. Null if all nodes are rendered.
+        this.renderedMarkers = null;
+
+        // Environment of last full render, holding link references.
+        this.env = {};
+
         // Used to deduplicate header Ids.
         // One for markdownItAnchor and one for markdownItTocDoneRight.
         this.headerIds = [new Set(), new Set()];
@@ -237,6 +255,10 @@ class MarkdownIt extends VxWorker {
             },
             containerClass: 'vx-table-of-contents'
         });
+
+        this.mdit.renderer.rules[MarkdownIt.blockMarkerType] = function() {
+            return '<!--' + MarkdownIt.blockMarkerData + '-->';
+        };
     }
 
     registerInternal() {
@@ -245,6 +267,12 @@ class MarkdownIt extends VxWorker {
                         p_text,
                         'window.vnotex.getWorker(\'markdownit\').markdownRenderFinished();');
         });
+
+        this.vnotex.on('markdownTextPatched', (p_patches) => {
+            this.renderPatches(this.vnotex.contentContainer,
+                               p_patches,
+                               'window.vnotex.getWorker(\'markdownit\').markdownRenderFinished();');
+        });
     }
 
     // Render Markdown @p_text to HTML in @p_node.
@@ -256,12 +284,17 @@ class MarkdownIt extends VxWorker {
         this.codeNodesCollected = false;
         this.headerIds[0].clear();
         this.headerIds[1].clear();
+        this.renderedMarkers = null;
 
         if (p_node != this.lastContainerNode) {
             this.lastContainerNode = p_node;
             this.preNodes = null;
         }
 
+        this.lines = p_text ? p_text.split('\n') : [''];
+        this.blocks = null;
+        this.blockEndMarker = null;
+
         if (!p_text) {
             p_node.innerHTML = '';
             this.finishWork();
@@ -269,9 +302,22 @@ class MarkdownIt extends VxWorker {
             return;
         }
 
-        let html = this.mdit.render(p_text);
+        this.env = {};
+        let marked = this.markBlocks(this.mdit.parse(p_text, this.env), 0, true);
+        let html = this.mdit.renderer.render(marked.tokens, this.mdit.options, this.env);
         p_node.innerHTML = html + this.loadedGuard(p_finishCbStr);
 
+        if (marked.blocks) {
+            let markers = MarkdownIt.collectBlockMarkers(p_node);
+            if (markers.length == marked.blocks.length + 1) {
+                for (let i = 0; i < marked.blocks.length; ++i) {
+                    MarkdownIt.attachBlockMarker(marked.blocks[i], markers[i]);
+                }
+                this.blocks = marked.blocks;
+                this.blockEndMarker = markers[markers.length - 1];
+            }
+        }
+
         if (this.preNodes == null) {
             this.preNodes = p_node.getElementsByTagName('pre');
         }
@@ -283,6 +329,321 @@ class MarkdownIt extends VxWorker {
         this.finishWork();
     }
 
+    // Apply line patches @p_patches to the text rendered in @p_node and re-render only
+    // the top-level blocks around them. Fall back to render() if that is not safe.
+    renderPatches(p_node, p_patches, p_finishCbStr) {
+        let lines = this.lines;
+        let canPatch = p_node == this.lastContainerNode && this.blocks != null;
+        let markers = [];
+        for (let i = 0; i < p_patches.length; ++i) {
+            let newLines = Utils.applyLinePatch(lines, p_patches[i]);
+            if (!newLines) {
+                // Keep current content and wait for the whole text.
+                console.error('Markdown text is out of sync with patches');
+                this.lines = null;
+                this.blocks = null;
+                this.renderedMarkers = [];
+                window.vxMarkdownAdapter.requestText();
+                this.finishWork();
+                this.markdownRenderFinished();
+                return;
+            }
+
+            if (canPatch) {
+                canPatch = this.renderPatch(p_node, lines, newLines, p_patches[i], markers);
+            }
+            lines = newLines;
+        }
+
+        if (!canPatch) {
+            this.render(p_node, lines.join('\n'), p_finishCbStr);
+            return;
+        }
+
+        this.lines = lines;
+        this.codeNodesStore.clearNodes();
+        this.codeNodesCollected = false;
+        this.renderedMarkers = markers;
+
+        p_node.insertAdjacentHTML('beforeend', this.loadedGuard(p_finishCbStr));
+
+        this.finishWork();
+    }
+
+    // Re-render the blocks covering @p_patch from @p_oldLines to @p_newLines.
+    // Markers of the new blocks will be appended to @p_markers.
+    // Return false without touching DOM if it could not be done locally.
+    renderPatch(p_node, p_oldLines, p_newLines, p_patch, p_markers) {
+        let blocks = this.blocks;
+        if (blocks.length == 0) {
+            return false;
+        }
+
+        // Changes that may affect the rendering of other blocks.
+        let changedLines = p_oldLines.slice(p_patch.startLine, p_patch.startLine + p_patch.removedCount);
+        if (MarkdownIt.hasContextLine(changedLines) || MarkdownIt.hasContextLine(p_patch.insertedLines)) {
+            return false;
+        }
+
+        // Include one more block at each side to cover lazy continuation lines and
+        // merged or split blocks.
+        let changeEnd = Math.max(p_patch.startLine, p_patch.startLine + p_patch.removedCount - 1);
+        let first = Math.max(this.findBlock(p_patch.startLine) - 1, 0);
+        let last = Math.min(Math.max(this.findBlock(changeEnd) + 1, first), blocks.length - 1);
+        for (let i = first; i <= last; ++i) {
+            if (blocks[i].type == 'front_matter') {
+                return false;
+            }
+        }
+
+        let delta = p_patch.insertedLines.length - p_patch.removedCount;
+        let regionStart = first == 0 ? 0 : blocks[first].start;
+        // Parse one more block after the region to make sure the region does not
+        // run into it, like list items merging into one list.
+        let hasProbe = last + 1 < blocks.length;
+        let probeStart = hasProbe ? blocks[last + 1].start + delta : -1;
+        let parseEnd = (last + 2 < blocks.length ? blocks[last + 2].start : p_oldLines.length) + delta;
+        let text = p_newLines.slice(regionStart, parseEnd).join('\n');
+        if (parseEnd < p_newLines.length) {
+            text += '\n';
+        }
+        if (/\[\[toc\]\]/i.test(text)) {
+            return false;
+        }
+
+        let beginMarker = blocks[first].marker;
+        let endMarker = last + 1 < blocks.length ? blocks[last + 1].marker : this.blockEndMarker;
+        if (beginMarker.parentNode !== p_node || endMarker.parentNode !== p_node) {
+            return false;
+        }
+
+        // Release header Ids of the old blocks and the probe block since they will
+        // be generated again.
+        let releaseEnd = last + 2 < blocks.length ? blocks[last + 2].marker : this.blockEndMarker;
+        for (let node = beginMarker; node && node !== releaseEnd; node = node.nextSibling) {
+            if (node.nodeType == Node.ELEMENT_NODE) {
+                MarkdownIt.forEachMatch(node, 'h1, h2, h3, h4, h5, h6', (p_heading) => {
+                    this.headerIds[0].delete(p_heading.id);
+                    this.headerIds[1].delete(p_heading.id);
+                });
+            }
+        }
+
+        let env = { references: this.env.references };
+        let frontMatterNode = this.frontMatterNode;
+        let tokens = this.mdit.parse(text, env);
+        this.frontMatterNode = frontMatterNode;
+
+        if (hasProbe) {
+            let probeIdx = tokens.findIndex((p_token) => {
+                return p_token.level == 0
+                       && p_token.nesting >= 0
+                       && p_token.map
+                       && p_token.map[0] + regionStart == probeStart;
+            });
+            if (probeIdx == -1) {
+                return false;
+            }
+            tokens = tokens.slice(0, probeIdx);
+        }
+
+        // Graphs are numbered through the whole document by their renderers.
+        for (let i = 0; i < tokens.length; ++i) {
+            if (tokens[i].type == 'fence'
+                && this.langsToSkipHighlight.has(tokens[i].info.trim().split(/\s+/)[0])) {
+                return false;
+            }
+        }
+
+        let marked = this.markBlocks(tokens, regionStart, false);
+        if (!marked.blocks || marked.blocks.length == 0 || env.footnotes) {
+            return false;
+        }
+
+        let template = document.createElement('template');
+        template.innerHTML = this.mdit.renderer.render(marked.tokens, this.mdit.options, env);
+        let fragment = template.content;
+        let markers = MarkdownIt.collectBlockMarkers(fragment);
+        if (markers.length != marked.blocks.length) {
+            return false;
+        }
+
+        // Source lines of the new nodes stay relative to the region, which is the line
+        // offset of the new blocks.
+        for (let i = 0; i < marked.blocks.length; ++i) {
+            MarkdownIt.attachBlockMarker(marked.blocks[i], markers[i]);
+            p_markers.push(markers[i]);
+        }
+
+        // Replace the old blocks.
+        let node = beginMarker;
+        while (node !== endMarker) {
+            let next = node.nextSibling;
+            p_node.removeChild(node);
+            node = next;
+        }
+        p_node.insertBefore(fragment, endMarker);
+
+        blocks.splice(first, last - first + 1, ...marked.blocks);
+        if (delta != 0) {
+            // Only the block records are shifted. Nodes are resolved via getSourceLine().
+            for (let i = first + marked.blocks.length; i < blocks.length; ++i) {
+                blocks[i].start += delta;
+                blocks[i].lineOffset += delta;
+            }
+        }
+
+        return true;
+    }
+
+    // Return the index of the last block starting at or before @p_line, or -1.
+    findBlock(p_line) {
+        let idx = -1;
+        let lo = 0;
+        let hi = this.blocks.length - 1;
+        while (lo <= hi) {
+            let mid = (lo + hi) >> 1;
+            if (this.blocks[mid].start <= p_line) {
+                idx = mid;
+                lo = mid + 1;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        return idx;
+    }
+
+    // Insert a marker token before each top-level block of @p_tokens parsed from line @p_lineOffset.
+    // Return { tokens, blocks }. blocks is null if some top-level block has no source map.
+    // Source lines rendered within a block are relative to its lineOffset.
+    markBlocks(p_tokens, p_lineOffset, p_endMarker) {
+        let Token = this.mdit.core.State.prototype.Token;
+        let tokens = [];
+        let blocks = [];
+        for (let i = 0; i < p_tokens.length; ++i) {
+            let token = p_tokens[i];
+            if (token.level == 0 && token.nesting >= 0) {
+                if (!token.map) {
+                    return { tokens: p_tokens, blocks: null };
+                }
+
+                tokens.push(new Token(MarkdownIt.blockMarkerType, '', 0));
+                blocks.push({ start: token.map[0] + p_lineOffset,
+                              lineOffset: p_lineOffset,
+                              type: token.type,
+                              marker: null });
+            }
+            tokens.push(token);
+        }
+
+        if (p_endMarker) {
+            tokens.push(new Token(MarkdownIt.blockMarkerType, '', 0));
+        }
+
+        return { tokens: tokens, blocks: blocks };
+    }
+
+    // Source line of @p_node with class source-line in the text rendered in the content container.
+    getSourceLine(p_node) {
+        let line = parseInt(p_node.getAttribute('data-source-line'));
+        if (!this.blocks) {
+            return line;
+        }
+
+        let top = p_node;
+        while (top && top.parentNode !== this.lastContainerNode) {
+            top = top.parentNode;
+        }
+
+        // The marker of the block is the nearest one before the top-level node.
+        for (let node = top; node; node = node.previousSibling) {
+            if (MarkdownIt.isBlockMarker(node)) {
+                return node.vxBlock ? line + node.vxBlock.lineOffset : line;
+            }
+        }
+        return line;
+    }
+
+    // Top-level nodes rendered by last round. Null if all nodes are rendered.
+    getRenderedNodes() {
+        if (!this.renderedMarkers) {
+            return null;
+        }
+
+        let nodes = [];
+        this.renderedMarkers.forEach((p_marker) => {
+            // Blocks may be replaced by later patches of the same round.
+            if (p_marker.parentNode !== this.lastContainerNode) {
+                return;
+            }
+
+            let node = p_marker.nextSibling;
+            while (node && !MarkdownIt.isBlockMarker(node)) {
+                if (node.nodeType == Node.ELEMENT_NODE) {
+                    nodes.push(node);
+                }
+                node = node.nextSibling;
+            }
+        });
+        return nodes;
+    }
+
+    // Get nodes with class @p_className in @p_node rendered by last round.
+    getRenderedNodesByClassName(p_node, p_className) {
+        let renderedNodes = p_node == this.lastContainerNode ? this.getRenderedNodes() : null;
+        if (!renderedNodes) {
+            return Array.from(p_node.getElementsByClassName(p_className));
+        }
+
+        let nodes = [];
+        renderedNodes.forEach((p_rendered) => {
+            MarkdownIt.forEachMatch(p_rendered, '.' + p_className, (p_match) => {
+                nodes.push(p_match);
+            });
+        });
+        return nodes;
+    }
+
+    // Call @p_func on @p_node and its descendants matching @p_selector.
+    static forEachMatch(p_node, p_selector, p_func) {
+        if (p_node.matches(p_selector)) {
+            p_func(p_node);
+        }
+        p_node.querySelectorAll(p_selector).forEach(p_func);
+    }
+
+    static isBlockMarker(p_node) {
+        return p_node.nodeType == Node.COMMENT_NODE && p_node.data == MarkdownIt.blockMarkerData;
+    }
+
+    // Return block markers among children of @p_parent in order.
+    static collectBlockMarkers(p_parent) {
+        let markers = [];
+        for (let node = p_parent.firstChild; node; node = node.nextSibling) {
+            if (MarkdownIt.isBlockMarker(node)) {
+                markers.push(node);
+            }
+        }
+        return markers;
+    }
+
+    static attachBlockMarker(p_block, p_marker) {
+        p_block.marker = p_marker;
+        p_marker.vxBlock = p_block;
+    }
+
+    // Whether @p_lines contain lines that may change the rendering of other blocks,
+    // such as fences, headings and definitions.
+    static hasContextLine(p_lines) {
+        let regExp = /^\s*(```|~~~|\$\$|:::)|^\s{0,3}(#{1,6}(\s|$)|(=+|-+)\s*$|\[[^\]]*\]:|<)|\[\[toc\]\]/i;
+        for (let i = 0; i < p_lines.length; ++i) {
+            if (regExp.test(p_lines[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     loadedGuard(p_cbStr) {
         if (!p_cbStr) {
             return '';
@@ -302,7 +663,18 @@ class MarkdownIt extends VxWorker {
 
     // Will be called when basic markdown is rendered.
     markdownRenderFinished() {
-        window.vxImageViewer.setupForAllImages(this.lastContainerNode);
+        let renderedNodes = this.getRenderedNodes();
+        if (renderedNodes) {
+            renderedNodes.forEach((p_node) => {
+                if (p_node.tagName.toLowerCase() == 'img') {
+                    window.vxImageViewer.setupIMGToView(p_node);
+                } else {
+                    window.vxImageViewer.setupForAllImages(p_node);
+                }
+            });
+        } else {
+            window.vxImageViewer.setupForAllImages(this.lastContainerNode);
+        }
         this.vnotex.setBasicMarkdownRendered();
     }
 
@@ -314,8 +686,18 @@ class MarkdownIt extends VxWorker {
         if (!this.codeNodesCollected) {
             // Collect code nodes.
             this.codeNodesCollected = true;
-            for (let i = 0; i < this.preNodes.length; ++i) {
-                this.codeNodesStore.addNode(this.preNodes[i].firstElementChild);
+            let preNodes = this.preNodes;
+            let renderedNodes = this.getRenderedNodes();
+            if (renderedNodes) {
+                preNodes = [];
+                renderedNodes.forEach((p_node) => {
+                    MarkdownIt.forEachMatch(p_node, 'pre', (p_pre) => {
+                        preNodes.push(p_pre);
+                    });
+                });
+            }
+            for (let i = 0; i < preNodes.length; ++i) {
+                this.codeNodesStore.addNode(preNodes[i].firstElementChild);
             }
         }
 
@@ -338,4 +720,8 @@ class MarkdownIt extends VxWorker {
     }
 }
 
+// Token type and comment data of block markers.
+MarkdownIt.blockMarkerType = 'vx_block_marker';
+MarkdownIt.blockMarkerData = 'vx-block';
+
 window.vnotex.registerWorker(new MarkdownIt(null));
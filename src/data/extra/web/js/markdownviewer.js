@@ -11,6 +11,19 @@ new QWebChannel(qt.webChannelTransport,
             window.vnotex.setMarkdownText(p_text);
         });
 
+        adapter.baseUrlChanged.connect(function(p_url) {
+            window.vnotex.setBaseUrl(p_url);
+        });
+
+        adapter.textPatched.connect(function(p_startLine, p_removedCount, p_insertedLines, p_lineCount) {
+            window.vnotex.patchMarkdownText({
+                startLine: p_startLine,
+                removedCount: p_removedCount,
+                insertedLines: p_insertedLines,
+                lineCount: p_lineCount
+            });
+        });
+
         adapter.editLineNumberUpdated.connect(function(p_lineNumber) {
             window.vnotex.scrollToLine(p_lineNumber);
         });
@@ -70,17 +70,18 @@ class MathJaxRenderer extends VxWorker {
         this.nodesToRender = [];
 
         // Transform extra class nodes.
-        let extraNodes = this.vnotex.getWorker('markdownit').getCodeNodes(this.langs);
+        let markdownIt = this.vnotex.getWorker('markdownit');
+        let extraNodes = markdownIt.getCodeNodes(this.langs);
         this.transformExtraNodes(p_node, p_className, extraNodes);
 
         // Collect nodes to render.
-        let nodes = p_node.getElementsByClassName(p_className);
+        let nodes = markdownIt.getRenderedNodesByClassName(p_node, p_className);
         if (nodes.length == 0) {
             this.finishWork();
             return;
         }
 
-        this.nodesToRender = Array.from(nodes);
+        this.nodesToRender = nodes;
 
         if (!this.initialize(() => {
             this.renderNodes();
@@ -38,6 +38,15 @@ class NodeLineMapper {
         }
     }
 
+    // Source lines of patched content are resolved by the renderer.
+    getSourceLine(p_node) {
+        let markdownIt = this.adapter.getWorker('markdownit');
+        if (markdownIt) {
+            return markdownIt.getSourceLine(p_node);
+        }
+        return parseInt(p_node.getAttribute(this.sourceLineAttributeName));
+    }
+
     getHeadingContent(p_node) {
         return p_node.textContent;
     }
@@ -132,7 +141,7 @@ class NodeLineMapper {
         let lastIdx = -1;
         while (left <= right) {
             let mid = Math.floor((left + right) / 2);
-            let lineNumber = parseInt(p_nodes[mid].getAttribute(this.sourceLineAttributeName));
+            let lineNumber = this.getSourceLine(p_nodes[mid]);
             if (lineNumber > p_lineNumber) {
                 right = mid - 1;
             } else if (lineNumber == p_lineNumber) {
@@ -184,7 +193,7 @@ class NodeLineMapper {
         let idx = this.binarySearchTopNode(this.nodesWithSourceLine);
         let lineNumber = -1;
         if (idx > -1) {
-            lineNumber = parseInt(this.nodesWithSourceLine[idx].getAttribute(this.sourceLineAttributeName));
+            lineNumber = this.getSourceLine(this.nodesWithSourceLine[idx]);
         }
 
         this.adapter.setTopLineNumber(lineNumber);
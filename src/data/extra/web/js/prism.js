@@ -58,8 +58,9 @@ class PrismRenderer extends VxWorker {
     renderCodeNodes(p_node) {
         this.initialize();
 
-        let codeNodes = this.vnotex.getWorker('markdownit').getCodeNodes(null);
-        this.doRender(p_node, codeNodes);
+        let markdownIt = this.vnotex.getWorker('markdownit');
+        let codeNodes = markdownIt.getCodeNodes(null);
+        this.doRender(p_node, codeNodes, markdownIt.getRenderedNodes());
     }
 
     // Whether has class lang- or language-.
@@ -74,7 +75,8 @@ class PrismRenderer extends VxWorker {
         return false;
     }
 
-    doRender(p_containerNode, p_nodes) {
+    // @p_roots: nodes to highlight under instead of @p_containerNode if not null.
+    doRender(p_containerNode, p_nodes, p_roots) {
         if (p_nodes.length > 0) {
             // Add `lang-txt` to code nodes without any class to let Prism catch them.
             for (let i = 0; i < p_nodes.length; ++i) {
@@ -85,7 +87,13 @@ class PrismRenderer extends VxWorker {
 
             p_containerNode.classList.add('line-numbers');
 
-            Prism.highlightAllUnder(p_containerNode, false /* async or not */);
+            if (p_roots) {
+                p_roots.forEach((p_root) => {
+                    Prism.highlightAllUnder(p_root, false /* async or not */);
+                });
+            } else {
+                Prism.highlightAllUnder(p_containerNode, false /* async or not */);
+            }
         }
 
         this.finishWork();
@@ -61,6 +61,19 @@ class Utils {
         return res;
     }
 
+    // Apply @p_patch { startLine, removedCount, insertedLines, lineCount } to @p_lines.
+    // Return the new lines, or null if @p_patch is not against @p_lines.
+    static applyLinePatch(p_lines, p_patch) {
+        if (!p_lines
+            || p_lines.length != p_patch.lineCount
+            || p_patch.startLine + p_patch.removedCount > p_lines.length) {
+            return null;
+        }
+
+        return p_lines.slice(0, p_patch.startLine).concat(p_patch.insertedLines,
+                                                          p_lines.slice(p_patch.startLine + p_patch.removedCount));
+    }
+
     // Check if @p_node contains source line info. If yes, add it to @p_newNode.
     static checkSourceLine(p_node, p_newNode) {
         if (p_node.classList.contains('source-line')) {
@@ -8,6 +8,7 @@
 
     Markdown scenario:
         - markdownTextUpdated(p_text)
+        - markdownTextPatched(p_patches)
         - basicMarkdownRendered()
         - fullMarkdownRendered()
 */
@@ -27,6 +28,8 @@ class VNoteX extends EventEmitter {
 
         this.pendingData = {
             text: null,
+            // Line patches against current text.
+            patches: [],
             lineNumber: -1,
             anchor: null
         }
@@ -75,6 +78,20 @@ class VNoteX extends EventEmitter {
             this.setBodySize(window.vxOptions.bodyWidth, window.vxOptions.bodyHeight);
             document.body.style.height = '800';
 
+            // With a base URL other than the page URL, in-page anchors would lead to
+            // another document.
+            document.addEventListener('click', (p_event) => {
+                let link = p_event.target.closest ? p_event.target.closest('a') : null;
+                if (!link) {
+                    return;
+                }
+                let href = link.getAttribute('href');
+                if (href && href.length > 1 && href[0] === '#') {
+                    p_event.preventDefault();
+                    this.nodeLineMapper.scrollToAnchor(decodeURIComponent(href.substring(1)));
+                }
+            });
+
             this.initialized = true;
 
             // Signal out.
@@ -113,8 +130,10 @@ class VNoteX extends EventEmitter {
             window.vxMarkdownAdapter.setWorkFinished();
 
             // Check pending work.
-            if (this.pendingData.text) {
+            if (this.pendingData.text !== null) {
                 this.setMarkdownText(this.pendingData.text);
+            } else if (this.pendingData.patches.length > 0) {
+                this.startPatchRound();
             } else if (this.pendingData.lineNumber > -1) {
                 this.scrollToLine(this.pendingData.lineNumber);
             }
@@ -136,7 +155,20 @@ class VNoteX extends EventEmitter {
         window.vxMarkdownAdapter.setReady(true);
     }
 
+    // Resolve relative URLs of the content against @p_url, so that a loaded page
+    // could show notes from different folders.
+    setBaseUrl(p_url) {
+        let base = document.getElementById('vx-base');
+        if (!base) {
+            base = document.createElement('base');
+            base.id = 'vx-base';
+            document.head.insertBefore(base, document.head.firstChild);
+        }
+        base.href = p_url;
+    }
+
     setMarkdownText(p_text) {
+        this.pendingData.patches = [];
         if (this.numOfOngoingWorkers > 0) {
             this.pendingData.text = p_text;
             console.info('wait for last render finish with remaing workers',
@@ -149,6 +181,37 @@ class VNoteX extends EventEmitter {
         }
     }
 
+    // @p_patch: { startLine, removedCount, insertedLines, lineCount }, replacing lines
+    // of the text set by last setMarkdownText() and patchMarkdownText().
+    patchMarkdownText(p_patch) {
+        if (this.pendingData.text !== null) {
+            let lines = Utils.applyLinePatch(this.pendingData.text.split('\n'), p_patch);
+            if (lines) {
+                this.pendingData.text = lines.join('\n');
+            } else {
+                console.error('pending Markdown text is out of sync with patches');
+                window.vxMarkdownAdapter.requestText();
+            }
+            return;
+        }
+
+        this.pendingData.patches.push(p_patch);
+        if (this.numOfOngoingWorkers > 0) {
+            console.info('wait for last render finish with remaing workers',
+                         this.numOfOngoingWorkers);
+        } else {
+            this.startPatchRound();
+        }
+    }
+
+    startPatchRound() {
+        let patches = this.pendingData.patches;
+        this.pendingData.patches = [];
+        this.numOfOngoingWorkers = this.workers.size;
+        console.log('start new round of ' + patches.length + ' patches with ' + this.numOfOngoingWorkers + ' workers');
+        this.emit('markdownTextPatched', patches);
+    }
+
     scrollToLine(p_lineNumber) {
         if (p_lineNumber < 0) {
             return;
@@ -18,10 +18,12 @@
 #include <core/vnotex.h>
 #include <core/logger.h>
 #include <widgets/mainwindow.h>
+#include <widgets/webresourceschemehandler.h>
 #include <QWebEngineSettings>
 #include <core/exception.h>
 #include <widgets/messageboxhelper.h>
 #include "commandlineoptions.h"
+#include "batchcommand.h"
 
 using namespace vnotex;
 
@@ -31,6 +33,12 @@ void initWebEngineSettings();
 
 void showMessageOnCommandLineIfAvailable(const QString &p_msg);
 
+void setApplicationInfo(QCoreApplication &p_app);
+
+int runBatchCommand(const CommandLineOptions &p_options);
+
+int runHeadless(int argc, char *argv[]);
+
 int main(int argc, char *argv[])
 {
     QTextCodec *codec = QTextCodec::codecForName("UTF8");
@@ -38,6 +46,11 @@ int main(int argc, char *argv[])
         QTextCodec::setCodecForLocale(codec);
     }
 
+    // Batch commands without GUI are run without QApplication and WebEngine.
+    if (CommandLineOptions::isHeadless(argc, argv)) {
+        return runHeadless(argc, argv);
+    }
+
     QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
 
     // This only takes effect on Win, X11 and Android.
@@ -68,6 +81,9 @@ int main(int argc, char *argv[])
     }
 #endif
 
+    // Custom schemes must be registered before QApplication.
+    WebResourceSchemeHandler::registerScheme();
+
     QApplication app(argc, argv);
 
     initWebEngineSettings();
@@ -77,10 +93,7 @@ int main(int argc, char *argv[])
         // Make sense only on Windows.
         app.setWindowIcon(QIcon(iconPath));
 
-        app.setApplicationName(ConfigMgr::c_appName);
-        app.setOrganizationName(ConfigMgr::c_orgName);
-
-        app.setApplicationVersion(ConfigMgr::getApplicationVersion());
+        setApplicationInfo(app);
     }
 
     CommandLineOptions cmdOptions;
@@ -107,6 +120,11 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (cmdOptions.hasBatchCommand()) {
+        // Batch commands needing GUI, such as exporting to HTML. Run without the main window.
+        return runBatchCommand(cmdOptions);
+    }
+
     // Guarding.
     SingleInstanceGuard guard;
     bool canRun = guard.tryRun();
@@ -130,6 +148,9 @@ int main(int argc, char *argv[])
     // Init logger after app info is set.
     Logger::init(cmdOptions.m_verbose);
 
+    // Viewers load template resources via it. Needs ConfigMgr.
+    WebResourceSchemeHandler::install();
+
     qInfo() << QString("%1 (v%2) started at %3 (%4)").arg(ConfigMgr::c_appName,
                                                           app.applicationVersion(),
                                                           QDateTime::currentDateTime().toString(),
@@ -178,6 +199,60 @@ int main(int argc, char *argv[])
     return ret;
 }
 
+void setApplicationInfo(QCoreApplication &p_app)
+{
+    p_app.setApplicationName(ConfigMgr::c_appName);
+    p_app.setOrganizationName(ConfigMgr::c_orgName);
+
+    p_app.setApplicationVersion(ConfigMgr::getApplicationVersion());
+}
+
+int runBatchCommand(const CommandLineOptions &p_options)
+{
+    // No need to guard since notebooks are opened standalone.
+    try {
+        ConfigMgr::getInst();
+    } catch (Exception &e) {
+        fprintf(stderr, "failed to initialize configuration manager (%s)\n", e.what());
+        return BatchCommand::Failed;
+    }
+
+    Logger::init(p_options.m_verbose);
+
+    BatchCommand cmd(p_options);
+    return cmd.run();
+}
+
+int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    setApplicationInfo(app);
+
+    CommandLineOptions cmdOptions;
+    switch (cmdOptions.parse(app.arguments())) {
+    case CommandLineOptions::Ok:
+        break;
+
+    case CommandLineOptions::Error:
+        // No WebEngine arguments to let go in headless mode.
+        fprintf(stderr, "%s\n", qPrintable(cmdOptions.m_errorMsg));
+        return BatchCommand::Failed;
+
+    case CommandLineOptions::VersionRequested:
+        fprintf(stdout, "%s %s\n", qPrintable(app.applicationName()), qPrintable(app.applicationVersion()));
+        return 0;
+
+    case CommandLineOptions::HelpRequested:
+        Q_FALLTHROUGH();
+    default:
+        fprintf(stdout, "%s\n", qPrintable(cmdOptions.m_helpText));
+        return 0;
+    }
+
+    Q_ASSERT(cmdOptions.hasBatchCommand());
+    return runBatchCommand(cmdOptions);
+}
+
 void loadTranslators(QApplication &p_app)
 {
     auto localeName = ConfigMgr::getInst().getCoreConfig().getLocale();
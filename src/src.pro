@@ -32,6 +32,7 @@ TRANSLATIONS += \
     data/core/translations/vnote_ja.ts
 
 SOURCES += \
+    batchcommand.cpp \
     commandlineoptions.cpp \
     main.cpp
 
@@ -144,4 +145,5 @@ unix:!macx {
 }
 
 HEADERS += \
+    batchcommand.h \
     commandlineoptions.h
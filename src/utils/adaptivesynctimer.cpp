@@ -0,0 +1,117 @@
+#include "adaptivesynctimer.h"
+
+#include <QTimer>
+
+using namespace vnotex;
+
+const int AdaptiveSyncTimer::c_costFactor = 2;
+
+const qint64 AdaptiveSyncTimer::c_maxInFlightTime = 5000;
+
+AdaptiveSyncTimer::AdaptiveSyncTimer(int p_minInterval, int p_maxInterval, QObject *p_parent)
+    : QObject(p_parent),
+      m_minInterval(p_minInterval),
+      m_maxInterval(p_maxInterval)
+{
+    Q_ASSERT(m_minInterval <= m_maxInterval);
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(m_minInterval);
+    connect(m_timer, &QTimer::timeout,
+            this, &AdaptiveSyncTimer::trigger);
+
+    // Deferred work may never report back, such as when its receiver is gone.
+    // Do not let it hold the pending request forever.
+    m_watchdogTimer = new QTimer(this);
+    m_watchdogTimer->setSingleShot(true);
+    m_watchdogTimer->setInterval(static_cast<int>(c_maxInFlightTime));
+    connect(m_watchdogTimer, &QTimer::timeout,
+            this, &AdaptiveSyncTimer::finish);
+}
+
+void AdaptiveSyncTimer::start()
+{
+    if (m_inFlight) {
+        m_pending = true;
+        return;
+    }
+
+    m_timer->start();
+}
+
+void AdaptiveSyncTimer::stop()
+{
+    m_pending = false;
+    m_timer->stop();
+}
+
+void AdaptiveSyncTimer::defer()
+{
+    if (m_triggering) {
+        m_deferred = true;
+    }
+}
+
+void AdaptiveSyncTimer::finish()
+{
+    if (!m_inFlight) {
+        return;
+    }
+
+    m_inFlight = false;
+    m_watchdogTimer->stop();
+
+    const auto cost = m_flightTimer.elapsed();
+    // Smooth it a bit so one outlier does not swing the interval.
+    m_cost = m_cost < 0 ? cost : (m_cost * 3 + cost) / 4;
+    updateInterval();
+
+    if (m_pending) {
+        m_pending = false;
+        m_timer->start();
+    }
+}
+
+void AdaptiveSyncTimer::reset()
+{
+    m_cost = -1;
+    updateInterval();
+}
+
+void AdaptiveSyncTimer::trigger()
+{
+    m_inFlight = true;
+    m_deferred = false;
+    m_flightTimer.start();
+
+    m_triggering = true;
+    emit timeout();
+    m_triggering = false;
+
+    if (!m_deferred) {
+        finish();
+    } else if (m_inFlight) {
+        m_watchdogTimer->start();
+    }
+}
+
+void AdaptiveSyncTimer::updateInterval()
+{
+    const auto interval = m_cost < 0 ? m_minInterval : m_cost * c_costFactor;
+    m_timer->setInterval(static_cast<int>(qBound<qint64>(m_minInterval, interval, m_maxInterval)));
+}
+
+int AdaptiveSyncTimer::interval() const
+{
+    return m_timer->interval();
+}
+
+qint64 AdaptiveSyncTimer::getCost() const
+{
+    return m_cost;
+}
+
+bool AdaptiveSyncTimer::isInFlight() const
+{
+    return m_inFlight;
+}
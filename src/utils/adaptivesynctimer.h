@@ -0,0 +1,85 @@
+#ifndef ADAPTIVESYNCTIMER_H
+#define ADAPTIVESYNCTIMER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+class QTimer;
+
+namespace vnotex
+{
+    // Debounce timer whose interval follows the cost of the work it triggers.
+    // Cost is the time from timeout() until the work finishes. Work is finished once
+    // timeout() returns unless one receiver calls defer(), in which case finish() must
+    // be called later. Requests coming in while work is in flight are merged into
+    // one, which is issued after the work finishes. Deferred work not finished within
+    // c_maxInFlightTime is finished by a watchdog.
+    class AdaptiveSyncTimer : public QObject
+    {
+        Q_OBJECT
+    public:
+        AdaptiveSyncTimer(int p_minInterval, int p_maxInterval, QObject *p_parent = nullptr);
+
+        // Request a sync.
+        void start();
+
+        // Drop pending request. Work in flight is not affected.
+        void stop();
+
+        // Called within timeout() to mark the work as asynchronous.
+        void defer();
+
+        // Mark the work in flight as finished.
+        void finish();
+
+        // Forget the measured cost, such as when the content is switched.
+        void reset();
+
+        int interval() const;
+
+        // Smoothed cost in milliseconds.
+        qint64 getCost() const;
+
+        bool isInFlight() const;
+
+    signals:
+        void timeout();
+
+    private:
+        void trigger();
+
+        void updateInterval();
+
+        // Managed by QObject.
+        QTimer *m_timer = nullptr;
+
+        // Managed by QObject.
+        QTimer *m_watchdogTimer = nullptr;
+
+        const int m_minInterval;
+
+        const int m_maxInterval;
+
+        qint64 m_cost = -1;
+
+        bool m_inFlight = false;
+
+        // Whether timeout() is being emitted.
+        bool m_triggering = false;
+
+        bool m_deferred = false;
+
+        // Whether there is a request during work in flight.
+        bool m_pending = false;
+
+        QElapsedTimer m_flightTimer;
+
+        // Interval is this times the cost.
+        static const int c_costFactor;
+
+        // Deferred work in flight longer than this is regarded as lost.
+        static const qint64 c_maxInFlightTime;
+    };
+}
+
+#endif // ADAPTIVESYNCTIMER_H
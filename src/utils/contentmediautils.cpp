@@ -8,6 +8,8 @@
 
 #include <notebookbackend/inotebookbackend.h>
 #include <notebook/node.h>
+#include <notebook/notebook.h>
+#include <notebook/mediastore.h>
 
 #include <buffer/filetypehelper.h>
 
@@ -20,6 +22,23 @@
 using namespace vnotex;
 
 void ContentMediaUtils::copyMediaFiles(Node *p_node,
+                                       INotebookBackend *p_backend,
+                                       const QString &p_destFilePath,
+                                       MediaStore *p_destStore)
+{
+    Q_ASSERT(p_node->hasContent());
+    auto file = p_node->getContentFile();
+    if (file->getContentType().isMarkdown()) {
+        copyMarkdownMediaFiles(file->read(),
+                               PathUtils::parentDirPath(file->getContentPath()),
+                               p_backend,
+                               p_destFilePath,
+                               p_destFilePath,
+                               p_destStore);
+    }
+}
+
+void ContentMediaUtils::moveMediaFiles(Node *p_node,
                                        INotebookBackend *p_backend,
                                        const QString &p_destFilePath)
 {
@@ -29,20 +48,26 @@ void ContentMediaUtils::copyMediaFiles(Node *p_node,
         copyMarkdownMediaFiles(file->read(),
                                PathUtils::parentDirPath(file->getContentPath()),
                                p_backend,
-                               p_destFilePath);
+                               p_destFilePath,
+                               file->getContentPath(),
+                               p_node->getNotebook()->getMediaStore(),
+                               true);
     }
 }
 
 void ContentMediaUtils::copyMediaFiles(const QString &p_filePath,
                                        INotebookBackend *p_backend,
-                                       const QString &p_destFilePath)
+                                       const QString &p_destFilePath,
+                                       MediaStore *p_destStore)
 {
     const auto &fileType = FileTypeHelper::getInst().getFileType(p_filePath);
     if (fileType.isMarkdown()) {
         copyMarkdownMediaFiles(FileUtils::readTextFile(p_filePath),
                                PathUtils::parentDirPath(p_filePath),
                                p_backend,
-                               p_destFilePath);
+                               p_destFilePath,
+                               p_destFilePath,
+                               p_destStore);
     }
 }
 
@@ -53,15 +78,21 @@ void ContentMediaUtils::copyMediaFiles(const File *p_file,
         copyMarkdownMediaFiles(p_file->read(),
                                p_file->getResourcePath(),
                                nullptr,
-                               p_destFilePath);
+                               p_destFilePath,
+                               p_destFilePath,
+                               nullptr);
     }
 }
 
 void ContentMediaUtils::copyMarkdownMediaFiles(const QString &p_content,
                                                const QString &p_basePath,
                                                INotebookBackend *p_backend,
-                                               const QString &p_destFilePath)
+                                               const QString &p_destFilePath,
+                                               const QString &p_outputFilePath,
+                                               MediaStore *p_destStore,
+                                               bool p_move)
 {
+    Q_ASSERT(!p_move || p_backend);
     auto content = p_content;
 
     // Images.
@@ -93,8 +124,32 @@ void ContentMediaUtils::copyMarkdownMediaFiles(const QString &p_content,
             continue;
         }
 
+        if (p_destStore && MediaStore::isBlobPath(link.m_path)) {
+            // Blobs are shared. Refer to it instead of copying.
+            auto blobPath = link.m_path;
+            if (!p_move) {
+                if (p_destStore->contains(blobPath)) {
+                    p_destStore->addRef(blobPath);
+                } else {
+                    blobPath = p_destStore->addFile(blobPath);
+                }
+            }
+
+            const auto newUrlInLink = destDir.relativeFilePath(blobPath);
+            if (newUrlInLink != link.m_urlInLink) {
+                content.replace(link.m_urlInLinkPos, link.m_urlInLink.size(), newUrlInLink);
+                renamedImages.insert(link.m_path, newUrlInLink);
+            }
+            continue;
+        }
+
         // Get the relative path of the image and apply it to the dest file path.
         const auto oldDestFilePath = destDir.filePath(link.m_urlInLink);
+        if (p_move && PathUtils::areSamePaths(link.m_path, oldDestFilePath)) {
+            // The link still resolves to the same image after move.
+            continue;
+        }
+
         destDir.mkpath(PathUtils::parentDirPath(oldDestFilePath));
         auto destFilePath = p_backend ? p_backend->renameIfExistsCaseInsensitive(oldDestFilePath)
                                       : FileUtils::renameIfExistsCaseInsensitive(oldDestFilePath);
@@ -114,7 +169,9 @@ void ContentMediaUtils::copyMarkdownMediaFiles(const QString &p_content,
             renamedImages.insert(link.m_path, newUrlInLink);
         }
 
-        if (p_backend) {
+        if (p_move) {
+            p_backend->moveFile(link.m_path, destFilePath);
+        } else if (p_backend) {
             p_backend->copyFile(link.m_path, destFilePath);
         } else {
             FileUtils::copyFile(link.m_path, destFilePath);
@@ -123,9 +180,9 @@ void ContentMediaUtils::copyMarkdownMediaFiles(const QString &p_content,
 
     if (!renamedImages.isEmpty()) {
         if (p_backend) {
-            p_backend->writeFile(p_destFilePath, content);
+            p_backend->writeFile(p_outputFilePath, content);
         } else {
-            FileUtils::writeFile(p_destFilePath, content);
+            FileUtils::writeFile(p_outputFilePath, content);
         }
     }
 }
@@ -135,11 +192,13 @@ void ContentMediaUtils::removeMediaFiles(Node *p_node)
     Q_ASSERT(p_node->hasContent());
     auto file = p_node->getContentFile();
     if (file->getContentType().isMarkdown()) {
-        removeMarkdownMediaFiles(file.data(), p_node->getBackend());
+        removeMarkdownMediaFiles(file.data(), p_node->getBackend(), p_node->getNotebook()->getMediaStore());
     }
 }
 
-void ContentMediaUtils::removeMarkdownMediaFiles(const File *p_file, INotebookBackend *p_backend)
+void ContentMediaUtils::removeMarkdownMediaFiles(const File *p_file,
+                                                 INotebookBackend *p_backend,
+                                                 MediaStore *p_store)
 {
     auto content = p_file->read();
 
@@ -161,6 +220,12 @@ void ContentMediaUtils::removeMarkdownMediaFiles(const File *p_file, INotebookBa
             qWarning() << "Image of Markdown file does not exist" << link.m_path << link.m_urlInLink;
             continue;
         }
+
+        if (p_store && p_store->contains(link.m_path)) {
+            p_store->release(link.m_path);
+            continue;
+        }
+
         p_backend->removeFile(link.m_path);
     }
 }
@@ -181,6 +246,17 @@ void ContentMediaUtils::copyAttachment(Node *p_node,
         FileUtils::copyDir(srcAttachmentFolderPath, p_destAttachmentFolderPath);
     }
 
+    fixAttachmentLinks(p_node, p_backend, p_destFilePath, p_destAttachmentFolderPath);
+}
+
+void ContentMediaUtils::fixAttachmentLinks(Node *p_node,
+                                           INotebookBackend *p_backend,
+                                           const QString &p_destFilePath,
+                                           const QString &p_destAttachmentFolderPath)
+{
+    Q_ASSERT(p_node->hasContent());
+    Q_ASSERT(!p_node->getAttachmentFolder().isEmpty());
+
     // Check if we need to modify links in content.
     // FIXME: check the whole relative path.
     if (p_node->getAttachmentFolder() == PathUtils::dirName(p_destAttachmentFolderPath)) {
@@ -189,7 +265,7 @@ void ContentMediaUtils::copyAttachment(Node *p_node,
 
     auto file = p_node->getContentFile();
     if (file->getContentType().isMarkdown()) {
-        fixMarkdownLinks(srcAttachmentFolderPath, p_backend, p_destFilePath, p_destAttachmentFolderPath);
+        fixMarkdownLinks(p_node->fetchAttachmentFolderPath(), p_backend, p_destFilePath, p_destAttachmentFolderPath);
     }
 }
 
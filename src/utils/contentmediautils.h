@@ -8,6 +8,7 @@ namespace vnotex
     class INotebookBackend;
     class Node;
     class File;
+    class MediaStore;
 
     // Utils to operate on the media files from node's content.
     class ContentMediaUtils
@@ -17,18 +18,28 @@ namespace vnotex
 
         // Fetch media files from @p_node and copy them to dest folder.
         // @p_destFilePath: @p_node has been copied to @p_destFilePath.
+        // @p_destStore: media store of the dest notebook. Blobs are referred instead of copied.
         static void copyMediaFiles(Node *p_node,
                                    INotebookBackend *p_backend,
-                                   const QString &p_destFilePath);
+                                   const QString &p_destFilePath,
+                                   MediaStore *p_destStore = nullptr);
 
         // @p_filePath: the file path to read the content for parse.
         static void copyMediaFiles(const QString &p_filePath,
                                    INotebookBackend *p_backend,
-                                   const QString &p_destFilePath);
+                                   const QString &p_destFilePath,
+                                   MediaStore *p_destStore = nullptr);
 
         static void copyMediaFiles(const File *p_file,
                                    const QString &p_destFilePath);
 
+        // Fetch media files from @p_node and move them along with the file.
+        // Should be called before @p_node's file is moved to @p_destFilePath.
+        // Links are updated in the source file if renaming happens.
+        static void moveMediaFiles(Node *p_node,
+                                   INotebookBackend *p_backend,
+                                   const QString &p_destFilePath);
+
         static void removeMediaFiles(Node *p_node);
 
         // Copy attachment folder.
@@ -37,13 +48,28 @@ namespace vnotex
                                    const QString &p_destFilePath,
                                    const QString &p_destAttachmentFolderPath);
 
+        // Update links to the attachment folder in @p_destFilePath, the copy of @p_node,
+        // once the folder is copied to @p_destAttachmentFolderPath.
+        // For callers copying the folder themselves.
+        static void fixAttachmentLinks(Node *p_node,
+                                       INotebookBackend *p_backend,
+                                       const QString &p_destFilePath,
+                                       const QString &p_destAttachmentFolderPath);
+
     private:
+        // @p_outputFilePath: where to write the content with updated links.
         static void copyMarkdownMediaFiles(const QString &p_content,
                                            const QString &p_basePath,
                                            INotebookBackend *p_backend,
-                                           const QString &p_destFilePath);
+                                           const QString &p_destFilePath,
+                                           const QString &p_outputFilePath,
+                                           MediaStore *p_destStore,
+                                           bool p_move = false);
 
-        static void removeMarkdownMediaFiles(const File *p_file, INotebookBackend *p_backend);
+        // Blobs of @p_store are released instead of removed.
+        static void removeMarkdownMediaFiles(const File *p_file,
+                                             INotebookBackend *p_backend,
+                                             MediaStore *p_store);
 
         // Fix local relative internal links locating in @p_srcFolderPath.
         static void fixMarkdownLinks(const QString &p_srcFolderPath,
@@ -1,15 +1,185 @@
 #include "fileutils.h"
 
 #include <QFile>
+#include <QSaveFile>
 #include <QMimeDatabase>
 #include <QDateTime>
 #include <QTemporaryFile>
+#include <QDirIterator>
+
+#if defined(Q_OS_UNIX)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
 
 #include "../core/exception.h"
 #include "pathutils.h"
 
 using namespace vnotex;
 
+static QAtomicInt s_copyMethodCounts[static_cast<int>(FileUtils::CopyMethod::MaxMethod)];
+
+#if defined(Q_OS_LINUX)
+// Whether @p_errno means the kernel or file system could not do this kind of copy,
+// so we should try the next method.
+static bool isCopyUnsupported(int p_errno)
+{
+    return p_errno == EXDEV
+           || p_errno == ENOSYS
+           || p_errno == EINVAL
+           || p_errno == EOPNOTSUPP
+           || p_errno == ENOTTY
+           || p_errno == EBADF
+           || p_errno == EPERM;
+}
+
+// Copy @p_filePath to @p_destPath in kernel.
+// Return MaxMethod if none of the fast paths is supported and nothing has been written.
+// Throw on I/O errors.
+static FileUtils::CopyMethod fastCopyFile(const QString &p_filePath, const QString &p_destPath)
+{
+    const auto srcPath = QFile::encodeName(p_filePath);
+    const auto destPath = QFile::encodeName(p_destPath);
+
+    int srcFd = ::open(srcPath.constData(), O_RDONLY | O_CLOEXEC);
+    if (srcFd < 0) {
+        return FileUtils::CopyMethod::MaxMethod;
+    }
+
+    struct stat st;
+    if (::fstat(srcFd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(srcFd);
+        return FileUtils::CopyMethod::MaxMethod;
+    }
+
+    // Fail if target exists, the same as QFile::copy().
+    int destFd = ::open(destPath.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 0777);
+    if (destFd < 0) {
+        ::close(srcFd);
+        return FileUtils::CopyMethod::MaxMethod;
+    }
+
+    auto method = FileUtils::CopyMethod::MaxMethod;
+    bool failed = false;
+    int err = 0;
+
+    // Some file systems report success while writing less, such as when copy_file_range(2)
+    // returns 0 early. Only trust a method if the target ends up as large as the source.
+    auto isComplete = [destFd, &st]() {
+        struct stat destSt;
+        return ::fstat(destFd, &destSt) == 0 && destSt.st_size == st.st_size;
+    };
+
+    // Drop what a method has written so that the next one starts over.
+    auto reset = [srcFd, destFd, &failed, &err]() {
+        if (::ftruncate(destFd, 0) != 0
+            || ::lseek(destFd, 0, SEEK_SET) != 0
+            || ::lseek(srcFd, 0, SEEK_SET) != 0) {
+            err = errno;
+            failed = true;
+        }
+    };
+
+#if defined(FICLONE)
+    if (::ioctl(destFd, FICLONE, srcFd) == 0) {
+        if (isComplete()) {
+            method = FileUtils::CopyMethod::Clone;
+        } else {
+            reset();
+        }
+    }
+#endif
+
+#if defined(SYS_copy_file_range)
+    if (method == FileUtils::CopyMethod::MaxMethod && !failed) {
+        off_t copied = 0;
+        while (copied < st.st_size) {
+            // Call via syscall() since glibc only wraps it since 2.27.
+            auto ret = ::syscall(SYS_copy_file_range, srcFd, nullptr, destFd, nullptr,
+                                 static_cast<size_t>(st.st_size - copied), 0u);
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                err = errno;
+                failed = copied > 0 || !isCopyUnsupported(err);
+                break;
+            } else if (ret == 0) {
+                // File shrinked or not supported by the file system.
+                break;
+            }
+
+            copied += ret;
+        }
+
+        // Nothing is written if it is not supported.
+        if (!failed) {
+            if (isComplete()) {
+                method = FileUtils::CopyMethod::CopyFileRange;
+            } else if (copied > 0) {
+                reset();
+            }
+        }
+    }
+#endif
+
+    if (method == FileUtils::CopyMethod::MaxMethod && !failed) {
+        off_t copied = 0;
+        while (copied < st.st_size) {
+            auto ret = ::sendfile(destFd, srcFd, &copied, static_cast<size_t>(st.st_size - copied));
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                err = errno;
+                failed = copied > 0 || !isCopyUnsupported(err);
+                break;
+            } else if (ret == 0) {
+                break;
+            }
+        }
+
+        // Leave a short copy to QFile::copy().
+        if (!failed && isComplete()) {
+            method = FileUtils::CopyMethod::SendFile;
+        }
+    }
+
+    ::close(srcFd);
+    if (::close(destFd) != 0 && !failed) {
+        err = errno;
+        failed = true;
+    }
+
+    if (method == FileUtils::CopyMethod::MaxMethod || failed) {
+        ::unlink(destPath.constData());
+        if (failed) {
+            Exception::throwOne(Exception::Type::FailToCopyFile,
+                                QString("failed to copy file: %1 %2 (%3)").arg(p_filePath,
+                                                                              p_destPath,
+                                                                              QString::fromLocal8Bit(::strerror(err))));
+        }
+
+        return FileUtils::CopyMethod::MaxMethod;
+    }
+
+    return method;
+}
+#endif
+
 QByteArray FileUtils::readFile(const QString &p_filePath)
 {
     QFile file(p_filePath);
@@ -59,6 +229,42 @@ void FileUtils::writeFile(const QString &p_filePath, const QString &p_text)
     file.close();
 }
 
+void FileUtils::writeFileAtomically(const QString &p_filePath, const QString &p_text)
+{
+    // QSaveFile syncs the temporary file to disk before renaming it on commit().
+    QSaveFile file(p_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        Exception::throwOne(Exception::Type::FailToWriteFile,
+                            QString("failed to write to file: %1").arg(p_filePath));
+    }
+
+    QTextStream stream(&file);
+    stream << p_text;
+    stream.flush();
+    if (stream.status() != QTextStream::Ok || !file.commit()) {
+        Exception::throwOne(Exception::Type::FailToWriteFile,
+                            QString("failed to commit file: %1 (%2)").arg(p_filePath, file.errorString()));
+    }
+}
+
+void FileUtils::appendFile(const QString &p_filePath, const QString &p_text)
+{
+    QFile file(p_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        Exception::throwOne(Exception::Type::FailToWriteFile,
+                            QString("failed to append to file: %1").arg(p_filePath));
+    }
+
+    QTextStream stream(&file);
+    stream << p_text;
+    stream.flush();
+    if (stream.status() != QTextStream::Ok) {
+        Exception::throwOne(Exception::Type::FailToWriteFile,
+                            QString("failed to append to file: %1 (%2)").arg(p_filePath, file.errorString()));
+    }
+    file.close();
+}
+
 void FileUtils::renameFile(const QString &p_path, const QString &p_name)
 {
     Q_ASSERT(PathUtils::isLegalFileName(p_name));
@@ -93,12 +299,12 @@ bool FileUtils::existsCaseInsensitive(const QString &p_path)
     return childExistsCaseInsensitive(PathUtils::parentDirPath(p_path), PathUtils::fileName(p_path));
 }
 
-void FileUtils::copyFile(const QString &p_filePath,
-                         const QString &p_destPath,
-                         bool p_move)
+FileUtils::CopyMethod FileUtils::copyFile(const QString &p_filePath,
+                                          const QString &p_destPath,
+                                          bool p_move)
 {
     if (PathUtils::areSamePaths(p_filePath, p_destPath)) {
-        return;
+        return p_move ? CopyMethod::Rename : CopyMethod::Plain;
     }
 
     QDir dir;
@@ -108,14 +314,26 @@ void FileUtils::copyFile(const QString &p_filePath,
     }
 
     bool failed = false;
+    auto method = CopyMethod::MaxMethod;
     if (p_move) {
         QFile file(p_filePath);
         if (!file.rename(p_destPath)) {
             failed = true;
         }
+        method = CopyMethod::Rename;
     } else {
-        if (!QFile::copy(p_filePath, p_destPath)) {
-            failed = true;
+#if defined(Q_OS_LINUX)
+        method = fastCopyFile(p_filePath, p_destPath);
+#endif
+        if (method == CopyMethod::MaxMethod) {
+            if (!QFile::copy(p_filePath, p_destPath)) {
+                failed = true;
+            } else if (QFileInfo(p_destPath).size() != QFileInfo(p_filePath).size()) {
+                // The last method. Do not leave a truncated copy behind.
+                QFile::remove(p_destPath);
+                failed = true;
+            }
+            method = CopyMethod::Plain;
         }
     }
 
@@ -123,6 +341,38 @@ void FileUtils::copyFile(const QString &p_filePath,
         Exception::throwOne(Exception::Type::FailToCopyFile,
                             QString("failed to copy file: %1 %2").arg(p_filePath, p_destPath));
     }
+
+    s_copyMethodCounts[static_cast<int>(method)].ref();
+    return method;
+}
+
+QString FileUtils::copyMethodToString(CopyMethod p_method)
+{
+    switch (p_method) {
+    case CopyMethod::Clone:
+        return QStringLiteral("clone");
+
+    case CopyMethod::CopyFileRange:
+        return QStringLiteral("copy_file_range");
+
+    case CopyMethod::SendFile:
+        return QStringLiteral("sendfile");
+
+    case CopyMethod::Plain:
+        return QStringLiteral("plain");
+
+    case CopyMethod::Rename:
+        return QStringLiteral("rename");
+
+    default:
+        return QString();
+    }
+}
+
+int FileUtils::getCopyMethodCount(CopyMethod p_method)
+{
+    Q_ASSERT(p_method < CopyMethod::MaxMethod);
+    return s_copyMethodCounts[static_cast<int>(p_method)].load();
 }
 
 void FileUtils::copyDir(const QString &p_dirPath,
@@ -138,7 +388,14 @@ void FileUtils::copyDir(const QString &p_dirPath,
                             QString("target directory %1 already exists").arg(p_destPath));
     }
 
-    // QDir.rename() could not move directory across dirves.
+    if (p_move) {
+        // A single rename moves the whole tree when on the same device.
+        // QDir::rename() does not fall back to copy, so it fails across devices.
+        QDir dir;
+        if (dir.mkpath(PathUtils::parentDirPath(p_destPath)) && dir.rename(p_dirPath, p_destPath)) {
+            return;
+        }
+    }
 
     // Create target directory.
     QDir destDir(p_destPath);
@@ -333,6 +590,19 @@ void FileUtils::removeEmptyDir(const QString &p_dirPath)
     }
 }
 
+qint64 FileUtils::dirSize(const QString &p_dirPath)
+{
+    qint64 size = 0;
+    QDirIterator it(p_dirPath,
+                    QDir::Files | QDir::Hidden | QDir::System | QDir::NoSymLinks,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        size += it.fileInfo().size();
+    }
+    return size;
+}
+
 QStringList FileUtils::entryListRecursively(const QString &p_dirPath, 
                                             const QStringList &p_nameFilters, 
                                             QDir::Filters p_filters)
@@ -351,3 +621,98 @@ QStringList FileUtils::entryListRecursively(const QString &p_dirPath,
     }
     return entrys;
 }
+
+static void sortNames(QStringList &p_names)
+{
+    std::sort(p_names.begin(), p_names.end(), [](const QString &p_a, const QString &p_b) {
+        return p_a.compare(p_b, Qt::CaseInsensitive) < 0;
+    });
+}
+
+FileUtils::DirEntries FileUtils::listDir(const QString &p_dirPath, bool p_fileSymLinks)
+{
+    DirEntries entries;
+
+#if defined(Q_OS_UNIX)
+    const auto encodedDirPath = QFile::encodeName(p_dirPath);
+    DIR *dir = ::opendir(encodedDirPath.constData());
+    if (!dir) {
+        return entries;
+    }
+
+    while (struct dirent *ent = ::readdir(dir)) {
+        const char *name = ent->d_name;
+        if (name[0] == '.') {
+            // Hidden, . and ..
+            continue;
+        }
+
+        bool isFolder = false;
+        bool isFile = false;
+        switch (ent->d_type) {
+        case DT_DIR:
+            isFolder = true;
+            break;
+
+        case DT_REG:
+            isFile = true;
+            break;
+
+        case DT_LNK:
+            Q_FALLTHROUGH();
+        case DT_UNKNOWN:
+        {
+            // Need to resolve it.
+            const auto fullPath = encodedDirPath + '/' + name;
+            struct stat st;
+            if (::lstat(fullPath.constData(), &st) != 0) {
+                break;
+            }
+
+            if (S_ISDIR(st.st_mode)) {
+                isFolder = true;
+                break;
+            }
+
+            if (S_ISLNK(st.st_mode)) {
+                // Links to folders are always skipped.
+                if (!p_fileSymLinks || ::stat(fullPath.constData(), &st) != 0) {
+                    break;
+                }
+            }
+
+            isFile = S_ISREG(st.st_mode);
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        if (isFolder) {
+            entries.m_folders << QFile::decodeName(name);
+        } else if (isFile) {
+            entries.m_files << QFile::decodeName(name);
+        }
+    }
+
+    ::closedir(dir);
+#else
+    QDirIterator it(p_dirPath, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        it.next();
+        const auto fi = it.fileInfo();
+        if (fi.isDir()) {
+            if (!fi.isSymLink()) {
+                entries.m_folders << fi.fileName();
+            }
+        } else if (fi.isFile() && (p_fileSymLinks || !fi.isSymLink())) {
+            entries.m_files << fi.fileName();
+        }
+    }
+#endif
+
+    sortNames(entries.m_folders);
+    sortNames(entries.m_files);
+    return entries;
+}
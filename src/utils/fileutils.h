@@ -14,6 +14,30 @@ namespace vnotex
     class FileUtils
     {
     public:
+        // Direct children of a directory.
+        struct DirEntries
+        {
+            QStringList m_folders;
+
+            QStringList m_files;
+        };
+
+        // How copyFile() transfers the data.
+        enum class CopyMethod
+        {
+            // ioctl(FICLONE). Extents are shared on copy-on-write file systems.
+            Clone = 0,
+            // copy_file_range(2). Copied in kernel, possibly offloaded.
+            CopyFileRange,
+            // sendfile(2). Copied in kernel.
+            SendFile,
+            // Copied in user space.
+            Plain,
+            // Moved via rename.
+            Rename,
+            MaxMethod
+        };
+
         FileUtils() = delete;
 
         static QByteArray readFile(const QString &p_filePath);
@@ -24,6 +48,13 @@ namespace vnotex
 
         static void writeFile(const QString &p_filePath, const QString &p_text);
 
+        // Write @p_text to a temporary file in the same folder, flush it to disk and
+        // rename it over @p_filePath, so that a crash never leaves a truncated file.
+        static void writeFileAtomically(const QString &p_filePath, const QString &p_text);
+
+        // Append @p_text to @p_filePath. Create it if not exists.
+        static void appendFile(const QString &p_filePath, const QString &p_text);
+
         // Rename file or dir.
         static void renameFile(const QString &p_path, const QString &p_name);
 
@@ -31,14 +62,21 @@ namespace vnotex
 
         static bool existsCaseInsensitive(const QString &p_path);
 
-        static void copyFile(const QString &p_filePath,
-                             const QString &p_destPath,
-                             bool p_move = false);
+        // Try the cheapest copy path first and fall back to a plain copy.
+        // Return the method used.
+        static CopyMethod copyFile(const QString &p_filePath,
+                                   const QString &p_destPath,
+                                   bool p_move = false);
 
         static void copyDir(const QString &p_dirPath,
                             const QString &p_destPath,
                             bool p_move = false);
 
+        static QString copyMethodToString(CopyMethod p_method);
+
+        // Number of files copied by @p_method so far.
+        static int getCopyMethodCount(CopyMethod p_method);
+
         static void removeFile(const QString &p_filePath);
 
         // Return false if it is not deleted due to non-empty.
@@ -77,6 +115,15 @@ namespace vnotex
         static QStringList entryListRecursively(const QString &p_dirPath,
                                                 const QStringList &p_nameFilters,
                                                 QDir::Filters filters=QDir::NoFilter);
+
+        // List direct children of @p_dirPath in one pass, classified into folders and files.
+        // Hidden entries and symbolic links to folders are skipped. Names are sorted case-insensitively.
+        // Works like entryList() with QDir::Dirs | QDir::NoSymLinks and QDir::Files but reads the directory once.
+        // @p_fileSymLinks: whether to include symbolic links to files.
+        static DirEntries listDir(const QString &p_dirPath, bool p_fileSymLinks = true);
+
+        // Total size in bytes of files under @p_dirPath recursively. Symbolic links are not followed.
+        static qint64 dirSize(const QString &p_dirPath);
     };
 } // ns vnotex
 
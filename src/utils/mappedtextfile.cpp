@@ -0,0 +1,252 @@
+#include "mappedtextfile.h"
+
+#include <algorithm>
+
+#include <QStringList>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+
+#include <string.h>
+
+using namespace vnotex;
+
+const int MappedTextFile::c_maxLinesPerPage = 20000;
+
+const int MappedTextFile::c_maxPageBytes = 4 * 1024 * 1024;
+
+MappedTextFile::MappedTextFile(const QString &p_filePath)
+    : m_filePath(p_filePath)
+{
+}
+
+MappedTextFile::~MappedTextFile()
+{
+    close();
+}
+
+bool MappedTextFile::open()
+{
+    close();
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "failed to open file" << m_filePath << file.errorString();
+        return false;
+    }
+
+    m_size = file.size();
+    m_modifiedTimeMsecs = QFileInfo(file).lastModified().toMSecsSinceEpoch();
+
+    // The map is only used to find line ends here.
+    const uchar *data = nullptr;
+    if (m_size > 0) {
+        data = file.map(0, m_size);
+        if (!data) {
+            qWarning() << "failed to map file" << m_filePath << file.errorString();
+            close();
+            return false;
+        }
+    }
+
+    buildIndex(data);
+
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+    }
+
+    m_opened = true;
+    return true;
+}
+
+void MappedTextFile::close()
+{
+    m_opened = false;
+    m_size = 0;
+    m_modifiedTimeMsecs = -1;
+    m_pageOffsets.clear();
+    m_pageFirstLines.clear();
+    m_pageLineStarts.clear();
+    m_lineCount = 0;
+}
+
+void MappedTextFile::addPage(qint64 p_offset, int p_firstLine, bool p_lineStart)
+{
+    m_pageOffsets.push_back(p_offset);
+    m_pageFirstLines.push_back(p_firstLine);
+    m_pageLineStarts.push_back(p_lineStart);
+}
+
+void MappedTextFile::buildIndex(const uchar *p_data)
+{
+    addPage(0, 0, true);
+
+    qint64 pageStart = 0;
+    int pageLines = 0;
+    int line = 0;
+    qint64 pos = 0;
+    while (pos < m_size) {
+        const auto nl = static_cast<const uchar *>(memchr(p_data + pos, '\n', m_size - pos));
+        // Line is [pos, lineEnd) including the '\n'.
+        const qint64 lineEnd = nl ? (nl - p_data) + 1 : m_size;
+
+        if (lineEnd - pageStart > c_maxPageBytes && pos > pageStart) {
+            addPage(pos, line, true);
+            pageStart = pos;
+            pageLines = 0;
+        }
+
+        // One line alone is too long. Cut it at a character boundary.
+        while (lineEnd - pageStart > c_maxPageBytes) {
+            qint64 cut = pageStart + c_maxPageBytes;
+            while (cut > pageStart + 1 && (p_data[cut] & 0xC0) == 0x80) {
+                --cut;
+            }
+
+            addPage(cut, line, false);
+            pageStart = cut;
+        }
+
+        pos = lineEnd;
+        if (nl) {
+            ++line;
+        }
+
+        if (++pageLines == c_maxLinesPerPage && pos < m_size) {
+            addPage(pos, line, true);
+            pageStart = pos;
+            pageLines = 0;
+        }
+    }
+
+    m_lineCount = line + 1;
+}
+
+qint64 MappedTextFile::size() const
+{
+    return m_size;
+}
+
+bool MappedTextFile::isStale() const
+{
+    QFileInfo info(m_filePath);
+    return !info.exists()
+           || info.size() != m_size
+           || info.lastModified().toMSecsSinceEpoch() != m_modifiedTimeMsecs;
+}
+
+int MappedTextFile::pageCount() const
+{
+    return m_pageOffsets.size();
+}
+
+int MappedTextFile::lineCount() const
+{
+    return m_lineCount;
+}
+
+int MappedTextFile::pageFirstLine(int p_page) const
+{
+    return m_pageFirstLines[p_page];
+}
+
+int MappedTextFile::pageOfLine(int p_lineNumber) const
+{
+    if (m_pageFirstLines.isEmpty()) {
+        return -1;
+    }
+
+    auto it = std::upper_bound(m_pageFirstLines.constBegin(), m_pageFirstLines.constEnd(), p_lineNumber);
+    int page = qMax(0, static_cast<int>(it - m_pageFirstLines.constBegin()) - 1);
+    // Go back to where the line starts if it is split across pages.
+    while (page > 0 && m_pageFirstLines[page] == p_lineNumber && !m_pageLineStarts[page]) {
+        --page;
+    }
+    return page;
+}
+
+qint64 MappedTextFile::pageBegin(int p_page) const
+{
+    return m_pageOffsets[p_page];
+}
+
+qint64 MappedTextFile::pageEnd(int p_page) const
+{
+    return p_page + 1 < m_pageOffsets.size() ? m_pageOffsets[p_page + 1] : m_size;
+}
+
+QString MappedTextFile::readPage(int p_page) const
+{
+    if (!m_opened || m_size == 0) {
+        return QString();
+    }
+
+    if (isStale()) {
+        qWarning() << "file changed on disk since indexed" << m_filePath;
+        return QString();
+    }
+
+    const auto begin = pageBegin(p_page);
+    auto end = pageEnd(p_page);
+    // The last page keeps the '\n' ending the file as an empty last line.
+    if (p_page + 1 < m_pageOffsets.size() && m_pageLineStarts[p_page + 1]) {
+        --end;
+    }
+
+    // Read instead of using a map, which raises SIGBUS if the file is truncated meanwhile.
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(begin)) {
+        qWarning() << "failed to read file" << m_filePath << file.errorString();
+        return QString();
+    }
+
+    const auto data = file.read(end - begin);
+    if (data.size() != end - begin) {
+        qWarning() << "file truncated on disk" << m_filePath;
+        return QString();
+    }
+
+    return QString::fromUtf8(data);
+}
+
+int MappedTextFile::findLine(int p_startLine,
+                             bool p_forward,
+                             const std::function<bool(const QString &)> &p_matcher) const
+{
+    const int cnt = pageCount();
+    if (cnt == 0) {
+        return -1;
+    }
+
+    p_startLine = qBound(0, p_startLine, m_lineCount - 1);
+    const int startPage = pageOfLine(p_startLine);
+
+    // The start page is visited twice: lines from the start line on first, and the rest after wrapping.
+    for (int step = 0; step <= cnt; ++step) {
+        const int page = p_forward ? (startPage + step) % cnt : (startPage - step + cnt) % cnt;
+        if (isStale()) {
+            return -1;
+        }
+
+        const auto lines = readPage(page).split(QLatin1Char('\n'));
+        const int firstLine = m_pageFirstLines[page];
+        for (int k = 0; k < lines.size(); ++k) {
+            const int idx = p_forward ? k : lines.size() - 1 - k;
+            const int line = firstLine + idx;
+            if (step == 0 && (p_forward ? line < p_startLine : line > p_startLine)) {
+                continue;
+            }
+
+            if (step == cnt && (p_forward ? line >= p_startLine : line <= p_startLine)) {
+                continue;
+            }
+
+            if (p_matcher(lines[idx])) {
+                return line;
+            }
+        }
+    }
+
+    return -1;
+}
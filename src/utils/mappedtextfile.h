@@ -0,0 +1,88 @@
+#ifndef MAPPEDTEXTFILE_H
+#define MAPPEDTEXTFILE_H
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+namespace vnotex
+{
+    // Read-only UTF-8 text file split into pages, so that only one page is decoded at a time.
+    // The file is mapped into memory only while open() indexes its pages. Pages are read
+    // from the file on demand, so a file truncated outside could not crash the reader.
+    // A page ends at a line boundary unless one line alone exceeds c_maxPageBytes.
+    // Pages are not read once the file is changed on disk. Call open() again to reindex it.
+    class MappedTextFile
+    {
+    public:
+        explicit MappedTextFile(const QString &p_filePath);
+
+        ~MappedTextFile();
+
+        // Index pages of the file. Reindex if already opened.
+        bool open();
+
+        void close();
+
+        qint64 size() const;
+
+        // Whether the file on disk differs from the indexed one in size or modified time.
+        bool isStale() const;
+
+        int pageCount() const;
+
+        // Line count as if the whole content were split by '\n'.
+        int lineCount() const;
+
+        // Zero-based number of the first line in @p_page.
+        int pageFirstLine(int p_page) const;
+
+        // Page where line @p_lineNumber starts.
+        int pageOfLine(int p_lineNumber) const;
+
+        // Content of @p_page without the '\n' ending it. Empty if stale or failed to read.
+        QString readPage(int p_page) const;
+
+        // Test lines one by one from @p_startLine, wrapping around at the ends.
+        // Return the first line @p_matcher accepts, or -1. Stop with -1 once stale.
+        // Pieces of a line split across pages are tested separately.
+        int findLine(int p_startLine,
+                     bool p_forward,
+                     const std::function<bool(const QString &)> &p_matcher) const;
+
+        static const int c_maxLinesPerPage;
+
+        static const int c_maxPageBytes;
+
+    private:
+        void buildIndex(const uchar *p_data);
+
+        void addPage(qint64 p_offset, int p_firstLine, bool p_lineStart);
+
+        // Byte range of @p_page.
+        qint64 pageBegin(int p_page) const;
+
+        qint64 pageEnd(int p_page) const;
+
+        QString m_filePath;
+
+        bool m_opened = false;
+
+        qint64 m_size = 0;
+
+        qint64 m_modifiedTimeMsecs = -1;
+
+        // Byte offset and first line of each page.
+        QVector<qint64> m_pageOffsets;
+
+        QVector<int> m_pageFirstLines;
+
+        // Whether each page starts at a line boundary.
+        QVector<bool> m_pageLineStarts;
+
+        int m_lineCount = 0;
+    };
+}
+
+#endif // MAPPEDTEXTFILE_H
@@ -0,0 +1,102 @@
+#include "textutils.h"
+
+using namespace vnotex;
+
+bool TextUtils::LinePatch::isEmpty() const
+{
+    return m_removedCount == 0 && m_insertedLines.isEmpty();
+}
+
+TextUtils::LinePatch TextUtils::diffLines(const QStringList &p_old, const QStringList &p_new)
+{
+    const int oldCnt = p_old.size();
+    const int newCnt = p_new.size();
+    const int minCnt = qMin(oldCnt, newCnt);
+
+    int prefix = 0;
+    while (prefix < minCnt && p_old[prefix] == p_new[prefix]) {
+        ++prefix;
+    }
+
+    int suffix = 0;
+    while (suffix < minCnt - prefix && p_old[oldCnt - 1 - suffix] == p_new[newCnt - 1 - suffix]) {
+        ++suffix;
+    }
+
+    LinePatch patch;
+    patch.m_startLine = prefix;
+    patch.m_removedCount = oldCnt - prefix - suffix;
+    patch.m_insertedLines = p_new.mid(prefix, newCnt - prefix - suffix);
+    return patch;
+}
+
+QString TextUtils::patchToString(const LinePatch &p_patch)
+{
+    const auto text = p_patch.m_insertedLines.join(QLatin1Char('\n'));
+    return QStringLiteral("@%1 %2 %3 %4\n").arg(QString::number(p_patch.m_startLine),
+                                                QString::number(p_patch.m_removedCount),
+                                                QString::number(p_patch.m_insertedLines.size()),
+                                                QString::number(text.size()))
+           + text + QLatin1Char('\n');
+}
+
+bool TextUtils::patchFromString(const QString &p_text, int &p_pos, LinePatch &p_patch)
+{
+    if (p_pos >= p_text.size() || p_text[p_pos] != QLatin1Char('@')) {
+        return false;
+    }
+
+    const int eol = p_text.indexOf(QLatin1Char('\n'), p_pos);
+    if (eol == -1) {
+        return false;
+    }
+
+    const auto fields = p_text.mid(p_pos + 1, eol - p_pos - 1).split(QLatin1Char(' '));
+    if (fields.size() != 4) {
+        return false;
+    }
+
+    int nums[4];
+    for (int i = 0; i < 4; ++i) {
+        bool ok = false;
+        nums[i] = fields[i].toInt(&ok);
+        if (!ok || nums[i] < 0) {
+            return false;
+        }
+    }
+
+    const int insertedCount = nums[2];
+    const int textStart = eol + 1;
+    const int textEnd = textStart + nums[3];
+    // The terminating new line tells a complete record from a truncated one.
+    if (textEnd >= p_text.size() || p_text[textEnd] != QLatin1Char('\n')) {
+        return false;
+    }
+
+    QStringList lines;
+    if (insertedCount > 0) {
+        lines = p_text.mid(textStart, nums[3]).split(QLatin1Char('\n'));
+        if (lines.size() != insertedCount) {
+            return false;
+        }
+    } else if (nums[3] > 0) {
+        return false;
+    }
+
+    p_patch.m_startLine = nums[0];
+    p_patch.m_removedCount = nums[1];
+    p_patch.m_insertedLines = lines;
+    p_pos = textEnd + 1;
+    return true;
+}
+
+void TextUtils::applyPatch(QStringList &p_lines, const LinePatch &p_patch)
+{
+    Q_ASSERT(p_patch.m_startLine + p_patch.m_removedCount <= p_lines.size());
+    QStringList lines;
+    lines.reserve(p_lines.size() - p_patch.m_removedCount + p_patch.m_insertedLines.size());
+    lines << p_lines.mid(0, p_patch.m_startLine)
+          << p_patch.m_insertedLines
+          << p_lines.mid(p_patch.m_startLine + p_patch.m_removedCount);
+    p_lines = lines;
+}
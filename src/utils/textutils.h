@@ -0,0 +1,42 @@
+#ifndef TEXTUTILS_H
+#define TEXTUTILS_H
+
+#include <QStringList>
+
+namespace vnotex
+{
+    class TextUtils
+    {
+    public:
+        // Lines [m_startLine, m_startLine + m_removedCount) of the old text are
+        // replaced with m_insertedLines.
+        struct LinePatch
+        {
+            bool isEmpty() const;
+
+            int m_startLine = 0;
+
+            int m_removedCount = 0;
+
+            QStringList m_insertedLines;
+        };
+
+        TextUtils() = delete;
+
+        // Return the single patch turning @p_old into @p_new by stripping the common
+        // leading and trailing lines.
+        static LinePatch diffLines(const QStringList &p_old, const QStringList &p_new);
+
+        static void applyPatch(QStringList &p_lines, const LinePatch &p_patch);
+
+        // Serialize @p_patch as one self-delimiting record:
+        // "@<startLine> <removedCount> <insertedCount> <length>\n<inserted lines joined by \n>\n".
+        static QString patchToString(const LinePatch &p_patch);
+
+        // Parse one record of patchToString() at @p_pos of @p_text and advance @p_pos past it.
+        // Return false if there is no complete record at @p_pos.
+        static bool patchFromString(const QString &p_text, int &p_pos, LinePatch &p_patch);
+    };
+}
+
+#endif // TEXTUTILS_H
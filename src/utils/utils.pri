@@ -6,6 +6,9 @@ SOURCES += \
     $$PWD/htmlutils.cpp \
     $$PWD/imageutils.cpp \
     $$PWD/pathutils.cpp \
+    $$PWD/textutils.cpp \
+    $$PWD/mappedtextfile.cpp \
+    $$PWD/adaptivesynctimer.cpp \
     $$PWD/processutils.cpp \
     $$PWD/urldragdroputils.cpp \
     $$PWD/utils.cpp \
@@ -21,6 +24,9 @@ HEADERS += \
     $$PWD/htmlutils.h \
     $$PWD/imageutils.h \
     $$PWD/pathutils.h \
+    $$PWD/textutils.h \
+    $$PWD/mappedtextfile.h \
+    $$PWD/adaptivesynctimer.h \
     $$PWD/processutils.h \
     $$PWD/urldragdroputils.h \
     $$PWD/utils.h \
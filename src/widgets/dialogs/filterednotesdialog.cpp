@@ -0,0 +1,158 @@
+#include "filterednotesdialog.h"
+
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QSpinBox>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QDateTime>
+#include <QLocale>
+
+#include <notebook/notebook.h>
+#include <notebook/nodemetadatatable.h>
+#include <core/vnotex.h>
+#include <core/fileopenparameters.h>
+#include "../widgetsfactory.h"
+
+using namespace vnotex;
+
+const int FilteredNotesDialog::c_maxResults = 500;
+
+FilteredNotesDialog::FilteredNotesDialog(Notebook *p_notebook, QWidget *p_parent)
+    : Dialog(p_parent),
+      m_notebook(p_notebook)
+{
+    Q_ASSERT(m_notebook);
+    setupUI();
+
+    // Table is built in background on first use.
+    connect(m_notebook->getNodeMetadataTable(), &NodeMetadataTable::built,
+            this, &FilteredNotesDialog::updateResults);
+
+    updateResults();
+}
+
+void FilteredNotesDialog::setupUI()
+{
+    auto mainWidget = new QWidget(this);
+    setCentralWidget(mainWidget);
+
+    auto mainLayout = new QVBoxLayout(mainWidget);
+
+    {
+        auto filterLayout = WidgetsFactory::createFormLayout();
+        mainLayout->addLayout(filterLayout);
+
+        m_daysSpinBox = WidgetsFactory::createSpinBox(mainWidget);
+        m_daysSpinBox->setRange(0, 36500);
+        m_daysSpinBox->setValue(7);
+        m_daysSpinBox->setSpecialValueText(tr("Any time"));
+        m_daysSpinBox->setSuffix(tr(" days"));
+        connect(m_daysSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+                this, &FilteredNotesDialog::updateResults);
+        filterLayout->addRow(tr("Modified within:"), m_daysSpinBox);
+
+        m_tagsLineEdit = WidgetsFactory::createLineEdit(mainWidget);
+        m_tagsLineEdit->setPlaceholderText(tr("Comma-separated tags all notes should have"));
+        connect(m_tagsLineEdit, &QLineEdit::editingFinished,
+                this, &FilteredNotesDialog::updateResults);
+        filterLayout->addRow(tr("Tags:"), m_tagsLineEdit);
+
+        auto sortLayout = new QHBoxLayout();
+        filterLayout->addRow(tr("Sort by:"), sortLayout);
+
+        m_sortComboBox = WidgetsFactory::createComboBox(mainWidget);
+        m_sortComboBox->addItem(tr("Modified Time"), static_cast<int>(NodeMetadataQuery::SortKey::ModifiedTime));
+        m_sortComboBox->addItem(tr("Created Time"), static_cast<int>(NodeMetadataQuery::SortKey::CreatedTime));
+        m_sortComboBox->addItem(tr("Size"), static_cast<int>(NodeMetadataQuery::SortKey::Size));
+        m_sortComboBox->addItem(tr("Name"), static_cast<int>(NodeMetadataQuery::SortKey::Name));
+        connect(m_sortComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                this, &FilteredNotesDialog::updateResults);
+        sortLayout->addWidget(m_sortComboBox, 1);
+
+        m_descendingCheckBox = WidgetsFactory::createCheckBox(tr("Descending"), mainWidget);
+        m_descendingCheckBox->setChecked(true);
+        connect(m_descendingCheckBox, &QCheckBox::stateChanged,
+                this, &FilteredNotesDialog::updateResults);
+        sortLayout->addWidget(m_descendingCheckBox);
+    }
+
+    m_resultTree = new QTreeWidget(mainWidget);
+    m_resultTree->setRootIsDecorated(false);
+    m_resultTree->setHeaderLabels(QStringList() << tr("Name") << tr("Path") << tr("Modified Time") << tr("Size") << tr("Tags"));
+    m_resultTree->header()->setStretchLastSection(true);
+    connect(m_resultTree, &QTreeWidget::itemActivated,
+            this, [this](QTreeWidgetItem *p_item) {
+                openNote(p_item->data(0, Qt::UserRole).toString());
+            });
+    mainLayout->addWidget(m_resultTree);
+
+    setDialogButtonBox(QDialogButtonBox::Close);
+
+    setWindowTitle(tr("Recent/Filtered Notes of %1").arg(m_notebook->getName()));
+}
+
+void FilteredNotesDialog::updateResults()
+{
+    auto table = m_notebook->getNodeMetadataTable();
+    if (!table->isBuilt()) {
+        setInformationText(tr("Indexing notes..."));
+        table->buildAsync();
+        return;
+    }
+
+    NodeMetadataQuery query;
+    const int days = m_daysSpinBox->value();
+    if (days > 0) {
+        query.m_modifiedAfterMsecs = QDateTime::currentDateTimeUtc().addDays(-days).toMSecsSinceEpoch();
+    }
+
+    const auto tags = m_tagsLineEdit->text().split(QLatin1Char(','), QString::SkipEmptyParts);
+    for (const auto &tag : tags) {
+        const auto trimmed = tag.trimmed();
+        if (!trimmed.isEmpty()) {
+            query.m_tags << trimmed;
+        }
+    }
+
+    query.m_sortKey = static_cast<NodeMetadataQuery::SortKey>(m_sortComboBox->currentData().toInt());
+    query.m_descending = m_descendingCheckBox->isChecked();
+    query.m_limit = c_maxResults;
+
+    const auto rows = table->query(query);
+
+    m_resultTree->clear();
+    QLocale locale;
+    for (int row : rows) {
+        const auto path = table->fetchPath(row);
+        auto item = new QTreeWidgetItem(m_resultTree);
+        item->setText(0, table->getName(row));
+        item->setData(0, Qt::UserRole, path);
+        item->setText(1, path);
+        item->setText(2, locale.toString(QDateTime::fromMSecsSinceEpoch(table->getModifiedTimeMsecs(row), Qt::UTC).toLocalTime(),
+                                         QLocale::ShortFormat));
+        item->setText(3, locale.formattedDataSize(table->getSize(row)));
+        item->setText(4, table->getTags(row).join(QStringLiteral(", ")));
+    }
+
+    for (int i = 0; i < m_resultTree->columnCount() - 1; ++i) {
+        m_resultTree->resizeColumnToContents(i);
+    }
+
+    setInformationText(tr("%n note(s) found", "", rows.size()));
+}
+
+void FilteredNotesDialog::openNote(const QString &p_path)
+{
+    auto node = m_notebook->loadNodeByPath(p_path);
+    if (!node) {
+        setInformationText(tr("Failed to locate note (%1)").arg(p_path), InformationLevel::Warning);
+        return;
+    }
+
+    emit VNoteX::getInst().openNodeRequested(node.data(), QSharedPointer<FileOpenParameters>::create());
+    accept();
+}
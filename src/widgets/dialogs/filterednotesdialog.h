@@ -0,0 +1,48 @@
+#ifndef FILTEREDNOTESDIALOG_H
+#define FILTEREDNOTESDIALOG_H
+
+#include "dialog.h"
+
+class QTreeWidget;
+class QSpinBox;
+class QLineEdit;
+class QComboBox;
+class QCheckBox;
+
+namespace vnotex
+{
+    class Notebook;
+
+    // List notes of a notebook filtered by modified time and tags, via its node metadata table.
+    class FilteredNotesDialog : public Dialog
+    {
+        Q_OBJECT
+    public:
+        FilteredNotesDialog(Notebook *p_notebook, QWidget *p_parent = nullptr);
+
+    private slots:
+        void updateResults();
+
+    private:
+        void setupUI();
+
+        void openNote(const QString &p_path);
+
+        Notebook *m_notebook = nullptr;
+
+        QSpinBox *m_daysSpinBox = nullptr;
+
+        QLineEdit *m_tagsLineEdit = nullptr;
+
+        QComboBox *m_sortComboBox = nullptr;
+
+        QCheckBox *m_descendingCheckBox = nullptr;
+
+        QTreeWidget *m_resultTree = nullptr;
+
+        // Max number of notes to list.
+        static const int c_maxResults;
+    };
+} // ns vnotex
+
+#endif // FILTEREDNOTESDIALOG_H
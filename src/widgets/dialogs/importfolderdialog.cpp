@@ -4,6 +4,7 @@
 #include <QFileInfo>
 #include <QVBoxLayout>
 #include <QLabel>
+#include <QProgressDialog>
 
 #include "folderfilesfilterwidget.h"
 #include "vnotex.h"
@@ -104,10 +105,19 @@ bool ImportFolderDialog::importFolder()
     }
 
     QString errMsg;
-    ImportFolderUtils::importFolderContents(nb,
-                                            m_newNode.data(),
-                                            m_filterWidget->getSuffixes(),
-                                            errMsg);
+    {
+        QProgressDialog proDlg(tr("Importing files..."), QString(), 0, 0, this);
+        proDlg.setWindowModality(Qt::WindowModal);
+        proDlg.setWindowTitle(tr("Import Folder"));
+        ImportFolderUtils::importFolderContents(nb,
+                                                m_newNode.data(),
+                                                m_filterWidget->getSuffixes(),
+                                                errMsg,
+                                                [&proDlg](int p_done, int p_total) {
+                                                    proDlg.setMaximum(p_total);
+                                                    proDlg.setValue(p_done);
+                                                });
+    }
 
     emit nb->nodeUpdated(m_parentNode);
 
@@ -1,51 +1,192 @@
 #include "importfolderutils.h"
 
+#include <QCoreApplication>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QElapsedTimer>
+#include <QVector>
+
 #include <notebook/notebook.h>
 #include <core/exception.h>
-#include <QCoreApplication>
+#include <utils/fileutils.h>
+#include <utils/pathutils.h>
 #include "legacynotebookutils.h"
 #include <utils/utils.h>
 
 using namespace vnotex;
 
-void ImportFolderUtils::importFolderContents(Notebook *p_notebook,
-                                             Node *p_node,
-                                             const QStringList &p_suffixes,
-                                             QString &p_errMsg)
+namespace
 {
-    auto rootDir = p_node->toDir();
-    auto children = rootDir.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks);
-    for (const auto &child : children) {
-        if (child.isDir()) {
-            if (p_notebook->isBuiltInFolder(p_node, child.fileName())) {
-                continue;
+    // Folder scanned from disk.
+    struct ScannedFolder
+    {
+        QString m_name;
+
+        QString m_path;
+
+        // Files matching the suffixes.
+        QStringList m_files;
+
+        QVector<ScannedFolder> m_folders;
+    };
+
+    // Scan a folder tree in thread pool.
+    class FolderScanner : public QRunnable
+    {
+    public:
+        FolderScanner(ScannedFolder *p_folder, const QStringList &p_suffixes)
+            : m_folder(p_folder),
+              m_suffixes(p_suffixes)
+        {
+        }
+
+        void run() Q_DECL_OVERRIDE
+        {
+            scan(*m_folder, m_suffixes, true);
+        }
+
+        // Scan @p_folder, whose m_path is set.
+        static void scan(ScannedFolder &p_folder, const QStringList &p_suffixes, bool p_recursive)
+        {
+            // Like the per-entry import, links are not followed.
+            const auto entries = FileUtils::listDir(p_folder.m_path, false);
+
+            p_folder.m_folders.resize(entries.m_folders.size());
+            for (int i = 0; i < entries.m_folders.size(); ++i) {
+                auto &folder = p_folder.m_folders[i];
+                folder.m_name = entries.m_folders[i];
+                folder.m_path = PathUtils::concatenateFilePath(p_folder.m_path, folder.m_name);
+                if (p_recursive) {
+                    scan(folder, p_suffixes, true);
+                }
+            }
+
+            for (const auto &file : entries.m_files) {
+                const int idx = file.lastIndexOf(QLatin1Char('.'));
+                if (idx != -1 && p_suffixes.contains(file.mid(idx + 1))) {
+                    p_folder.m_files << file;
+                }
             }
+        }
+
+    private:
+        ScannedFolder *m_folder = nullptr;
+
+        QStringList m_suffixes;
+    };
+}
+
+static int countEntries(const ScannedFolder &p_folder)
+{
+    int cnt = p_folder.m_files.size() + p_folder.m_folders.size();
+    for (const auto &folder : p_folder.m_folders) {
+        cnt += countEntries(folder);
+    }
+    return cnt;
+}
+
+static void addScannedFolder(Notebook *p_notebook,
+                             Node *p_node,
+                             const ScannedFolder &p_folder,
+                             int p_total,
+                             int &p_done,
+                             QString &p_errMsg,
+                             const ImportFolderUtils::ProgressCallback &p_progress)
+{
+    const int c_progressStep = 100;
 
-            QSharedPointer<Node> node;
+    for (const auto &folder : p_folder.m_folders) {
+        if (p_notebook->isBuiltInFolder(p_node, folder.m_name)) {
+            p_done += countEntries(folder) + 1;
+            continue;
+        }
+
+        QSharedPointer<Node> node;
+        try {
+            node = p_notebook->addAsNode(p_node, Node::Flag::Container, folder.m_name, NodeParameters());
+        } catch (Exception &p_e) {
+            Utils::appendMsg(p_errMsg, ImportFolderUtilsTranslate::tr("Failed to add folder (%1) as node (%2).").arg(folder.m_name, p_e.what()));
+            p_done += countEntries(folder) + 1;
+            continue;
+        }
+
+        if (p_progress && (++p_done % c_progressStep == 0)) {
+            p_progress(p_done, p_total);
+        }
+
+        addScannedFolder(p_notebook, node.data(), folder, p_total, p_done, p_errMsg, p_progress);
+    }
+
+    for (const auto &file : p_folder.m_files) {
+        if (!p_notebook->isBuiltInFile(p_node, file)) {
             try {
-                node = p_notebook->addAsNode(p_node, Node::Flag::Container, child.fileName(), NodeParameters());
+                p_notebook->addAsNode(p_node, Node::Flag::Content, file, NodeParameters());
             } catch (Exception &p_e) {
-                Utils::appendMsg(p_errMsg, ImportFolderUtilsTranslate::tr("Failed to add folder (%1) as node (%2).").arg(child.fileName(), p_e.what()));
-                continue;
+                Utils::appendMsg(p_errMsg, ImportFolderUtilsTranslate::tr("Failed to add file (%1) as node (%2).").arg(PathUtils::concatenateFilePath(p_folder.m_path, file), p_e.what()));
             }
+        }
 
-            importFolderContents(p_notebook, node.data(), p_suffixes, p_errMsg);
-        } else if (!p_notebook->isBuiltInFile(p_node, child.fileName())) {
-            if (p_suffixes.contains(child.suffix())) {
-                try {
-                    p_notebook->addAsNode(p_node, Node::Flag::Content, child.fileName(), NodeParameters());
-                } catch (Exception &p_e) {
-                    Utils::appendMsg(p_errMsg, ImportFolderUtilsTranslate::tr("Failed to add file (%1) as node (%2).").arg(child.filePath(), p_e.what()));
-                }
+        if (p_progress && (++p_done % c_progressStep == 0)) {
+            p_progress(p_done, p_total);
+        }
+    }
+}
+
+void ImportFolderUtils::importFolderContents(Notebook *p_notebook,
+                                             Node *p_node,
+                                             const QStringList &p_suffixes,
+                                             QString &p_errMsg,
+                                             const ProgressCallback &p_progress)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Scan the first level and then scan each sub-folder in parallel.
+    ScannedFolder root;
+    root.m_path = p_node->fetchAbsolutePath();
+    FolderScanner::scan(root, p_suffixes, false);
+
+    {
+        QThreadPool pool;
+        for (int i = 0; i < root.m_folders.size(); ++i) {
+            if (p_notebook->isBuiltInFolder(p_node, root.m_folders[i].m_name)) {
+                continue;
             }
+
+            pool.start(new FolderScanner(root.m_folders.data() + i, p_suffixes));
         }
+        pool.waitForDone();
     }
+
+    const int total = countEntries(root);
+    const auto scanTime = timer.elapsed();
+
+    int done = 0;
+    {
+        Notebook::BulkUpdateScope bulkUpdate(p_notebook);
+        addScannedFolder(p_notebook, p_node, root, total, done, p_errMsg, p_progress);
+    }
+
+    if (p_progress) {
+        p_progress(total, total);
+    }
+
+    const auto totalTime = qMax<qint64>(timer.elapsed(), 1);
+    qInfo() << QString("imported %1 entries under %2 in %3 ms (scan %4 ms, %5 entries/s)")
+                      .arg(QString::number(total),
+                           p_node->fetchAbsolutePath(),
+                           QString::number(totalTime),
+                           QString::number(scanTime),
+                           QString::number(static_cast<qint64>(total) * 1000 / totalTime));
 }
 
 void ImportFolderUtils::importFolderContentsByLegacyConfig(Notebook *p_notebook,
                                                            Node *p_node,
                                                            QString &p_errMsg)
 {
+    // Write config of @p_node once after all its children are added.
+    Notebook::BulkUpdateScope bulkUpdate(p_notebook);
+
     auto rootDir = p_node->toDir();
 
     const auto config = LegacyNotebookUtils::getFolderConfig(rootDir.absolutePath());
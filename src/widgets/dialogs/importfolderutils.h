@@ -5,6 +5,8 @@
 
 #include <QStringList>
 
+#include <functional>
+
 namespace vnotex
 {
     class Notebook;
@@ -21,12 +23,18 @@ namespace vnotex
     public:
         ImportFolderUtils() = delete;
 
+        // Called with the number of processed entries and the total number.
+        typedef std::function<void(int p_done, int p_total)> ProgressCallback;
+
         // Process folder @p_node.
         // @p_node has already been added.
+        // The folder tree is scanned in parallel first, then all the nodes are added in bulk
+        // and config of each folder is written once.
         static void importFolderContents(Notebook *p_notebook,
                                          Node *p_node,
                                          const QStringList &p_suffixes,
-                                         QString &p_errMsg);
+                                         QString &p_errMsg,
+                                         const ProgressCallback &p_progress = ProgressCallback());
 
         // Process folder @p_node by legacy notebook config.
         // @p_node has already been added.
@@ -7,6 +7,7 @@
 #include <utils/pathutils.h>
 #include <utils/utils.h>
 #include <utils/fileutils.h>
+#include <notebookbackend/asyncnotebookbackend.h>
 #include "vnotex.h"
 #include "notebookmgr.h"
 #include "legacynotebookutils.h"
@@ -117,7 +118,9 @@ bool ImportLegacyNotebookDialog::importLegacyNotebook()
             if (PathUtils::isEmptyDir(binFolderPath)) {
                 FileUtils::removeDir(binFolderPath);
             } else {
-                nb->moveDirToRecycleBin(binFolderPath);
+                // Import below scans the root folder, so it must be gone by then.
+                const auto id = nb->moveDirToRecycleBin(binFolderPath);
+                nb->getAsyncBackend()->wait(id);
             }
         }
     }
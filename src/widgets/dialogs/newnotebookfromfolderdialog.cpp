@@ -3,6 +3,7 @@
 #include <QLineEdit>
 #include <QVBoxLayout>
 #include <QGroupBox>
+#include <QProgressDialog>
 
 #include "../widgetsfactory.h"
 #include "folderfilesfilterwidget.h"
@@ -151,7 +152,19 @@ bool NewNotebookFromFolderDialog::newNotebookFromFolder()
 
     QString errMsg;
     auto rootNode = nb->getRootNode();
-    ImportFolderUtils::importFolderContents(nb.data(), rootNode.data(), m_filterWidget->getSuffixes(), errMsg);
+    {
+        QProgressDialog proDlg(tr("Importing files..."), QString(), 0, 0, this);
+        proDlg.setWindowModality(Qt::WindowModal);
+        proDlg.setWindowTitle(tr("Import Folder"));
+        ImportFolderUtils::importFolderContents(nb.data(),
+                                                rootNode.data(),
+                                                m_filterWidget->getSuffixes(),
+                                                errMsg,
+                                                [&proDlg](int p_done, int p_total) {
+                                                    proDlg.setMaximum(p_total);
+                                                    proDlg.setValue(p_done);
+                                                });
+    }
 
     emit nb->nodeUpdated(rootNode.data());
 
@@ -76,7 +76,8 @@ void MarkdownViewer::setPreviewHelper(PreviewHelper *p_previewHelper)
                 if (m_adapter->isViewerReady()) {
                     m_adapter->graphPreviewRequested(p_id, p_timeStamp, p_lang, p_text);
                 } else {
-                    p_previewHelper->handleGraphPreviewData(MarkdownViewerAdapter::PreviewData());
+                    // Reply with empty data to close the round.
+                    p_previewHelper->handleGraphPreviewData(MarkdownViewerAdapter::PreviewData(p_id, p_timeStamp, QString(), QByteArray(), false));
                 }
             });
     connect(p_previewHelper, &PreviewHelper::mathPreviewRequested,
@@ -86,7 +87,7 @@ void MarkdownViewer::setPreviewHelper(PreviewHelper *p_previewHelper)
                 if (m_adapter->isViewerReady()) {
                     m_adapter->mathPreviewRequested(p_id, p_timeStamp, p_text);
                 } else {
-                    p_previewHelper->handleMathPreviewData(MarkdownViewerAdapter::PreviewData());
+                    p_previewHelper->handleMathPreviewData(MarkdownViewerAdapter::PreviewData(p_id, p_timeStamp, QString(), QByteArray(), false));
                 }
             });
     connect(m_adapter, &MarkdownViewerAdapter::graphPreviewDataReady,
@@ -259,7 +260,8 @@ void MarkdownViewer::handleClipboardChanged(QClipboard::Mode p_mode)
     if (clipboard->property(c_propertyCrossCopy).toBool()) {
         clipboard->setProperty(c_propertyCrossCopy, false);
         if (mimeData->hasHtml() && !mimeData->hasImage() && !m_crossCopyTarget.isEmpty()) {
-            crossCopy(m_crossCopyTarget, url().toString(), mimeData->html());
+            const auto &baseUrl = m_adapter->getBaseUrl();
+            crossCopy(m_crossCopyTarget, baseUrl.isEmpty() ? url().toString() : baseUrl, mimeData->html());
         }
     }
 }
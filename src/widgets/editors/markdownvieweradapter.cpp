@@ -3,12 +3,16 @@
 #include <QDebug>
 #include <QMap>
 
+#include <utils/textutils.h>
+
 #include "../outlineprovider.h"
 #include "plantumlhelper.h"
 #include "graphvizhelper.h"
 
 using namespace vnotex;
 
+const int MarkdownViewerAdapter::c_minLinesToPatch = 200;
+
 MarkdownViewerAdapter::MarkdownData::MarkdownData(const QString &p_text,
                                                   int p_lineNumber,
                                                   const QString &p_anchor)
@@ -89,7 +93,7 @@ void MarkdownViewerAdapter::setText(int p_revision,
 
     m_revision = p_revision;
     if (m_viewerReady) {
-        emit textUpdated(p_text);
+        sendText(p_text, true);
         scrollToPosition(Position(p_lineNumber, ""));
     } else {
         m_pendingData.reset(new MarkdownData(p_text, p_lineNumber, ""));
@@ -100,7 +104,7 @@ void MarkdownViewerAdapter::setText(const QString &p_text)
 {
     m_revision = 0;
     if (m_viewerReady) {
-        emit textUpdated(p_text);
+        sendText(p_text, false);
     } else {
         m_pendingData.reset(new MarkdownData(p_text, -1, ""));
     }
@@ -114,8 +118,12 @@ void MarkdownViewerAdapter::setReady(bool p_ready)
 
     m_viewerReady = p_ready;
     if (m_viewerReady) {
+        if (!m_baseUrl.isEmpty()) {
+            emit baseUrlChanged(m_baseUrl);
+        }
+
         if (m_pendingData) {
-            emit textUpdated(m_pendingData->m_text);
+            sendText(m_pendingData->m_text, false);
             scrollToPosition(m_pendingData->m_position);
             m_pendingData.reset();
         }
@@ -125,6 +133,36 @@ void MarkdownViewerAdapter::setReady(bool p_ready)
 
 }
 
+void MarkdownViewerAdapter::requestText()
+{
+    qWarning() << "Markdown viewer requested the whole text" << m_lines.size();
+    emit textUpdated(m_lines.join(QLatin1Char('\n')));
+}
+
+void MarkdownViewerAdapter::sendText(const QString &p_text, bool p_allowPatch)
+{
+    auto lines = p_text.split(QLatin1Char('\n'));
+    if (p_allowPatch && m_lines.size() >= c_minLinesToPatch && lines.size() >= c_minLinesToPatch) {
+        const auto patch = TextUtils::diffLines(m_lines, lines);
+        // Web side re-renders only the blocks around the patch, which pays off
+        // while the patch is small compared to the text.
+        if (patch.m_removedCount + patch.m_insertedLines.size() <= lines.size() / 2) {
+            if (!patch.isEmpty()) {
+                const int lineCount = m_lines.size();
+                m_lines = lines;
+                emit textPatched(patch.m_startLine, patch.m_removedCount, patch.m_insertedLines, lineCount);
+            } else {
+                // Nothing to render. Close the round as web side would do.
+                emit workFinished();
+            }
+            return;
+        }
+    }
+
+    m_lines = lines;
+    emit textUpdated(p_text);
+}
+
 void MarkdownViewerAdapter::scrollToLine(int p_lineNumber)
 {
     if (p_lineNumber == -1) {
@@ -365,13 +403,32 @@ void MarkdownViewerAdapter::setSavedContent(const QString &p_headContent,
 
 void MarkdownViewerAdapter::reset()
 {
-    m_revision = 0;
+    resetText();
     m_viewerReady = false;
+    m_crossCopyTargets.clear();
+}
+
+void MarkdownViewerAdapter::resetText()
+{
+    m_revision = 0;
     m_pendingData.reset();
+    m_lines.clear();
     m_topLineNumber = -1;
     m_headings.clear();
     m_currentHeadingIndex = -1;
-    m_crossCopyTargets.clear();
+}
+
+void MarkdownViewerAdapter::setBaseUrl(const QUrl &p_url)
+{
+    m_baseUrl = p_url.toString();
+    if (m_viewerReady) {
+        emit baseUrlChanged(m_baseUrl);
+    }
+}
+
+const QString &MarkdownViewerAdapter::getBaseUrl() const
+{
+    return m_baseUrl;
 }
 
 void MarkdownViewerAdapter::renderGraph(quint64 p_id,
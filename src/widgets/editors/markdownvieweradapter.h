@@ -6,6 +6,7 @@
 #include <QJsonObject>
 #include <QScopedPointer>
 #include <QJsonArray>
+#include <QUrl>
 
 #include <core/global.h>
 
@@ -126,10 +127,23 @@ namespace vnotex
         // Should be called before WebViewer.setHtml().
         void reset();
 
+        // Forget the text web side holds while keeping the loaded page, so that next text
+        // is sent as a whole.
+        void resetText();
+
+        // Resolve relative URLs of the content against @p_url instead of the URL of the page.
+        void setBaseUrl(const QUrl &p_url);
+
+        // Empty if not set.
+        const QString &getBaseUrl() const;
+
         // Functions to be called from web side.
     public slots:
         void setReady(bool p_ready);
 
+        // Web side failed to apply a patch and needs the whole text.
+        void requestText();
+
         void setWorkFinished();
 
         // The line number at the top.
@@ -184,6 +198,17 @@ namespace vnotex
         // Current Markdown text is updated.
         void textUpdated(const QString &p_text);
 
+        // Base URL of the content is changed.
+        void baseUrlChanged(const QString &p_url);
+
+        // Lines [@p_startLine, @p_startLine + @p_removedCount) of current Markdown text
+        // are replaced with @p_insertedLines.
+        // @p_lineCount: number of lines before patching, to detect out-of-sync.
+        void textPatched(int p_startLine,
+                         int p_removedCount,
+                         const QStringList &p_insertedLines,
+                         int p_lineCount);
+
         // Current editor line number is updated.
         void editLineNumberUpdated(int p_lineNumber);
 
@@ -255,8 +280,14 @@ namespace vnotex
 
         void scrollToAnchor(const QString &p_anchor);
 
+        // Send @p_text to web side, as a patch against last text if @p_allowPatch.
+        void sendText(const QString &p_text, bool p_allowPatch);
+
         int m_revision = 0;
 
+        // Lines of the text web side holds. Empty if web side holds nothing.
+        QStringList m_lines;
+
         // Whether web side viewer is ready to handle text update.
         bool m_viewerReady = false;
 
@@ -273,6 +304,12 @@ namespace vnotex
 
         // Targets supported by cross copy. Set by web.
         QStringList m_crossCopyTargets;
+
+        // Base URL of the content set at web side once ready.
+        QString m_baseUrl;
+
+        // Texts with fewer lines are always sent as a whole.
+        static const int c_minLinesToPatch;
     };
 }
 
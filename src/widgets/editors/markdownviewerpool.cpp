@@ -0,0 +1,197 @@
+#include "markdownviewerpool.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QPointer>
+#include <QUrl>
+#include <QWebEnginePage>
+#include <QDebug>
+
+#include <core/vnotex.h>
+#include <core/thememgr.h>
+#include <core/configmgr.h>
+#include <core/editorconfig.h>
+#include <core/markdowneditorconfig.h>
+#include <core/htmltemplatehelper.h>
+#include "markdownviewer.h"
+#include "editormarkdownvieweradapter.h"
+
+using namespace vnotex;
+
+const int MarkdownViewerPool::c_maxIdleViewers = 2;
+
+MarkdownViewerPool::MarkdownViewerPool()
+{
+    // Web pages should be gone before QApplication.
+    connect(qApp, &QCoreApplication::aboutToQuit,
+            this, &MarkdownViewerPool::clear);
+
+    m_prewarmTimer = new QTimer(this);
+    m_prewarmTimer->setSingleShot(true);
+    m_prewarmTimer->setInterval(2000);
+    connect(m_prewarmTimer, &QTimer::timeout,
+            this, &MarkdownViewerPool::prewarm);
+}
+
+MarkdownViewer *MarkdownViewerPool::acquire(QWidget *p_parent)
+{
+    const auto &markdownEditorConfig = ConfigMgr::getInst().getEditorConfig().getMarkdownEditorConfig();
+
+    MarkdownViewer *viewer = nullptr;
+    if (m_idleViewers.isEmpty()) {
+        viewer = createViewer();
+        loadTemplate(viewer);
+    } else {
+        viewer = m_idleViewers.takeLast();
+        viewer->setZoomFactor(markdownEditorConfig.getZoomFactorInReadMode());
+    }
+
+    viewer->setParent(p_parent);
+
+    // Keep one ready for the next window.
+    m_prewarmTimer->start();
+
+    return viewer;
+}
+
+void MarkdownViewerPool::release(MarkdownViewer *p_viewer)
+{
+    Q_ASSERT(p_viewer && !m_idleViewers.contains(p_viewer));
+    p_viewer->hide();
+    p_viewer->setParent(nullptr);
+
+    if (m_quitting || m_idleViewers.size() >= c_maxIdleViewers) {
+        delete p_viewer;
+        return;
+    }
+
+    m_memoryUsages.remove(p_viewer);
+
+    auto adapter = dynamic_cast<EditorMarkdownViewerAdapter *>(p_viewer->adapter());
+    adapter->setBuffer(nullptr);
+
+    // Drop the content of previous note but keep the template.
+    if (hasLatestTemplate(p_viewer)) {
+        adapter->resetText();
+        adapter->setText(QString());
+    } else {
+        loadTemplate(p_viewer);
+    }
+    m_idleViewers.push_back(p_viewer);
+}
+
+bool MarkdownViewerPool::hasLatestTemplate(const MarkdownViewer *p_viewer) const
+{
+    const int revision = HtmlTemplateHelper::getMarkdownViewerTemplateRevision();
+    return revision != -1 && m_templateRevisions.value(p_viewer, -1) == revision;
+}
+
+void MarkdownViewerPool::loadTemplate(MarkdownViewer *p_viewer)
+{
+    const auto &markdownEditorConfig = ConfigMgr::getInst().getEditorConfig().getMarkdownEditorConfig();
+    HtmlTemplateHelper::updateMarkdownViewerTemplate(markdownEditorConfig);
+
+    p_viewer->adapter()->reset();
+    m_templateRevisions.insert(p_viewer, HtmlTemplateHelper::getMarkdownViewerTemplateRevision());
+
+    // Notes set their own base URL via the adapter.
+    p_viewer->setHtml(HtmlTemplateHelper::getMarkdownViewerTemplate(),
+                      QUrl::fromLocalFile(ConfigMgr::getInst().getUserFolder() + QLatin1Char('/')));
+}
+
+MarkdownViewer *MarkdownViewerPool::createViewer()
+{
+    const auto &markdownEditorConfig = ConfigMgr::getInst().getEditorConfig().getMarkdownEditorConfig();
+    auto viewer = new MarkdownViewer(new EditorMarkdownViewerAdapter(nullptr, nullptr),
+                                     VNoteX::getInst().getThemeMgr().getBaseBackground(),
+                                     markdownEditorConfig.getZoomFactorInReadMode(),
+                                     nullptr);
+    ++m_viewerCount;
+    connect(viewer, &QObject::destroyed,
+            this, [this, viewer]() {
+                --m_viewerCount;
+                m_templateRevisions.remove(viewer);
+                m_memoryUsages.remove(viewer);
+            });
+    return viewer;
+}
+
+void MarkdownViewerPool::prewarm()
+{
+    if (m_quitting || !m_idleViewers.isEmpty()) {
+        return;
+    }
+
+    auto viewer = createViewer();
+    loadTemplate(viewer);
+    m_idleViewers.push_back(viewer);
+}
+
+void MarkdownViewerPool::clear()
+{
+    m_quitting = true;
+    m_prewarmTimer->stop();
+
+    for (auto viewer : m_idleViewers) {
+        delete viewer;
+    }
+    m_idleViewers.clear();
+}
+
+int MarkdownViewerPool::getViewerCount() const
+{
+    return m_viewerCount;
+}
+
+int MarkdownViewerPool::getIdleViewerCount() const
+{
+    return m_idleViewers.size();
+}
+
+void MarkdownViewerPool::addFirstRenderTime(qint64 p_msecs, bool p_templateLoaded)
+{
+    ++m_firstRenderCount[p_templateLoaded];
+    m_totalFirstRenderTime[p_templateLoaded] += p_msecs;
+}
+
+qint64 MarkdownViewerPool::getAverageFirstRenderTime(bool p_templateLoaded) const
+{
+    const int cnt = m_firstRenderCount[p_templateLoaded];
+    return cnt > 0 ? m_totalFirstRenderTime[p_templateLoaded] / cnt : -1;
+}
+
+void MarkdownViewerPool::updateMemoryUsage(MarkdownViewer *p_viewer)
+{
+    // Not standard but provided by Chromium.
+    QPointer<MarkdownViewer> viewer(p_viewer);
+    p_viewer->page()->runJavaScript(QStringLiteral("performance.memory ? performance.memory.usedJSHeapSize : -1"),
+                                    [this, viewer](const QVariant &p_result) {
+                                        if (!viewer || m_idleViewers.contains(viewer.data())) {
+                                            return;
+                                        }
+
+                                        bool ok = false;
+                                        const auto bytes = p_result.toLongLong(&ok);
+                                        if (ok && bytes >= 0) {
+                                            m_memoryUsages.insert(viewer.data(), bytes);
+                                        }
+                                    });
+}
+
+int MarkdownViewerPool::getMeasuredViewerCount() const
+{
+    return m_memoryUsages.size();
+}
+
+qint64 MarkdownViewerPool::getAverageMemoryUsage() const
+{
+    if (m_memoryUsages.isEmpty()) {
+        return -1;
+    }
+
+    qint64 total = 0;
+    for (auto it = m_memoryUsages.constBegin(); it != m_memoryUsages.constEnd(); ++it) {
+        total += it.value();
+    }
+    return total / m_memoryUsages.size();
+}
@@ -0,0 +1,96 @@
+#ifndef MARKDOWNVIEWERPOOL_H
+#define MARKDOWNVIEWERPOOL_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+
+class QTimer;
+
+namespace vnotex
+{
+    class MarkdownViewer;
+
+    // Pool of MarkdownViewers shared by all MarkdownViewWindows, so that a window
+    // does not pay for a new web page each time it shows a note.
+    // Viewers keep the viewer template loaded and switch notes via their adapters.
+    class MarkdownViewerPool : public QObject
+    {
+        Q_OBJECT
+    public:
+        static MarkdownViewerPool &getInst()
+        {
+            static MarkdownViewerPool inst;
+            return inst;
+        }
+
+        // Take an idle viewer or create a new one. It is owned by @p_parent until released.
+        MarkdownViewer *acquire(QWidget *p_parent);
+
+        // Drop the content of @p_viewer and keep it for later use, or delete it if the pool is full.
+        void release(MarkdownViewer *p_viewer);
+
+        // Whether @p_viewer has loaded the latest viewer template.
+        bool hasLatestTemplate(const MarkdownViewer *p_viewer) const;
+
+        // Load the latest viewer template into @p_viewer. Its adapter is reset.
+        void loadTemplate(MarkdownViewer *p_viewer);
+
+        // Number of viewers alive, including idle ones.
+        int getViewerCount() const;
+
+        int getIdleViewerCount() const;
+
+        // Record the time from giving a note to a viewer until it is rendered.
+        // @p_templateLoaded: whether the viewer had the template loaded already.
+        void addFirstRenderTime(qint64 p_msecs, bool p_templateLoaded);
+
+        // Average first render time in milliseconds, or -1 if nothing recorded.
+        qint64 getAverageFirstRenderTime(bool p_templateLoaded) const;
+
+        // Query the JS heap size of @p_viewer, which is showing a note.
+        void updateMemoryUsage(MarkdownViewer *p_viewer);
+
+        // Number of viewers showing notes with known memory usage.
+        int getMeasuredViewerCount() const;
+
+        // Average JS heap size in bytes of viewers showing notes, or -1 if unknown.
+        qint64 getAverageMemoryUsage() const;
+
+        // Max number of idle viewers kept.
+        static const int c_maxIdleViewers;
+
+    private:
+        MarkdownViewerPool();
+
+        MarkdownViewer *createViewer();
+
+        // Create one idle viewer if there is none.
+        void prewarm();
+
+        void clear();
+
+        QVector<MarkdownViewer *> m_idleViewers;
+
+        int m_viewerCount = 0;
+
+        // Whether application is quitting. No viewer is kept then.
+        bool m_quitting = false;
+
+        // Template revision loaded by each viewer.
+        QHash<const MarkdownViewer *, int> m_templateRevisions;
+
+        // JS heap size of each viewer showing a note.
+        QHash<const MarkdownViewer *, qint64> m_memoryUsages;
+
+        // Indexed by whether the template was loaded already.
+        int m_firstRenderCount[2] = {0, 0};
+
+        qint64 m_totalFirstRenderTime[2] = {0, 0};
+
+        // Managed by QObject.
+        QTimer *m_prewarmTimer = nullptr;
+    };
+}
+
+#endif // MARKDOWNVIEWERPOOL_H
@@ -1,15 +1,16 @@
 #include "previewhelper.h"
 
 #include <QDebug>
+#include <QMetaMethod>
 #include <QTextDocument>
 #include <QTextBlock>
-#include <QTimer>
 
 #include <vtextedit/texteditorconfig.h>
 #include <vtextedit/previewmgr.h>
 #include <vtextedit/textutils.h>
 
 #include <utils/utils.h>
+#include <utils/adaptivesynctimer.h>
 
 #include "markdowneditor.h"
 #include "plantumlhelper.h"
@@ -124,17 +125,15 @@ PreviewHelper::PreviewHelper(MarkdownEditor *p_editor, QObject *p_parent)
 {
     setMarkdownEditor(p_editor);
 
-    const int interval = 1000;
-    m_codeBlockTimer = new QTimer(this);
-    m_codeBlockTimer->setSingleShot(true);
-    m_codeBlockTimer->setInterval(interval);
-    connect(m_codeBlockTimer, &QTimer::timeout,
+    // Interval follows the time previews of previous round take.
+    const int minInterval = 200;
+    const int maxInterval = 3000;
+    m_codeBlockTimer = new AdaptiveSyncTimer(minInterval, maxInterval, this);
+    connect(m_codeBlockTimer, &AdaptiveSyncTimer::timeout,
             this, &PreviewHelper::handleCodeBlocksUpdate);
 
-    m_mathBlockTimer = new QTimer(this);
-    m_mathBlockTimer->setSingleShot(true);
-    m_mathBlockTimer->setInterval(interval);
-    connect(m_mathBlockTimer, &QTimer::timeout,
+    m_mathBlockTimer = new AdaptiveSyncTimer(minInterval, maxInterval, this);
+    connect(m_mathBlockTimer, &AdaptiveSyncTimer::timeout,
             this, &PreviewHelper::handleMathBlocksUpdate);
 }
 
@@ -186,6 +185,12 @@ void PreviewHelper::handleCodeBlocksUpdate()
         }
     }
 
+    // Previews come back asynchronously.
+    m_ongoingCodeBlockPreviews = needPreviewBlocks.size();
+    if (m_ongoingCodeBlockPreviews > 0) {
+        m_codeBlockTimer->defer();
+    }
+
     for (auto idx : needPreviewBlocks) {
         inplacePreviewCodeBlock(idx);
     }
@@ -249,6 +254,12 @@ void PreviewHelper::inplacePreviewCodeBlock(int p_blockPreviewIdx)
         || (checkPreviewSourceLang(SourceFlag::PlantUml, blockData.m_lang) && m_webPlantUmlEnabled)
         || (checkPreviewSourceLang(SourceFlag::Graphviz, blockData.m_lang) && m_webGraphvizEnabled)
         || checkPreviewSourceLang(SourceFlag::Math, blockData.m_lang)) {
+        if (!isSignalConnected(QMetaMethod::fromSignal(&PreviewHelper::graphPreviewRequested))) {
+            // No viewer to render it, such as when it is released. Close the round.
+            handleGraphPreviewData(MarkdownViewerAdapter::PreviewData(p_blockPreviewIdx, m_codeBlockTimeStamp, QString(), QByteArray(), false));
+            return;
+        }
+
         emit graphPreviewRequested(p_blockPreviewIdx,
                                    m_codeBlockTimeStamp,
                                    blockData.m_lang,
@@ -286,6 +297,8 @@ void PreviewHelper::handleGraphPreviewData(const MarkdownViewerAdapter::PreviewD
     if (p_data.m_timeStamp != m_codeBlockTimeStamp) {
         return;
     }
+
+    finishCodeBlockPreview();
     if (p_data.m_id >= static_cast<quint64>(m_codeBlocksData.size()) || p_data.m_data.isEmpty()) {
         updateEditorInplacePreviewCodeBlock();
         return;
@@ -365,6 +378,7 @@ void PreviewHelper::mathBlocksUpdated(const QVector<vte::peg::MathBlock> &p_math
 void PreviewHelper::handleMathBlocksUpdate()
 {
     ++m_mathBlockTimeStamp;
+    m_ongoingMathBlockPreviews = 0;
     m_mathBlocksData.clear();
     m_mathBlocksData.reserve(m_pendingMathBlocks.size());
 
@@ -388,10 +402,15 @@ void PreviewHelper::handleMathBlocksUpdate()
         if (!cacheHit) {
             needUpdateEditorInplacePreview = false;
             m_mathBlocksData[blockPreviewIdx].m_text = mb.m_text;
+            ++m_ongoingMathBlockPreviews;
             inplacePreviewMathBlock(blockPreviewIdx);
         }
     }
 
+    if (m_ongoingMathBlockPreviews > 0) {
+        m_mathBlockTimer->defer();
+    }
+
     if (needUpdateEditorInplacePreview) {
         updateEditorInplacePreviewMathBlock();
     }
@@ -403,6 +422,12 @@ void PreviewHelper::inplacePreviewMathBlock(int p_blockPreviewIdx)
 {
     const auto &blockData = m_mathBlocksData[p_blockPreviewIdx];
     Q_ASSERT(!blockData.m_text.isEmpty());
+    if (!isSignalConnected(QMetaMethod::fromSignal(&PreviewHelper::mathPreviewRequested))) {
+        // No viewer to render it. Close the round.
+        handleMathPreviewData(MarkdownViewerAdapter::PreviewData(p_blockPreviewIdx, m_mathBlockTimeStamp, QString(), QByteArray(), false));
+        return;
+    }
+
     emit mathPreviewRequested(p_blockPreviewIdx, m_mathBlockTimeStamp, blockData.m_text);
 }
 
@@ -443,6 +468,8 @@ void PreviewHelper::handleMathPreviewData(const MarkdownViewerAdapter::PreviewDa
     if (p_data.m_timeStamp != m_mathBlockTimeStamp) {
         return;
     }
+
+    finishMathBlockPreview();
     if (p_data.m_id >= static_cast<quint64>(m_mathBlocksData.size()) || p_data.m_data.isEmpty()) {
         updateEditorInplacePreviewMathBlock();
         return;
@@ -494,6 +521,8 @@ void PreviewHelper::handleLocalData(quint64 p_id,
         return;
     }
 
+    finishCodeBlockPreview();
+
     Q_UNUSED(p_format);
     Q_ASSERT(p_format == QStringLiteral("svg"));
 
@@ -528,3 +557,17 @@ bool PreviewHelper::needForcedBackground(const QString &p_lang) const
 
     return false;
 }
+
+void PreviewHelper::finishCodeBlockPreview()
+{
+    if (m_ongoingCodeBlockPreviews > 0 && --m_ongoingCodeBlockPreviews == 0) {
+        m_codeBlockTimer->finish();
+    }
+}
+
+void PreviewHelper::finishMathBlockPreview()
+{
+    if (m_ongoingMathBlockPreviews > 0 && --m_ongoingMathBlockPreviews == 0) {
+        m_mathBlockTimer->finish();
+    }
+}
@@ -11,7 +11,6 @@
 #include <core/global.h>
 #include "markdownvieweradapter.h"
 
-class QTimer;
 class QTextDocument;
 
 namespace vte
@@ -22,6 +21,7 @@ namespace vte
 namespace vnotex
 {
     class MarkdownEditor;
+    class AdaptiveSyncTimer;
 
     // Helper to manage in-place preview and focus preview.
     class PreviewHelper : public QObject
@@ -194,6 +194,11 @@ namespace vnotex
 
         void handleMathBlocksUpdate();
 
+        // Called on each returned preview of current time stamp.
+        void finishCodeBlockPreview();
+
+        void finishMathBlockPreview();
+
         MarkdownEditor *m_editor = nullptr;
 
         QTextDocument *m_document = nullptr;
@@ -232,11 +237,18 @@ namespace vnotex
 
         QVector<vte::peg::FencedCodeBlock> m_pendingCodeBlocks;
 
-        QTimer *m_codeBlockTimer = nullptr;
+        // Managed by QObject.
+        AdaptiveSyncTimer *m_codeBlockTimer = nullptr;
+
+        // Number of code block previews of current time stamp not returned yet.
+        int m_ongoingCodeBlockPreviews = 0;
 
         QVector<vte::peg::MathBlock> m_pendingMathBlocks;
 
-        QTimer *m_mathBlockTimer = nullptr;
+        // Managed by QObject.
+        AdaptiveSyncTimer *m_mathBlockTimer = nullptr;
+
+        int m_ongoingMathBlockPreviews = 0;
     };
 }
 
@@ -0,0 +1,95 @@
+#include "lazyviewwindow.h"
+
+#include <QLabel>
+
+#include <utils/pathutils.h>
+
+using namespace vnotex;
+
+LazyViewWindow::LazyViewWindow(const ViewWindowSession &p_session, QWidget *p_parent)
+    : ViewWindow(p_parent),
+      m_session(p_session)
+{
+    m_mode = m_session.m_viewWindowMode;
+
+    setupUI();
+}
+
+void LazyViewWindow::setupUI()
+{
+    auto label = new QLabel(tr("Loading %1").arg(m_session.m_bufferPath), this);
+    label->setAlignment(Qt::AlignCenter);
+    label->setFocusPolicy(Qt::StrongFocus);
+    setCentralWidget(label);
+}
+
+const ViewWindowSession &LazyViewWindow::getSession() const
+{
+    return m_session;
+}
+
+QString LazyViewWindow::getName() const
+{
+    return PathUtils::fileName(m_session.m_bufferPath);
+}
+
+QString LazyViewWindow::getTitle() const
+{
+    return m_session.m_bufferPath;
+}
+
+QString LazyViewWindow::getLatestContent() const
+{
+    return QString();
+}
+
+void LazyViewWindow::setMode(ViewWindowMode p_mode)
+{
+    m_mode = p_mode;
+    m_session.m_viewWindowMode = p_mode;
+}
+
+void LazyViewWindow::openTwice(const QSharedPointer<FileOpenParameters> &p_paras)
+{
+    Q_UNUSED(p_paras);
+}
+
+ViewWindowSession LazyViewWindow::saveSession() const
+{
+    return m_session;
+}
+
+void LazyViewWindow::handleEditorConfigChange()
+{
+}
+
+void LazyViewWindow::setModified(bool p_modified)
+{
+    Q_UNUSED(p_modified);
+}
+
+void LazyViewWindow::handleBufferChangedInternal(const QSharedPointer<FileOpenParameters> &p_paras)
+{
+    Q_UNUSED(p_paras);
+}
+
+void LazyViewWindow::syncEditorFromBuffer()
+{
+}
+
+void LazyViewWindow::syncEditorFromBufferContent()
+{
+}
+
+void LazyViewWindow::scrollUp()
+{
+}
+
+void LazyViewWindow::scrollDown()
+{
+}
+
+void LazyViewWindow::zoom(bool p_zoomIn)
+{
+    Q_UNUSED(p_zoomIn);
+}
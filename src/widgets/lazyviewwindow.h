@@ -0,0 +1,56 @@
+#ifndef LAZYVIEWWINDOW_H
+#define LAZYVIEWWINDOW_H
+
+#include "viewwindow.h"
+
+namespace vnotex
+{
+    // Placeholder of a ViewWindow restored from session, which holds no buffer.
+    // ViewArea replaces it with the real ViewWindow once it is activated.
+    class LazyViewWindow : public ViewWindow
+    {
+        Q_OBJECT
+    public:
+        explicit LazyViewWindow(const ViewWindowSession &p_session, QWidget *p_parent = nullptr);
+
+        const ViewWindowSession &getSession() const;
+
+        QString getName() const Q_DECL_OVERRIDE;
+
+        QString getTitle() const Q_DECL_OVERRIDE;
+
+        QString getLatestContent() const Q_DECL_OVERRIDE;
+
+        void setMode(ViewWindowMode p_mode) Q_DECL_OVERRIDE;
+
+        void openTwice(const QSharedPointer<FileOpenParameters> &p_paras) Q_DECL_OVERRIDE;
+
+        ViewWindowSession saveSession() const Q_DECL_OVERRIDE;
+
+    public slots:
+        void handleEditorConfigChange() Q_DECL_OVERRIDE;
+
+    protected slots:
+        void setModified(bool p_modified) Q_DECL_OVERRIDE;
+
+        void handleBufferChangedInternal(const QSharedPointer<FileOpenParameters> &p_paras) Q_DECL_OVERRIDE;
+
+    protected:
+        void syncEditorFromBuffer() Q_DECL_OVERRIDE;
+
+        void syncEditorFromBufferContent() Q_DECL_OVERRIDE;
+
+        void scrollUp() Q_DECL_OVERRIDE;
+
+        void scrollDown() Q_DECL_OVERRIDE;
+
+        void zoom(bool p_zoomIn) Q_DECL_OVERRIDE;
+
+    private:
+        void setupUI();
+
+        ViewWindowSession m_session;
+    };
+}
+
+#endif // LAZYVIEWWINDOW_H
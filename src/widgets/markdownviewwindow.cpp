@@ -7,6 +7,10 @@
 #include <QCoreApplication>
 #include <QScrollBar>
 #include <QLabel>
+#include <QTimer>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QDebug>
 
 #include <core/fileopenparameters.h>
 #include <core/editorconfig.h>
@@ -22,6 +26,7 @@
 #include "editors/markdowneditor.h"
 #include "textviewwindowhelper.h"
 #include "editors/markdownviewer.h"
+#include "editors/markdownviewerpool.h"
 #include "editors/editormarkdownvieweradapter.h"
 #include "editors/previewhelper.h"
 #include "dialogs/deleteconfirmdialog.h"
@@ -43,10 +48,24 @@ MarkdownViewWindow::MarkdownViewWindow(QWidget *p_parent)
     setupUI();
 
     setupPreviewHelper();
+
+    m_releaseViewerTimer = new QTimer(this);
+    m_releaseViewerTimer->setSingleShot(true);
+    m_releaseViewerTimer->setInterval(10000);
+    connect(m_releaseViewerTimer, &QTimer::timeout,
+            this, [this]() {
+                if (m_viewer && isReadMode() && !isVisible()) {
+                    releaseViewer();
+                }
+            });
 }
 
 MarkdownViewWindow::~MarkdownViewWindow()
 {
+    if (m_viewer) {
+        releaseViewer();
+    }
+
     if (m_textEditorStatusWidget) {
         getMainStatusWidget()->removeWidget(m_textEditorStatusWidget.get());
         m_textEditorStatusWidget->setParent(nullptr);
@@ -115,6 +134,7 @@ void MarkdownViewWindow::setModeInternal(ViewWindowMode p_mode, bool p_syncBuffe
         }
 
         // Avoid focus glitch.
+        Q_ASSERT(m_viewer);
         m_viewer->show();
         m_viewer->setFocus();
 
@@ -139,14 +159,22 @@ void MarkdownViewWindow::setModeInternal(ViewWindowMode p_mode, bool p_syncBuffe
             if (p_syncBuffer) {
                 syncTextEditorFromBuffer(true);
             }
+        } else if (!m_viewer) {
+            // Released while hidden in read mode. Editor still needs it to preview.
+            setupViewer();
+            if (p_syncBuffer) {
+                syncViewerFromBuffer(false);
+            }
         }
 
         // Avoid focus glitch.
         m_editor->show();
         m_editor->setFocus();
 
-        Q_ASSERT(m_viewer);
-        m_viewer->hide();
+        // Viewer may be released while hidden.
+        if (m_viewer) {
+            m_viewer->hide();
+        }
 
         getMainStatusWidget()->setCurrentWidget(m_textEditorStatusWidget.get());
         break;
@@ -323,13 +351,7 @@ void MarkdownViewWindow::setupTextEditor()
     m_previewHelper->setMarkdownEditor(m_editor);
     m_editor->setPreviewHelper(m_previewHelper);
 
-    // Connect viewer and editor.
-    connect(adapter(), &MarkdownViewerAdapter::viewerReady,
-            m_editor->getHighlighter(), &vte::PegMarkdownHighlighter::updateHighlight);
-    connect(m_editor, &MarkdownEditor::htmlToMarkdownRequested,
-            adapter(), &MarkdownViewerAdapter::htmlToMarkdownRequested);
-    connect(adapter(), &MarkdownViewerAdapter::htmlToMarkdownReady,
-            m_editor, &MarkdownEditor::handleHtmlToMarkdownData);
+    connectTextEditorAndViewer();
 
     // Connect outline pipeline.
     connect(m_editor, &MarkdownEditor::headingsChanged,
@@ -372,7 +394,9 @@ void MarkdownViewWindow::focusEditor()
 {
     switch (m_mode) {
     case ViewWindowMode::Read:
-        m_viewer->setFocus();
+        if (m_viewer) {
+            m_viewer->setFocus();
+        }
         break;
 
     case ViewWindowMode::Edit:
@@ -396,15 +420,13 @@ void MarkdownViewWindow::setupViewer()
 
     HtmlTemplateHelper::updateMarkdownViewerTemplate(markdownEditorConfig);
 
-    auto adapter = new EditorMarkdownViewerAdapter(nullptr, this);
-    m_viewer = new MarkdownViewer(adapter,
-                                  VNoteX::getInst().getThemeMgr().getBaseBackground(),
-                                  markdownEditorConfig.getZoomFactorInReadMode(),
-                                  this);
+    m_viewer = MarkdownViewerPool::getInst().acquire(this);
+    auto adapter = this->adapter();
+    // Editor is always before viewer.
     m_splitter->addWidget(m_viewer);
 
     // Status widget.
-    {
+    if (!m_viewerStatusWidget) {
         // TODO: implement a real status widget for viewer.
         auto label = new QLabel(tr("Markdown Viewer"), this);
         label->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
@@ -450,6 +472,68 @@ void MarkdownViewWindow::setupViewer()
             this, [this](const QString &p_text, int p_totalMatches, int p_currentMatchIndex) {
                 this->showFindResult(p_text, p_totalMatches, p_currentMatchIndex);
             });
+
+    connect(adapter, &MarkdownViewerAdapter::workFinished,
+            this, [this]() {
+                if (m_firstRenderTimer.isValid()) {
+                    const auto elapsed = m_firstRenderTimer.elapsed();
+                    m_firstRenderTimer.invalidate();
+                    auto &pool = MarkdownViewerPool::getInst();
+                    pool.addFirstRenderTime(elapsed, m_firstRenderTemplateLoaded);
+                    pool.updateMemoryUsage(m_viewer);
+                    qDebug() << "markdown viewer rendered in" << elapsed << "ms" << getTitle();
+                }
+            });
+
+    // Rendering of synced content is done.
+    connect(adapter, &MarkdownViewerAdapter::workFinished,
+            this, &MarkdownViewWindow::finishSyncBufferContent);
+
+    if (m_editor) {
+        connectTextEditorAndViewer();
+    }
+}
+
+void MarkdownViewWindow::releaseViewer()
+{
+    Q_ASSERT(m_viewer);
+    m_releaseViewerTimer->stop();
+
+    auto adapter = this->adapter();
+    m_viewerTopLineNumber = adapter->getTopLineNumber();
+    m_firstRenderTimer.invalidate();
+
+    disconnect(m_viewer, nullptr, this, nullptr);
+    disconnect(adapter, nullptr, this, nullptr);
+    disconnect(m_previewHelper, nullptr, m_viewer, nullptr);
+    disconnect(adapter, nullptr, m_previewHelper, nullptr);
+    if (m_editor) {
+        disconnect(adapter, nullptr, m_editor, nullptr);
+        disconnect(adapter, nullptr, m_editor->getHighlighter(), nullptr);
+        disconnect(m_editor, nullptr, adapter, nullptr);
+    }
+
+    MarkdownViewerPool::getInst().release(m_viewer);
+    m_viewer = nullptr;
+
+    // No workFinished() from it any more.
+    finishSyncBufferContent();
+}
+
+void MarkdownViewWindow::connectTextEditorAndViewer()
+{
+    Q_ASSERT(m_editor && m_viewer);
+    connect(adapter(), &MarkdownViewerAdapter::viewerReady,
+            m_editor->getHighlighter(), &vte::PegMarkdownHighlighter::updateHighlight);
+    connect(m_editor, &MarkdownEditor::htmlToMarkdownRequested,
+            adapter(), &MarkdownViewerAdapter::htmlToMarkdownRequested);
+    connect(adapter(), &MarkdownViewerAdapter::htmlToMarkdownReady,
+            m_editor, &MarkdownEditor::handleHtmlToMarkdownData);
+
+    // A viewer from the pool may be ready already.
+    if (adapter()->isViewerReady()) {
+        m_editor->getHighlighter()->updateHighlight();
+    }
 }
 
 void MarkdownViewWindow::syncTextEditorFromBuffer(bool p_syncPositionFromReadMode)
@@ -498,18 +582,31 @@ void MarkdownViewWindow::syncViewerFromBuffer(bool p_syncPositionFromEditMode)
         if (p_syncPositionFromEditMode) {
             lineNumber = getEditLineNumber();
         }
+        if (lineNumber == -1) {
+            // Position before the viewer is released.
+            lineNumber = m_viewerTopLineNumber;
+        }
+        m_viewerTopLineNumber = -1;
 
         // TODO: Check buffer for last position recover.
 
+        // Keep the loaded template and just switch the content if possible.
+        auto &pool = MarkdownViewerPool::getInst();
+        m_firstRenderTemplateLoaded = pool.hasLatestTemplate(m_viewer);
+        if (m_firstRenderTemplateLoaded) {
+            adapter()->resetText();
+        } else {
+            pool.loadTemplate(m_viewer);
+        }
+        m_firstRenderTimer.start();
+
         // Use getPath() instead of getBasePath() to make in-page anchor work.
-        adapter()->reset();
-        m_viewer->setHtml(HtmlTemplateHelper::getMarkdownViewerTemplate(),
-                          PathUtils::pathToUrl(buffer->getContentPath()));
+        adapter()->setBaseUrl(PathUtils::pathToUrl(buffer->getContentPath()));
         adapter()->setText(m_bufferRevision, buffer->getContent(), lineNumber);
     } else {
-        adapter()->reset();
-        m_viewer->setHtml("");
-        adapter()->setText(0, "", -1);
+        m_firstRenderTimer.invalidate();
+        adapter()->resetText();
+        adapter()->setText(QString());
     }
     m_viewerBufferRevision = m_bufferRevision;
 }
@@ -538,7 +635,11 @@ void MarkdownViewWindow::syncTextEditorFromBufferContent(bool p_syncPosition)
 
 void MarkdownViewWindow::syncViewerFromBufferContent(bool p_syncPosition)
 {
-    Q_ASSERT(m_viewer);
+    if (!m_viewer) {
+        // Released while hidden. Will sync all on next setup.
+        return;
+    }
+
     if (m_viewerBufferRevision == m_bufferRevision) {
         if (p_syncPosition) {
             adapter()->scrollToPosition(MarkdownViewerAdapter::Position(getEditLineNumber(), QString()));
@@ -551,6 +652,8 @@ void MarkdownViewWindow::syncViewerFromBufferContent(bool p_syncPosition)
     adapter()->setText(m_bufferRevision,
                        buffer->getContent(),
                        p_syncPosition ? getEditLineNumber() : -1);
+    // Take the rendering into account for the next sync.
+    deferSyncBufferContent();
 
     m_viewerBufferRevision = m_bufferRevision;
 }
@@ -858,7 +961,7 @@ void MarkdownViewWindow::zoom(bool p_zoomIn)
 void MarkdownViewWindow::handleFindTextChanged(const QString &p_text, FindOptions p_options)
 {
     if (isReadMode()) {
-        if (p_options & FindOption::IncrementalSearch) {
+        if ((p_options & FindOption::IncrementalSearch) && m_viewer) {
             adapter()->findText(p_text, p_options);
         }
     } else {
@@ -869,7 +972,9 @@ void MarkdownViewWindow::handleFindTextChanged(const QString &p_text, FindOption
 void MarkdownViewWindow::handleFindNext(const QString &p_text, FindOptions p_options)
 {
     if (isReadMode()) {
-        adapter()->findText(p_text, p_options);
+        if (m_viewer) {
+            adapter()->findText(p_text, p_options);
+        }
     } else {
         TextViewWindowHelper::handleFindNext(this, p_text, p_options);
     }
@@ -897,7 +1002,7 @@ void MarkdownViewWindow::handleFindAndReplaceWidgetClosed()
 {
     if (m_editor) {
         TextViewWindowHelper::handleFindAndReplaceWidgetClosed(this);
-    } else {
+    } else if (m_viewer) {
         adapter()->findText("", FindOption::FindNone);
     }
 }
@@ -938,8 +1043,11 @@ void MarkdownViewWindow::scrollToLine(int p_lineNumber)
     }
 
     if (isReadMode()) {
-        Q_ASSERT(m_viewer);
-        adapter()->scrollToPosition(MarkdownViewerAdapter::Position(p_lineNumber, QString()));
+        if (m_viewer) {
+            adapter()->scrollToPosition(MarkdownViewerAdapter::Position(p_lineNumber, QString()));
+        } else {
+            m_viewerTopLineNumber = p_lineNumber;
+        }
     } else {
         Q_ASSERT(m_editor);
         m_editor->scrollToLine(p_lineNumber, true);
@@ -961,8 +1069,11 @@ ViewWindowSession MarkdownViewWindow::saveSession() const
 {
     auto session = ViewWindow::saveSession();
     if (getBuffer()) {
-        session.m_lineNumber = isReadMode() ? adapter()->getTopLineNumber()
-                                            : m_editor->getCursorPosition().first;
+        if (isReadMode()) {
+            session.m_lineNumber = m_viewer ? adapter()->getTopLineNumber() : m_viewerTopLineNumber;
+        } else {
+            session.m_lineNumber = m_editor->getCursorPosition().first;
+        }
     }
     return session;
 }
@@ -982,3 +1093,25 @@ void MarkdownViewWindow::setupPreviewHelper()
                                    markdownEditorConfig.getPlantUmlCommand());
     GraphvizHelper::getInst().init(markdownEditorConfig.getGraphvizExe());
 }
+
+void MarkdownViewWindow::showEvent(QShowEvent *p_event)
+{
+    ViewWindow::showEvent(p_event);
+
+    m_releaseViewerTimer->stop();
+    if (!m_viewer && (isReadMode() || m_editor) && getBuffer()) {
+        setupViewer();
+        syncViewerFromBuffer(false);
+        m_viewer->setVisible(isReadMode());
+    }
+}
+
+void MarkdownViewWindow::hideEvent(QHideEvent *p_event)
+{
+    ViewWindow::hideEvent(p_event);
+
+    // Not for minimizing.
+    if (!p_event->spontaneous() && m_viewer && isReadMode()) {
+        m_releaseViewerTimer->start();
+    }
+}
@@ -4,9 +4,11 @@
 #include "viewwindow.h"
 
 #include <QScopedPointer>
+#include <QElapsedTimer>
 
 class QSplitter;
 class QStackedWidget;
+class QTimer;
 
 namespace vte
 {
@@ -85,6 +87,10 @@ namespace vnotex
 
         void zoom(bool p_zoomIn) Q_DECL_OVERRIDE;
 
+        void showEvent(QShowEvent *p_event) Q_DECL_OVERRIDE;
+
+        void hideEvent(QHideEvent *p_event) Q_DECL_OVERRIDE;
+
     private:
         void setupUI();
 
@@ -97,8 +103,14 @@ namespace vnotex
         // Focus appropriate editor according to current mode.
         void focusEditor();
 
+        // Take a viewer from MarkdownViewerPool.
         void setupViewer();
 
+        // Give the viewer back to MarkdownViewerPool, keeping only the reading position.
+        void releaseViewer();
+
+        void connectTextEditorAndViewer();
+
         void setupPreviewHelper();
 
         void syncTextEditorFromBuffer(bool p_syncPositionFromReadMode);
@@ -154,9 +166,22 @@ namespace vnotex
         // Managed by QObject.
         MarkdownEditor *m_editor = nullptr;
 
-        // Managed by QObject.
+        // Managed by QObject. Taken from MarkdownViewerPool.
         MarkdownViewer *m_viewer = nullptr;
 
+        // Top line of the viewer when it is released. Restored on next setup.
+        int m_viewerTopLineNumber = -1;
+
+        // Release the viewer if hidden for a while.
+        // Managed by QObject.
+        QTimer *m_releaseViewerTimer = nullptr;
+
+        // Time since giving a note to the viewer until it is rendered.
+        QElapsedTimer m_firstRenderTimer;
+
+        // Whether the viewer had the template loaded when given the note.
+        bool m_firstRenderTemplateLoaded = false;
+
         QSharedPointer<QWidget> m_textEditorStatusWidget;
 
         QSharedPointer<QWidget> m_viewerStatusWidget;
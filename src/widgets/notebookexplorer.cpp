@@ -5,6 +5,7 @@
 #include <QToolButton>
 #include <QMenu>
 #include <QActionGroup>
+#include <QDateTime>
 
 #include "titlebar.h"
 #include "dialogs/newnotebookdialog.h"
@@ -15,10 +16,12 @@
 #include "dialogs/importnotebookdialog.h"
 #include "dialogs/importfolderdialog.h"
 #include "dialogs/importlegacynotebookdialog.h"
+#include "dialogs/filterednotesdialog.h"
 #include "vnotex.h"
 #include "mainwindow.h"
 #include "notebook/notebook.h"
 #include "notebookmgr.h"
+#include "buffermgr.h"
 #include <utils/iconutils.h>
 #include <utils/widgetutils.h>
 #include <utils/pathutils.h>
@@ -31,6 +34,9 @@
 #include <core/events.h>
 #include <core/exception.h>
 #include <core/fileopenparameters.h>
+#include <versioncontroller/iversioncontroller.h>
+#include <notebook/mediagarbagecollector.h>
+#include <buffer/buffer.h>
 #include "navigationmodemgr.h"
 #include "widgetsfactory.h"
 
@@ -136,6 +142,30 @@ TitleBar *NotebookExplorer::setupTitleBar(QWidget *p_parent)
                                 dialog.exec();
                             });
 
+    titleBar->addMenuAction(tr("&Snapshot Notebook"),
+                            titleBar,
+                            [this]() {
+                                snapshotCurrentNotebook();
+                            });
+
+    titleBar->addMenuAction(tr("&Recent/Filtered Notes"),
+                            titleBar,
+                            [this]() {
+                                if (!m_currentNotebook) {
+                                    return;
+                                }
+
+                                FilteredNotesDialog dialog(m_currentNotebook.data(),
+                                                           VNoteX::getInst().getMainWindow());
+                                dialog.exec();
+                            });
+
+    titleBar->addMenuAction(tr("&Clean Up Unused Media"),
+                            titleBar,
+                            [this]() {
+                                cleanUpUnusedMedia();
+                            });
+
     titleBar->addMenuSeparator();
 
     // External Files menu.
@@ -357,6 +387,82 @@ void NotebookExplorer::importLegacyNotebook()
     dialog.exec();
 }
 
+void NotebookExplorer::snapshotCurrentNotebook()
+{
+    if (!m_currentNotebook) {
+        return;
+    }
+
+    auto vc = m_currentNotebook->getVersionController().data();
+    auto conn = QSharedPointer<QMetaObject::Connection>::create();
+    *conn = connect(vc, &IVersionController::snapshotFinished,
+                    this, [conn](bool p_succeeded, const QString &p_errMsg) {
+                        QObject::disconnect(*conn);
+                        if (p_succeeded) {
+                            VNoteX::getInst().showStatusMessageShort(tr("Notebook snapshot taken"));
+                        } else {
+                            VNoteX::getInst().showStatusMessageShort(tr("Failed to take snapshot (%1)").arg(p_errMsg));
+                        }
+                    });
+    vc->snapshot(tr("Snapshot at %1").arg(QDateTime::currentDateTime().toString(Qt::ISODate)));
+}
+
+void NotebookExplorer::cleanUpUnusedMedia()
+{
+    if (!m_currentNotebook) {
+        return;
+    }
+
+    auto collector = m_currentNotebook->getMediaGarbageCollector();
+    if (collector->isRunning()) {
+        VNoteX::getInst().showStatusMessageShort(tr("Media clean-up is in progress"));
+        return;
+    }
+
+    // Images pasted into notes not saved yet are referred only by their buffers.
+    QHash<QString, QString> unsavedContents;
+    const auto buffers = VNoteX::getInst().getBufferMgr().getModifiedBuffers();
+    for (auto buffer : buffers) {
+        auto node = buffer->getNode();
+        if (node && node->getNotebook() == m_currentNotebook.data()) {
+            unsavedContents.insert(buffer->getContentPath(), buffer->getContent());
+        }
+    }
+
+    // Find orphans first and move exactly the confirmed ones.
+    auto conn = QSharedPointer<QMetaObject::Connection>::create();
+    *conn = connect(collector, &MediaGarbageCollector::finished,
+                    this, [conn, collector](const MediaGarbageCollector::Result &p_result) {
+                        QObject::disconnect(*conn);
+                        const int cnt = p_result.m_files.size() + p_result.m_folders.size();
+                        if (cnt == 0) {
+                            VNoteX::getInst().showStatusMessageShort(tr("No unused media found"));
+                            return;
+                        }
+
+                        int ret = MessageBoxHelper::questionOkCancel(MessageBoxHelper::Question,
+                                                                     tr("Move %n unused media file(s) to recycle bin?", "", cnt),
+                                                                     tr("No note refers to them."),
+                                                                     (p_result.m_files + p_result.m_folders).join(QLatin1Char('\n')),
+                                                                     VNoteX::getInst().getMainWindow());
+                        if (ret != QMessageBox::Ok) {
+                            return;
+                        }
+
+                        auto appliedConn = QSharedPointer<QMetaObject::Connection>::create();
+                        *appliedConn = connect(collector, &MediaGarbageCollector::applied,
+                                               collector, [appliedConn](int p_movedCount) {
+                                                   QObject::disconnect(*appliedConn);
+                                                   VNoteX::getInst().showStatusMessageShort(tr("%n unused media file(s) moved to recycle bin", "", p_movedCount));
+                                               });
+                        if (!collector->apply(p_result)) {
+                            QObject::disconnect(*appliedConn);
+                            VNoteX::getInst().showStatusMessageShort(tr("Media clean-up is in progress"));
+                        }
+                    });
+    collector->collect(true, unsavedContents);
+}
+
 void NotebookExplorer::locateNode(Node *p_node)
 {
     Q_ASSERT(p_node);
@@ -53,6 +53,12 @@ namespace vnotex
 
         void importLegacyNotebook();
 
+        // Record all changes of current notebook via its version controller.
+        void snapshotCurrentNotebook();
+
+        // Move images and attachments no note refers to into recycle bin after confirmation.
+        void cleanUpUnusedMedia();
+
         void locateNode(Node *p_node);
 
     signals:
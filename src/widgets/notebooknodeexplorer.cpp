@@ -8,10 +8,12 @@
 #include <QAction>
 #include <QSet>
 #include <QShortcut>
+#include <QTreeWidgetItemIterator>
 
 #include <notebook/notebook.h>
 #include <notebook/node.h>
 #include <notebook/externalnode.h>
+#include <versioncontroller/iversioncontroller.h>
 #include "exception.h"
 #include "messageboxhelper.h"
 #include "vnotex.h"
@@ -315,6 +317,7 @@ void NotebookNodeExplorer::setNotebook(const QSharedPointer<Notebook> &p_noteboo
 
     if (m_notebook) {
         disconnect(m_notebook.data(), nullptr, this, nullptr);
+        disconnect(m_notebook->getVersionController().data(), nullptr, this, nullptr);
     }
 
     saveNotebookTreeState();
@@ -326,6 +329,10 @@ void NotebookNodeExplorer::setNotebook(const QSharedPointer<Notebook> &p_noteboo
                 this, [this](const Node *p_node) {
                     updateNode(p_node->getParent());
                 });
+        connect(m_notebook.data(), &Notebook::nodeRefreshed,
+                this, &NotebookNodeExplorer::updateNode);
+        connect(m_notebook->getVersionController().data(), &IVersionController::statusUpdated,
+                this, &NotebookNodeExplorer::updateVersionStatus);
     }
 
     generateNodeTree();
@@ -491,7 +498,14 @@ void NotebookNodeExplorer::loadRecycleBinNode(QTreeWidgetItem *p_item, Node *p_n
     p_item->setText(Column::Name, tr("Recycle Bin"));
     p_item->setIcon(Column::Name, getNodeItemIcon(p_node));
 
-    loadChildren(p_item, p_node, p_level - 1);
+    // Date folders are loaded on expansion so their configs are not read on open.
+    Q_UNUSED(p_level);
+    auto children = p_node->getChildren();
+    sortNodes(children);
+    for (const auto &child : children) {
+        auto item = new QTreeWidgetItem(p_item);
+        fillTreeItem(item, child.data(), false);
+    }
 
     // No need to restore state.
 }
@@ -501,7 +515,67 @@ void NotebookNodeExplorer::fillTreeItem(QTreeWidgetItem *p_item, Node *p_node, b
     setItemNodeData(p_item, NodeData(p_node, p_loaded));
     p_item->setText(Column::Name, p_node->getName());
     p_item->setIcon(Column::Name, getNodeItemIcon(p_node));
-    p_item->setToolTip(Column::Name, p_node->exists() ? p_node->getName() : (tr("[Invalid] %1").arg(p_node->getName())));
+    decorateItemByVersionStatus(p_item, p_node);
+}
+
+void NotebookNodeExplorer::decorateItemByVersionStatus(QTreeWidgetItem *p_item, const Node *p_node) const
+{
+    QString statusText;
+    const auto status = m_notebook->isRecycleBinNode(p_node) ? IVersionController::Status::Unmodified
+                                                             : m_notebook->getVersionController()->getStatus(p_node->fetchPath());
+    switch (status) {
+    case IVersionController::Status::Modified:
+        statusText = tr("Modified");
+        break;
+
+    case IVersionController::Status::Added:
+        statusText = tr("Added");
+        break;
+
+    case IVersionController::Status::Deleted:
+        statusText = tr("Deleted");
+        break;
+
+    case IVersionController::Status::Renamed:
+        statusText = tr("Renamed");
+        break;
+
+    case IVersionController::Status::Untracked:
+        statusText = tr("Untracked");
+        break;
+
+    case IVersionController::Status::Conflicted:
+        statusText = tr("Conflicted");
+        break;
+
+    default:
+        break;
+    }
+
+    // Changed nodes are shown in italic with the status in tool tip.
+    auto font = p_item->font(Column::Name);
+    font.setItalic(!statusText.isEmpty());
+    p_item->setFont(Column::Name, font);
+
+    auto toolTip = p_node->exists() ? p_node->getName() : (tr("[Invalid] %1").arg(p_node->getName()));
+    if (!statusText.isEmpty()) {
+        toolTip = tr("%1 [%2]").arg(toolTip, statusText);
+    }
+    p_item->setToolTip(Column::Name, toolTip);
+}
+
+void NotebookNodeExplorer::updateVersionStatus()
+{
+    if (!m_notebook) {
+        return;
+    }
+
+    for (QTreeWidgetItemIterator it(m_masterExplorer); *it; ++it) {
+        auto data = getItemNodeData(*it);
+        if (data.isNode()) {
+            decorateItemByVersionStatus(*it, data.getNode());
+        }
+    }
 }
 
 void NotebookNodeExplorer::fillTreeItem(QTreeWidgetItem *p_item, const QSharedPointer<ExternalNode> &p_node) const
@@ -1674,9 +1748,9 @@ void NotebookNodeExplorer::sortNodes(QVector<QSharedPointer<Node>> &p_nodes, int
     case ViewOrder::OrderedByCreatedTime:
         std::sort(p_nodes.begin() + p_start, p_nodes.begin() + p_end, [reversed](const QSharedPointer<Node> &p_a, const QSharedPointer<Node> p_b) {
             if (reversed) {
-                return p_b->getCreatedTimeUtc() < p_a->getCreatedTimeUtc();
+                return p_b->getCreatedTimeMsecs() < p_a->getCreatedTimeMsecs();
             } else {
-                return p_a->getCreatedTimeUtc() < p_b->getCreatedTimeUtc();
+                return p_a->getCreatedTimeMsecs() < p_b->getCreatedTimeMsecs();
             }
         });
         break;
@@ -1687,9 +1761,9 @@ void NotebookNodeExplorer::sortNodes(QVector<QSharedPointer<Node>> &p_nodes, int
     case ViewOrder::OrderedByModifiedTime:
         std::sort(p_nodes.begin() + p_start, p_nodes.begin() + p_end, [reversed](const QSharedPointer<Node> &p_a, const QSharedPointer<Node> p_b) {
             if (reversed) {
-                return p_b->getModifiedTimeUtc() < p_a->getModifiedTimeUtc();
+                return p_b->getModifiedTimeMsecs() < p_a->getModifiedTimeMsecs();
             } else {
-                return p_a->getModifiedTimeUtc() < p_b->getModifiedTimeUtc();
+                return p_a->getModifiedTimeMsecs() < p_b->getModifiedTimeMsecs();
             }
         });
         break;
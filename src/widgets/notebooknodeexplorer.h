@@ -179,6 +179,12 @@ namespace vnotex
 
         void fillTreeItem(QTreeWidgetItem *p_item, const QSharedPointer<ExternalNode> &p_node) const;
 
+        // Show version control status of @p_node on @p_item.
+        void decorateItemByVersionStatus(QTreeWidgetItem *p_item, const Node *p_node) const;
+
+        // Update version control status of all loaded items.
+        void updateVersionStatus();
+
         const QIcon &getNodeItemIcon(const Node *p_node) const;
 
         const QIcon &getNodeItemIcon(const ExternalNode *p_node) const;
@@ -4,6 +4,8 @@
 #include <QDebug>
 #include <QScrollBar>
 #include <QToolBar>
+#include <QRegularExpression>
+#include <QThread>
 
 #include <vtextedit/vtextedit.h>
 #include <core/editorconfig.h>
@@ -15,6 +17,7 @@
 #include <core/thememgr.h>
 #include "editors/statuswidget.h"
 #include <core/fileopenparameters.h>
+#include <utils/mappedtextfile.h>
 
 using namespace vnotex;
 
@@ -70,6 +73,15 @@ void TextViewWindow::setupToolBar()
 
     addAction(toolBar, ViewWindowToolBarHelper::Attachment);
 
+    // Shown for large file only.
+    m_previousPageAct = toolBar->addAction(tr("Previous Page"), this, [this]() {
+        loadLargeFilePage(m_largeFilePage - 1);
+    });
+    m_nextPageAct = toolBar->addAction(tr("Next Page"), this, [this]() {
+        loadLargeFilePage(m_largeFilePage + 1);
+    });
+    updateLargeFileActions();
+
     ToolBarHelper::addSpacer(toolBar);
     addAction(toolBar, ViewWindowToolBarHelper::FindAndReplace);
 }
@@ -88,7 +100,15 @@ void TextViewWindow::syncEditorFromBuffer()
     m_propogateEditorToBuffer = false;
 
     auto buffer = getBuffer();
-    if (buffer) {
+    m_largeFile = buffer ? buffer->getLargeFile() : QSharedPointer<const MappedTextFile>();
+    m_largeFilePage = 0;
+    ++m_largeFileFindId;
+    if (m_largeFile) {
+        // No highlighting for large file.
+        m_editor->setSyntax("");
+        m_editor->setReadOnly(true);
+        loadLargeFilePage(0);
+    } else if (buffer) {
         m_editor->setSyntax(QFileInfo(buffer->getPath()).suffix());
         m_editor->setReadOnly(buffer->isReadOnly());
         m_editor->setText(buffer->getContent());
@@ -102,6 +122,8 @@ void TextViewWindow::syncEditorFromBuffer()
 
     m_bufferRevision = buffer ? buffer->getRevision() : 0;
     m_propogateEditorToBuffer = old;
+
+    updateLargeFileActions();
 }
 
 void TextViewWindow::syncEditorFromBufferContent()
@@ -111,8 +133,15 @@ void TextViewWindow::syncEditorFromBufferContent()
 
     auto buffer = getBuffer();
     Q_ASSERT(buffer);
-    m_editor->setText(buffer->getContent());
-    m_editor->setModified(buffer->isModified());
+    if (m_largeFile) {
+        // File is remapped into a new one on reload.
+        m_largeFile = buffer->getLargeFile();
+        ++m_largeFileFindId;
+        loadLargeFilePage(qBound(0, m_largeFilePage, m_largeFile->pageCount() - 1));
+    } else {
+        m_editor->setText(buffer->getContent());
+        m_editor->setModified(buffer->isModified());
+    }
 
     m_bufferRevision = buffer->getRevision();
     m_propogateEditorToBuffer = old;
@@ -207,6 +236,11 @@ void TextViewWindow::handleFindTextChanged(const QString &p_text, FindOptions p_
 
 void TextViewWindow::handleFindNext(const QString &p_text, FindOptions p_options)
 {
+    if (m_largeFile) {
+        findInLargeFile(p_text, p_options);
+        return;
+    }
+
     TextViewWindowHelper::handleFindNext(this, p_text, p_options);
 }
 
@@ -246,7 +280,12 @@ void TextViewWindow::handleFileOpenParameters(const QSharedPointer<FileOpenParam
     }
 
     if (p_paras->m_lineNumber > -1) {
-        m_editor->scrollToLine(p_paras->m_lineNumber, true);
+        if (m_largeFile) {
+            const int page = m_largeFile->pageOfLine(p_paras->m_lineNumber);
+            loadLargeFilePage(page, p_paras->m_lineNumber - m_largeFile->pageFirstLine(page));
+        } else {
+            m_editor->scrollToLine(p_paras->m_lineNumber, true);
+        }
     }
 }
 
@@ -255,6 +294,121 @@ ViewWindowSession TextViewWindow::saveSession() const
     auto session = ViewWindow::saveSession();
     if (getBuffer()) {
         session.m_lineNumber = m_editor->getCursorPosition().first;
+        if (m_largeFile) {
+            session.m_lineNumber += m_largeFile->pageFirstLine(m_largeFilePage);
+        }
     }
     return session;
 }
+
+void TextViewWindow::loadLargeFilePage(int p_page, int p_lineInPage)
+{
+    if (!m_largeFile || p_page < 0 || p_page >= m_largeFile->pageCount()) {
+        return;
+    }
+
+    const bool old = m_propogateEditorToBuffer;
+    m_propogateEditorToBuffer = false;
+
+    m_largeFilePage = p_page;
+    m_editor->setText(m_largeFile->readPage(p_page));
+    m_editor->setModified(false);
+
+    m_propogateEditorToBuffer = old;
+
+    if (p_lineInPage >= 0) {
+        m_editor->scrollToLine(p_lineInPage, true);
+    }
+
+    updateLargeFileActions();
+
+    if (m_largeFile->pageCount() > 1) {
+        showMessage(tr("Large file: page %1/%2 from line %3").arg(QString::number(p_page + 1),
+                                                                   QString::number(m_largeFile->pageCount()),
+                                                                   QString::number(m_largeFile->pageFirstLine(p_page) + 1)));
+    }
+}
+
+void TextViewWindow::updateLargeFileActions()
+{
+    if (!m_previousPageAct) {
+        return;
+    }
+
+    const bool paged = m_largeFile && m_largeFile->pageCount() > 1;
+    m_previousPageAct->setVisible(paged);
+    m_nextPageAct->setVisible(paged);
+    if (paged) {
+        m_previousPageAct->setEnabled(m_largeFilePage > 0);
+        m_nextPageAct->setEnabled(m_largeFilePage < m_largeFile->pageCount() - 1);
+    }
+}
+
+void TextViewWindow::findInLargeFile(const QString &p_text, FindOptions p_options)
+{
+    Q_ASSERT(m_largeFile);
+    if (p_text.isEmpty()) {
+        return;
+    }
+
+    const auto caseSensitivity = p_options & FindOption::CaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    const bool useRegExp = p_options & (FindOption::RegularExpression | FindOption::WholeWordOnly);
+    QRegularExpression regExp;
+    if (useRegExp) {
+        auto pattern = p_options & FindOption::RegularExpression ? p_text : QRegularExpression::escape(p_text);
+        if (p_options & FindOption::WholeWordOnly) {
+            pattern = QStringLiteral("\\b%1\\b").arg(pattern);
+        }
+        regExp.setPattern(pattern);
+        if (caseSensitivity == Qt::CaseInsensitive) {
+            regExp.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        }
+
+        if (!regExp.isValid()) {
+            showFindResult(p_text, 0, 0);
+            return;
+        }
+    }
+
+    const bool forward = !(p_options & FindOption::FindBackward);
+    const int cursorLine = m_largeFile->pageFirstLine(m_largeFilePage) + m_editor->getCursorPosition().first;
+
+    // Scanning a large file takes a while. The worker holds the file so it outlives a remap.
+    const int findId = ++m_largeFileFindId;
+    auto file = m_largeFile;
+    auto line = QSharedPointer<int>::create(-1);
+    auto th = QThread::create([file, line, cursorLine, forward, useRegExp, regExp, p_text, caseSensitivity]() {
+        *line = file->findLine(cursorLine + (forward ? 1 : -1),
+                               forward,
+                               [&](const QString &p_line) {
+                                   return useRegExp ? p_line.contains(regExp)
+                                                    : p_line.contains(p_text, caseSensitivity);
+                               });
+    });
+    connect(th, &QThread::finished,
+            th, &QObject::deleteLater);
+    connect(th, &QThread::finished,
+            this, [this, findId, line, p_text, p_options]() {
+                if (findId == m_largeFileFindId) {
+                    handleLargeFileFound(*line, p_text, p_options);
+                }
+            });
+    th->start();
+}
+
+void TextViewWindow::handleLargeFileFound(int p_line, const QString &p_text, FindOptions p_options)
+{
+    if (p_line == -1 || !m_largeFile) {
+        showFindResult(p_text, 0, 0);
+        return;
+    }
+
+    const int page = m_largeFile->pageOfLine(p_line);
+    if (page != m_largeFilePage) {
+        loadLargeFilePage(page);
+    }
+    m_editor->scrollToLine(p_line - m_largeFile->pageFirstLine(page), true);
+
+    // Highlight the match within the line found.
+    TextViewWindowHelper::handleFindNext(this, p_text, p_options & ~FindOptions(FindOption::FindBackward));
+}
@@ -3,6 +3,8 @@
 
 #include "viewwindow.h"
 
+class QAction;
+
 namespace vte
 {
     class TextEditorConfig;
@@ -14,6 +16,7 @@ namespace vnotex
     class TextEditor;
     class TextEditorConfig;
     class EditorConfig;
+    class MappedTextFile;
 
     class TextViewWindow : public ViewWindow
     {
@@ -76,6 +79,17 @@ namespace vnotex
 
         void handleFileOpenParameters(const QSharedPointer<FileOpenParameters> &p_paras);
 
+        // Show @p_page of the large file and put cursor at @p_lineInPage if not negative.
+        void loadLargeFilePage(int p_page, int p_lineInPage = -1);
+
+        void updateLargeFileActions();
+
+        // Search the large file line by line from the line after cursor across pages.
+        // The search runs in background and only the latest one is taken.
+        void findInLargeFile(const QString &p_text, FindOptions p_options);
+
+        void handleLargeFileFound(int p_line, const QString &p_text, FindOptions p_options);
+
         static QSharedPointer<vte::TextEditorConfig> createTextEditorConfig(const TextEditorConfig &p_config);
 
         static QSharedPointer<vte::TextEditorParameters> createTextEditorParameters(const EditorConfig& p_editorConfig, const TextEditorConfig &p_config);
@@ -87,6 +101,18 @@ namespace vnotex
         bool m_propogateEditorToBuffer = false;
 
         int m_textEditorConfigRevision = 0;
+
+        // Non-null if the buffer is a large file shown page by page.
+        QSharedPointer<const MappedTextFile> m_largeFile;
+
+        // Increased for each search in large file to drop outdated results.
+        int m_largeFileFindId = 0;
+
+        int m_largeFilePage = 0;
+
+        QAction *m_previousPageAct = nullptr;
+
+        QAction *m_nextPageAct = nullptr;
     };
 }
 
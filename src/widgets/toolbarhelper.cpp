@@ -9,6 +9,7 @@
 #include <QApplication>
 #include <QDir>
 #include <QFileDialog>
+#include <QLocale>
 
 #include "mainwindow.h"
 #include "vnotex.h"
@@ -20,11 +21,16 @@
 #include "fullscreentoggleaction.h"
 #include <core/configmgr.h>
 #include <core/coreconfig.h>
+#include <core/editorconfig.h>
+#include <core/buffermgr.h>
+#include <core/notebookmgr.h>
+#include <notebook/notebook.h>
 #include <core/sessionconfig.h>
 #include <core/fileopenparameters.h>
 #include <core/exception.h>
 #include "propertydefs.h"
 #include "dialogs/settings/settingsdialog.h"
+#include "editors/markdownviewerpool.h"
 #include <core/task.h>
 #include "messageboxhelper.h"
 
@@ -555,6 +561,51 @@ QToolBar *ToolBarHelper::setupSettingsToolBar(MainWindow *p_win, QToolBar *p_too
                             }
                         });
 
+        menu->addAction(MainWindow::tr("Buffer Diagnostics"),
+                        menu,
+                        [p_win]() {
+                            const auto &bufferMgr = VNoteX::getInst().getBufferMgr();
+                            const auto &viewerPool = MarkdownViewerPool::getInst();
+                            const int budget = ConfigMgr::getInst().getEditorConfig().getBufferMemoryBudget();
+                            const auto formatTime = [](qint64 p_msecs) {
+                                return p_msecs >= 0 ? MainWindow::tr("%1 ms").arg(p_msecs) : MainWindow::tr("N/A");
+                            };
+                            const auto memoryUsage = viewerPool.getAverageMemoryUsage();
+                            QLocale locale;
+                            auto text = MainWindow::tr("Open buffers: %1\n"
+                                                             "Buffers with contents dropped: %2\n"
+                                                             "Resident buffer contents: %3\n"
+                                                             "Memory budget: %4\n"
+                                                             "Markdown viewers: %5 (%6 idle in pool)\n"
+                                                             "Average time to render a note in a loaded viewer: %7\n"
+                                                             "Average time to render a note in a new viewer: %8\n"
+                                                             "Average JS heap per Markdown tab: %9 (%10 tabs measured)")
+                                                             .arg(bufferMgr.getBufferCount())
+                                                             .arg(bufferMgr.getEvictedBufferCount())
+                                                             .arg(locale.formattedDataSize(bufferMgr.getResidentBytes()))
+                                                             .arg(budget > 0 ? locale.formattedDataSize(static_cast<qint64>(budget) * 1024 * 1024)
+                                                                             : MainWindow::tr("Unlimited"))
+                                                             .arg(viewerPool.getViewerCount())
+                                                             .arg(viewerPool.getIdleViewerCount())
+                                                             .arg(formatTime(viewerPool.getAverageFirstRenderTime(true)))
+                                                             .arg(formatTime(viewerPool.getAverageFirstRenderTime(false)))
+                                                             .arg(memoryUsage >= 0 ? locale.formattedDataSize(memoryUsage) : MainWindow::tr("N/A"))
+                                                             .arg(viewerPool.getMeasuredViewerCount());
+                            const auto &notebookMgr = VNoteX::getInst().getNotebookMgr();
+                            const auto notebook = notebookMgr.findNotebookById(notebookMgr.getCurrentNotebookId());
+                            if (notebook) {
+                                text += MainWindow::tr("\nLoaded nodes of notebook %1: %2").arg(notebook->getName(),
+                                                                                               notebook->collectNodeMemoryStats().toString());
+                            }
+                            MessageBoxHelper::notify(MessageBoxHelper::Information,
+                                                     text,
+                                                     MainWindow::tr("Unmodified notes not shown are dropped from memory beyond the budget "
+                                                                    "and read again on demand. Markdown viewers of hidden tabs "
+                                                                    "are given back to the pool with the viewer template kept loaded."),
+                                                     QString(),
+                                                     p_win);
+                        });
+
         menu->addSeparator();
 
         menu->addAction(MainWindow::tr("Feedback And Discussions"),
@@ -12,12 +12,15 @@
 #include <QApplication>
 #include <QSet>
 #include <QHash>
+#include <QPointer>
 
 #include "viewwindow.h"
+#include "lazyviewwindow.h"
 #include "mainwindow.h"
 #include "events.h"
 #include <utils/widgetutils.h>
 #include <utils/docsutils.h>
+#include <utils/pathutils.h>
 #include <utils/urldragdroputils.h>
 #include <core/vnotex.h>
 #include <core/configmgr.h>
@@ -110,6 +113,12 @@ ViewArea::ViewArea(QWidget *p_parent)
                 }
             });
 
+    m_prefetchTimer = new QTimer(this);
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(1500);
+    connect(m_prefetchTimer, &QTimer::timeout,
+            this, &ViewArea::prefetchLazyViewWindows);
+
     connect(qApp, &QApplication::focusChanged,
             this, [this](QWidget *p_old, QWidget *p_now) {
                 if (!p_now) {
@@ -161,10 +170,34 @@ void ViewArea::openBuffer(Buffer *p_buffer, const QSharedPointer<FileOpenParamet
 {
     // We allow multiple ViewWindows of the same buffer in different workspaces by default.
     QVector<ViewWindow *> wins;
+    LazyViewWindow *lazyWin = nullptr;
     if (!p_paras->m_alwaysNewWindow) {
         wins = findBufferInViewSplits(p_buffer);
+        if (wins.isEmpty()) {
+            lazyWin = findLazyViewWindowInViewSplits(p_buffer->getPath());
+        }
     }
-    if (wins.isEmpty()) {
+
+    if (lazyWin) {
+        // Load the placeholder in place instead of adding a duplicate tab.
+        auto split = lazyWin->getViewSplit();
+        const bool isCurrent = split->getCurrentViewWindow() == lazyWin;
+        auto window = p_buffer->createViewWindow(p_paras, nullptr);
+        split->addViewWindow(window);
+        split->moveViewWindow(window, split->indexOf(lazyWin));
+        if (isCurrent) {
+            split->setCurrentViewWindow(window);
+        }
+
+        split->takeViewWindow(lazyWin);
+        delete lazyWin;
+
+        if (p_paras->m_activate) {
+            setCurrentViewWindow(window);
+        } else {
+            checkCurrentViewWindowChange();
+        }
+    } else if (wins.isEmpty()) {
         if (!m_currentSplit) {
             addFirstViewSplit();
         }
@@ -174,7 +207,9 @@ void ViewArea::openBuffer(Buffer *p_buffer, const QSharedPointer<FileOpenParamet
         // Create a ViewWindow from @p_buffer.
         auto window = p_buffer->createViewWindow(p_paras, nullptr);
         m_currentSplit->addViewWindow(window);
-        setCurrentViewWindow(window);
+        if (p_paras->m_activate) {
+            setCurrentViewWindow(window);
+        }
     } else {
         auto selectedWin = wins.first();
         for (auto win : wins) {
@@ -187,7 +222,9 @@ void ViewArea::openBuffer(Buffer *p_buffer, const QSharedPointer<FileOpenParamet
 
         selectedWin->openTwice(p_paras);
 
-        setCurrentViewWindow(selectedWin);
+        if (p_paras->m_activate) {
+            setCurrentViewWindow(selectedWin);
+        }
     }
 
     if (p_paras->m_focus) {
@@ -211,6 +248,29 @@ QVector<ViewWindow *> ViewArea::findBufferInViewSplits(const Buffer *p_buffer) c
     return wins;
 }
 
+LazyViewWindow *ViewArea::findLazyViewWindowInViewSplits(const QString &p_bufferPath) const
+{
+    LazyViewWindow *lazyWin = nullptr;
+    for (auto split : m_splits) {
+        const int cnt = split->getViewWindowCount();
+        for (int i = 0; i < cnt; ++i) {
+            auto win = dynamic_cast<LazyViewWindow *>(split->getViewWindow(i));
+            if (win && PathUtils::areSamePaths(win->getSession().m_bufferPath, p_bufferPath)) {
+                if (split == m_currentSplit) {
+                    return win;
+                }
+
+                if (!lazyWin) {
+                    lazyWin = win;
+                }
+                break;
+            }
+        }
+    }
+
+    return lazyWin;
+}
+
 ViewSplit *ViewArea::createViewSplit(QWidget *p_parent, ID p_viewSplitId)
 {
     auto workspace = createWorkspace();
@@ -261,7 +321,11 @@ ViewSplit *ViewArea::createViewSplit(QWidget *p_parent, ID p_viewSplitId)
                 checkCurrentViewWindowChange();
             });
     connect(split, &ViewSplit::currentViewWindowChanged,
-            this, [this](ViewWindow *p_win) {
+            this, [this, split](ViewWindow *p_win) {
+                if (dynamic_cast<LazyViewWindow *>(p_win)) {
+                    loadCurrentLazyViewWindowLater(split);
+                }
+
                 checkCurrentViewWindowChange();
                 if (shouldUseGlobalStatusWidget()) {
                     if (p_win) {
@@ -501,7 +565,7 @@ void ViewArea::splitViewSplit(ViewSplit *p_split, SplitType p_type)
     // Clone a ViewWindow for the same buffer to display in the new split.
     {
         auto win = p_split->getCurrentViewWindow();
-        if (win) {
+        if (win && win->getBuffer()) {
             auto buffer = win->getBuffer();
             auto newWindow = buffer->createViewWindow(QSharedPointer<FileOpenParameters>::create(), newSplit);
             newSplit->addViewWindow(newWindow);
@@ -804,7 +868,7 @@ void ViewArea::setupShortcuts()
             connect(shortcut, &QShortcut::activated,
                     this, [this]() {
                         auto win = getCurrentViewWindow();
-                        if (win) {
+                        if (win && win->getBuffer()) {
                             auto node = win->getBuffer()->getNode();
                             if (node) {
                                 emit VNoteX::getInst().locateNodeRequested(node);
@@ -835,6 +899,10 @@ bool ViewArea::close(Node *p_node, bool p_force)
 {
     return closeIf(p_force, [p_node](ViewWindow *p_win) {
                 auto buffer = p_win->getBuffer();
+                if (!buffer) {
+                    // Placeholder not loaded yet.
+                    return PathUtils::pathContains(p_node->fetchAbsolutePath(), p_win->getTitle());
+                }
                 return buffer->match(p_node) || buffer->isChildOf(p_node);
             }, false);
 }
@@ -1038,7 +1106,9 @@ QList<Buffer *> ViewArea::getAllBuffersInViewSplits() const
     for (auto split : m_splits) {
         auto wins = getAllViewWindows(split);
         for (auto win : wins) {
-            bufferSet.insert(win->getBuffer());
+            if (win->getBuffer()) {
+                bufferSet.insert(win->getBuffer());
+            }
         }
     }
 
@@ -1090,7 +1160,7 @@ void ViewArea::loadSession()
             }
 
             for (const auto &winSession : ws.m_viewWindows) {
-                openViewWindowFromSession(winSession);
+                addLazyViewWindowFromSession(winSession);
             }
 
             // Check if there is any window.
@@ -1114,12 +1184,15 @@ void ViewArea::loadSession()
             const auto &ws = session.m_workspaces[it.value()];
 
             for (const auto &winSession : ws.m_viewWindows) {
-                openViewWindowFromSession(winSession);
+                addLazyViewWindowFromSession(winSession);
             }
 
             if (m_currentSplit->getViewWindowCount() > 0) {
                 m_currentSplit->setCurrentViewWindow(ws.m_currentViewWindowIndex);
             }
+
+            // Only the visible ViewWindows are loaded.
+            loadCurrentLazyViewWindowLater(split);
         }
 
         postFirstViewSplit();
@@ -1218,7 +1291,7 @@ void ViewArea::loadSplitterFromSession(const ViewAreaSession::Node &p_node, QSpl
     }
 }
 
-void ViewArea::openViewWindowFromSession(const ViewWindowSession &p_session)
+void ViewArea::openViewWindowFromSession(const ViewWindowSession &p_session, bool p_activate)
 {
     if (p_session.m_bufferPath.isEmpty()) {
         return;
@@ -1229,6 +1302,98 @@ void ViewArea::openViewWindowFromSession(const ViewWindowSession &p_session)
     paras->m_readOnly = p_session.m_readOnly;
     paras->m_lineNumber = p_session.m_lineNumber;
     paras->m_alwaysNewWindow = true;
+    paras->m_activate = p_activate;
+    paras->m_focus = p_activate;
 
     emit VNoteX::getInst().openFileRequested(p_session.m_bufferPath, paras);
 }
+
+void ViewArea::addLazyViewWindowFromSession(const ViewWindowSession &p_session)
+{
+    if (p_session.m_bufferPath.isEmpty()) {
+        return;
+    }
+
+    Q_ASSERT(m_currentSplit);
+    m_currentSplit->addViewWindow(new LazyViewWindow(p_session, nullptr));
+}
+
+void ViewArea::loadCurrentLazyViewWindowLater(ViewSplit *p_split)
+{
+    // The split may be switched to another workspace or closed in between.
+    QPointer<ViewSplit> split(p_split);
+    QTimer::singleShot(0, this, [this, split]() {
+        if (!split) {
+            return;
+        }
+
+        auto win = dynamic_cast<LazyViewWindow *>(split->getCurrentViewWindow());
+        if (win) {
+            loadLazyViewWindow(win, true);
+        }
+    });
+}
+
+void ViewArea::loadLazyViewWindow(LazyViewWindow *p_win, bool p_activate)
+{
+    auto split = p_win->getViewSplit();
+    Q_ASSERT(split);
+
+    auto lastSplit = m_currentSplit;
+    setCurrentViewSplit(split, false);
+
+    const int idx = split->indexOf(p_win);
+    const int cnt = split->getViewWindowCount();
+    openViewWindowFromSession(p_win->getSession(), p_activate);
+
+    bool loaded = split->getViewWindowCount() > cnt;
+    if (loaded) {
+        // The new ViewWindow is appended to the split.
+        split->moveViewWindow(getAllViewWindows(split).last(), idx);
+    }
+
+    split->takeViewWindow(p_win);
+    delete p_win;
+
+    if (!loaded && split->getViewWindowCount() == 0) {
+        removeViewSplit(split, true);
+    }
+
+    if (!p_activate && m_splits.contains(lastSplit)) {
+        setCurrentViewSplit(lastSplit, false);
+    }
+
+    checkCurrentViewWindowChange();
+
+    if (p_activate) {
+        m_prefetchTimer->start();
+    }
+}
+
+void ViewArea::prefetchLazyViewWindows()
+{
+    if (!m_currentSplit) {
+        return;
+    }
+
+    const auto wins = getAllViewWindows(m_currentSplit);
+    const int idx = wins.indexOf(m_currentSplit->getCurrentViewWindow());
+    if (idx == -1) {
+        return;
+    }
+
+    for (int i : {idx + 1, idx - 1}) {
+        if (i < 0 || i >= wins.size()) {
+            continue;
+        }
+
+        auto win = dynamic_cast<LazyViewWindow *>(wins[i]);
+        if (win) {
+            loadLazyViewWindow(win, false);
+
+            // One at a time to keep responsive.
+            m_prefetchTimer->start();
+            return;
+        }
+    }
+}
@@ -19,6 +19,7 @@ namespace vnotex
 {
     class Buffer;
     class ViewWindow;
+    class LazyViewWindow;
     class Event;
     class Notebook;
     struct FileOpenParameters;
@@ -150,6 +151,9 @@ namespace vnotex
         // Does not search invisible work spaces.
         QVector<ViewWindow *> findBufferInViewSplits(const Buffer *p_buffer) const;
 
+        // Find placeholder of @p_bufferPath among all view splits, preferring current split.
+        LazyViewWindow *findLazyViewWindowInViewSplits(const QString &p_bufferPath) const;
+
         ViewSplit *createViewSplit(QWidget *p_parent, ID p_viewSplitId = InvalidViewSplitId);
 
         // A Scene widget will be used when there is no split.
@@ -216,7 +220,20 @@ namespace vnotex
 
         void loadSplitterFromSession(const ViewAreaSession::Node &p_node, QSplitter *p_splitter);
 
-        void openViewWindowFromSession(const ViewWindowSession &p_session);
+        // @p_activate: whether make the new ViewWindow current.
+        void openViewWindowFromSession(const ViewWindowSession &p_session, bool p_activate);
+
+        // Add a placeholder of @p_session to current split, which will be loaded once activated.
+        void addLazyViewWindowFromSession(const ViewWindowSession &p_session);
+
+        // Load current ViewWindow of @p_split if it is a placeholder when back to event loop.
+        void loadCurrentLazyViewWindowLater(ViewSplit *p_split);
+
+        // Replace @p_win with the real ViewWindow at the same tab.
+        void loadLazyViewWindow(LazyViewWindow *p_win, bool p_activate);
+
+        // Load placeholders next to current ViewWindow, which are likely to be visited next.
+        void prefetchLazyViewWindows();
 
         QLayout *m_mainLayout = nullptr;
 
@@ -240,6 +257,9 @@ namespace vnotex
         // Timer to check file change outside periodically.
         QTimer *m_fileCheckTimer = nullptr;
 
+        // Timer to prefetch placeholders after activating one.
+        QTimer *m_prefetchTimer = nullptr;
+
         ID m_nextViewSplitId = InvalidViewSplitId + 1;
     };
 } // ns vnotex
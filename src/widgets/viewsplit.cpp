@@ -380,6 +380,13 @@ void ViewSplit::takeViewWindow(ViewWindow *p_win)
     p_win->setParent(nullptr);
 }
 
+void ViewSplit::moveViewWindow(ViewWindow *p_win, int p_idx)
+{
+    int idx = indexOf(p_win);
+    Q_ASSERT(idx != -1);
+    tabBar()->moveTab(idx, p_idx);
+}
+
 QSharedPointer<ViewWorkspace> ViewSplit::getWorkspace() const
 {
     return m_workspace;
@@ -593,7 +600,7 @@ void ViewSplit::createContextMenuOnTabBar(QMenu *p_menu, int p_tabIdx) const
                       [this, p_tabIdx]() {
                           auto win = getViewWindow(p_tabIdx);
                           if (win) {
-                              const auto filePath = win->getBuffer()->getPath();
+                              const auto filePath = win->getTitle();
                               ClipboardUtils::setTextToClipboard(filePath);
                               VNoteX::getInst().showStatusMessageShort(tr("Copied path: %1").arg(filePath));
                           }
@@ -604,14 +611,14 @@ void ViewSplit::createContextMenuOnTabBar(QMenu *p_menu, int p_tabIdx) const
                       [this, p_tabIdx]() {
                           auto win = getViewWindow(p_tabIdx);
                           if (win) {
-                              const auto location = PathUtils::parentDirPath(win->getBuffer()->getPath());
+                              const auto location = PathUtils::parentDirPath(win->getTitle());
                               WidgetUtils::openUrlByDesktop(QUrl::fromLocalFile(location));
                           }
                       });
 
     // Locate Node.
     auto win = getViewWindow(p_tabIdx);
-    if (win && win->getBuffer()->getNode()) {
+    if (win && win->getBuffer() && win->getBuffer()->getNode()) {
         auto locateNodeAct = p_menu->addAction(tr("Locate Node"),
                                                [this, p_tabIdx]() {
                                                    auto win = getViewWindow(p_tabIdx);
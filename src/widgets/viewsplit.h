@@ -51,6 +51,9 @@ namespace vnotex
         // @p_win is not deleted.
         void takeViewWindow(ViewWindow *p_win);
 
+        // Move @p_win to tab @p_idx.
+        void moveViewWindow(ViewWindow *p_win, int p_idx);
+
         void setWorkspace(const QSharedPointer<ViewWorkspace> &p_workspace);
 
         QSharedPointer<ViewWorkspace> getWorkspace() const;
@@ -20,6 +20,7 @@
 #include <utils/iconutils.h>
 #include <utils/utils.h>
 #include <utils/widgetutils.h>
+#include <utils/adaptivesynctimer.h>
 #include <core/configmgr.h>
 #include <core/editorconfig.h>
 #include "messageboxhelper.h"
@@ -60,10 +61,9 @@ ViewWindow::ViewWindow(QWidget *p_parent)
                 }
             });
 
-    m_syncBufferContentTimer = new QTimer(this);
-    m_syncBufferContentTimer->setSingleShot(true);
-    m_syncBufferContentTimer->setInterval(500);
-    connect(m_syncBufferContentTimer, &QTimer::timeout,
+    // Small notes sync almost instantly while large ones are throttled.
+    m_syncBufferContentTimer = new AdaptiveSyncTimer(100, 2000, this);
+    connect(m_syncBufferContentTimer, &AdaptiveSyncTimer::timeout,
             this, [this]() {
                 Q_ASSERT(getBuffer());
                 if (getBuffer()->getRevision() != m_bufferRevision) {
@@ -167,6 +167,11 @@ void ViewWindow::detachFromBuffer(bool p_quiet)
 
     detachFromBufferInternal();
 
+    // Cost of previous buffer does not apply.
+    m_syncBufferContentTimer->stop();
+    m_syncBufferContentTimer->finish();
+    m_syncBufferContentTimer->reset();
+
     disconnect(this, 0, m_buffer, 0);
     disconnect(m_buffer, 0, this, 0);
 
@@ -178,6 +183,16 @@ void ViewWindow::detachFromBuffer(bool p_quiet)
     }
 }
 
+void ViewWindow::deferSyncBufferContent()
+{
+    m_syncBufferContentTimer->defer();
+}
+
+void ViewWindow::finishSyncBufferContent()
+{
+    m_syncBufferContentTimer->finish();
+}
+
 QIcon ViewWindow::getIcon() const
 {
     if (m_buffer) {
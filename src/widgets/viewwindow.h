@@ -12,12 +12,12 @@
 #include "viewwindowsession.h"
 
 class QVBoxLayout;
-class QTimer;
 class QToolBar;
 
 namespace vnotex
 {
     class ViewSplit;
+    class AdaptiveSyncTimer;
     struct FileOpenParameters;
     class DragDropAreaIndicator;
     class DragDropAreaIndicatorInterface;
@@ -54,7 +54,7 @@ namespace vnotex
 
         virtual QString getName() const;
 
-        QString getTitle() const;
+        virtual QString getTitle() const;
 
         ViewSplit *getViewSplit() const;
         void setViewSplit(ViewSplit *p_split);
@@ -196,6 +196,12 @@ namespace vnotex
         // Sync buffer content changes to editor.
         virtual void syncEditorFromBufferContent() = 0;
 
+        // Called within syncEditorFromBufferContent() by windows rendering asynchronously.
+        // Call finishSyncBufferContent() once the content is rendered.
+        void deferSyncBufferContent();
+
+        void finishSyncBufferContent();
+
         // Whether we are in a mode that enable us to insert text.
         bool inModeCanInsert() const;
 
@@ -309,7 +315,8 @@ namespace vnotex
         // Managed by QObject.
         QVBoxLayout *m_bottomLayout = nullptr;
 
-        QTimer *m_syncBufferContentTimer = nullptr;
+        // Interval follows the cost of previous sync of the buffer.
+        AdaptiveSyncTimer *m_syncBufferContentTimer = nullptr;
 
         // Managed by QObject.
         // Allocated on necessary. Use getAttachmentDragDropArea() to access.
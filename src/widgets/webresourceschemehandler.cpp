@@ -0,0 +1,103 @@
+#include "webresourceschemehandler.h"
+
+#include <QWebEngineUrlScheme>
+#include <QWebEngineUrlRequestJob>
+#include <QWebEngineProfile>
+#include <QBuffer>
+#include <QFileInfo>
+#include <QMimeDatabase>
+#include <QDebug>
+
+#include <core/configmgr.h>
+#include <core/htmltemplatehelper.h>
+#include <core/exception.h>
+#include <utils/fileutils.h>
+#include <utils/pathutils.h>
+
+using namespace vnotex;
+
+const QByteArray WebResourceSchemeHandler::c_scheme = QByteArrayLiteral("vxres");
+
+void WebResourceSchemeHandler::registerScheme()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QWebEngineUrlScheme scheme(c_scheme);
+    scheme.setSyntax(QWebEngineUrlScheme::Syntax::Path);
+    scheme.setFlags(QWebEngineUrlScheme::SecureScheme
+                    | QWebEngineUrlScheme::LocalScheme
+                    | QWebEngineUrlScheme::LocalAccessAllowed
+                    | QWebEngineUrlScheme::CorsEnabled);
+    QWebEngineUrlScheme::registerScheme(scheme);
+#endif
+}
+
+void WebResourceSchemeHandler::install()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const auto &configMgr = ConfigMgr::getInst();
+    auto profile = QWebEngineProfile::defaultProfile();
+    auto handler = new WebResourceSchemeHandler({configMgr.getAppFolder(), configMgr.getUserFolder()}, profile);
+    profile->installUrlSchemeHandler(c_scheme, handler);
+
+    HtmlTemplateHelper::setViewerResourceScheme(QString::fromLatin1(c_scheme));
+#endif
+}
+
+WebResourceSchemeHandler::WebResourceSchemeHandler(const QStringList &p_rootFolders, QObject *p_parent)
+    : QWebEngineUrlSchemeHandler(p_parent),
+      m_rootFolders(p_rootFolders)
+{
+}
+
+bool WebResourceSchemeHandler::isAllowed(const QString &p_filePath) const
+{
+    for (const auto &folder : m_rootFolders) {
+        if (PathUtils::pathContains(folder, p_filePath)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WebResourceSchemeHandler::requestStarted(QWebEngineUrlRequestJob *p_job)
+{
+    auto url = p_job->requestUrl();
+    url.setScheme(QStringLiteral("file"));
+    const auto filePath = PathUtils::cleanPath(url.toLocalFile());
+    if (!isAllowed(filePath)) {
+        qWarning() << "denied web resource request" << p_job->requestUrl();
+        p_job->fail(QWebEngineUrlRequestJob::RequestDenied);
+        return;
+    }
+
+    // A stat to pick up changes of user files.
+    const QFileInfo info(filePath);
+    if (!info.isFile()) {
+        p_job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    const auto modifiedTime = info.lastModified().toMSecsSinceEpoch();
+    auto it = m_resources.find(filePath);
+    if (it == m_resources.end() || it->m_modifiedTime != modifiedTime) {
+        Resource res;
+        res.m_modifiedTime = modifiedTime;
+        try {
+            res.m_data = FileUtils::readFile(filePath);
+        } catch (Exception &p_e) {
+            qWarning() << "failed to read web resource" << filePath << p_e.what();
+            p_job->fail(QWebEngineUrlRequestJob::RequestFailed);
+            return;
+        }
+
+        static QMimeDatabase mimeDb;
+        res.m_mimeType = mimeDb.mimeTypeForFile(filePath, QMimeDatabase::MatchExtension).name().toLatin1();
+        it = m_resources.insert(filePath, res);
+    }
+
+    // Job owns the buffer. Data is implicitly shared with the cache.
+    auto buffer = new QBuffer(p_job);
+    buffer->setData(it->m_data);
+    p_job->reply(it->m_mimeType, buffer);
+}
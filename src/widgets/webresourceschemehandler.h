@@ -0,0 +1,52 @@
+#ifndef WEBRESOURCESCHEMEHANDLER_H
+#define WEBRESOURCESCHEMEHANDLER_H
+
+#include <QWebEngineUrlSchemeHandler>
+#include <QHash>
+#include <QByteArray>
+#include <QStringList>
+
+namespace vnotex
+{
+    // Serve styles and scripts of the viewer template from memory.
+    // URL is the file URL of the resource with scheme c_scheme, so relative URLs
+    // within styles resolve as well. Only files within the app and user folders are served.
+    class WebResourceSchemeHandler : public QWebEngineUrlSchemeHandler
+    {
+        Q_OBJECT
+    public:
+        // Must be called before QApplication is created.
+        // Fonts referred by styles need CORS, which custom schemes support since Qt 5.14.
+        // It does nothing before Qt 5.14 and file URLs are kept.
+        static void registerScheme();
+
+        // Install to the default profile and tell HtmlTemplateHelper to use it.
+        // It does nothing before Qt 5.14.
+        static void install();
+
+        void requestStarted(QWebEngineUrlRequestJob *p_job) Q_DECL_OVERRIDE;
+
+        static const QByteArray c_scheme;
+
+    private:
+        struct Resource
+        {
+            qint64 m_modifiedTime = 0;
+
+            QByteArray m_mimeType;
+
+            QByteArray m_data;
+        };
+
+        explicit WebResourceSchemeHandler(const QStringList &p_rootFolders, QObject *p_parent = nullptr);
+
+        bool isAllowed(const QString &p_filePath) const;
+
+        QStringList m_rootFolders;
+
+        // Resources by file path.
+        QHash<QString, Resource> m_resources;
+    };
+}
+
+#endif // WEBRESOURCESCHEMEHANDLER_H
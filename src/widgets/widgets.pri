@@ -27,6 +27,7 @@ SOURCES += \
     $$PWD/dialogs/settings/texteditorpage.cpp \
     $$PWD/dialogs/settings/themepage.cpp \
     $$PWD/dialogs/sortdialog.cpp \
+    $$PWD/dialogs/filterednotesdialog.cpp \
     $$PWD/dialogs/tableinsertdialog.cpp \
     $$PWD/dragdropareaindicator.cpp \
     $$PWD/editors/editormarkdownvieweradapter.cpp \
@@ -37,6 +38,7 @@ SOURCES += \
     $$PWD/editors/markdowntablehelper.cpp \
     $$PWD/editors/markdownviewer.cpp \
     $$PWD/editors/markdownvieweradapter.cpp \
+    $$PWD/editors/markdownviewerpool.cpp \
     $$PWD/editors/plantumlhelper.cpp \
     $$PWD/editors/previewhelper.cpp \
     $$PWD/editors/statuswidget.cpp \
@@ -47,6 +49,8 @@ SOURCES += \
     $$PWD/findandreplacewidget.cpp \
     $$PWD/fullscreentoggleaction.cpp \
     $$PWD/inputdialog.cpp \
+    $$PWD/lazyviewwindow.cpp \
+    $$PWD/webresourceschemehandler.cpp \
     $$PWD/lineedit.cpp \
     $$PWD/lineeditdelegate.cpp \
     $$PWD/listwidget.cpp \
@@ -128,6 +132,7 @@ HEADERS += \
     $$PWD/dialogs/settings/texteditorpage.h \
     $$PWD/dialogs/settings/themepage.h \
     $$PWD/dialogs/sortdialog.h \
+    $$PWD/dialogs/filterednotesdialog.h \
     $$PWD/dialogs/tableinsertdialog.h \
     $$PWD/dragdropareaindicator.h \
     $$PWD/editors/editormarkdownvieweradapter.h \
@@ -138,6 +143,7 @@ HEADERS += \
     $$PWD/editors/markdowntablehelper.h \
     $$PWD/editors/markdownviewer.h \
     $$PWD/editors/markdownvieweradapter.h \
+    $$PWD/editors/markdownviewerpool.h \
     $$PWD/editors/plantumlhelper.h \
     $$PWD/editors/previewhelper.h \
     $$PWD/editors/statuswidget.h \
@@ -148,6 +154,8 @@ HEADERS += \
     $$PWD/findandreplacewidget.h \
     $$PWD/fullscreentoggleaction.h \
     $$PWD/inputdialog.h \
+    $$PWD/lazyviewwindow.h \
+    $$PWD/webresourceschemehandler.h \
     $$PWD/lineedit.h \
     $$PWD/lineeditdelegate.h \
     $$PWD/listwidget.h \
@@ -3,18 +3,36 @@
 #include <QDebug>
 #include <QTemporaryDir>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 
 #include <versioncontroller/dummyversioncontrollerfactory.h>
 #include <versioncontroller/iversioncontroller.h>
+#include <versioncontroller/gitversioncontroller.h>
 #include <notebookconfigmgr/vxnotebookconfigmgrfactory.h>
 #include <notebookconfigmgr/inotebookconfigmgr.h>
 #include <notebookconfigmgr/bundlenotebookconfigmgr.h>
+#include <notebookconfigmgr/vxnotebookchecker.h>
 #include <notebookbackend/localnotebookbackendfactory.h>
 #include <notebookbackend/inotebookbackend.h>
+#include <notebookbackend/asyncnotebookbackend.h>
 #include <notebook/bundlenotebookfactory.h>
 #include <notebook/notebook.h>
 #include <notebook/notebookparameters.h>
+#include <notebook/mediastore.h>
+#include <notebook/mediagarbagecollector.h>
+#include <notebook/nodemetadatatable.h>
+#include <notebook/notebookwatcher.h>
+#include <core/file.h>
+#include <core/externalfile.h>
+#include <buffer/buffer.h>
+#include <buffer/filebufferprovider.h>
 #include <utils/pathutils.h>
+#include <utils/fileutils.h>
+#include <widgets/dialogs/importfolderutils.h>
 
 using namespace tests;
 
@@ -42,6 +60,46 @@ void TestNotebook::testVersionControllerServer()
     QCOMPARE(dummyVC->getName(), dummyFactory->getName());
 }
 
+void TestNotebook::testGitStatusParsing()
+{
+    typedef IVersionController::Status Status;
+
+    // Output of "git status --porcelain=v1 -z" from the top level of a repository
+    // where the notebook is folder "notes".
+    QByteArray output;
+    output.append(" M notes/a.md").append('\0');
+    // Renamed, followed by the original path.
+    output.append("R  notes/new name.md").append('\0').append("notes/old name.md").append('\0');
+    output.append("?? notes/untracked/b.md").append('\0');
+    // Paths with quotes, spaces and non-ASCII characters are never quoted with -z.
+    output.append("?? notes/\"quoted\" \xc3\xa9t\xc3\xa9.md").append('\0');
+    output.append("A  notes/added.md").append('\0');
+    output.append(" D notes/deleted.md").append('\0');
+    output.append("UU notes/conflicted.md").append('\0');
+    // Outside the notebook.
+    output.append("?? other/c.md").append('\0');
+
+    const auto entries = GitVersionController::parseStatusOutput(output, QStringLiteral("notes/"));
+    QCOMPARE(entries.size(), 7);
+    QCOMPARE(entries[0].first, QStringLiteral("a.md"));
+    QCOMPARE(entries[0].second, Status::Modified);
+    QCOMPARE(entries[1].first, QStringLiteral("new name.md"));
+    QCOMPARE(entries[1].second, Status::Renamed);
+    QCOMPARE(entries[2].first, QStringLiteral("untracked/b.md"));
+    QCOMPARE(entries[2].second, Status::Untracked);
+    QCOMPARE(entries[3].first, QString::fromUtf8("\"quoted\" \xc3\xa9t\xc3\xa9.md"));
+    QCOMPARE(entries[3].second, Status::Untracked);
+    QCOMPARE(entries[4].second, Status::Added);
+    QCOMPARE(entries[5].second, Status::Deleted);
+    QCOMPARE(entries[6].second, Status::Conflicted);
+
+    // Notebook at the top level keeps all paths.
+    const auto allEntries = GitVersionController::parseStatusOutput(output, QString());
+    QCOMPARE(allEntries.size(), 8);
+    QCOMPARE(allEntries[1].first, QStringLiteral("notes/new name.md"));
+    QCOMPARE(allEntries[7].first, QStringLiteral("other/c.md"));
+}
+
 void TestNotebook::testNotebookConfigMgrServer()
 {
     Q_ASSERT(!m_ncmServer);
@@ -111,9 +169,633 @@ void TestNotebook::testBundleNotebookFactoryNewNotebook()
     QVERIFY(QFileInfo::exists(notebookConfigPath));
 }
 
+void TestNotebook::benchmarkFetchNodePath()
+{
+    auto notebook = newTestNotebook("deep_tree_notebook");
+
+    // Build a deep tree.
+    const int depth = 32;
+    Node *node = notebook->getRootNode().data();
+    for (int i = 0; i < depth; ++i) {
+        node = notebook->newNode(node, Node::Flag::Container, QString("folder_%1").arg(i)).data();
+    }
+    auto leaf = notebook->newNode(node, Node::Flag::Content, "leaf.md");
+
+    // Cached paths should share the same data without reallocation.
+    const auto path = leaf->fetchPath();
+    const auto absPath = leaf->fetchAbsolutePath();
+    QCOMPARE(leaf->fetchPath().constData(), path.constData());
+    QCOMPARE(leaf->fetchAbsolutePath().constData(), absPath.constData());
+
+    QBENCHMARK {
+        leaf->fetchPath();
+        leaf->fetchAbsolutePath();
+    }
+
+    // Adding and loading nodes should keep caches of others.
+    const auto generation = Node::getPathGeneration();
+    notebook->newNode(node, Node::Flag::Content, "sibling.md");
+    notebook->reloadNodes();
+    auto top = notebook->getRootNode()->findChild("folder_0");
+    top->load();
+    QCOMPARE(Node::getPathGeneration(), generation);
+
+    // Renaming an ancestor should invalidate the cache.
+    leaf = notebook->loadNodeByPath(path);
+    QVERIFY(leaf);
+    QCOMPARE(leaf->fetchPath(), path);
+    top->updateName("folder_renamed");
+    QVERIFY(Node::getPathGeneration() != generation);
+    QVERIFY(leaf->fetchPath().startsWith("folder_renamed/"));
+    QVERIFY(QFileInfo::exists(leaf->fetchAbsolutePath()));
+}
+
+void TestNotebook::testAsyncBackendCopyDir()
+{
+    auto notebook = newTestNotebook("async_backend_notebook");
+    auto backend = notebook->getBackend();
+    backend->makePath("src/sub");
+    backend->writeFile("src/a.txt", QByteArray(1024, 'a'));
+    backend->writeFile("src/sub/b.txt", QByteArray(2048, 'b'));
+
+    auto asyncBackend = notebook->getAsyncBackend();
+    QSignalSpy progressSpy(asyncBackend, &AsyncNotebookBackend::progressUpdated);
+    QSignalSpy finishedSpy(asyncBackend, &AsyncNotebookBackend::requestFinished);
+
+    QString errMsg("not called");
+    QVector<AsyncNotebookBackend::Operation> ops;
+    ops << AsyncNotebookBackend::Operation::copyDir("src", "dest")
+        << AsyncNotebookBackend::Operation::removeDir("src");
+    auto id = asyncBackend->submit(ops, [&errMsg](const QString &p_errMsg) {
+        errMsg = p_errMsg;
+    });
+
+    QVERIFY(finishedSpy.wait());
+    QCOMPARE(finishedSpy.first().at(0).value<ID>(), id);
+    QVERIFY(finishedSpy.first().at(1).toBool());
+    QVERIFY(errMsg.isEmpty());
+    QCOMPARE(asyncBackend->pendingRequestCount(), 0);
+
+    QVERIFY(!backend->exists("src"));
+    QCOMPARE(backend->readFile("dest/sub/b.txt"), QByteArray(2048, 'b'));
+
+    // Progress ends with all bytes done.
+    QVERIFY(!progressSpy.isEmpty());
+    QCOMPARE(progressSpy.last().at(1).toLongLong(), 3072);
+    QCOMPARE(progressSpy.last().at(2).toLongLong(), 3072);
+
+    // Failure stops the batch and reports the error.
+    ops.clear();
+    ops << AsyncNotebookBackend::Operation::copyDir("not_exist", "dest2")
+        << AsyncNotebookBackend::Operation::makePath("dest3");
+    asyncBackend->submit(ops, [&errMsg](const QString &p_errMsg) {
+        errMsg = p_errMsg;
+    });
+    QVERIFY(finishedSpy.wait());
+    QVERIFY(!errMsg.isEmpty());
+    QVERIFY(!backend->exists("dest3"));
+
+    // Serial moves of same-named files into one folder get unique names.
+    backend->makePath("bin");
+    ID lastId = AsyncNotebookBackend::InvalidRequestId;
+    for (int i = 0; i < 3; ++i) {
+        const auto dirPath = QString("x%1").arg(i);
+        backend->makePath(dirPath);
+        backend->writeFile(dirPath + "/c.txt", QByteArray::number(i));
+        lastId = asyncBackend->submit({AsyncNotebookBackend::Operation::moveFileInto(dirPath + "/c.txt", "bin")},
+                                      nullptr,
+                                      true);
+    }
+    // Serial requests run in order, so the last one finishes last.
+    asyncBackend->wait(lastId);
+    QTRY_COMPARE(asyncBackend->pendingRequestCount(), 0);
+    QCOMPARE(QDir(backend->getFullPath("bin")).entryList(QDir::Files).size(), 3);
+    QCOMPARE(backend->readFile("bin/c.txt"), QByteArray("0"));
+    QVERIFY(!backend->exists("x0/c.txt"));
+}
+
+void TestNotebook::testMoveNodeWithinNotebook()
+{
+    auto notebook = newTestNotebook("move_node_notebook");
+    auto root = notebook->getRootNode();
+    auto folderA = notebook->newNode(root.data(), Node::Flag::Container, "folder_a");
+    auto folderB = notebook->newNode(root.data(), Node::Flag::Container, "folder_b");
+    auto note = notebook->newNode(folderA.data(), Node::Flag::Content, "note.md", "hello");
+    const auto noteId = note->getId();
+    const auto srcAttachmentFolderPath = note->fetchAttachmentFolderPath();
+    note->newAttachmentFile(srcAttachmentFolderPath, "atta.txt");
+
+    // Move a file node with its attachment.
+    auto movedNote = notebook->copyNodeAsChildOf(note, folderB.data(), true);
+    QVERIFY(movedNote);
+    QCOMPARE(movedNote->getId(), noteId);
+    QCOMPARE(movedNote->getParent(), folderB.data());
+    QVERIFY(!folderA->findChild("note.md"));
+    QVERIFY(!QFileInfo::exists(PathUtils::concatenateFilePath(folderA->fetchAbsolutePath(), "note.md")));
+    QCOMPARE(notebook->getBackend()->readTextFile(movedNote->fetchPath()), QString("hello"));
+    QVERIFY(!QFileInfo::exists(srcAttachmentFolderPath));
+    QVERIFY(QFileInfo::exists(PathUtils::concatenateFilePath(movedNote->fetchAttachmentFolderPath(), "atta.txt")));
+
+    // Move a folder node as a whole.
+    auto movedFolder = notebook->copyNodeAsChildOf(folderB, folderA.data(), true);
+    QVERIFY(movedFolder);
+    QVERIFY(!root->findChild("folder_b"));
+    QVERIFY(!QFileInfo::exists(PathUtils::concatenateFilePath(root->fetchAbsolutePath(), "folder_b")));
+
+    // Children are loaded from the moved config.
+    movedFolder->load();
+    QCOMPARE(movedFolder->getId(), folderB->getId());
+    auto reloadedNote = movedFolder->findChild("note.md");
+    QVERIFY(reloadedNote);
+    QCOMPARE(reloadedNote->getId(), noteId);
+    QVERIFY(QFileInfo::exists(PathUtils::concatenateFilePath(reloadedNote->fetchAttachmentFolderPath(), "atta.txt")));
+
+    // Attachments are copied to another notebook in background. The source goes afterwards.
+    auto otherNotebook = newTestNotebook("move_node_other_notebook");
+    auto otherRoot = otherNotebook->getRootNode();
+    const auto srcNotePath = reloadedNote->fetchAbsolutePath();
+    QSignalSpy finishedSpy(otherNotebook->getAsyncBackend(), &AsyncNotebookBackend::requestFinished);
+    auto copiedNote = otherNotebook->copyNodeAsChildOf(reloadedNote, otherRoot.data(), true);
+    QVERIFY(copiedNote);
+    QCOMPARE(otherNotebook->getBackend()->readTextFile(copiedNote->fetchPath()), QString("hello"));
+    QVERIFY(QFileInfo::exists(srcNotePath));
+    QVERIFY(finishedSpy.count() > 0 || finishedSpy.wait());
+    QVERIFY(finishedSpy.first().at(1).toBool());
+    QVERIFY(QFileInfo::exists(PathUtils::concatenateFilePath(copiedNote->fetchAttachmentFolderPath(), "atta.txt")));
+    QVERIFY(!QFileInfo::exists(srcNotePath));
+    QVERIFY(!movedFolder->findChild("note.md"));
+}
+
+void TestNotebook::testMediaStoreRefCount()
+{
+    auto notebook = newTestNotebook("media_store_notebook");
+    auto store = notebook->getMediaStore();
+
+    // Same content is stored once.
+    const QByteArray data("fake image data");
+    const auto blobPath = store->addData(data, "png");
+    QVERIFY(store->contains(blobPath));
+    QVERIFY(MediaStore::isBlobPath(blobPath));
+    QCOMPARE(store->addData(data, "png"), blobPath);
+    QCOMPARE(store->getRefCount(blobPath), 2);
+
+    const auto otherPath = store->addData(QByteArray("other image data"), "png");
+    QVERIFY(otherPath != blobPath);
+
+    // The blob is kept until the last reference is dropped.
+    QVERIFY(!store->release(blobPath));
+    QVERIFY(QFileInfo::exists(blobPath));
+    QCOMPARE(store->getRefCount(blobPath), 1);
+
+    // Counts are hints. The blob is kept until the collector finds no note linking it.
+    QVERIFY(store->release(blobPath));
+    QVERIFY(QFileInfo::exists(blobPath));
+    QCOMPARE(store->getRefCount(blobPath), 0);
+    QCOMPARE(store->getRefCount(otherPath), 1);
+
+    auto root = notebook->getRootNode();
+    const auto linkPath = PathUtils::relativePath(root->fetchAbsolutePath(), blobPath);
+    auto note = notebook->newNode(root.data(),
+                                  Node::Flag::Content,
+                                  "note.md",
+                                  QString("![](%1)").arg(linkPath));
+
+    auto collector = notebook->getMediaGarbageCollector();
+    QVERIFY(collector->collect(false));
+    collector->waitForDone();
+    notebook->getAsyncBackend()->waitForDone();
+    QVERIFY(QFileInfo::exists(blobPath));
+    QVERIFY(!QFileInfo::exists(otherPath));
+    QCOMPARE(store->getRefCount(blobPath), 1);
+
+    notebook->removeNode(note, true);
+    QVERIFY(collector->collect(false));
+    collector->waitForDone();
+    notebook->getAsyncBackend()->waitForDone();
+    QVERIFY(!QFileInfo::exists(blobPath));
+}
+
+void TestNotebook::testMediaGarbageCollector()
+{
+    auto notebook = newTestNotebook("media_gc_notebook");
+    auto root = notebook->getRootNode();
+    const auto imageFolderPath = PathUtils::concatenateFilePath(root->fetchAbsolutePath(), notebook->getImageFolder());
+    notebook->getBackend()->makePath(imageFolderPath);
+    FileUtils::writeFile(PathUtils::concatenateFilePath(imageFolderPath, "used.png"), QByteArray("used"));
+    FileUtils::writeFile(PathUtils::concatenateFilePath(imageFolderPath, "orphan.png"), QByteArray("orphan"));
+    notebook->newNode(root.data(),
+                      Node::Flag::Content,
+                      "note.md",
+                      QString("![](%1/used.png)").arg(notebook->getImageFolder()));
+
+    auto collector = notebook->getMediaGarbageCollector();
+    MediaGarbageCollector::Result result;
+    connect(collector, &MediaGarbageCollector::finished,
+            this, [&result](const MediaGarbageCollector::Result &p_result) {
+                result = p_result;
+            });
+
+    // Dry run only reports.
+    QVERIFY(collector->collect(true));
+    collector->waitForDone();
+    QCOMPARE(result.m_noteCount, 1);
+    QCOMPARE(result.m_parsedNoteCount, 1);
+    QCOMPARE(result.m_files.size(), 1);
+    QVERIFY(result.m_files[0].endsWith("orphan.png"));
+    QVERIFY(QFileInfo::exists(result.m_files[0]));
+
+    // Unsaved contents are parsed instead of the files.
+    QHash<QString, QString> unsavedContents;
+    unsavedContents.insert(PathUtils::concatenateFilePath(root->fetchAbsolutePath(), "note.md"),
+                           QString("![](%1/used.png) ![](%1/orphan.png)").arg(notebook->getImageFolder()));
+    QVERIFY(collector->collect(true, unsavedContents));
+    collector->waitForDone();
+    QCOMPARE(result.m_parsedNoteCount, 1);
+    QVERIFY(result.m_files.isEmpty());
+
+    QVERIFY(collector->collect(true));
+    collector->waitForDone();
+    QCOMPARE(result.m_parsedNoteCount, 1);
+
+    // Unchanged notes are served from cache.
+    QVERIFY(collector->collect(true));
+    collector->waitForDone();
+    QCOMPARE(result.m_parsedNoteCount, 0);
+    QCOMPARE(result.m_files.size(), 1);
+
+    // Files linked only by normal links, reference definitions or HTML are in use too.
+    const QStringList linkedFiles = {"spec.pdf", "link.png", "ref.png", "html.png", "anchor.pdf", "space name.png"};
+    for (const auto &name : linkedFiles) {
+        FileUtils::writeFile(PathUtils::concatenateFilePath(imageFolderPath, name), name.toUtf8());
+    }
+    notebook->newNode(root.data(),
+                      Node::Flag::Content,
+                      "links.md",
+                      QString("[spec](%1/spec.pdf \"Spec\") and [a](./%1/link.png)\n\n"
+                              "[ref]: %1/ref.png\n\n"
+                              "<img width=\"10\" src=\"%1/html.png\">\n"
+                              "<a href='%1/anchor.pdf#page=2'>pdf</a>\n"
+                              "[b](<%1/space name.png>) [c](https://example.com/%1/orphan.png)").arg(notebook->getImageFolder()));
+    QVERIFY(collector->collect(true));
+    collector->waitForDone();
+    QCOMPARE(result.m_parsedNoteCount, 1);
+    QCOMPARE(result.m_files.size(), 1);
+    QVERIFY(result.m_files[0].endsWith("orphan.png"));
+
+    // Apply the result of the dry run. Moves finish in background.
+    QSignalSpy appliedSpy(collector, &MediaGarbageCollector::applied);
+    QVERIFY(collector->apply(result));
+    QVERIFY(collector->isRunning());
+    QVERIFY(!collector->collect(true));
+    QVERIFY(appliedSpy.wait());
+    QCOMPARE(appliedSpy.first().at(0).toInt(), 1);
+    QVERIFY(!collector->isRunning());
+    QVERIFY(!QFileInfo::exists(PathUtils::concatenateFilePath(imageFolderPath, "orphan.png")));
+    QVERIFY(QFileInfo::exists(PathUtils::concatenateFilePath(imageFolderPath, "used.png")));
+    for (const auto &name : linkedFiles) {
+        QVERIFY(QFileInfo::exists(PathUtils::concatenateFilePath(imageFolderPath, name)));
+    }
+}
+
+void TestNotebook::testPurgeRecycleBin()
+{
+    auto notebook = newTestNotebook("purge_recycle_bin_notebook");
+    auto recycleBin = notebook->getRecycleBinNode();
+    QVERIFY(recycleBin);
+
+    const auto today = QDate::currentDate();
+    auto addDateFolder = [&](int p_daysAgo, const QByteArray &p_data) {
+        auto node = notebook->newNode(recycleBin.data(),
+                                      Node::Flag::Container,
+                                      today.addDays(-p_daysAgo).toString("yyyyMMdd"));
+        FileUtils::writeFile(PathUtils::concatenateFilePath(node->fetchAbsolutePath(), "deleted.txt"), p_data);
+        return node->fetchAbsolutePath();
+    };
+
+    const auto expiredPath = addDateFolder(100, "expired");
+    const auto oldPath = addDateFolder(20, QByteArray(1024, 'a'));
+    const auto recentPath = addDateFolder(10, QByteArray(1024, 'b'));
+    const auto todayPath = addDateFolder(0, QByteArray(1024, 'c'));
+
+    QSignalSpy spy(notebook.data(), &Notebook::recycleBinPurged);
+
+    // By age.
+    notebook->purgeRecycleBin(30, 0);
+    QVERIFY(spy.count() > 0 || spy.wait());
+    QCOMPARE(spy.takeFirst().at(0).toInt(), 1);
+    QVERIFY(!QFileInfo::exists(expiredPath));
+    QCOMPARE(recycleBin->getChildrenCount(), 3);
+
+    // By size. Oldest goes first and today is kept.
+    notebook->purgeRecycleBin(0, 2500);
+    QVERIFY(spy.count() > 0 || spy.wait());
+    QCOMPARE(spy.takeFirst().at(0).toInt(), 1);
+    QVERIFY(!QFileInfo::exists(oldPath));
+    QVERIFY(QFileInfo::exists(recentPath));
+    QVERIFY(QFileInfo::exists(todayPath));
+
+    notebook->purgeRecycleBin(0, 1);
+    QVERIFY(spy.count() > 0 || spy.wait());
+    QCOMPARE(spy.takeFirst().at(0).toInt(), 1);
+    QVERIFY(!QFileInfo::exists(recentPath));
+    QVERIFY(QFileInfo::exists(todayPath));
+    QCOMPARE(recycleBin->getChildrenCount(), 1);
+}
+
+void TestNotebook::testNotebookChecker()
+{
+    auto notebook = newTestNotebook("checker_notebook");
+    auto root = notebook->getRootNode();
+    auto folder = notebook->newNode(root.data(), Node::Flag::Container, "folder");
+    auto missingNote = notebook->newNode(folder.data(), Node::Flag::Content, "missing.md");
+    notebook->newNode(folder.data(), Node::Flag::Content, "kept.md");
+
+    // Drift made outside.
+    QFile::remove(missingNote->fetchAbsolutePath());
+    FileUtils::writeFile(PathUtils::concatenateFilePath(folder->fetchAbsolutePath(), "unindexed.md"), QString("hi"));
+    const auto orphanPath = PathUtils::concatenateFilePath(folder->fetchAbsolutePath(),
+                                                           notebook->getAttachmentFolder() + "/orphan");
+    notebook->getBackend()->makePath(orphanPath);
+
+    VXNotebookChecker checker(notebook.data());
+    auto report = checker.check();
+    QCOMPARE(report.m_issues.size(), 3);
+    QCOMPARE(report.m_fileCount, 1);
+
+    QSet<VXNotebookChecker::IssueType> types;
+    for (const auto &issue : report.m_issues) {
+        types.insert(issue.m_type);
+    }
+    QVERIFY(types.contains(VXNotebookChecker::IssueType::MissingFile));
+    QVERIFY(types.contains(VXNotebookChecker::IssueType::UnindexedFile));
+    QVERIFY(types.contains(VXNotebookChecker::IssueType::OrphanedAttachmentFolder));
+
+    QCOMPARE(checker.repair(report), 3);
+    notebook->getAsyncBackend()->waitForDone();
+    QVERIFY(!folder->findChild("missing.md"));
+    QVERIFY(folder->findChild("unindexed.md"));
+    QVERIFY(!QFileInfo::exists(orphanPath));
+
+    report = checker.check();
+    QVERIFY(report.m_issues.isEmpty());
+    QCOMPARE(report.m_fileCount, 2);
+}
+
+void TestNotebook::testNotebookReindex()
+{
+    auto notebook = newTestNotebook("reindex_notebook");
+    auto root = notebook->getRootNode();
+    notebook->newNode(root.data(), Node::Flag::Content, "indexed.md");
+
+    // Nested folders created outside.
+    const auto deepFolderPath = PathUtils::concatenateFilePath(notebook->getRootFolderAbsolutePath(), "a/b");
+    QVERIFY(QDir().mkpath(deepFolderPath));
+    FileUtils::writeFile(PathUtils::concatenateFilePath(deepFolderPath, "deep.md"), QString("hi"));
+
+    VXNotebookChecker checker(notebook.data());
+    QCOMPARE(checker.reindex(), 3);
+
+    auto node = notebook->loadNodeByPath(PathUtils::concatenateFilePath(deepFolderPath, "deep.md"));
+    QVERIFY(node);
+    QVERIFY(node->hasContent());
+
+    QVERIFY(checker.check().m_issues.isEmpty());
+    QCOMPARE(checker.reindex(), 0);
+}
+
+void TestNotebook::testNodeMetadataTable()
+{
+    auto notebook = newTestNotebook("metadata_table_notebook");
+    auto root = notebook->getRootNode();
+    auto folder = notebook->newNode(root.data(), Node::Flag::Container, "folder");
+
+    const auto now = QDateTime::currentDateTimeUtc();
+    auto addNote = [&](const QString &p_name, int p_size, int p_ageDays, const QStringList &p_tags) {
+        FileUtils::writeFile(PathUtils::concatenateFilePath(folder->fetchAbsolutePath(), p_name), QByteArray(p_size, 'a'));
+        NodeParameters paras;
+        paras.m_modifiedTimeUtc = now.addDays(-p_ageDays);
+        paras.m_tags = p_tags;
+        notebook->addAsNode(folder.data(), Node::Flag::Content, p_name, paras);
+    };
+    addNote("old.md", 10, 30, {"work"});
+    addNote("small.md", 20, 1, {"work"});
+    addNote("large.md", 300, 2, {"work", "todo"});
+    addNote("untagged.md", 400, 1, {});
+
+    auto table = notebook->getNodeMetadataTable();
+
+    NodeMetadataQuery query;
+    query.m_modifiedAfterMsecs = now.addDays(-7).toMSecsSinceEpoch();
+    query.m_tags << "work";
+    query.m_sortKey = NodeMetadataQuery::SortKey::Size;
+    auto rows = table->query(query);
+    QCOMPARE(rows.size(), 2);
+    QCOMPARE(table->getName(rows[0]), QString("large.md"));
+    QCOMPARE(table->fetchPath(rows[0]), QString("folder/large.md"));
+    QCOMPARE(table->getSize(rows[0]), qint64(300));
+    QCOMPARE(table->getName(rows[1]), QString("small.md"));
+
+    query.m_tags << "todo";
+    QCOMPARE(table->query(query).size(), 1);
+
+    query.m_tags = QStringList("unknown_tag");
+    QVERIFY(table->query(query).isEmpty());
+
+    // Changes are picked up after configs are written.
+    addNote("new.md", 1, 0, {"work"});
+    query.m_tags = QStringList("work");
+    query.m_sortKey = NodeMetadataQuery::SortKey::ModifiedTime;
+    query.m_limit = 1;
+    rows = table->query(query);
+    QCOMPARE(rows.size(), 1);
+    QCOMPARE(table->getName(rows[0]), QString("new.md"));
+
+    // Rows are updated in place when content is written.
+    const int rowCount = table->rowCount();
+    auto oldNote = folder->findChild("old.md");
+    oldNote->getContentFile()->write(QString(500, 'b'));
+    query.m_sortKey = NodeMetadataQuery::SortKey::Size;
+    rows = table->query(query);
+    QCOMPARE(rows.size(), 1);
+    QCOMPARE(table->getName(rows[0]), QString("old.md"));
+    QCOMPARE(table->getSize(rows[0]), qint64(500));
+    QCOMPARE(table->rowCount(), rowCount);
+
+    // Built in background from configs without loading folders.
+    notebook->reloadNodes();
+    QVERIFY(!table->isBuilt());
+    QSignalSpy builtSpy(table, &NodeMetadataTable::built);
+    table->buildAsync();
+    QTRY_COMPARE(builtSpy.count(), 1);
+    QVERIFY(!notebook->getRootNode()->findChild("folder")->isLoaded());
+    QCOMPARE(table->rowCount(), rowCount);
+    query.m_limit = 0;
+    QCOMPARE(table->query(query).size(), 4);
+}
+
+void TestNotebook::testRefreshNodeOnExternalChanges()
+{
+    auto notebook = newTestNotebook("refresh_node_notebook");
+    auto root = notebook->getRootNode();
+    auto folder = notebook->newNode(root.data(), Node::Flag::Container, "folder");
+    auto noteA = notebook->newNode(folder.data(), Node::Flag::Content, "a.md");
+    auto noteB = notebook->newNode(folder.data(), Node::Flag::Content, "b.md");
+
+    const auto configPath = PathUtils::concatenateFilePath(folder->fetchAbsolutePath(), "vx.json");
+    const auto oldConfig = FileUtils::readFile(configPath);
+    auto noteC = notebook->newNode(folder.data(), Node::Flag::Content, "c.md");
+    const auto noteCId = noteC->getId();
+    const auto newConfig = FileUtils::readFile(configPath);
+
+    // Nothing changed.
+    QVERIFY(!notebook->refreshNode(folder.data()));
+
+    // Config reverted outside, such as by git checkout.
+    FileUtils::writeFile(configPath, oldConfig);
+    QVERIFY(notebook->refreshNode(folder.data()));
+    QCOMPARE(folder->getChildrenCount(), 2);
+    QVERIFY(!folder->findChild("c.md"));
+    // Unchanged children are kept.
+    QCOMPARE(folder->findChild("a.md"), noteA);
+    QCOMPARE(folder->findChild("b.md"), noteB);
+
+    FileUtils::writeFile(configPath, newConfig);
+    QVERIFY(notebook->refreshNode(folder.data()));
+    QCOMPARE(folder->getChildrenCount(), 3);
+    auto refreshedC = folder->findChild("c.md");
+    QVERIFY(refreshedC);
+    QCOMPARE(refreshedC->getId(), noteCId);
+    QCOMPARE(folder->findChild("a.md"), noteA);
+
+    // Metadata of kept children changed outside.
+    {
+        auto jobj = QJsonDocument::fromJson(FileUtils::readFile(configPath)).object();
+        auto files = jobj["files"].toArray();
+        for (int i = 0; i < files.size(); ++i) {
+            auto file = files[i].toObject();
+            if (file["name"].toString() == "a.md") {
+                file["tags"] = QJsonArray::fromStringList({"outside"});
+                files[i] = file;
+            }
+        }
+        jobj["files"] = files;
+        FileUtils::writeFile(configPath, QJsonDocument(jobj).toJson());
+    }
+    QVERIFY(notebook->refreshNode(folder.data()));
+    QCOMPARE(folder->findChild("a.md"), noteA);
+    QCOMPARE(noteA->getTags(), QStringList({"outside"}));
+    QVERIFY(!notebook->refreshNode(folder.data()));
+
+    NotebookWatcher watcher;
+    watcher.setNotebook(notebook);
+    QVector<Node *> refreshedNodes;
+    connect(notebook.data(), &Notebook::nodeRefreshed,
+            this, [&refreshedNodes](Node *p_node) {
+                refreshedNodes.push_back(p_node);
+            });
+
+    // Changes by VNote itself are not refreshed.
+    notebook->newNode(folder.data(), Node::Flag::Content, "d.md");
+    QTest::qWait(1500);
+    QVERIFY(refreshedNodes.isEmpty());
+
+    // Watcher picks up files removed outside.
+    QVERIFY(QFile::remove(noteB->fetchAbsolutePath()));
+    QTRY_VERIFY_WITH_TIMEOUT(!refreshedNodes.isEmpty(), 10000);
+    QCOMPARE(refreshedNodes.first(), folder.data());
+    QVERIFY(!noteB->exists());
+    QVERIFY(noteA->exists());
+    QCOMPARE(folder->findChild("b.md"), noteB);
+}
+
+void TestNotebook::testImportFolderContents()
+{
+    auto notebook = newTestNotebook("import_folder_notebook");
+    auto root = notebook->getRootNode();
+    const auto rootPath = root->fetchAbsolutePath();
+    QVERIFY(QDir().mkpath(PathUtils::concatenateFilePath(rootPath, "sub/deep")));
+    FileUtils::writeFile(PathUtils::concatenateFilePath(rootPath, "a.md"), QString("a"));
+    FileUtils::writeFile(PathUtils::concatenateFilePath(rootPath, "skipped.txt"), QString("txt"));
+    FileUtils::writeFile(PathUtils::concatenateFilePath(rootPath, "sub/deep/b.md"), QString("b"));
+#if defined(Q_OS_UNIX)
+    // Links are not imported, as before the bulk import.
+    QVERIFY(QFile::link(PathUtils::concatenateFilePath(rootPath, "a.md"),
+                        PathUtils::concatenateFilePath(rootPath, "link.md")));
+    QVERIFY(QFile::link(PathUtils::concatenateFilePath(rootPath, "sub"),
+                        PathUtils::concatenateFilePath(rootPath, "link_dir")));
+#endif
+
+    QString errMsg;
+    ImportFolderUtils::importFolderContents(notebook.data(), root.data(), {"md"}, errMsg);
+    QVERIFY(errMsg.isEmpty());
+
+    QVERIFY(root->findChild("a.md"));
+    QVERIFY(!root->findChild("skipped.txt"));
+    QVERIFY(!root->findChild("link.md"));
+    QVERIFY(!root->findChild("link_dir"));
+    auto sub = root->findChild("sub");
+    QVERIFY(sub && sub->isContainer());
+    auto deep = sub->findChild("deep");
+    QVERIFY(deep);
+    QVERIFY(deep->findChild("b.md"));
+
+    // Configs are written once the bulk update ends.
+    QVERIFY(FileUtils::readFile(PathUtils::concatenateFilePath(rootPath, "sub/deep/vx.json")).contains("b.md"));
+}
+
+void TestNotebook::testBufferOverlappingSaves()
+{
+    const auto filePath = PathUtils::concatenateFilePath(getTestFolderPath(), "overlapping_saves.md");
+    FileUtils::writeFile(filePath, QString("v0"));
+
+    BufferParameters paras;
+    paras.m_provider.reset(new FileBufferProvider(QSharedPointer<ExternalFile>::create(filePath), nullptr, false));
+    Buffer buffer(paras);
+
+    QVector<Buffer::OperationCode> codes;
+    int lastSavedRevision = -1;
+    connect(&buffer, &Buffer::saveFinished,
+            this, [&codes, &lastSavedRevision](Buffer::OperationCode p_code, int p_revision) {
+                codes.push_back(p_code);
+                lastSavedRevision = p_revision;
+            });
+
+    // Saves requested while one is running are coalesced into one save of the latest content.
+    // Our own writes in flight are not taken as changes from outside.
+    int revision = 0;
+    for (int i = 1; i <= 5; ++i) {
+        buffer.setContent(QString("v%1").arg(i), revision);
+        buffer.saveAsync(false);
+        QVERIFY(!buffer.checkFileChangedOutside());
+    }
+
+    QTRY_COMPARE(lastSavedRevision, revision);
+    for (auto code : codes) {
+        QVERIFY(code == Buffer::OperationCode::Success);
+    }
+    QVERIFY(!buffer.isModified());
+    QVERIFY(!buffer.checkFileChangedOutside());
+    QCOMPARE(FileUtils::readTextFile(filePath), QStringLiteral("v5"));
+
+    buffer.close();
+}
+
 QString TestNotebook::getTestFolderPath() const
 {
     return m_testDir->path();
 }
 
+QSharedPointer<Notebook> TestNotebook::newTestNotebook(const QString &p_name)
+{
+    NotebookParameters para;
+    para.m_name = p_name;
+    para.m_rootFolderPath = PathUtils::concatenateFilePath(getTestFolderPath(), p_name);
+    para.m_notebookBackend = m_backendServer->getItem("local.vnotex")
+                                            ->createNotebookBackend(para.m_rootFolderPath);
+    para.m_versionController = m_vcServer->getItem("dummy.vnotex")->createVersionController();
+    para.m_notebookConfigMgr = m_ncmServer->getItem("vx.vnotex")->createNotebookConfigMgr(para.m_notebookBackend);
+
+    return m_nbServer->getItem("bundle.vnotex")->newNotebook(para);
+}
+
 QTEST_MAIN(tests::TestNotebook)
@@ -14,6 +14,7 @@ namespace vnotex
     class INotebookConfigMgrFactory;
     class INotebookBackendFactory;
     class INotebookFactory;
+    class Notebook;
 }
 
 namespace tests
@@ -28,6 +29,8 @@ namespace tests
         // Define test cases here per slot.
         void testVersionControllerServer();
 
+        void testGitStatusParsing();
+
         void testNotebookConfigMgrServer();
 
         void testNotebookBackendServer();
@@ -36,9 +39,35 @@ namespace tests
 
         void testBundleNotebookFactoryNewNotebook();
 
+        void benchmarkFetchNodePath();
+
+        void testAsyncBackendCopyDir();
+
+        void testMoveNodeWithinNotebook();
+
+        void testMediaStoreRefCount();
+
+        void testMediaGarbageCollector();
+
+        void testPurgeRecycleBin();
+
+        void testNotebookChecker();
+
+        void testNotebookReindex();
+
+        void testNodeMetadataTable();
+
+        void testRefreshNodeOnExternalChanges();
+
+        void testImportFolderContents();
+
+        void testBufferOverlappingSaves();
+
     private:
         QString getTestFolderPath() const;
 
+        QSharedPointer<vnotex::Notebook> newTestNotebook(const QString &p_name);
+
         QSharedPointer<QTemporaryDir> m_testDir;
 
         QSharedPointer<vnotex::NameBasedServer<vnotex::IVersionControllerFactory>> m_vcServer;
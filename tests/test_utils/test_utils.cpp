@@ -2,9 +2,15 @@
 
 #include <QDebug>
 #include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QRandomGenerator>
 
 #include <utils/pathutils.h>
 #include <utils/fileutils.h>
+#include <utils/textutils.h>
+#include <utils/mappedtextfile.h>
+#include <utils/adaptivesynctimer.h>
+#include <core/exception.h>
 
 using namespace tests;
 
@@ -227,4 +233,367 @@ void TestUtils::testIsText()
     }
 }
 
+void TestUtils::testListDir()
+{
+    QTemporaryDir dir;
+    const QString testFolderPath(dir.path());
+
+    QDir paDir(testFolderPath);
+    QVERIFY(paDir.mkdir("dirb"));
+    QVERIFY(paDir.mkdir("DirA"));
+    QVERIFY(paDir.mkdir(".hidden_dir"));
+
+    for (const auto &name : {"fileb.md", "FileA.md", ".hidden_file"}) {
+        QFile file(testFolderPath + "/" + name);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.close();
+    }
+
+    auto entries = FileUtils::listDir(testFolderPath);
+    QCOMPARE(entries.m_folders, QStringList({"DirA", "dirb"}));
+    QCOMPARE(entries.m_files, QStringList({"FileA.md", "fileb.md"}));
+
+    // Should be the same as entryList().
+    QCOMPARE(entries.m_folders, paDir.entryList(QDir::Dirs | QDir::NoSymLinks | QDir::NoDotAndDotDot));
+    QCOMPARE(entries.m_files, paDir.entryList(QDir::Files));
+
+#if defined(Q_OS_UNIX)
+    // Links to folders are skipped while links to files are optional.
+    QVERIFY(QFile::link(testFolderPath + "/DirA", testFolderPath + "/link_dir"));
+    QVERIFY(QFile::link(testFolderPath + "/FileA.md", testFolderPath + "/link_file.md"));
+    entries = FileUtils::listDir(testFolderPath);
+    QCOMPARE(entries.m_folders, QStringList({"DirA", "dirb"}));
+    QCOMPARE(entries.m_files, QStringList({"FileA.md", "fileb.md", "link_file.md"}));
+
+    entries = FileUtils::listDir(testFolderPath, false);
+    QCOMPARE(entries.m_folders, QStringList({"DirA", "dirb"}));
+    QCOMPARE(entries.m_files, QStringList({"FileA.md", "fileb.md"}));
+#endif
+}
+
+void TestUtils::testCopyFile()
+{
+    QTemporaryDir dir;
+    const QString testFolderPath(dir.path());
+
+    // Larger than one page to exercise the chunked paths.
+    QByteArray data;
+    for (int i = 0; i < 100000; ++i) {
+        data.append(static_cast<char>(i % 251));
+    }
+
+    const auto srcFilePath = testFolderPath + "/src.bin";
+    FileUtils::writeFile(srcFilePath, data);
+
+    const auto destFilePath = testFolderPath + "/sub/dest.bin";
+    const auto method = FileUtils::copyFile(srcFilePath, destFilePath);
+    QVERIFY(method < FileUtils::CopyMethod::Rename);
+    QVERIFY(!FileUtils::copyMethodToString(method).isEmpty());
+    QVERIFY(FileUtils::getCopyMethodCount(method) > 0);
+    QCOMPARE(FileUtils::readFile(destFilePath), data);
+
+    // Empty file.
+    const auto emptyFilePath = testFolderPath + "/empty.bin";
+    FileUtils::writeFile(emptyFilePath, QByteArray());
+    FileUtils::copyFile(emptyFilePath, testFolderPath + "/empty_copy.bin");
+    QCOMPARE(QFileInfo(testFolderPath + "/empty_copy.bin").size(), 0);
+
+    // Existing target is not overwritten.
+    bool thrown = false;
+    try {
+        FileUtils::copyFile(emptyFilePath, destFilePath);
+    } catch (Exception &p_e) {
+        Q_UNUSED(p_e);
+        thrown = true;
+    }
+    QVERIFY(thrown);
+    QCOMPARE(FileUtils::readFile(destFilePath), data);
+}
+
+void TestUtils::testWriteFileAtomically()
+{
+    QTemporaryDir dir;
+    const QString testFolderPath(dir.path());
+
+    const auto filePath = testFolderPath + "/note.md";
+    FileUtils::writeFileAtomically(filePath, "# Title\nfirst");
+    QCOMPARE(FileUtils::readTextFile(filePath), QString("# Title\nfirst"));
+
+    // Overwrite.
+    FileUtils::writeFileAtomically(filePath, "second");
+    QCOMPARE(FileUtils::readTextFile(filePath), QString("second"));
+
+    // No temporary file left.
+    QCOMPARE(QDir(testFolderPath).entryList(QDir::Files | QDir::Hidden), QStringList("note.md"));
+
+    // Missing folder.
+    bool thrown = false;
+    try {
+        FileUtils::writeFileAtomically(testFolderPath + "/missing/note.md", "text");
+    } catch (Exception &p_e) {
+        Q_UNUSED(p_e);
+        thrown = true;
+    }
+    QVERIFY(thrown);
+}
+
+void TestUtils::testDiffLines()
+{
+    const QStringList oldLines({"a", "b", "c", "d"});
+
+    auto patch = TextUtils::diffLines(oldLines, oldLines);
+    QVERIFY(patch.isEmpty());
+
+    patch = TextUtils::diffLines(oldLines, QStringList({"a", "x", "y", "d"}));
+    QCOMPARE(patch.m_startLine, 1);
+    QCOMPARE(patch.m_removedCount, 2);
+    QCOMPARE(patch.m_insertedLines, QStringList({"x", "y"}));
+
+    // Insertion of a line the same as its neighbor.
+    patch = TextUtils::diffLines(oldLines, QStringList({"a", "b", "b", "c", "d"}));
+    QCOMPARE(patch.m_removedCount, 0);
+    QCOMPARE(patch.m_insertedLines.size(), 1);
+
+    patch = TextUtils::diffLines(oldLines, QStringList());
+    QCOMPARE(patch.m_startLine, 0);
+    QCOMPARE(patch.m_removedCount, 4);
+
+    // One line edited in a note of about 1 MB.
+    QStringList lines;
+    for (int i = 0; i < 20000; ++i) {
+        lines << QString("Line %1 of a large note with some more words to fill it up.").arg(i);
+    }
+    const auto text = lines.join('\n');
+    auto newText = text;
+    newText.insert(text.size() / 2, QStringLiteral("typed"));
+
+    QBENCHMARK {
+        patch = TextUtils::diffLines(lines, newText.split('\n'));
+    }
+    QCOMPARE(patch.m_removedCount, 1);
+    QCOMPARE(patch.m_insertedLines.size(), 1);
+
+    TextUtils::applyPatch(lines, patch);
+    QCOMPARE(lines.join('\n'), newText);
+}
+
+void TestUtils::testRandomLinePatches()
+{
+    // Edits as typed in the editor, each sent to the viewer as one patch against the last text.
+    QRandomGenerator rand(41);
+    QStringList sent;
+    for (int i = 0; i < 300; ++i) {
+        sent << QString("line %1").arg(i);
+    }
+
+    QStringList viewer = sent;
+    for (int round = 0; round < 500; ++round) {
+        auto lines = sent;
+        const int pos = rand.bounded(lines.size() + 1);
+        switch (rand.bounded(4)) {
+        case 0:
+            lines.insert(pos, QString("inserted %1").arg(round));
+            break;
+
+        case 1:
+            if (pos < lines.size()) {
+                lines.removeAt(pos);
+            }
+            break;
+
+        case 2:
+            if (pos < lines.size()) {
+                lines[pos] += QStringLiteral(" typed");
+            }
+            break;
+
+        default:
+            // Paste several lines, some of them the same as their neighbors.
+            for (int k = rand.bounded(1, 5); k > 0; --k) {
+                lines.insert(pos, pos > 0 ? lines[pos - 1] : QString());
+            }
+            break;
+        }
+
+        const auto patch = TextUtils::diffLines(sent, lines);
+        QVERIFY(patch.m_startLine + patch.m_removedCount <= sent.size());
+        TextUtils::applyPatch(viewer, patch);
+        QCOMPARE(viewer, lines);
+        sent = lines;
+    }
+}
+
+void TestUtils::testPatchToString()
+{
+    QStringList lines({"# Title", "", "body", "end"});
+    QVector<TextUtils::LinePatch> patches;
+    patches << TextUtils::diffLines(lines, QStringList({"# Title", "", "new", "body", "end"}));
+    patches << TextUtils::diffLines(QStringList({"a", "b"}), QStringList({"a"}));
+    // One empty line differs from no line.
+    patches << TextUtils::diffLines(QStringList({"a"}), QStringList({"a", ""}));
+
+    QString journal;
+    for (const auto &patch : patches) {
+        journal += TextUtils::patchToString(patch);
+    }
+
+    int pos = 0;
+    for (const auto &patch : patches) {
+        TextUtils::LinePatch parsed;
+        QVERIFY(TextUtils::patchFromString(journal, pos, parsed));
+        QCOMPARE(parsed.m_startLine, patch.m_startLine);
+        QCOMPARE(parsed.m_removedCount, patch.m_removedCount);
+        QCOMPARE(parsed.m_insertedLines, patch.m_insertedLines);
+    }
+    QCOMPARE(pos, journal.size());
+
+    // Truncated last record.
+    const auto truncated = journal.left(journal.size() - 1);
+    pos = 0;
+    int cnt = 0;
+    TextUtils::LinePatch parsed;
+    while (TextUtils::patchFromString(truncated, pos, parsed)) {
+        ++cnt;
+    }
+    QCOMPARE(cnt, patches.size() - 1);
+}
+
+void TestUtils::testMappedTextFile()
+{
+    QTemporaryDir dir;
+    const auto filePath = dir.path() + "/large.log";
+
+    // Three pages by line count and a trailing new line.
+    const int cnt = MappedTextFile::c_maxLinesPerPage * 2 + 10;
+    QStringList lines;
+    for (int i = 0; i < cnt; ++i) {
+        lines << QString("line %1 \u00e9").arg(i);
+    }
+    lines << QString();
+    const auto text = lines.join('\n');
+    FileUtils::writeFile(filePath, text.toUtf8());
+
+    MappedTextFile file(filePath);
+    QVERIFY(file.open());
+    QCOMPARE(file.pageCount(), 3);
+    QCOMPARE(file.lineCount(), lines.size());
+
+    QStringList readLines;
+    for (int i = 0; i < file.pageCount(); ++i) {
+        QCOMPARE(file.pageFirstLine(i), readLines.size());
+        readLines << file.readPage(i).split('\n');
+    }
+    QCOMPARE(readLines, lines);
+
+    QCOMPARE(file.pageOfLine(0), 0);
+    QCOMPARE(file.pageOfLine(MappedTextFile::c_maxLinesPerPage), 1);
+    QCOMPARE(file.pageOfLine(cnt - 1), 2);
+
+    auto matcher = [](const QString &p_line) {
+        return p_line.startsWith(QStringLiteral("line 25000 "));
+    };
+    QCOMPARE(file.findLine(0, true, matcher), 25000);
+    // Wrap around.
+    QCOMPARE(file.findLine(30000, true, matcher), 25000);
+    QCOMPARE(file.findLine(10, false, matcher), 25000);
+    QCOMPARE(file.findLine(0, true, [](const QString &p_line) {
+        return p_line.contains("nothing");
+    }), -1);
+
+    // A line longer than one page is cut at a character boundary.
+    const QString longLine(MappedTextFile::c_maxPageBytes, QChar(0x00e9));
+    FileUtils::writeFile(filePath, (QStringLiteral("head\n") + longLine).toUtf8());
+    QVERIFY(file.open());
+    QCOMPARE(file.lineCount(), 2);
+    QVERIFY(file.pageCount() > 2);
+    QString tail;
+    for (int i = 1; i < file.pageCount(); ++i) {
+        QCOMPARE(file.pageFirstLine(i), 1);
+        tail += file.readPage(i);
+    }
+    QCOMPARE(file.readPage(0), QStringLiteral("head"));
+    QCOMPARE(tail, longLine);
+    QCOMPARE(file.pageOfLine(1), 1);
+
+    // Pages are not touched once the file is truncated outside.
+    QVERIFY(!file.isStale());
+    FileUtils::writeFile(filePath, QByteArray("head\n"));
+    QVERIFY(file.isStale());
+    QVERIFY(file.readPage(1).isEmpty());
+    QCOMPARE(file.findLine(0, true, [](const QString &p_line) {
+        Q_UNUSED(p_line);
+        return true;
+    }), -1);
+
+    // Empty file.
+    FileUtils::writeFile(filePath, QByteArray());
+    QVERIFY(file.open());
+    QCOMPARE(file.pageCount(), 1);
+    QCOMPARE(file.lineCount(), 1);
+    QVERIFY(file.readPage(0).isEmpty());
+}
+
+void TestUtils::testAdaptiveSyncTimer()
+{
+    AdaptiveSyncTimer timer(10, 1000);
+    QCOMPARE(timer.interval(), 10);
+
+    bool deferring = false;
+    connect(&timer, &AdaptiveSyncTimer::timeout,
+            this, [&timer, &deferring]() {
+                if (deferring) {
+                    timer.defer();
+                } else {
+                    QTest::qSleep(100);
+                }
+            });
+    QSignalSpy spy(&timer, &AdaptiveSyncTimer::timeout);
+
+    // Synchronous work finishes with timeout() and scales the interval.
+    timer.start();
+    QVERIFY(spy.wait());
+    QVERIFY(!timer.isInFlight());
+    QVERIFY(timer.getCost() >= 100);
+    QVERIFY(timer.interval() >= 200);
+    QVERIFY(timer.interval() <= 1000);
+
+    timer.reset();
+    QCOMPARE(timer.interval(), 10);
+
+    // Requests during deferred work are merged into one.
+    deferring = true;
+    timer.start();
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(timer.isInFlight());
+    timer.start();
+    timer.start();
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 2);
+
+    timer.finish();
+    QVERIFY(!timer.isInFlight());
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 3);
+    timer.finish();
+
+    // Nothing pending any more.
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 3);
+
+    // Deferred work never finished is given up by the watchdog and the merged request goes on.
+    timer.start();
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 4);
+    QVERIFY(timer.isInFlight());
+    timer.start();
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 4);
+    QVERIFY(spy.wait(10000));
+    QCOMPARE(spy.count(), 5);
+    QVERIFY(timer.isInFlight());
+    timer.finish();
+    QVERIFY(!timer.isInFlight());
+}
+
 QTEST_MAIN(tests::TestUtils)
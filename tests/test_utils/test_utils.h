@@ -32,6 +32,25 @@ namespace tests
         void testRenameFile();
 
         void testIsText();
+
+        void testListDir();
+
+        void testCopyFile();
+
+        void testWriteFileAtomically();
+
+        // TextUtils Tests.
+        void testDiffLines();
+
+        void testRandomLinePatches();
+
+        void testPatchToString();
+
+        // MappedTextFile Tests.
+        void testMappedTextFile();
+
+        // AdaptiveSyncTimer Tests.
+        void testAdaptiveSyncTimer();
     };
 } // ns tests
 
@@ -11,9 +11,15 @@ INCLUDEPATH *= $$SRC_FOLDER
 SOURCES += \
     test_utils.cpp \
     $$UTILS_FOLDER/pathutils.cpp \
-    $$UTILS_FOLDER/fileutils.cpp
+    $$UTILS_FOLDER/fileutils.cpp \
+    $$UTILS_FOLDER/textutils.cpp \
+    $$UTILS_FOLDER/mappedtextfile.cpp \
+    $$UTILS_FOLDER/adaptivesynctimer.cpp
 
 HEADERS += \
     test_utils.h \
     $$UTILS_FOLDER/pathutils.h \
-    $$UTILS_FOLDER/fileutils.h
+    $$UTILS_FOLDER/fileutils.h \
+    $$UTILS_FOLDER/textutils.h \
+    $$UTILS_FOLDER/mappedtextfile.h \
+    $$UTILS_FOLDER/adaptivesynctimer.h